@@ -1 +1,83 @@
-// TODO 
\ No newline at end of file
+// crc16.c
+#include "crc16.h"
+#include "crc16_tables.h"
+
+uint16_t crc16_update_bitwise(uint16_t crc, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)((uint16_t)data[i] << 8);
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+uint16_t crc16_update_table(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len--)
+    {
+        crc = (uint16_t)((crc << 8) ^ crc16_t0[(uint8_t)((crc >> 8) ^ *data++)]);
+    }
+
+    return crc;
+}
+
+// The 16-bit register overlaps the first two bytes of each slice; every
+// other byte only needs its "followed by N zero bytes" table.
+uint16_t crc16_update_slice4(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len >= 4)
+    {
+        crc = (uint16_t)(crc16_t3[(uint8_t)((crc >> 8) ^ data[0])] ^
+                         crc16_t2[(uint8_t)(crc ^ data[1])] ^
+                         crc16_t1[data[2]] ^
+                         crc16_t0[data[3]]);
+        data += 4;
+        len -= 4;
+    }
+
+    return crc16_update_table(crc, data, len);
+}
+
+uint16_t crc16_update_slice8(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len >= 8)
+    {
+        crc = (uint16_t)(crc16_t7[(uint8_t)((crc >> 8) ^ data[0])] ^
+                         crc16_t6[(uint8_t)(crc ^ data[1])] ^
+                         crc16_t5[data[2]] ^
+                         crc16_t4[data[3]] ^
+                         crc16_t3[data[4]] ^
+                         crc16_t2[data[5]] ^
+                         crc16_t1[data[6]] ^
+                         crc16_t0[data[7]]);
+        data += 8;
+        len -= 8;
+    }
+
+    return crc16_update_table(crc, data, len);
+}
+
+uint16_t crc16_update(uint16_t crc, const uint8_t *data, size_t len)
+{
+#if CRC16_IMPL == CRC16_IMPL_BITWISE
+    return crc16_update_bitwise(crc, data, len);
+#elif CRC16_IMPL == CRC16_IMPL_TABLE
+    return crc16_update_table(crc, data, len);
+#elif CRC16_IMPL == CRC16_IMPL_SLICE4
+    return crc16_update_slice4(crc, data, len);
+#elif CRC16_IMPL == CRC16_IMPL_SLICE8
+    return crc16_update_slice8(crc, data, len);
+#else
+#error "Unknown CRC16_IMPL"
+#endif
+}
+
+uint16_t crc16_ccitt(const uint8_t *data, size_t len)
+{
+    return crc16_final(crc16_update(crc16_init(), data, len));
+}
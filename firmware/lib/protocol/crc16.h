@@ -1 +1,67 @@
-// TODO 
\ No newline at end of file
+// crc16.h
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+    CRC16 (CCITT-FALSE)
+
+    Responsibilities:
+    - Compute the frame check sequence used by the telemetry packet format.
+    - Provide an incremental init/update/final API so frames can be checked
+      as they stream in.
+
+    Engines (select with -D CRC16_IMPL=<n>, default CRC16_IMPL_TABLE):
+    - CRC16_IMPL_BITWISE: reference, no tables, ~8 shifts per byte.
+    - CRC16_IMPL_TABLE:   one 256-entry table (512 B), one lookup per byte.
+    - CRC16_IMPL_SLICE4:  four tables (2 KB), four bytes per step.
+    - CRC16_IMPL_SLICE8:  eight tables (4 KB), eight bytes per step.
+    The slicing engines only pay off on long buffers; short telemetry frames
+    are dominated by the byte-wise tail.
+
+    Invariants:
+    - Polynomial 0x1021, initial value 0xFFFF, no reflection, no final XOR.
+    - crc16_ccitt("123456789") == 0x29B1.
+    - All engines produce identical results for any split of the input.
+*/
+
+#define CRC16_IMPL_BITWISE 0
+#define CRC16_IMPL_TABLE 1
+#define CRC16_IMPL_SLICE4 2
+#define CRC16_IMPL_SLICE8 3
+
+#ifndef CRC16_IMPL
+#define CRC16_IMPL CRC16_IMPL_TABLE
+#endif
+
+#define CRC16_INIT_VALUE 0xFFFFu
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint16_t crc16_init(void)
+{
+    return (uint16_t)CRC16_INIT_VALUE;
+}
+
+// Feed len bytes into a running CRC using the build-selected engine.
+uint16_t crc16_update(uint16_t crc, const uint8_t *data, size_t len);
+
+static inline uint16_t crc16_final(uint16_t crc)
+{
+    return crc; // CCITT-FALSE has no output XOR
+}
+
+// One-shot convenience: crc16_final(crc16_update(crc16_init(), data, len)).
+uint16_t crc16_ccitt(const uint8_t *data, size_t len);
+
+// Individual engines, always available for cross-checking and benchmarks.
+uint16_t crc16_update_bitwise(uint16_t crc, const uint8_t *data, size_t len);
+uint16_t crc16_update_table(uint16_t crc, const uint8_t *data, size_t len);
+uint16_t crc16_update_slice4(uint16_t crc, const uint8_t *data, size_t len);
+uint16_t crc16_update_slice8(uint16_t crc, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
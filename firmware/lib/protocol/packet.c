@@ -1 +1,588 @@
-// TODO 
\ No newline at end of file
+// packet.c
+#include "packet.h"
+#include "crc16.h"
+
+#include <string.h>
+
+static void put_u16le(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32le(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_u48le(uint8_t *p, uint64_t v)
+{
+    put_u32le(p, (uint32_t)v);
+    put_u16le(&p[4], (uint16_t)(v >> 32));
+}
+
+static uint16_t get_u16le(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static uint32_t get_u32le(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u48le(const uint8_t *p)
+{
+    return (uint64_t)get_u32le(p) | ((uint64_t)get_u16le(&p[4]) << 32);
+}
+
+size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out, size_t out_cap)
+{
+    if (out == NULL || PKT_COBS_MAX(len) > out_cap)
+        return 0;
+
+    size_t code_idx = 0; // where the current block's code byte goes
+    size_t o = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (in[i] == 0)
+        {
+            out[code_idx] = code;
+            code_idx = o++;
+            code = 1;
+            continue;
+        }
+
+        out[o++] = in[i];
+        code++;
+
+        // A full block of 254 data bytes ends without an implied zero.
+        if (code == 0xFF)
+        {
+            out[code_idx] = code;
+            code_idx = o++;
+            code = 1;
+        }
+    }
+
+    out[code_idx] = code;
+    return o;
+}
+
+size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t out_cap)
+{
+    if (in == NULL || out == NULL)
+        return 0;
+
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < len)
+    {
+        uint8_t code = in[i++];
+        if (code == 0)
+            return 0; // delimiter inside a frame
+
+        for (uint8_t k = 1; k < code; k++)
+        {
+            if (i >= len || in[i] == 0 || o >= out_cap)
+                return 0;
+            out[o++] = in[i++];
+        }
+
+        // Every block except a full one (and the last) is followed by an implied zero.
+        if (code != 0xFF && i < len)
+        {
+            if (o >= out_cap)
+                return 0;
+            out[o++] = 0;
+        }
+    }
+
+    return o;
+}
+
+size_t pkt_encode(const pkt_t *pkt, uint8_t *out, size_t out_cap)
+{
+    if (pkt == NULL || out == NULL || pkt->payload_len > PKT_MAX_PAYLOAD)
+        return 0;
+    if (pkt->payload_len > 0 && pkt->payload == NULL)
+        return 0;
+
+    uint8_t raw[PKT_MAX_RAW];
+    raw[0] = pkt->type;
+    put_u16le(&raw[1], pkt->seq);
+    put_u48le(&raw[3], pkt->timestamp_us);
+    if (pkt->payload_len > 0)
+    {
+        memcpy(&raw[PKT_HEADER_SIZE], pkt->payload, pkt->payload_len);
+    }
+
+    size_t raw_len = PKT_HEADER_SIZE + pkt->payload_len;
+    uint16_t crc = crc16_ccitt(raw, raw_len);
+    raw[raw_len++] = (uint8_t)(crc >> 8);
+    raw[raw_len++] = (uint8_t)crc;
+
+    if (out_cap < 2)
+        return 0;
+
+    out[0] = PKT_FRAME_DELIM;
+    size_t n = cobs_encode(raw, raw_len, &out[1], out_cap - 2);
+    if (n == 0)
+        return 0;
+    out[1 + n] = PKT_FRAME_DELIM;
+    return n + 2;
+}
+
+bool pkt_decode(const uint8_t *frame, size_t len, uint8_t *scratch, size_t scratch_cap, pkt_t *pkt)
+{
+    if (frame == NULL || scratch == NULL || pkt == NULL)
+        return false;
+
+    // Strip optional delimiters.
+    while (len > 0 && frame[0] == PKT_FRAME_DELIM)
+    {
+        frame++;
+        len--;
+    }
+    while (len > 0 && frame[len - 1] == PKT_FRAME_DELIM)
+    {
+        len--;
+    }
+
+    size_t raw_len = cobs_decode(frame, len, scratch, scratch_cap);
+    if (raw_len < PKT_HEADER_SIZE + PKT_CRC_SIZE)
+        return false;
+    if (crc16_ccitt(scratch, raw_len) != 0)
+        return false;
+
+    return pkt_view_raw(scratch, raw_len, pkt);
+}
+
+bool pkt_view_raw(const uint8_t *raw, size_t raw_len, pkt_t *pkt)
+{
+    if (raw == NULL || pkt == NULL || raw_len < PKT_HEADER_SIZE + PKT_CRC_SIZE)
+        return false;
+
+    pkt->type = raw[0];
+    pkt->seq = get_u16le(&raw[1]);
+    pkt->timestamp_us = get_u48le(&raw[3]);
+    pkt->payload = &raw[PKT_HEADER_SIZE];
+    pkt->payload_len = raw_len - PKT_HEADER_SIZE - PKT_CRC_SIZE;
+    return true;
+}
+
+size_t pkt_telemetry_pack(const pkt_telemetry_t *rec, uint8_t *out, size_t out_cap)
+{
+    if (rec == NULL || out == NULL || out_cap < PKT_TELEMETRY_PAYLOAD_SIZE)
+        return 0;
+
+    out[0] = rec->state;
+    put_u32le(&out[1], rec->telemetry_period_ms);
+    put_u32le(&out[5], rec->heartbeat_period_ms);
+    put_u32le(&out[9], rec->fault_count);
+    return PKT_TELEMETRY_PAYLOAD_SIZE;
+}
+
+bool pkt_telemetry_unpack(const uint8_t *payload, size_t len, pkt_telemetry_t *rec)
+{
+    if (payload == NULL || rec == NULL || len != PKT_TELEMETRY_PAYLOAD_SIZE)
+        return false;
+
+    rec->state = payload[0];
+    rec->telemetry_period_ms = get_u32le(&payload[1]);
+    rec->heartbeat_period_ms = get_u32le(&payload[5]);
+    rec->fault_count = get_u32le(&payload[9]);
+    return true;
+}
+
+size_t pkt_replay_pack(uint32_t spool_seq, const pkt_telemetry_t *rec, uint8_t *out, size_t out_cap)
+{
+    if (rec == NULL || out == NULL || out_cap < PKT_REPLAY_PAYLOAD_SIZE)
+        return 0;
+
+    put_u32le(&out[0], spool_seq);
+    return 4u + pkt_telemetry_pack(rec, &out[4], out_cap - 4u);
+}
+
+bool pkt_replay_unpack(const uint8_t *payload, size_t len, uint32_t *spool_seq, pkt_telemetry_t *rec)
+{
+    if (payload == NULL || spool_seq == NULL || len != PKT_REPLAY_PAYLOAD_SIZE)
+        return false;
+
+    *spool_seq = get_u32le(&payload[0]);
+    return pkt_telemetry_unpack(&payload[4], len - 4u, rec);
+}
+
+size_t pkt_summary_pack(const pkt_summary_t *sum, uint8_t *out, size_t out_cap)
+{
+    if (sum == NULL || out == NULL || out_cap < PKT_SUMMARY_PAYLOAD_SIZE)
+        return 0;
+
+    const uint32_t fields[10] = {sum->window_ms, sum->count, sum->lost,
+                                 (uint32_t)sum->min, (uint32_t)sum->max,
+                                 (uint32_t)sum->mean_q8, sum->stddev_q8,
+                                 (uint32_t)sum->p50, (uint32_t)sum->p90, (uint32_t)sum->p99};
+    out[0] = sum->channel;
+    for (size_t i = 0; i < 10u; i++)
+        put_u32le(&out[1u + 4u * i], fields[i]);
+    return PKT_SUMMARY_PAYLOAD_SIZE;
+}
+
+bool pkt_summary_unpack(const uint8_t *payload, size_t len, pkt_summary_t *sum)
+{
+    if (payload == NULL || sum == NULL || len != PKT_SUMMARY_PAYLOAD_SIZE)
+        return false;
+
+    sum->channel = payload[0];
+    sum->window_ms = get_u32le(&payload[1]);
+    sum->count = get_u32le(&payload[5]);
+    sum->lost = get_u32le(&payload[9]);
+    sum->min = (int32_t)get_u32le(&payload[13]);
+    sum->max = (int32_t)get_u32le(&payload[17]);
+    sum->mean_q8 = (int32_t)get_u32le(&payload[21]);
+    sum->stddev_q8 = get_u32le(&payload[25]);
+    sum->p50 = (int32_t)get_u32le(&payload[29]);
+    sum->p90 = (int32_t)get_u32le(&payload[33]);
+    sum->p99 = (int32_t)get_u32le(&payload[37]);
+    return true;
+}
+
+size_t pkt_stream_pack(const pkt_stream_t *blk, uint8_t *out, size_t out_cap)
+{
+    if (blk == NULL || out == NULL || blk->count > PKT_STREAM_MAX_SAMPLES || (blk->count > 0 && blk->samples == NULL))
+        return 0;
+
+    size_t len = PKT_STREAM_HEADER_SIZE + 2u * (size_t)blk->count;
+    if (out_cap < len)
+        return 0;
+
+    out[0] = blk->channel;
+    out[1] = blk->count;
+    put_u16le(&out[2], blk->rate_hz);
+    put_u32le(&out[4], blk->first_index);
+    put_u32le(&out[8], blk->lost);
+    for (size_t i = 0; i < blk->count; i++)
+        put_u16le(&out[PKT_STREAM_HEADER_SIZE + 2u * i], (uint16_t)blk->samples[i]);
+    return len;
+}
+
+bool pkt_stream_unpack(const uint8_t *payload, size_t len, pkt_stream_t *blk, int16_t *samples, size_t max)
+{
+    if (payload == NULL || blk == NULL || samples == NULL || len < PKT_STREAM_HEADER_SIZE)
+        return false;
+
+    uint8_t count = payload[1];
+    if (len != PKT_STREAM_HEADER_SIZE + 2u * (size_t)count || count > max)
+        return false;
+
+    blk->channel = payload[0];
+    blk->count = count;
+    blk->rate_hz = get_u16le(&payload[2]);
+    blk->first_index = get_u32le(&payload[4]);
+    blk->lost = get_u32le(&payload[8]);
+    for (size_t i = 0; i < count; i++)
+        samples[i] = (int16_t)get_u16le(&payload[PKT_STREAM_HEADER_SIZE + 2u * i]);
+    blk->samples = samples;
+    return true;
+}
+
+size_t pkt_varint_encode(uint32_t v, uint8_t *out, size_t out_cap)
+{
+    size_t n = 0;
+    do
+    {
+        if (n >= out_cap)
+            return 0;
+        uint8_t b = (uint8_t)(v & 0x7Fu);
+        v >>= 7;
+        out[n++] = v ? (uint8_t)(b | 0x80u) : b;
+    } while (v);
+    return n;
+}
+
+size_t pkt_varint_decode(const uint8_t *in, size_t len, uint32_t *v)
+{
+    uint32_t x = 0;
+    for (size_t i = 0; i < len && i < PKT_VARINT_MAX; i++)
+    {
+        x |= (uint32_t)(in[i] & 0x7Fu) << (7 * i);
+        if ((in[i] & 0x80u) == 0)
+        {
+            // The fifth byte only has 4 bits of room.
+            if (i == PKT_VARINT_MAX - 1 && in[i] > 0x0Fu)
+                return 0;
+            *v = x;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+void pkt_delta_init(pkt_delta_t *d, uint16_t key_interval)
+{
+    if (d == NULL)
+        return;
+
+    memset(d, 0, sizeof(*d));
+    d->key_interval = key_interval ? key_interval : 1;
+}
+
+void pkt_delta_request_key(pkt_delta_t *enc)
+{
+    if (enc != NULL)
+        enc->have_ref = false;
+}
+
+size_t pkt_delta_encode(pkt_delta_t *enc, const uint32_t *fields, size_t count, uint8_t *out, size_t out_cap, bool *key)
+{
+    if (enc == NULL || fields == NULL || out == NULL || key == NULL || count > PKT_DELTA_MAX_FIELDS || out_cap < 1)
+        return 0;
+
+    bool keyframe = !enc->have_ref || enc->since_key >= enc->key_interval;
+    uint8_t mask = 0;
+    size_t n = 1;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t v;
+        if (keyframe)
+            v = fields[i];
+        else
+            v = pkt_zigzag_encode((int32_t)(fields[i] - enc->ref[i]));
+        if (v == 0)
+            continue;
+
+        size_t w = pkt_varint_encode(v, &out[n], out_cap - n);
+        if (w == 0)
+            return 0;
+        n += w;
+        mask |= (uint8_t)(1u << i);
+    }
+    out[0] = mask;
+
+    for (size_t i = 0; i < count; i++)
+        enc->ref[i] = fields[i];
+    enc->have_ref = true;
+    enc->since_key = keyframe ? 1 : (uint16_t)(enc->since_key + 1);
+    *key = keyframe;
+    return n;
+}
+
+bool pkt_delta_decode(pkt_delta_t *dec, bool key, uint16_t seq, const uint8_t *payload, size_t len, uint32_t *fields, size_t count)
+{
+    if (dec == NULL || payload == NULL || fields == NULL || count > PKT_DELTA_MAX_FIELDS || len < 1)
+        return false;
+    if (!key && (!dec->have_ref || seq != dec->next_seq))
+    {
+        dec->have_ref = false; // missed a record: deltas are useless until a keyframe
+        return false;
+    }
+
+    uint8_t mask = payload[0];
+    if (count < PKT_DELTA_MAX_FIELDS && (mask >> count) != 0)
+        return false;
+
+    uint32_t next[PKT_DELTA_MAX_FIELDS];
+    size_t pos = 1;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t v = 0;
+        if (mask & (1u << i))
+        {
+            size_t r = pkt_varint_decode(&payload[pos], len - pos, &v);
+            if (r == 0)
+                return false;
+            pos += r;
+        }
+        next[i] = key ? v : dec->ref[i] + (uint32_t)pkt_zigzag_decode(v);
+    }
+    if (pos != len)
+        return false;
+
+    for (size_t i = 0; i < count; i++)
+        dec->ref[i] = fields[i] = next[i];
+    dec->have_ref = true;
+    dec->next_seq = (uint16_t)(seq + 1);
+    return true;
+}
+
+static void telemetry_to_fields(const pkt_telemetry_t *rec, uint32_t *f)
+{
+    f[0] = rec->state;
+    f[1] = rec->telemetry_period_ms;
+    f[2] = rec->heartbeat_period_ms;
+    f[3] = rec->fault_count;
+}
+
+size_t pkt_telemetry_pack_delta(pkt_delta_t *enc, const pkt_telemetry_t *rec, uint8_t *out, size_t out_cap, uint8_t *type)
+{
+    if (rec == NULL || type == NULL)
+        return 0;
+
+    uint32_t f[PKT_TELEMETRY_FIELDS];
+    telemetry_to_fields(rec, f);
+
+    bool key = false;
+    size_t n = pkt_delta_encode(enc, f, PKT_TELEMETRY_FIELDS, out, out_cap, &key);
+    *type = key ? PKT_TYPE_TELEMETRY_KEY : PKT_TYPE_TELEMETRY_DELTA;
+    return n;
+}
+
+bool pkt_telemetry_unpack_delta(pkt_delta_t *dec, const pkt_t *pkt, pkt_telemetry_t *rec)
+{
+    if (dec == NULL || pkt == NULL || rec == NULL)
+        return false;
+
+    uint32_t f[PKT_TELEMETRY_FIELDS];
+    if (pkt->type == PKT_TYPE_TELEMETRY)
+    {
+        // A full record is as good as a keyframe.
+        if (!pkt_telemetry_unpack(pkt->payload, pkt->payload_len, rec))
+            return false;
+        telemetry_to_fields(rec, f);
+        memcpy(dec->ref, f, sizeof(f));
+        dec->have_ref = true;
+        dec->next_seq = (uint16_t)(pkt->seq + 1);
+        return true;
+    }
+    if (pkt->type == PKT_TYPE_TELEMETRY_REPLAY)
+    {
+        uint32_t spool_seq;
+        return pkt_replay_unpack(pkt->payload, pkt->payload_len, &spool_seq, rec);
+    }
+    if (pkt->type != PKT_TYPE_TELEMETRY_KEY && pkt->type != PKT_TYPE_TELEMETRY_DELTA)
+        return false;
+
+    if (!pkt_delta_decode(dec, pkt->type == PKT_TYPE_TELEMETRY_KEY, pkt->seq, pkt->payload, pkt->payload_len, f, PKT_TELEMETRY_FIELDS))
+        return false;
+    if (f[0] > 0xFFu)
+        return false;
+
+    rec->state = (uint8_t)f[0];
+    rec->telemetry_period_ms = f[1];
+    rec->heartbeat_period_ms = f[2];
+    rec->fault_count = f[3];
+    return true;
+}
+
+size_t pkt_changes_pack(pkt_delta_t *enc, const pkt_changes_t *c, uint8_t *out, size_t out_cap, uint8_t *type)
+{
+    if (c == NULL || type == NULL || out == NULL || out_cap < 2 || c->channels > PKT_CHANGES_MAX_CHANNELS)
+        return 0;
+
+    uint32_t f[PKT_DELTA_MAX_FIELDS];
+    telemetry_to_fields(&c->rec, f);
+    for (size_t i = 0; i < c->channels; i++)
+        f[PKT_TELEMETRY_FIELDS + i] = pkt_zigzag_encode(c->value[i]);
+
+    bool key = false;
+    size_t n = pkt_delta_encode(enc, f, PKT_TELEMETRY_FIELDS + c->channels, &out[1], out_cap - 1, &key);
+    if (n == 0)
+        return 0;
+    out[0] = c->channels;
+    *type = key ? PKT_TYPE_CHANGES_KEY : PKT_TYPE_CHANGES_DELTA;
+    return n + 1;
+}
+
+bool pkt_changes_unpack(pkt_delta_t *dec, const pkt_t *pkt, pkt_changes_t *c)
+{
+    if (dec == NULL || pkt == NULL || c == NULL || pkt->payload_len < 2)
+        return false;
+    if (pkt->type != PKT_TYPE_CHANGES_KEY && pkt->type != PKT_TYPE_CHANGES_DELTA)
+        return false;
+
+    uint8_t channels = pkt->payload[0];
+    if (channels > PKT_CHANGES_MAX_CHANNELS)
+        return false;
+
+    uint32_t f[PKT_DELTA_MAX_FIELDS];
+    if (!pkt_delta_decode(dec, pkt->type == PKT_TYPE_CHANGES_KEY, pkt->seq, &pkt->payload[1], pkt->payload_len - 1, f,
+                          PKT_TELEMETRY_FIELDS + channels))
+        return false;
+    if (f[0] > 0xFFu)
+        return false;
+
+    c->rec.state = (uint8_t)f[0];
+    c->rec.telemetry_period_ms = f[1];
+    c->rec.heartbeat_period_ms = f[2];
+    c->rec.fault_count = f[3];
+    c->channels = channels;
+    for (size_t i = 0; i < channels; i++)
+        c->value[i] = pkt_zigzag_decode(f[PKT_TELEMETRY_FIELDS + i]);
+    return true;
+}
+
+size_t pkt_channels_pack(const pkt_channel_value_t *values, size_t count, uint8_t *out, size_t out_cap)
+{
+    if ((values == NULL && count > 0) || out == NULL || out_cap < 1 || count > 0xFFu)
+        return 0;
+
+    size_t n = 1;
+    out[0] = (uint8_t)count;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (n >= out_cap)
+            return 0;
+        out[n++] = values[i].channel;
+        size_t w = pkt_varint_encode(pkt_zigzag_encode(values[i].value), &out[n], out_cap - n);
+        if (w == 0)
+            return 0;
+        n += w;
+    }
+    return n;
+}
+
+bool pkt_channels_unpack(const uint8_t *payload, size_t len, pkt_channel_value_t *values, size_t max, size_t *count)
+{
+    if (payload == NULL || count == NULL || len < 1 || payload[0] > max || (values == NULL && payload[0] > 0))
+        return false;
+
+    size_t n = payload[0];
+    size_t pos = 1;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (pos >= len)
+            return false;
+        values[i].channel = payload[pos++];
+        uint32_t v = 0;
+        size_t r = pkt_varint_decode(&payload[pos], len - pos, &v);
+        if (r == 0)
+            return false;
+        pos += r;
+        values[i].value = pkt_zigzag_decode(v);
+    }
+    if (pos != len)
+        return false;
+    *count = n;
+    return true;
+}
+
+size_t pkt_dgram_header_pack(const pkt_dgram_t *h, uint8_t *out, size_t out_cap)
+{
+    if (h == NULL || out == NULL || out_cap < PKT_DGRAM_HEADER_SIZE)
+        return 0;
+
+    out[0] = PKT_DGRAM_MAGIC;
+    out[1] = PKT_DGRAM_VERSION;
+    put_u16le(&out[2], h->node);
+    put_u32le(&out[4], h->seq);
+    return PKT_DGRAM_HEADER_SIZE;
+}
+
+bool pkt_dgram_header_unpack(const uint8_t *in, size_t len, pkt_dgram_t *h)
+{
+    if (in == NULL || h == NULL || len < PKT_DGRAM_HEADER_SIZE)
+        return false;
+    if (in[0] != PKT_DGRAM_MAGIC || in[1] != PKT_DGRAM_VERSION)
+        return false;
+
+    h->node = get_u16le(&in[2]);
+    h->seq = get_u32le(&in[4]);
+    return true;
+}
@@ -1 +1,313 @@
-// TODO 
\ No newline at end of file
+// packet.h
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+    Binary Telemetry Packet Format
+
+    Responsibilities:
+    - Define the on-wire layout of binary telemetry packets.
+    - Encode packets into self-synchronizing COBS frames and decode them back.
+
+    Wire layout (before COBS, all multi-byte fields little-endian except CRC):
+        [type:1][seq:2][timestamp_us:6][payload:0..PKT_MAX_PAYLOAD][crc16:2 big-endian]
+
+    Timestamp:
+    - Microseconds since boot from the 64-bit monotonic clock, sent as the
+      low 48 bits (wraps after ~8.9 years).
+
+    Framing:
+    - The raw packet is COBS encoded so it contains no 0x00 bytes, then wrapped
+      in 0x00 delimiters: 00 <cobs bytes> 00. The leading delimiter flushes any
+      text or line noise a receiver may have buffered since the last frame.
+    - CRC16 (CCITT-FALSE) covers type..payload. Running the CRC over the whole
+      raw packet including the big-endian CRC yields 0.
+
+    Compressed telemetry (optional, negotiated by the application):
+    - PKT_TYPE_TELEMETRY_KEY / PKT_TYPE_TELEMETRY_DELTA carry the record as a
+      list of uint32 fields: [present mask:1][varint per present field].
+    - A keyframe sends absolute values; zero fields are left out of the mask.
+    - A delta sends zig-zag varints of (field - previous field) for the fields
+      that changed; unchanged fields cost nothing, an idle record is 1 byte.
+    - Deltas apply to the record with the previous seq. After a gap a
+      receiver waits for the next keyframe (every key_interval records).
+
+    Replayed telemetry:
+    - PKT_TYPE_TELEMETRY_REPLAY carries a record recorded earlier (e.g. from
+      the flash spool while the host was away): [spool seq:4 LE][13-byte
+      record]. The header timestamp is the original one and the header seq
+      is the low 16 bits of the spool seq; the full 32-bit value is what a
+      host passes back to resume a replay. Replayed records never touch
+      live delta state.
+
+    Window summaries:
+    - PKT_TYPE_SUMMARY replaces a channel's raw samples with one record
+      per window: [channel:1][window_ms:4][count:4][lost:4][min:4][max:4]
+      [mean_q8:4][stddev_q8:4][p50:4][p90:4][p99:4], little-endian, values
+      in channel units. Mean and standard deviation are fixed point with 8
+      fractional bits, saturated to their range. The header timestamp is
+      when the window closed; summaries have their own seq stream.
+
+    Stream blocks:
+    - PKT_TYPE_STREAM carries consecutive samples of one channel taken on a
+      fixed-rate timer: [channel:1][count:1][rate_hz:2][first_index:4]
+      [lost:4][count x int16 sample], little-endian. first_index numbers
+      the block's first sample since STREAM START, so a gap in it is a lost
+      block; lost is the running total of samples dropped on overruns.
+      Samples are raw channel units saturated to int16. The header
+      timestamp is when the block was sent; blocks have their own seq stream.
+
+    Changed telemetry (publish on change):
+    - PKT_TYPE_CHANGES_KEY / PKT_TYPE_CHANGES_DELTA carry the telemetry
+      record followed by the latest value of up to PKT_CHANGES_MAX_CHANNELS
+      sensor channels, through the delta coder: [channels:1][present mask:1]
+      [varint per present field]. Channel values are zig-zag coded.
+    - The sender only sends a record when a field changed, so the mask of a
+      delta is the set of changed fields. Periods with nothing to report
+      send nothing and take no seq, so deltas still chain; keyframes come
+      every N periods and on request. This stream shares its seq with the
+      other telemetry types.
+
+    Subscribed channels:
+    - PKT_TYPE_CHANNELS carries the latest value of every subscribed channel
+      whose period came up in one tick: [count:1] then per channel
+      [channel:1][zig-zag varint value]. A tick with more channels due
+      than one payload holds sends several. The header timestamp is the
+      tick; these records have their own seq stream.
+
+    Datagram links (UDP):
+    - Each datagram starts with an 8-byte header and carries whole
+      messages only (frames and reply lines, as on the serial link):
+      [magic:1 'T'][version:1][node:2 LE][seq:4 LE][messages...].
+      seq counts datagrams per node from 0 at boot, so a collector sees
+      loss and reordering from gaps in it; node tells the senders apart.
+
+    Invariants:
+    - Encoders never write past out_cap; they return 0 if the frame does not fit.
+    - Decoders never write past scratch_cap and reject frames with bad CRC.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PKT_FRAME_DELIM 0x00u
+
+#define PKT_HEADER_SIZE 9u
+#define PKT_CRC_SIZE 2u
+#define PKT_MAX_PAYLOAD 128u
+#define PKT_MAX_RAW (PKT_HEADER_SIZE + PKT_MAX_PAYLOAD + PKT_CRC_SIZE)
+#define PKT_TIMESTAMP_MASK 0xFFFFFFFFFFFFull // 48-bit on-wire timestamp
+
+// COBS adds one byte per 254 bytes of input (plus one), framing adds two delimiters.
+#define PKT_COBS_MAX(n) ((n) + ((n) / 254u) + 1u)
+#define PKT_MAX_FRAME (PKT_COBS_MAX(PKT_MAX_RAW) + 2u)
+
+typedef enum
+{
+    PKT_TYPE_TELEMETRY = 0x01,       // fixed 13-byte record
+    PKT_TYPE_TELEMETRY_KEY = 0x02,   // varint record, absolute values
+    PKT_TYPE_TELEMETRY_DELTA = 0x03, // varint record, changes since seq - 1
+    PKT_TYPE_TELEMETRY_REPLAY = 0x04, // spool seq + fixed record, recorded earlier
+    PKT_TYPE_SUMMARY = 0x05,          // per-channel window statistics
+    PKT_TYPE_STREAM = 0x06,           // block of fixed-rate samples, one channel
+    PKT_TYPE_CHANGES_KEY = 0x07,      // record + channel values, absolute
+    PKT_TYPE_CHANGES_DELTA = 0x08,    // changed fields only, since seq - 1
+    PKT_TYPE_CHANNELS = 0x09          // subscribed channel values due together
+} pkt_type_t;
+
+typedef struct
+{
+    uint8_t type;
+    uint16_t seq;
+    uint64_t timestamp_us;  // only the low 48 bits are sent
+    const uint8_t *payload; // points into caller-owned storage
+    size_t payload_len;
+} pkt_t;
+
+// Telemetry record carried in PKT_TYPE_TELEMETRY packets.
+// Uptime is carried in the packet header timestamp.
+typedef struct
+{
+    uint8_t state;
+    uint32_t telemetry_period_ms;
+    uint32_t heartbeat_period_ms;
+    uint32_t fault_count;
+} pkt_telemetry_t;
+
+#define PKT_TELEMETRY_PAYLOAD_SIZE 13u
+#define PKT_TELEMETRY_FIELDS 4u
+#define PKT_REPLAY_PAYLOAD_SIZE (4u + PKT_TELEMETRY_PAYLOAD_SIZE)
+
+// Window summary carried in PKT_TYPE_SUMMARY packets.
+typedef struct
+{
+    uint8_t channel;
+    uint32_t window_ms;
+    uint32_t count;
+    uint32_t lost;
+    int32_t min;
+    int32_t max;
+    int32_t mean_q8;    // mean * 256
+    uint32_t stddev_q8; // standard deviation * 256
+    int32_t p50;
+    int32_t p90;
+    int32_t p99;
+} pkt_summary_t;
+
+#define PKT_SUMMARY_PAYLOAD_SIZE 41u
+
+// Block of streamed samples carried in PKT_TYPE_STREAM packets.
+#define PKT_STREAM_HEADER_SIZE 12u
+#define PKT_STREAM_MAX_SAMPLES ((PKT_MAX_PAYLOAD - PKT_STREAM_HEADER_SIZE) / 2u)
+
+typedef struct
+{
+    uint8_t channel;
+    uint8_t count;        // samples in this block
+    uint16_t rate_hz;
+    uint32_t first_index; // sample number of samples[0] since the stream started
+    uint32_t lost;        // samples dropped on overruns so far
+    const int16_t *samples;
+} pkt_stream_t;
+
+#define PKT_VARINT_MAX 5u      // bytes in the longest uint32 varint
+
+// One channel value in a PKT_TYPE_CHANNELS record.
+typedef struct
+{
+    uint8_t channel;
+    int32_t value;
+} pkt_channel_value_t;
+
+// Values that always fit one PKT_TYPE_CHANNELS payload.
+#define PKT_CHANNELS_MAX_VALUES ((PKT_MAX_PAYLOAD - 1u) / (1u + PKT_VARINT_MAX))
+#define PKT_DELTA_MAX_FIELDS 8u // one bit each in the present mask
+#define PKT_DELTA_MAX_PAYLOAD (1u + PKT_DELTA_MAX_FIELDS * PKT_VARINT_MAX)
+#define PKT_DELTA_DEFAULT_KEY_INTERVAL 32u
+
+// Telemetry record plus channel values carried in PKT_TYPE_CHANGES_* packets.
+#define PKT_CHANGES_MAX_CHANNELS (PKT_DELTA_MAX_FIELDS - PKT_TELEMETRY_FIELDS)
+#define PKT_CHANGES_MAX_PAYLOAD (1u + PKT_DELTA_MAX_PAYLOAD)
+
+// Header of a datagram on a UDP link.
+#define PKT_DGRAM_MAGIC 0x54u // 'T'
+#define PKT_DGRAM_VERSION 1u
+#define PKT_DGRAM_HEADER_SIZE 8u
+
+typedef struct
+{
+    uint16_t node;
+    uint32_t seq;
+} pkt_dgram_t;
+
+typedef struct
+{
+    pkt_telemetry_t rec;
+    uint8_t channels; // values used, <= PKT_CHANGES_MAX_CHANNELS
+    int32_t value[PKT_CHANGES_MAX_CHANNELS];
+} pkt_changes_t;
+
+// Delta coder state; one per direction (encoder on the node, decoder per
+// receiver stream).
+typedef struct
+{
+    uint32_t ref[PKT_DELTA_MAX_FIELDS]; // fields of the last record sent / received
+    uint16_t key_interval; // encoder: records per keyframe (1 = keyframes only)
+    uint16_t since_key;    // encoder: records since the last keyframe
+    uint16_t next_seq;     // decoder: seq a delta must carry to apply
+    bool have_ref;         // ref is valid (encoder: a keyframe was sent)
+} pkt_delta_t;
+
+static inline uint32_t pkt_zigzag_encode(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t pkt_zigzag_decode(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1u);
+}
+
+// COBS encode len bytes of in into out. Returns encoded length or 0 if out_cap is too small.
+size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out, size_t out_cap);
+
+// COBS decode len bytes (no delimiters) of in into out. Returns decoded length or 0 on error.
+size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t out_cap);
+
+// Encode a packet as a complete delimited frame. Returns frame length or 0 on error.
+size_t pkt_encode(const pkt_t *pkt, uint8_t *out, size_t out_cap);
+
+// Decode one frame (delimiters optional) into scratch. On success pkt->payload
+// points into scratch. Returns false on framing, length or CRC errors.
+bool pkt_decode(const uint8_t *frame, size_t len, uint8_t *scratch, size_t scratch_cap, pkt_t *pkt);
+
+// Fill pkt from a decoded raw packet (header, payload, CRC) without copying.
+// Checks only the length; callers validate the CRC. pkt->payload points into raw.
+bool pkt_view_raw(const uint8_t *raw, size_t raw_len, pkt_t *pkt);
+
+// Serialize / parse the telemetry record payload.
+size_t pkt_telemetry_pack(const pkt_telemetry_t *rec, uint8_t *out, size_t out_cap);
+bool pkt_telemetry_unpack(const uint8_t *payload, size_t len, pkt_telemetry_t *rec);
+
+// Serialize / parse a PKT_TYPE_TELEMETRY_REPLAY payload.
+size_t pkt_replay_pack(uint32_t spool_seq, const pkt_telemetry_t *rec, uint8_t *out, size_t out_cap);
+bool pkt_replay_unpack(const uint8_t *payload, size_t len, uint32_t *spool_seq, pkt_telemetry_t *rec);
+
+// Serialize / parse a PKT_TYPE_SUMMARY payload.
+size_t pkt_summary_pack(const pkt_summary_t *sum, uint8_t *out, size_t out_cap);
+bool pkt_summary_unpack(const uint8_t *payload, size_t len, pkt_summary_t *sum);
+
+// Serialize a PKT_TYPE_STREAM payload (count <= PKT_STREAM_MAX_SAMPLES).
+// unpack copies at most max samples into samples and points blk->samples
+// at them.
+size_t pkt_stream_pack(const pkt_stream_t *blk, uint8_t *out, size_t out_cap);
+bool pkt_stream_unpack(const uint8_t *payload, size_t len, pkt_stream_t *blk, int16_t *samples, size_t max);
+
+// Serialize / parse a PKT_TYPE_CHANNELS payload (count <= 255). unpack
+// rejects records of more than max values and sets *count.
+size_t pkt_channels_pack(const pkt_channel_value_t *values, size_t count, uint8_t *out, size_t out_cap);
+bool pkt_channels_unpack(const uint8_t *payload, size_t len, pkt_channel_value_t *values, size_t max, size_t *count);
+
+// Write / read the header at the start of a datagram. unpack rejects
+// short datagrams and a wrong magic or version.
+size_t pkt_dgram_header_pack(const pkt_dgram_t *h, uint8_t *out, size_t out_cap);
+bool pkt_dgram_header_unpack(const uint8_t *in, size_t len, pkt_dgram_t *h);
+
+// LEB128 varint (7 bits per byte, low first). encode returns bytes written or
+// 0 if out_cap is too small; decode returns bytes read or 0 if truncated/overlong.
+size_t pkt_varint_encode(uint32_t v, uint8_t *out, size_t out_cap);
+size_t pkt_varint_decode(const uint8_t *in, size_t len, uint32_t *v);
+
+// key_interval 0 is treated as 1. Also forces the next record to be a keyframe.
+void pkt_delta_init(pkt_delta_t *d, uint16_t key_interval);
+
+// Make the next encoded record a keyframe (e.g. a receiver asked to resync).
+void pkt_delta_request_key(pkt_delta_t *enc);
+
+// Encode count (<= PKT_DELTA_MAX_FIELDS) fields as a keyframe or delta
+// payload. *key tells which. Returns payload length or 0 if out_cap is too small.
+size_t pkt_delta_encode(pkt_delta_t *enc, const uint32_t *fields, size_t count, uint8_t *out, size_t out_cap, bool *key);
+
+// Apply a keyframe or delta payload with sequence number seq. Returns false
+// on malformed payloads and on deltas that do not follow the last record
+// (lost packet: wait for the next keyframe).
+bool pkt_delta_decode(pkt_delta_t *dec, bool key, uint16_t seq, const uint8_t *payload, size_t len, uint32_t *fields, size_t count);
+
+// Telemetry record through the delta coder. pack sets *type to
+// PKT_TYPE_TELEMETRY_KEY or _DELTA; unpack accepts every telemetry type
+// (replayed records are returned without updating dec).
+size_t pkt_telemetry_pack_delta(pkt_delta_t *enc, const pkt_telemetry_t *rec, uint8_t *out, size_t out_cap, uint8_t *type);
+bool pkt_telemetry_unpack_delta(pkt_delta_t *dec, const pkt_t *pkt, pkt_telemetry_t *rec);
+
+// Record and channel values through the delta coder. pack sets *type to
+// PKT_TYPE_CHANGES_KEY or _DELTA; the channel count must stay the same
+// between keyframes. unpack accepts only those two types.
+size_t pkt_changes_pack(pkt_delta_t *enc, const pkt_changes_t *c, uint8_t *out, size_t out_cap, uint8_t *type);
+bool pkt_changes_unpack(pkt_delta_t *dec, const pkt_t *pkt, pkt_changes_t *c);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1 +1,124 @@
-// TODO 
\ No newline at end of file
+// parser.c
+#include "parser.h"
+#include "crc16.h"
+
+#include <string.h>
+
+static void start_frame(parser_t *p)
+{
+    p->len = 0;
+    p->state = PARSER_CODE;
+    p->zero_pending = false;
+}
+
+static void drop_frame(parser_t *p)
+{
+    p->stats.resyncs++;
+    p->state = PARSER_HUNT;
+}
+
+static bool append(parser_t *p, uint8_t b)
+{
+    if (p->len >= sizeof(p->buf))
+    {
+        p->stats.overruns++;
+        drop_frame(p);
+        return false;
+    }
+    p->buf[p->len++] = b;
+    return true;
+}
+
+static void end_frame(parser_t *p)
+{
+    if (p->state == PARSER_HUNT)
+        return; // the frame was already dropped and counted
+
+    if (p->state == PARSER_DATA)
+    {
+        p->stats.framing_errors++; // delimiter inside a COBS block
+        return;
+    }
+
+    if (p->len == 0)
+        return; // back-to-back delimiters between frames
+
+    if (p->len < PKT_HEADER_SIZE + PKT_CRC_SIZE)
+    {
+        p->stats.framing_errors++;
+        return;
+    }
+
+    // Running the CRC over data plus its big-endian CRC leaves zero.
+    if (crc16_update(crc16_init(), p->buf, p->len) != 0)
+    {
+        p->stats.crc_errors++;
+        return;
+    }
+
+    pkt_t pkt;
+    pkt_view_raw(p->buf, p->len, &pkt);
+
+    p->stats.frames_ok++;
+    if (p->on_frame)
+        p->on_frame(p->ctx, &pkt);
+}
+
+void parser_init(parser_t *p, parser_frame_cb_t on_frame, void *ctx)
+{
+    if (p == NULL)
+        return;
+
+    memset(p, 0, sizeof(*p));
+    p->on_frame = on_frame;
+    p->ctx = ctx;
+    start_frame(p);
+}
+
+void parser_feed(parser_t *p, const uint8_t *data, size_t len)
+{
+    if (p == NULL || data == NULL)
+        return;
+
+    p->stats.bytes_in += (uint32_t)len;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t b = data[i];
+
+        if (b == PKT_FRAME_DELIM)
+        {
+            end_frame(p);
+            start_frame(p);
+            continue;
+        }
+
+        switch (p->state)
+        {
+        case PARSER_HUNT:
+            break;
+
+        case PARSER_CODE:
+            // A new block means the previous short block ended in a real zero.
+            if (p->zero_pending && !append(p, 0))
+                break;
+            p->remaining = (uint8_t)(b - 1);
+            p->zero_pending = (b != 0xFF);
+            p->state = p->remaining ? PARSER_DATA : PARSER_CODE;
+            break;
+
+        case PARSER_DATA:
+            if (!append(p, b))
+                break;
+            if (--p->remaining == 0)
+                p->state = PARSER_CODE;
+            break;
+        }
+    }
+}
+
+void parser_reset_stats(parser_t *p)
+{
+    if (p != NULL)
+        memset(&p->stats, 0, sizeof(p->stats));
+}
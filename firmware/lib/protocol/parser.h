@@ -1 +1,71 @@
-// TODO 
\ No newline at end of file
+// parser.h
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "packet.h"
+
+/*
+    Streaming Frame Parser
+
+    Responsibilities:
+    - Reassemble COBS framed packets from a byte stream delivered in chunks of
+      any size (including one byte at a time).
+    - Decode COBS in place as bytes arrive and validate the CRC at the delimiter.
+    - Hand each good packet to a callback as a view into the parser's buffer.
+    - Resynchronize on the next 0x00 delimiter after corrupt or oversized input.
+
+    Invariants:
+    - No heap allocation and no copies: pkt->payload points into parser->buf
+      and is only valid for the duration of the callback.
+    - Memory use is fixed at sizeof(parser_t).
+    - Every non-empty frame that is not delivered is counted in exactly one of
+      crc_errors, framing_errors or overruns.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*parser_frame_cb_t)(void *ctx, const pkt_t *pkt);
+
+typedef struct
+{
+    uint32_t frames_ok;      // packets delivered to the callback
+    uint32_t crc_errors;     // complete frames whose CRC did not check
+    uint32_t framing_errors; // truncated COBS blocks or frames shorter than a header
+    uint32_t overruns;       // frames longer than PKT_MAX_RAW
+    uint32_t resyncs;        // times the parser dropped input and hunted for a delimiter
+    uint32_t bytes_in;       // total bytes fed
+} parser_stats_t;
+
+typedef enum
+{
+    PARSER_HUNT = 0, // discarding until the next delimiter
+    PARSER_CODE,     // expecting a COBS code byte
+    PARSER_DATA      // copying data bytes of the current COBS block
+} parser_state_t;
+
+typedef struct
+{
+    uint8_t buf[PKT_MAX_RAW]; // decoded bytes of the frame in progress
+    size_t len;
+    parser_state_t state;
+    uint8_t remaining;        // data bytes left in the current COBS block
+    bool zero_pending;        // previous block implies a zero if more data follows
+    parser_frame_cb_t on_frame;
+    void *ctx;
+    parser_stats_t stats;
+} parser_t;
+
+void parser_init(parser_t *p, parser_frame_cb_t on_frame, void *ctx);
+
+// Feed a chunk of received bytes. Calls on_frame for every good packet completed.
+void parser_feed(parser_t *p, const uint8_t *data, size_t len);
+
+void parser_reset_stats(parser_t *p);
+
+#ifdef __cplusplus
+}
+#endif
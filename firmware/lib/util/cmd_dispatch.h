@@ -0,0 +1,222 @@
+// cmd_dispatch.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+    Compile-time Command Dispatch Table
+
+    Responsibilities:
+    - Split a command line into its command token and argument string in a
+      single pass, without copying or allocating.
+    - Map the command token to its handler through a hash index that is
+      built at compile time from a registration table.
+    - Generate help text from the same table, so HELP never drifts from the
+      registered commands.
+
+    Invariants:
+    - The index is an open-addressed table of 2^k slots (at least twice the
+      number of commands) keyed by FNV-1a; lookup hashes the token once,
+      probes at most max_probe() slots and confirms with one memcmp.
+    - Registering the same name twice fails to compile when the table is
+      declared constexpr.
+    - Registration order is preserved for help text.
+*/
+namespace util
+{
+    typedef struct
+    {
+        const char *ptr;
+        size_t len;
+    } cmd_token_t;
+
+    typedef enum
+    {
+        CMD_BLANK = 0, // empty or whitespace-only line
+        CMD_UNKNOWN,   // no such command, or arguments given to one that takes none
+        CMD_HANDLED
+    } cmd_result_t;
+
+    // Not constexpr on purpose: reaching it while building a constexpr table
+    // turns a duplicate registration into a compile error.
+    inline void cmd_duplicate_name_registered() {}
+
+    template <typename Ctx>
+    struct CmdEntry
+    {
+        const char *name;  // command token, e.g. "RATE"
+        const char *usage; // argument synopsis for help, e.g. "<ms>" ("" if none)
+        bool takes_args;   // false: trailing arguments make the line unknown
+        void (*handler)(Ctx *ctx, const char *args);
+    };
+
+    constexpr size_t cmd_strlen(const char *s)
+    {
+        size_t n = 0;
+        while (s[n] != '\0')
+            n++;
+        return n;
+    }
+
+    constexpr uint32_t cmd_hash(const char *s, size_t len)
+    {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < len; i++)
+            h = (h ^ (uint8_t)s[i]) * 16777619u;
+        return h;
+    }
+
+    constexpr bool cmd_is_space(char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    // Split "  NAME   args..." into name and args. Returns false for a blank line.
+    inline bool cmd_split(const char *line, cmd_token_t *name, const char **args)
+    {
+        while (cmd_is_space(*line))
+            line++;
+        if (*line == '\0')
+            return false;
+
+        const char *end = line;
+        while (*end != '\0' && !cmd_is_space(*end))
+            end++;
+
+        name->ptr = line;
+        name->len = (size_t)(end - line);
+
+        while (cmd_is_space(*end))
+            end++;
+        *args = end;
+        return true;
+    }
+
+    constexpr size_t cmd_index_slots(size_t n)
+    {
+        size_t slots = 4;
+        while (slots < 2 * n)
+            slots <<= 1;
+        return slots;
+    }
+
+    template <typename Ctx, size_t N>
+    class CmdTable
+    {
+    public:
+        static constexpr size_t SLOTS = cmd_index_slots(N);
+        static_assert(N > 0 && N < 255, "CmdTable holds 1..254 commands");
+
+        constexpr CmdTable(const CmdEntry<Ctx> (&entries)[N]) : entries_(), lens_(), slots_(), max_probe_(0)
+        {
+            for (size_t i = 0; i < N; i++)
+            {
+                entries_[i] = entries[i];
+                lens_[i] = cmd_strlen(entries[i].name);
+
+                size_t slot = cmd_hash(entries[i].name, lens_[i]) & (SLOTS - 1);
+                size_t probe = 1;
+                while (slots_[slot] != 0)
+                {
+                    const size_t other = slots_[slot] - 1;
+                    if (same(entries[i].name, lens_[i], entries_[other].name, lens_[other]))
+                        cmd_duplicate_name_registered();
+                    slot = (slot + 1) & (SLOTS - 1);
+                    probe++;
+                }
+                slots_[slot] = (uint8_t)(i + 1);
+                if (probe > max_probe_)
+                    max_probe_ = probe;
+            }
+        }
+
+        // Look up a command token. Returns nullptr if it is not registered.
+        const CmdEntry<Ctx> *find(const char *name, size_t len) const
+        {
+            size_t slot = cmd_hash(name, len) & (SLOTS - 1);
+            for (size_t probe = 0; probe < max_probe_; probe++)
+            {
+                uint8_t idx = slots_[slot];
+                if (idx == 0)
+                    return nullptr;
+                idx--;
+                if (lens_[idx] == len && memcmp(entries_[idx].name, name, len) == 0)
+                    return &entries_[idx];
+                slot = (slot + 1) & (SLOTS - 1);
+            }
+            return nullptr;
+        }
+
+        // Tokenize line, look the command up and run its handler.
+        cmd_result_t dispatch(Ctx *ctx, const char *line) const
+        {
+            cmd_token_t name;
+            const char *args;
+            if (!cmd_split(line, &name, &args))
+                return CMD_BLANK;
+
+            const CmdEntry<Ctx> *cmd = find(name.ptr, name.len);
+            if (cmd == nullptr || (!cmd->takes_args && *args != '\0'))
+                return CMD_UNKNOWN;
+
+            cmd->handler(ctx, args);
+            return CMD_HANDLED;
+        }
+
+        // Append "NAME usage NAME ..." in registration order after prefix.
+        // Returns the text length; output is truncated (and terminated) at cap.
+        size_t help_text(char *out, size_t cap, const char *prefix) const
+        {
+            size_t n = 0;
+            append(out, cap, &n, prefix);
+            for (size_t i = 0; i < N; i++)
+            {
+                if (i > 0)
+                    append(out, cap, &n, " ");
+                append(out, cap, &n, entries_[i].name);
+                if (entries_[i].usage[0] != '\0')
+                {
+                    append(out, cap, &n, " ");
+                    append(out, cap, &n, entries_[i].usage);
+                }
+            }
+            return n;
+        }
+
+        static constexpr size_t size() { return N; }
+        constexpr size_t max_probe() const { return max_probe_; }
+        const CmdEntry<Ctx> &entry(size_t i) const { return entries_[i]; }
+
+    private:
+        static constexpr bool same(const char *a, size_t alen, const char *b, size_t blen)
+        {
+            if (alen != blen)
+                return false;
+            for (size_t i = 0; i < alen; i++)
+            {
+                if (a[i] != b[i])
+                    return false;
+            }
+            return true;
+        }
+
+        static void append(char *out, size_t cap, size_t *n, const char *s)
+        {
+            size_t len = strlen(s);
+            if (cap > 0 && *n < cap - 1)
+            {
+                size_t room = cap - 1 - *n;
+                memcpy(out + *n, s, len < room ? len : room);
+            }
+            *n += len;
+            if (cap > 0)
+                out[*n < cap - 1 ? *n : cap - 1] = '\0';
+        }
+
+        CmdEntry<Ctx> entries_[N];
+        size_t lens_[N];
+        uint8_t slots_[SLOTS]; // 0 = empty, else entry index + 1
+        size_t max_probe_;
+    };
+} // namespace util
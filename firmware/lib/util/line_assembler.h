@@ -0,0 +1,89 @@
+// line_assembler.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    Line Assembler
+
+    Responsibilities:
+    - Turn a byte stream into '\n'-terminated text lines without blocking:
+      bytes are fed as they arrive, in chunks of any size.
+    - Accept both \n and \r\n endings ('\r' is ignored anywhere).
+    - Drop lines that do not fit (N - 1 characters) as a whole and count
+      them, rather than handing out a truncated command.
+
+    Invariants:
+    - feed() stops right after the first complete line; the caller reads it
+      with line() and calls clear() before feeding the rest.
+    - line() is NUL-terminated only once feed() has reported a complete line.
+    - No heap use; state is N bytes plus a few counters.
+*/
+namespace util
+{
+    template <size_t N>
+    class LineAssembler
+    {
+        static_assert(N >= 2, "LineAssembler needs room for one character and the terminator");
+
+    public:
+        static constexpr size_t capacity() { return N - 1; }
+
+        // Consume bytes from data until a line completes or the input runs
+        // out. Returns the number of bytes consumed; *complete tells whether
+        // line() now holds a full line.
+        size_t feed(const uint8_t *data, size_t len, bool *complete)
+        {
+            *complete = false;
+            for (size_t i = 0; i < len; i++)
+            {
+                char c = (char)data[i];
+
+                if (c == '\r')
+                    continue;
+
+                if (c == '\n')
+                {
+                    if (discarding_)
+                    {
+                        // End of an over-long line; start fresh with the next one.
+                        discarding_ = false;
+                        len_ = 0;
+                        continue;
+                    }
+                    buf_[len_] = '\0';
+                    *complete = true;
+                    return i + 1;
+                }
+
+                if (discarding_)
+                    continue;
+
+                if (len_ < N - 1)
+                {
+                    buf_[len_++] = c;
+                }
+                else
+                {
+                    discarding_ = true;
+                    lines_dropped_++;
+                }
+            }
+            return len;
+        }
+
+        const char *line() const { return buf_; }
+        size_t length() const { return len_; }
+
+        // Start the next line (after a complete one has been read).
+        void clear() { len_ = 0; }
+
+        uint32_t lines_dropped() const { return lines_dropped_; }
+
+    private:
+        char buf_[N] = {};
+        size_t len_ = 0;
+        bool discarding_ = false; // dropping the rest of an over-long line
+        uint32_t lines_dropped_ = 0;
+    };
+} // namespace util
@@ -0,0 +1,98 @@
+// log_histogram.h
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+/*
+    Log-Scale Histogram
+
+    Responsibilities:
+    - Record latencies (cycles, microseconds, any uint32) into fixed
+      buckets cheaply enough to leave on in the main loop, and answer
+      count / min / max / mean and approximate percentiles afterwards.
+
+    Buckets:
+    - Half-octave: values 0..3 get a bucket each, then every power of two
+      is split in two ([4,6) [6,8) [8,12) [12,16) ...), 64 buckets for the
+      full uint32 range. A value's bucket is one count-leading-zeros and a
+      shift; the relative width of a bucket is at most 50%.
+    - percentile() answers the upper edge of the bucket holding the rank,
+      capped at max(): never below the true value, at most one bucket above.
+
+    Invariants:
+    - No heap allocation, 256 bytes of counters plus a few totals.
+    - Plain data: all-zero (static storage, memset) is an empty histogram,
+      so it can live inside C-style state structs.
+    - Counts are 32-bit and wrap after 2^32 records (days of loop passes
+      at the fastest loop rates); reset before then.
+*/
+namespace util
+{
+    class LogHistogram
+    {
+    public:
+        static constexpr unsigned BUCKETS = 64;
+
+        void reset() { memset(this, 0, sizeof(*this)); }
+
+        void record(uint32_t v)
+        {
+            min_ = (count_ == 0 || v < min_) ? v : min_;
+            max_ = v > max_ ? v : max_;
+            counts_[bucket_of(v)]++;
+            count_++;
+            sum_ += v;
+        }
+
+        uint32_t count() const { return count_; }
+        uint32_t min() const { return min_; }
+        uint32_t max() const { return max_; }
+        uint64_t sum() const { return sum_; }
+        uint32_t mean() const { return count_ ? (uint32_t)(sum_ / count_) : 0; }
+        uint32_t bucket_count(unsigned b) const { return b < BUCKETS ? counts_[b] : 0; }
+
+        // Value at per_mille (500 = median, 990 = p99); 0 when empty.
+        uint32_t percentile(uint32_t per_mille) const
+        {
+            if (count_ == 0)
+                return 0;
+            uint64_t rank = ((uint64_t)count_ * per_mille + 999u) / 1000u; // ceil
+            rank = rank == 0 ? 1 : rank;
+
+            uint64_t seen = 0;
+            for (unsigned b = 0; b < BUCKETS; b++)
+            {
+                seen += counts_[b];
+                if (seen >= rank)
+                {
+                    uint32_t upper = b + 1 < BUCKETS ? bucket_floor(b + 1) - 1u : UINT32_MAX;
+                    return upper < max_ ? upper : max_;
+                }
+            }
+            return max_;
+        }
+
+        static unsigned bucket_of(uint32_t v)
+        {
+            if (v < 4u)
+                return v;
+            unsigned msb = 31u - (unsigned)__builtin_clz(v);
+            return 2u * msb + ((v >> (msb - 1u)) & 1u);
+        }
+
+        // Smallest value in bucket b.
+        static uint32_t bucket_floor(unsigned b)
+        {
+            if (b < 4u)
+                return b;
+            return (2u | (b & 1u)) << (b / 2u - 1u);
+        }
+
+    private:
+        uint32_t counts_[BUCKETS];
+        uint32_t count_;
+        uint32_t min_;
+        uint32_t max_;
+        uint64_t sum_;
+    };
+} // namespace util
@@ -0,0 +1,145 @@
+// msg_pool.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    Fixed-Block Message Pool
+
+    Responsibilities:
+    - Hand out fixed-size blocks for outbound messages (telemetry lines,
+      frames, replies) so they can be built in place and queued by reference
+      instead of being formatted into a shared buffer and copied.
+    - O(1) alloc() and free() through an index free list; no heap.
+    - Count exhaustion and misuse so a starved producer shows up in stats
+      rather than as silent loss.
+
+    Ownership:
+    - alloc() transfers a block to the caller. Whoever holds it either
+      frees it or passes it on (e.g. util::TxQueue::enqueue_ref() with
+      MsgPool::release as the release function), exactly once.
+
+    Invariants:
+    - Single context: alloc() and free() run on the same core, like
+      util::TxQueue, so no atomics are needed.
+    - free() of a pointer that is not a block start, or of a block that is
+      already free, is ignored and counted in bad_frees.
+*/
+namespace util
+{
+    typedef struct
+    {
+        uint32_t allocs;    // successful alloc() calls
+        uint32_t frees;     // blocks returned
+        uint32_t exhausted; // alloc() calls that found no free block
+        uint32_t bad_frees; // foreign pointers and double frees (ignored)
+        uint16_t in_use;    // blocks currently allocated
+        uint16_t high_water; // peak in_use
+    } msg_pool_stats_t;
+
+    template <size_t BLOCK, size_t COUNT>
+    class MsgPool
+    {
+        static_assert(BLOCK >= 1, "MsgPool blocks must hold at least one byte");
+        static_assert(COUNT >= 1 && COUNT < 0xFFFF, "MsgPool block count must fit a uint16_t index");
+
+        static const uint16_t NONE = 0xFFFF;
+
+    public:
+        MsgPool()
+        {
+            for (size_t i = 0; i < COUNT; i++)
+            {
+                next_[i] = (uint16_t)(i + 1 < COUNT ? i + 1 : NONE);
+                used_[i] = 0;
+            }
+            free_head_ = 0;
+        }
+
+        MsgPool(const MsgPool &) = delete;
+        MsgPool &operator=(const MsgPool &) = delete;
+
+        // A BLOCK-byte block, or nullptr when every block is in use.
+        uint8_t *alloc()
+        {
+            if (free_head_ == NONE)
+            {
+                stats_.exhausted++;
+                return nullptr;
+            }
+
+            uint16_t i = free_head_;
+            free_head_ = next_[i];
+            used_[i] = 1;
+
+            stats_.allocs++;
+            stats_.in_use++;
+            if (stats_.in_use > stats_.high_water)
+                stats_.high_water = stats_.in_use;
+            return blocks_[i];
+        }
+
+        void free(const void *block)
+        {
+            size_t i;
+            if (!index_of(block, &i) || !used_[i])
+            {
+                stats_.bad_frees++;
+                return;
+            }
+
+            used_[i] = 0;
+            next_[i] = free_head_;
+            free_head_ = (uint16_t)i;
+
+            stats_.frees++;
+            stats_.in_use--;
+        }
+
+        // Release function for util::TxQueue::enqueue_ref(); ctx is the pool.
+        static void release(void *ctx, const void *block)
+        {
+            static_cast<MsgPool *>(ctx)->free(block);
+        }
+
+        bool owns(const void *block) const
+        {
+            size_t i;
+            return index_of(block, &i);
+        }
+
+        static constexpr size_t block_size() { return BLOCK; }
+        static constexpr size_t capacity() { return COUNT; }
+        size_t available() const { return COUNT - stats_.in_use; }
+
+        const msg_pool_stats_t &stats() const { return stats_; }
+        void reset_stats()
+        {
+            uint16_t in_use = stats_.in_use;
+            stats_ = msg_pool_stats_t();
+            stats_.in_use = in_use;
+            stats_.high_water = in_use;
+        }
+
+    private:
+        bool index_of(const void *block, size_t *index) const
+        {
+            const uint8_t *p = static_cast<const uint8_t *>(block);
+            const uint8_t *base = &blocks_[0][0];
+            if (p < base || p >= base + sizeof(blocks_))
+                return false;
+
+            size_t offset = (size_t)(p - base);
+            if (offset % BLOCK != 0)
+                return false;
+            *index = offset / BLOCK;
+            return true;
+        }
+
+        alignas(4) uint8_t blocks_[COUNT][BLOCK];
+        uint16_t next_[COUNT]; // free-list links (valid for free blocks)
+        uint8_t used_[COUNT];  // 1 while allocated, catches double frees
+        uint16_t free_head_;
+        msg_pool_stats_t stats_ = {};
+    };
+} // namespace util
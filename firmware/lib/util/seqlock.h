@@ -0,0 +1,100 @@
+// seqlock.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+/*
+    Single-Writer Sequence Lock
+
+    Responsibilities:
+    - Publish a small value (a state snapshot, a set of counters) from one
+      context to any number of readers on other cores/threads without locks.
+    - Guarantee readers never observe a torn value: a read that overlaps a
+      write is detected and retried.
+
+    Implementation:
+    - The sequence counter is odd while a write is in progress. The value is
+      stored as relaxed atomic words fenced around the counter updates, so
+      concurrent copies are well-defined under the C++ memory model.
+
+    Invariants:
+    - Exactly one writer context calls write(); the writer never waits.
+    - Readers may spin while a write is in progress; writes are a handful of
+      word stores, so the wait is bounded.
+*/
+namespace util
+{
+    template <typename T>
+    class Seqlock
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Seqlock values are copied with memcpy");
+
+        static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    public:
+        Seqlock()
+        {
+            T zero;
+            memset(&zero, 0, sizeof(zero));
+            write(zero);
+            seq_.store(0, std::memory_order_relaxed);
+        }
+
+        // ---- Writer side ----
+
+        void write(const T &value)
+        {
+            uint32_t words[WORDS] = {0};
+            memcpy(words, &value, sizeof(T));
+
+            uint32_t seq = seq_.load(std::memory_order_relaxed);
+            seq_.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for (size_t i = 0; i < WORDS; i++)
+                data_[i].store(words[i], std::memory_order_relaxed);
+
+            seq_.store(seq + 2, std::memory_order_release);
+        }
+
+        // ---- Reader side ----
+
+        // One attempt; false if it overlapped a write.
+        bool try_read(T &out) const
+        {
+            uint32_t before = seq_.load(std::memory_order_acquire);
+            if (before & 1u)
+                return false;
+
+            uint32_t words[WORDS];
+            for (size_t i = 0; i < WORDS; i++)
+                words[i] = data_[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) != before)
+                return false;
+
+            memcpy(&out, words, sizeof(T));
+            return true;
+        }
+
+        // Retries until a consistent copy is read. Returns the number of retries.
+        uint32_t read(T &out) const
+        {
+            uint32_t retries = 0;
+            while (!try_read(out))
+                retries++;
+            return retries;
+        }
+
+        // Number of completed writes (changes whenever the value is republished).
+        uint32_t version() const { return seq_.load(std::memory_order_acquire) >> 1; }
+
+    private:
+        std::atomic<uint32_t> seq_{0};
+        std::atomic<uint32_t> data_[WORDS];
+    };
+} // namespace util
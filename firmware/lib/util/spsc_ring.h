@@ -0,0 +1,149 @@
+// spsc_ring.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+/*
+    Lock-free Single-Producer / Single-Consumer Ring Buffer
+
+    Responsibilities:
+    - Pass elements from one producer context (ISR, core, thread) to one
+      consumer context without locks.
+    - Support bulk writes and readBytes-style bulk drains, plus zero-copy
+      access to the contiguous readable region.
+    - Track the high-water mark and the number of elements dropped because
+      the ring was full.
+
+    Invariants:
+    - N is a power of two; indices run freely and are masked on access, so
+      all N slots are usable.
+    - Only the producer calls push()/write(); only the consumer calls
+      pop()/read()/peek_span()/consume().
+    - head_ is published with release ordering after the data is written and
+      tail_ after the data is read, so each side sees complete elements.
+    - Statistics are written by the producer only.
+*/
+namespace util
+{
+    template <typename T, size_t N>
+    class SpscRing
+    {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+        static_assert(std::is_trivially_copyable<T>::value, "SpscRing elements are copied with memcpy");
+
+    public:
+        static constexpr size_t capacity() { return N; }
+
+        // ---- Producer side ----
+
+        bool push(const T &value)
+        {
+            return write(&value, 1) == 1;
+        }
+
+        // Copies as many of n elements as fit; the rest are counted as overflow.
+        size_t write(const T *src, size_t n)
+        {
+            size_t head = head_.load(std::memory_order_relaxed);
+            size_t tail = tail_.load(std::memory_order_acquire);
+            size_t space = N - (head - tail);
+
+            size_t count = n < space ? n : space;
+            overflows_ += (uint32_t)(n - count);
+            if (count == 0)
+                return 0;
+
+            size_t idx = head & (N - 1);
+            size_t first = N - idx < count ? N - idx : count;
+            memcpy(&buf_[idx], src, first * sizeof(T));
+            memcpy(&buf_[0], src + first, (count - first) * sizeof(T));
+
+            head_.store(head + count, std::memory_order_release);
+
+            size_t used = head + count - tail;
+            if (used > high_water_)
+                high_water_ = used;
+            return count;
+        }
+
+        size_t free_space() const
+        {
+            return N - size();
+        }
+
+        // ---- Consumer side ----
+
+        bool pop(T &out)
+        {
+            return read(&out, 1) == 1;
+        }
+
+        // Drains up to n elements into dst; returns the number copied.
+        size_t read(T *dst, size_t n)
+        {
+            size_t count = 0;
+            size_t avail;
+            const T *span;
+            while (count < n && (span = peek_span(&avail)) != nullptr)
+            {
+                size_t take = n - count < avail ? n - count : avail;
+                memcpy(dst + count, span, take * sizeof(T));
+                consume(take);
+                count += take;
+            }
+            return count;
+        }
+
+        // Returns the contiguous readable region (up to the wrap point) or
+        // nullptr if empty. The region stays valid until consume().
+        const T *peek_span(size_t *n) const
+        {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            size_t head = head_.load(std::memory_order_acquire);
+            size_t avail = head - tail;
+            if (avail == 0)
+            {
+                *n = 0;
+                return nullptr;
+            }
+
+            size_t idx = tail & (N - 1);
+            *n = N - idx < avail ? N - idx : avail;
+            return &buf_[idx];
+        }
+
+        void consume(size_t n)
+        {
+            tail_.store(tail_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+        }
+
+        // ---- Either side (snapshot) ----
+
+        size_t size() const
+        {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+
+        bool empty() const { return size() == 0; }
+
+        size_t high_water() const { return high_water_; }
+        uint32_t overflows() const { return overflows_; }
+
+        // Producer side only.
+        void reset_stats()
+        {
+            high_water_ = size();
+            overflows_ = 0;
+        }
+
+    private:
+        std::atomic<size_t> head_{0}; // next slot to write (producer-owned)
+        std::atomic<size_t> tail_{0}; // next slot to read (consumer-owned)
+        size_t high_water_ = 0;
+        uint32_t overflows_ = 0;
+        T buf_[N];
+    };
+} // namespace util
@@ -0,0 +1,256 @@
+// text_format.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+
+/*
+    Compile-Time Text Templates
+
+    Responsibilities:
+    - Format short protocol lines ("STATE={} TIME={} ...") from integers
+      without snprintf: no format string parsing at run time, no varargs,
+      no locale or floating-point code pulled into the image.
+    - Check templates at compile time: the number of {} placeholders must
+      match the argument types, every argument must be an integer, and the
+      worst-case line length is a constant (max_len) callers can
+      static_assert against their buffer.
+
+    Usage:
+        static constexpr char k_text[] = "A={} B={}";
+        typedef util::TextFormat<k_text, uint32_t, int32_t> line_t;
+        size_t n = line_t::write(buf, sizeof(buf), a, b);
+
+    Integer conversion:
+    - Digit count from the bit length (one multiply, one table compare),
+      then two digits per step from a 200-byte pair table, written back to
+      front straight into the output. Each step divides by the constant 100,
+      which compilers turn into a multiply.
+    - 64-bit values below 2^32 take the 32-bit path; larger ones split once
+      by 10^9 so 32-bit targets do at most two 64-bit divisions.
+
+    Invariants:
+    - Output is byte-identical to the equivalent snprintf %d/%u/%lu/%llu
+      conversions, NUL-terminated, and truncated like snprintf when cap is
+      smaller than needed (write() then returns the truncated length).
+    - write() returns 0 only when cap == 0.
+*/
+namespace util
+{
+    namespace text_detail
+    {
+        static constexpr char k_pairs[201] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+        static constexpr uint32_t k_pow10[10] = {
+            1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u};
+
+        // Decimal digits in v (1 for 0).
+        static inline unsigned digits_u32(uint32_t v)
+        {
+            unsigned bits = 32u - (unsigned)__builtin_clz(v | 1u);
+            unsigned t = (bits * 1233u) >> 12; // ~ bits * log10(2)
+            return t + ((v | 1u) >= k_pow10[t] ? 1u : 0u);
+        }
+
+        // Write exactly n digits of v ending at out + n.
+        static inline void put_digits(char *out, uint32_t v, unsigned n)
+        {
+            char *p = out + n;
+            while (v >= 100u)
+            {
+                uint32_t q = v / 100u;
+                unsigned r = (unsigned)(v - q * 100u);
+                p -= 2;
+                memcpy(p, &k_pairs[2 * r], 2);
+                v = q;
+            }
+            if (v >= 10u)
+            {
+                p -= 2;
+                memcpy(p, &k_pairs[2 * v], 2);
+            }
+            else
+            {
+                *--p = (char)('0' + v);
+            }
+            // Leading zeros for fixed-width chunks.
+            while (p > out)
+                *--p = '0';
+        }
+
+        static inline size_t put_u32(char *out, uint32_t v)
+        {
+            unsigned n = digits_u32(v);
+            put_digits(out, v, n);
+            return n;
+        }
+
+        static inline size_t put_u64(char *out, uint64_t v)
+        {
+            if ((v >> 32) == 0)
+                return put_u32(out, (uint32_t)v);
+
+            const uint32_t chunk = 1000000000u;
+            uint64_t hi = v / chunk;
+            uint32_t lo = (uint32_t)(v - hi * chunk);
+            size_t n = put_u64(out, hi);
+            put_digits(out + n, lo, 9);
+            return n + 9;
+        }
+
+        template <typename T>
+        static inline size_t put_int(char *out, T v)
+        {
+            typedef typename std::make_unsigned<T>::type U;
+
+            size_t sign = 0;
+            U u = (U)v;
+            if constexpr (std::is_signed<T>::value)
+            {
+                if (v < 0)
+                {
+                    *out = '-';
+                    sign = 1;
+                    u = (U)(0u - u);
+                }
+            }
+            if constexpr (sizeof(U) > 4)
+                return sign + put_u64(out + sign, (uint64_t)u);
+            else
+                return sign + put_u32(out + sign, (uint32_t)u);
+        }
+
+        // Longest decimal rendering of T, sign included.
+        template <typename T>
+        constexpr size_t max_chars()
+        {
+            static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                          "TextFormat arguments must be integers");
+            return (sizeof(T) == 1 ? 3 : sizeof(T) == 2 ? 5 : sizeof(T) == 4 ? 10 : 20) +
+                   (std::is_signed<T>::value ? 1 : 0);
+        }
+
+        constexpr size_t length(const char *s)
+        {
+            size_t n = 0;
+            while (s[n] != '\0')
+                n++;
+            return n;
+        }
+
+        constexpr size_t count_placeholders(const char *s)
+        {
+            size_t n = 0;
+            for (size_t i = 0; s[i] != '\0'; i++)
+            {
+                if (s[i] == '{' && s[i + 1] == '}')
+                    n++;
+            }
+            return n;
+        }
+
+        // Offset where literal segment k starts (segment 0 starts at 0,
+        // segment k > 0 right after the k-th placeholder).
+        constexpr size_t segment_start(const char *s, size_t k)
+        {
+            size_t i = 0;
+            for (size_t seen = 0; seen < k; i++)
+            {
+                if (s[i] == '{' && s[i + 1] == '}')
+                {
+                    seen++;
+                    i++;
+                }
+            }
+            return i;
+        }
+
+        // Length of literal segment k (up to the next placeholder or the end).
+        constexpr size_t segment_len(const char *s, size_t k)
+        {
+            size_t start = segment_start(s, k);
+            size_t i = start;
+            while (s[i] != '\0' && !(s[i] == '{' && s[i + 1] == '}'))
+                i++;
+            return i - start;
+        }
+
+        template <typename... Args>
+        constexpr size_t sum_max_chars()
+        {
+            size_t total = 0;
+            size_t each[] = {0, max_chars<Args>()...};
+            for (size_t v : each)
+                total += v;
+            return total;
+        }
+    } // namespace text_detail
+
+    template <const char *Text, typename... Args>
+    class TextFormat
+    {
+        static constexpr size_t ARGS = sizeof...(Args);
+        static_assert(text_detail::count_placeholders(Text) == ARGS,
+                      "TextFormat: number of {} placeholders does not match the argument types");
+
+    public:
+        // Worst-case line length, excluding the NUL.
+        static constexpr size_t max_len =
+            text_detail::length(Text) - 2 * ARGS + text_detail::sum_max_chars<Args...>();
+
+        static size_t write(char *out, size_t cap, Args... args)
+        {
+            if (out == nullptr || cap == 0)
+                return 0;
+
+            if (cap > max_len)
+            {
+                size_t n = emit(out, std::index_sequence_for<Args...>(), args...);
+                out[n] = '\0';
+                return n;
+            }
+
+            // Short buffer: format in full, then truncate like snprintf.
+            char tmp[max_len + 1];
+            size_t n = emit(tmp, std::index_sequence_for<Args...>(), args...);
+            if (n > cap - 1)
+                n = cap - 1;
+            memcpy(out, tmp, n);
+            out[n] = '\0';
+            return n;
+        }
+
+    private:
+        template <size_t K>
+        static size_t literal(char *out)
+        {
+            constexpr size_t start = text_detail::segment_start(Text, K);
+            constexpr size_t len = text_detail::segment_len(Text, K);
+            memcpy(out, Text + start, len);
+            return len;
+        }
+
+        template <size_t... I>
+        static size_t emit(char *out, std::index_sequence<I...>, Args... args)
+        {
+            size_t n = 0;
+            // Literal segment I, then argument I, in order; the last literal follows.
+            int order[] = {0, ((n += literal<I>(out + n)), (n += text_detail::put_int(out + n, args)), 0)...};
+            (void)order;
+            n += literal<ARGS>(out + n);
+            return n;
+        }
+    };
+} // namespace util
@@ -0,0 +1,338 @@
+// tx_queue.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+    Bounded, Non-blocking Transmit Queue
+
+    Responsibilities:
+    - Accept whole messages (text lines, binary frames) without ever blocking
+      the caller.
+    - Gather consecutive small messages so the link sees larger writes.
+    - Drain a bounded number of bytes per flush() through a sink that only
+      takes what the hardware can accept right now.
+    - Apply an explicit policy when full and count every drop.
+    - Queue caller-owned buffers by reference (enqueue_ref()) so messages
+      built in place, e.g. in util::MsgPool blocks, reach the link without
+      being copied. The queue then owns the buffer and calls its release
+      function exactly once: when it has been sent, overwritten, or
+      rejected.
+
+    Policies:
+    - TX_DROP_NEWEST:      a message that does not fit is rejected whole.
+    - TX_OVERWRITE_OLDEST: whole queued messages are discarded oldest first
+                           until the new one fits. A message that has
+                           started transmitting is never discarded.
+
+    Invariants:
+    - Messages are never truncated or interleaved: the link sees each one
+      complete (possibly across several flushes) or not at all.
+    - Single context: enqueue() and flush() are called from the same core, so
+      unlike util::SpscRing no atomics are needed and queued messages can be
+      removed from either end.
+    - N (bytes) and M (messages) are powers of two. N bounds copied bytes
+      only; by-reference messages use a message slot but no ring space.
+*/
+namespace util
+{
+    typedef enum
+    {
+        TX_DROP_NEWEST = 0,
+        TX_OVERWRITE_OLDEST
+    } tx_policy_t;
+
+    typedef struct
+    {
+        const void *data;
+        size_t len;
+    } tx_iov_t;
+
+    // Returns a by-reference message buffer to its owner (e.g. MsgPool::release).
+    typedef void (*tx_release_fn)(void *ctx, const void *data);
+
+    typedef struct
+    {
+        uint32_t msgs_queued;      // messages accepted
+        uint32_t msgs_dropped;     // new messages rejected (did not fit)
+        uint32_t msgs_overwritten; // old messages discarded to make room
+        uint32_t bytes_dropped;    // bytes of dropped + overwritten messages
+        uint32_t bytes_sent;       // bytes handed to the sink
+        uint32_t flushes;          // flush() calls that moved at least one byte
+        size_t high_water;         // peak queued bytes
+    } tx_queue_stats_t;
+
+    template <size_t N, size_t M>
+    class TxQueue
+    {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "TxQueue byte capacity must be a power of two");
+        static_assert(M >= 2 && (M & (M - 1)) == 0, "TxQueue message capacity must be a power of two");
+
+    public:
+        explicit TxQueue(tx_policy_t policy = TX_DROP_NEWEST) : policy_(policy) {}
+
+        void set_policy(tx_policy_t policy) { policy_ = policy; }
+        tx_policy_t policy() const { return policy_; }
+
+        bool enqueue(const void *data, size_t len)
+        {
+            tx_iov_t iov = {data, len};
+            return enqueue(&iov, 1);
+        }
+
+        // Queue the concatenation of iov[0..count) as one message.
+        bool enqueue(const tx_iov_t *iov, size_t count)
+        {
+            size_t len = 0;
+            for (size_t i = 0; i < count; i++)
+                len += iov[i].len;
+
+            if (len == 0)
+                return true;
+
+            if (!make_room(len))
+            {
+                stats_.msgs_dropped++;
+                stats_.bytes_dropped += (uint32_t)len;
+                return false;
+            }
+
+            for (size_t i = 0; i < count; i++)
+                put(static_cast<const uint8_t *>(iov[i].data), iov[i].len);
+            push_slot((uint32_t)len, nullptr, nullptr, nullptr);
+            return true;
+        }
+
+        // Queue len bytes at data without copying. Ownership passes to the
+        // queue whatever the outcome: release(ctx, data) is called once the
+        // message has been sent or dropped (immediately if rejected).
+        bool enqueue_ref(const void *data, size_t len, tx_release_fn release, void *ctx)
+        {
+            if (len == 0)
+            {
+                if (release)
+                    release(ctx, data);
+                return true;
+            }
+
+            if (!make_room(0))
+            {
+                stats_.msgs_dropped++;
+                stats_.bytes_dropped += (uint32_t)len;
+                if (release)
+                    release(ctx, data);
+                return false;
+            }
+
+            ref_bytes_ += len;
+            push_slot((uint32_t)len, static_cast<const uint8_t *>(data), release, ctx);
+            return true;
+        }
+
+        // Hand up to max_bytes to sink(const uint8_t *data, size_t len) -> accepted.
+        // Stops early when the sink accepts less than offered (link busy).
+        // Copied messages next to each other go out in one call; a
+        // by-reference message is offered from its own buffer.
+        template <typename Sink>
+        size_t flush(Sink &&sink, size_t max_bytes)
+        {
+            size_t sent = 0;
+
+            while (sent < max_bytes && !empty())
+            {
+                const ref_t &front = refs_[msg_tail_ & (M - 1)];
+                const uint8_t *src;
+                size_t span;
+                if (front.data != nullptr)
+                {
+                    src = front.data + front_sent_;
+                    span = lens_[msg_tail_ & (M - 1)] - front_sent_;
+                }
+                else
+                {
+                    size_t idx = tail_ & (N - 1);
+                    size_t run = copied_run();
+                    src = &buf_[idx];
+                    span = N - idx < run ? N - idx : run;
+                }
+                size_t want = span < max_bytes - sent ? span : max_bytes - sent;
+
+                size_t took = sink(src, want);
+                if (took > want)
+                    took = want;
+
+                if (front.data == nullptr)
+                    tail_ += took;
+                retire(took);
+                sent += took;
+
+                if (took < want)
+                    break;
+            }
+
+            if (sent > 0)
+            {
+                stats_.bytes_sent += (uint32_t)sent;
+                stats_.flushes++;
+            }
+            return sent;
+        }
+
+        // Unsent bytes, copied and by-reference.
+        size_t queued_bytes() const { return ring_bytes() + ref_bytes_ - (front_is_ref() ? front_sent_ : 0); }
+        size_t queued_msgs() const { return msg_head_ - msg_tail_; }
+        bool empty() const { return msg_head_ == msg_tail_; }
+        static constexpr size_t capacity() { return N; }
+        // Largest copied message that would be accepted now without dropping anything.
+        size_t free_bytes() const { return queued_msgs() < M ? N - ring_bytes() : 0; }
+
+        const tx_queue_stats_t &stats() const { return stats_; }
+        void reset_stats()
+        {
+            stats_ = tx_queue_stats_t();
+            stats_.high_water = queued_bytes();
+        }
+
+    private:
+        typedef struct
+        {
+            const uint8_t *data; // nullptr: message bytes are in buf_
+            tx_release_fn release;
+            void *ctx;
+        } ref_t;
+
+        size_t ring_bytes() const { return head_ - tail_; }
+
+        bool front_is_ref() const
+        {
+            return !empty() && refs_[msg_tail_ & (M - 1)].data != nullptr;
+        }
+
+        // Unsent ring bytes of the copied messages at the front, up to the
+        // first by-reference message.
+        size_t copied_run() const
+        {
+            if (ref_bytes_ == 0)
+                return ring_bytes();
+
+            size_t run = 0;
+            for (size_t m = msg_tail_; m != msg_head_ && refs_[m & (M - 1)].data == nullptr; m++)
+                run += lens_[m & (M - 1)];
+            return run - front_sent_;
+        }
+
+        void push_slot(uint32_t len, const uint8_t *data, tx_release_fn release, void *ctx)
+        {
+            size_t slot = msg_head_++ & (M - 1);
+            lens_[slot] = len;
+            refs_[slot].data = data;
+            refs_[slot].release = release;
+            refs_[slot].ctx = ctx;
+
+            stats_.msgs_queued++;
+            if (queued_bytes() > stats_.high_water)
+                stats_.high_water = queued_bytes();
+        }
+
+        void release_slot(size_t slot)
+        {
+            ref_t &ref = refs_[slot];
+            ref_bytes_ -= lens_[slot];
+            if (ref.release)
+                ref.release(ref.ctx, ref.data);
+            ref.data = nullptr;
+        }
+
+        bool fits(size_t len) const
+        {
+            return N - ring_bytes() >= len && queued_msgs() < M;
+        }
+
+        bool make_room(size_t len)
+        {
+            if (len > N)
+                return false;
+
+            if (policy_ == TX_OVERWRITE_OLDEST)
+            {
+                // A front message already partly on the wire must finish.
+                size_t keep = front_sent_ > 0 ? 1 : 0;
+                while (!fits(len) && queued_msgs() > keep)
+                    drop_oldest(keep);
+            }
+
+            return fits(len);
+        }
+
+        // Discard the oldest message that has not started transmitting.
+        void drop_oldest(size_t skip)
+        {
+            size_t slot = (msg_tail_ + skip) & (M - 1);
+            uint32_t len = lens_[slot];
+            bool copied = refs_[slot].data == nullptr;
+
+            stats_.bytes_dropped += len;
+            if (!copied)
+                release_slot(slot);
+
+            if (skip)
+            {
+                size_t front = msg_tail_ & (M - 1);
+
+                // Slide the unsent rest of a copied front message over the
+                // dropped one so the byte stream stays contiguous.
+                if (copied && refs_[front].data == nullptr)
+                {
+                    size_t rest = lens_[front] - front_sent_;
+                    for (size_t i = rest; i-- > 0;)
+                        buf_[(tail_ + len + i) & (N - 1)] = buf_[(tail_ + i) & (N - 1)];
+                }
+                lens_[slot] = lens_[front];
+                refs_[slot] = refs_[front];
+                refs_[front].data = nullptr;
+            }
+
+            if (copied)
+                tail_ += len;
+            msg_tail_++;
+
+            stats_.msgs_overwritten++;
+        }
+
+        void put(const uint8_t *src, size_t len)
+        {
+            size_t idx = head_ & (N - 1);
+            size_t first = N - idx < len ? N - idx : len;
+            memcpy(&buf_[idx], src, first);
+            memcpy(&buf_[0], src + first, len - first);
+            head_ += len;
+        }
+
+        // Account sent bytes against queued message boundaries.
+        void retire(size_t n)
+        {
+            front_sent_ += n;
+            while (msg_tail_ != msg_head_ && front_sent_ >= lens_[msg_tail_ & (M - 1)])
+            {
+                size_t slot = msg_tail_ & (M - 1);
+                front_sent_ -= lens_[slot];
+                if (refs_[slot].data != nullptr)
+                    release_slot(slot);
+                msg_tail_++;
+            }
+        }
+
+        uint8_t buf_[N];
+        uint32_t lens_[M];
+        ref_t refs_[M] = {};
+        size_t ref_bytes_ = 0;  // queued bytes held by reference (whole messages)
+        size_t head_ = 0;       // byte write index (free running)
+        size_t tail_ = 0;       // byte read index (free running)
+        size_t msg_head_ = 0;   // message length write index
+        size_t msg_tail_ = 0;   // message length read index (front message)
+        size_t front_sent_ = 0; // bytes of the front message already sent
+        tx_policy_t policy_;
+        tx_queue_stats_t stats_ = {};
+    };
+} // namespace util
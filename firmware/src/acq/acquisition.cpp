@@ -0,0 +1,135 @@
+// acquisition.cpp
+#include "acq/acquisition.h"
+
+#include <string.h>
+
+// Longest single sleep in acq_idle(): -D ACQ_IDLE_MAX_SLEEP_MS=1000
+#ifndef ACQ_IDLE_MAX_SLEEP_MS
+#define ACQ_IDLE_MAX_SLEEP_MS 1000
+#endif
+
+namespace acq
+{
+    static void telemetry_job(void *ctx, uint64_t now_us)
+    {
+        acq_t *acq = (acq_t *)ctx;
+        const app::app_snapshot_t *cfg = &acq->current;
+
+        acq_msg_t msg;
+        bool binary = cfg->telemetry_mode != app::APP_TELEMETRY_TEXT;
+        size_t len = app::app_format_telemetry(cfg, now_us, acq->telemetry_seq, &acq->telemetry_delta, msg.data, sizeof(msg.data));
+        if (len == 0)
+            return;
+        if (binary)
+            acq->telemetry_seq++;
+
+        msg.kind = binary ? ACQ_MSG_FRAME : ACQ_MSG_TEXT;
+        msg.len = (uint16_t)len;
+
+        if (acq->out.push(msg))
+        {
+            acq->counters.records++;
+            acq->time->hal_wake(); // core0 may be asleep in app_idle()
+        }
+        else
+        {
+            acq->counters.dropped++;
+        }
+    }
+
+    void acq_init(acq_t *acq, uint64_t now_us, hal::time::IHalTime *time, sensors::sensor_registry_t *sensors)
+    {
+        acq->time = time;
+        acq->sensors = sensors;
+        acq->telemetry_seq = 0;
+        memset(&acq->counters, 0, sizeof(acq->counters));
+
+        acq->config_version = acq->config.version();
+        acq->config.read(acq->current);
+        pkt_delta_init(&acq->telemetry_delta, acq->current.delta_key_interval);
+
+        const uint32_t period_us = acq->current.telemetry_period_ms * 1000u;
+        sched::sched_init(&acq->sched);
+        acq->telemetry_task = sched::sched_add(&acq->sched, now_us + period_us, period_us, telemetry_job, acq);
+
+        acq->stats.write(acq->counters);
+    }
+
+    // Pick up a new snapshot from core0, if one was published.
+    static void follow_config(acq_t *acq, uint64_t now_us)
+    {
+        uint32_t version = acq->config.version();
+        if (version == acq->config_version)
+            return;
+
+        app::app_snapshot_t cfg;
+        acq->config.read(cfg);
+        acq->config_version = version;
+
+        if (cfg.telemetry_period_ms != acq->current.telemetry_period_ms)
+        {
+            sched::sched_set_period(&acq->sched, acq->telemetry_task, cfg.telemetry_period_ms * 1000u, now_us);
+        }
+        if (cfg.delta_generation != acq->current.delta_generation)
+        {
+            pkt_delta_init(&acq->telemetry_delta, cfg.delta_key_interval);
+        }
+        acq->current = cfg;
+        acq->counters.config_updates++;
+    }
+
+    void acq_tick(acq_t *acq, uint64_t now_us)
+    {
+        acq->counters.iterations++;
+
+        follow_config(acq, now_us);
+
+        if (acq->sensors)
+        {
+            acq->counters.samples += sensors::sensor_registry_poll(acq->sensors, (uint32_t)(now_us / 1000u));
+        }
+
+        sched::sched_run(&acq->sched, now_us);
+
+        acq->stats.write(acq->counters);
+    }
+
+    void acq_idle(acq_t *acq, uint64_t now_us)
+    {
+        uint64_t deadline = now_us + (uint64_t)ACQ_IDLE_MAX_SLEEP_MS * 1000u;
+        uint64_t due;
+        if (sched::sched_next_deadline(&acq->sched, &due) && due < deadline)
+            deadline = due;
+        if (acq->sensors && sensors::sensor_registry_next_due_us(acq->sensors, now_us, &due) && due < deadline)
+            deadline = due;
+
+        if (deadline > now_us)
+            acq->time->hal_sleep_until(deadline);
+    }
+
+    size_t acq_drain(acq_t *acq, hal::serial::ISerialIo *serial, hal::logging::ILogger *logger, size_t max_msgs)
+    {
+        size_t n = 0;
+        acq_msg_t msg;
+        while (n < max_msgs && acq->out.pop(msg))
+        {
+            if (msg.kind == ACQ_MSG_FRAME)
+                serial->hal_serial_write(msg.data, msg.len);
+            else if (logger)
+                logger->log((const char *)msg.data);
+            n++;
+        }
+        return n;
+    }
+
+    bool acq_pending(const acq_t *acq)
+    {
+        return !acq->out.empty();
+    }
+
+    void acq_read_stats(const acq_t *acq, acq_stats_t *out)
+    {
+        acq->stats.read(*out);
+    }
+
+} // namespace acq
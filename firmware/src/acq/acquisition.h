@@ -0,0 +1,107 @@
+// acquisition.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "app.h"
+#include "packet.h"
+#include "seqlock.h"
+#include "spsc_ring.h"
+
+/*
+    Acquisition Core (dual-core mode)
+
+    Responsibilities:
+    - Run sensor sampling and telemetry framing on the second core, leaving
+      command handling, the LED and serial TX on core0.
+    - Hand finished telemetry (status lines or binary frames) to core0
+      through a lock-free SPSC queue; core0 forwards it with acq_drain().
+    - Follow core0's configuration through the app_snapshot_t seqlock and
+      publish its own counters through a second seqlock.
+
+    Ownership:
+    - acq_tick()/acq_idle() run on the acquisition core only; acq_drain(),
+      acq_pending() and acq_read_stats() run on core0 only.
+    - config is written by core0 (app_publish()), stats by the acquisition
+      core. Everything else in acq_t belongs to the acquisition core.
+
+    Invariants:
+    - No heap allocation; no locks. A full queue drops the new record and
+      counts it instead of blocking the sampler.
+*/
+
+// Queue depth between the cores, in messages:
+// -D ACQ_QUEUE_DEPTH=16
+#ifndef ACQ_QUEUE_DEPTH
+#define ACQ_QUEUE_DEPTH 16
+#endif
+
+namespace acq
+{
+    typedef enum
+    {
+        ACQ_MSG_TEXT = 0, // NUL-terminated status line, sent through the logger
+        ACQ_MSG_FRAME     // complete binary frame, sent raw
+    } acq_msg_kind_t;
+
+    typedef struct
+    {
+        uint8_t kind; // acq_msg_kind_t
+        uint16_t len; // bytes in data (excluding the NUL of a text line)
+        uint8_t data[PKT_MAX_FRAME];
+    } acq_msg_t;
+
+    typedef struct
+    {
+        uint32_t iterations; // acq_tick() calls
+        uint32_t samples;    // sensor reads
+        uint32_t records;    // telemetry records queued for core0
+        uint32_t dropped;    // records dropped because the queue was full
+        uint32_t config_updates; // snapshot changes picked up from core0
+    } acq_stats_t;
+
+    typedef struct
+    {
+        // Shared with core0
+        util::Seqlock<app::app_snapshot_t> config; // core0 -> acquisition
+        util::Seqlock<acq_stats_t> stats;          // acquisition -> core0
+        util::SpscRing<acq_msg_t, ACQ_QUEUE_DEPTH> out;
+
+        // Acquisition core only
+        hal::time::IHalTime *time;
+        sensors::sensor_registry_t *sensors;
+        sched::scheduler_t sched;
+        int telemetry_task;
+        uint16_t telemetry_seq;
+        pkt_delta_t telemetry_delta; // restarted when core0 changes the mode
+        uint32_t config_version;
+        app::app_snapshot_t current; // last configuration read from core0
+        acq_stats_t counters;
+    } acq_t;
+
+    // Call on core0 before the acquisition core starts, after
+    // app_offload_acquisition(app, &acq->config) has published the first
+    // snapshot. sensors may be NULL.
+    void acq_init(acq_t *acq, uint64_t now_us, hal::time::IHalTime *time, sensors::sensor_registry_t *sensors);
+
+    // ---- Acquisition core ----
+
+    // Sample due channels and frame due telemetry. Never blocks.
+    void acq_tick(acq_t *acq, uint64_t now_us);
+
+    // Sleep until the next sample or record is due (or core0 signals).
+    void acq_idle(acq_t *acq, uint64_t now_us);
+
+    // ---- Core0 ----
+
+    // Forward up to max_msgs queued records: text through logger, frames
+    // through serial. Returns the number forwarded.
+    size_t acq_drain(acq_t *acq, hal::serial::ISerialIo *serial, hal::logging::ILogger *logger, size_t max_msgs);
+
+    bool acq_pending(const acq_t *acq);
+
+    // Consistent copy of the acquisition counters.
+    void acq_read_stats(const acq_t *acq, acq_stats_t *out);
+
+} // namespace acq
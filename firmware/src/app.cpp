@@ -2,7 +2,11 @@
 
 #include <string.h>
 #include <stdlib.h>
-#include <stdio.h>
+#include <math.h>
+
+#include "packet.h"
+#include "cmd_dispatch.h"
+#include "text_format.h"
 
 // Default telemetry period can be set from PlatformIO build flags:
 // -D TELEMETRY_DEFAULT_PERIOD_MS=200
@@ -10,37 +14,617 @@
 #define TELEMETRY_DEFAULT_PERIOD_MS 1000
 #endif
 
+// Bytes of queued serial output handed to the link per app_tick(). Output is
+// queued by the serial HAL, so this bounds the time a tick spends on TX:
+// -D TX_FLUSH_BUDGET_BYTES=256
+#ifndef TX_FLUSH_BUDGET_BYTES
+#define TX_FLUSH_BUDGET_BYTES 256
+#endif
+
+// Longest single sleep in app_idle(), so a missed wake event costs at most
+// this much latency: -D APP_IDLE_MAX_SLEEP_MS=1000
+#ifndef APP_IDLE_MAX_SLEEP_MS
+#define APP_IDLE_MAX_SLEEP_MS 1000
+#endif
+
+// Records per keyframe in TELEMETRY DELTA mode when the command does not
+// give one: -D TELEMETRY_DELTA_KEY_INTERVAL=32
+#ifndef TELEMETRY_DELTA_KEY_INTERVAL
+#define TELEMETRY_DELTA_KEY_INTERVAL PKT_DELTA_DEFAULT_KEY_INTERVAL
+#endif
+
+// Telemetry periods per keyframe in TELEMETRY CHANGES mode when the command
+// does not give one: -D TELEMETRY_CHANGES_KEY_PERIODS=60
+#ifndef TELEMETRY_CHANGES_KEY_PERIODS
+#define TELEMETRY_CHANGES_KEY_PERIODS 60
+#endif
+
+// Spooled records per spool_sync() while the link is down; bounds what a
+// reset can lose against extra page programs: -D SPOOL_SYNC_RECORDS=16
+#ifndef SPOOL_SYNC_RECORDS
+#define SPOOL_SYNC_RECORDS 16
+#endif
+
+// Bytes of replayed frames queued per app_tick() at most; the serial HAL's
+// free TX space limits it further: -D REPLAY_BURST_BYTES=512
+#ifndef REPLAY_BURST_BYTES
+#define REPLAY_BURST_BYTES 512
+#endif
+
+// Shortest / longest SUMMARY window:
+// -D SUMMARY_MIN_WINDOW_MS=10 -D SUMMARY_MAX_WINDOW_MS=3600000
+#ifndef SUMMARY_MIN_WINDOW_MS
+#define SUMMARY_MIN_WINDOW_MS 10
+#endif
+
+#ifndef SUMMARY_MAX_WINDOW_MS
+#define SUMMARY_MAX_WINDOW_MS 3600000
+#endif
+
+#define US_PER_MS 1000u
+
+// Spool record: [timestamp_us:6 LE][telemetry record:13]
+#define SPOOL_TS_SIZE 6u
+#define SPOOL_RECORD_SIZE (SPOOL_TS_SIZE + PKT_TELEMETRY_PAYLOAD_SIZE)
+
 namespace app
 {
     // Heartbeat LED toggle period
     static const uint32_t HEARTBEAT_PERIOD_MS = 2000;
 
-    static void log_status(const app_t *app, uint32_t now_ms)
+    static void fill_snapshot(const app_t *app, app_snapshot_t *snap)
+    {
+        memset(snap, 0, sizeof(*snap));
+        snap->boot_us = app->boot_us;
+        snap->telemetry_period_ms = app->telemetry_period_ms;
+        snap->fault_count = app->fault_count;
+        snap->delta_key_interval = app->telemetry_delta.key_interval;
+        snap->delta_generation = app->delta_generation;
+        snap->state = (uint8_t)app->state;
+        snap->telemetry_mode = (uint8_t)app->telemetry_mode;
+    }
+
+    // Text templates (checked at compile time, see text_format.h)
+    static constexpr char k_status_text[] = "STATE={} TIME={} TELEMETRY_MS={} HEARTBEAT_MS={} FAULTS={}";
+    typedef util::TextFormat<k_status_text, int, uint64_t, uint32_t, uint32_t, uint32_t> status_format_t;
+    static constexpr char k_status_reply_prefix[] = "OK "; // STATUS reply: the longest log_status() prefix
+
+    static constexpr char k_loop_text[] = "OK LOOP ITER={} SLEEPS={} EARLY={} IDLE_MS={} UP_MS={}";
+    typedef util::TextFormat<k_loop_text, uint32_t, uint32_t, uint32_t, uint64_t, uint64_t> loop_format_t;
+
+    static constexpr char k_delta_text[] = "OK TELEMETRY DELTA KEY={}";
+    typedef util::TextFormat<k_delta_text, uint32_t> delta_format_t;
+
+    static constexpr char k_changes_text[] = "OK TELEMETRY CHANGES KEY={}";
+    typedef util::TextFormat<k_changes_text, uint32_t> changes_format_t;
+
+    static constexpr char k_deadband_text[] = "OK DEADBAND CH={} COUNTS={}";
+    typedef util::TextFormat<k_deadband_text, uint32_t, uint32_t> deadband_format_t;
+
+    static constexpr char k_replay_text[] = "OK REPLAY FROM={} TO={}";
+    typedef util::TextFormat<k_replay_text, uint32_t, uint32_t> replay_format_t;
+
+    static constexpr char k_replay_done_text[] = "OK REPLAY DONE SENT={} NEXT={}";
+    typedef util::TextFormat<k_replay_done_text, uint32_t, uint32_t> replay_done_format_t;
+
+    static constexpr char k_summary_text[] = "SUMMARY CH={} N={} MIN={} MAX={} MEAN={} VAR={} P50={} P90={} P99={} LOST={}";
+    typedef util::TextFormat<k_summary_text, uint32_t, uint32_t, int32_t, int32_t, int32_t, uint32_t, int32_t, int32_t, int32_t, uint32_t> summary_format_t;
+
+    static constexpr char k_summary_on_text[] = "OK SUMMARY CH={} WINDOW_MS={}";
+    typedef util::TextFormat<k_summary_on_text, uint32_t, uint32_t> summary_on_format_t;
+
+    static constexpr char k_summary_off_text[] = "OK SUMMARY CH={} OFF";
+    typedef util::TextFormat<k_summary_off_text, uint32_t> summary_off_format_t;
+
+    static constexpr char k_summary_range_text[] = "ERR SUMMARY window out of range ({}..{})";
+    typedef util::TextFormat<k_summary_range_text, uint32_t, uint32_t> summary_range_format_t;
+
+    static constexpr char k_sub_text[] = "OK SUB CH={} MS={}";
+    typedef util::TextFormat<k_sub_text, uint32_t, uint32_t> sub_format_t;
+
+    static constexpr char k_unsub_text[] = "OK UNSUB CH={}";
+    typedef util::TextFormat<k_unsub_text, uint32_t> unsub_format_t;
+
+    // One value of a "CH" line: "CH 0=2048 5=1000"
+    static constexpr char k_channel_text[] = " {}={}";
+    typedef util::TextFormat<k_channel_text, uint32_t, int32_t> channel_format_t;
+
+    static constexpr char k_stream_on_text[] = "OK STREAM START CH={} HZ={} PERIOD_US={}";
+    typedef util::TextFormat<k_stream_on_text, uint32_t, uint32_t, uint32_t> stream_on_format_t;
+
+    static constexpr char k_stream_off_text[] = "OK STREAM STOP SAMPLES={} BLOCKS={} LOST={} OVERRUNS={}";
+    typedef util::TextFormat<k_stream_off_text, uint32_t, uint32_t, uint32_t, uint32_t> stream_off_format_t;
+
+    static constexpr char k_stream_text[] = "OK STREAM CH={} HZ={} SAMPLES={} BLOCKS={} LOST={} OVERRUNS={}";
+    typedef util::TextFormat<k_stream_text, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t> stream_format_t;
+
+#if APP_INSTRUMENT
+    static constexpr char k_stats_text[] = "OK STATS UP_MS={} TICKS={} LOOP_HZ={} MAX_STALL_US={}";
+    typedef util::TextFormat<k_stats_text, uint64_t, uint32_t, uint32_t, uint32_t> stats_format_t;
+
+    // Follows a path name: "STATS TICK N=..."
+    static constexpr char k_stats_path_text[] = " N={} MEAN={} P50={} P90={} P99={} MAX={}";
+    typedef util::TextFormat<k_stats_path_text, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t> stats_path_format_t;
+#endif
+
+    static constexpr char k_tag_text[] = "#{} ";
+    typedef util::TextFormat<k_tag_text, uint32_t> tag_format_t;
+
+    static void batch_flush(app_t *app)
+    {
+        app_reply_batch_t *b = &app->reply;
+        if (b->len > 0)
+            app->serial->hal_serial_write((const uint8_t *)b->buf, b->len);
+        b->len = 0;
+    }
+
+    // Reply to the command being handled: tagged like the command, and
+    // appended to the batch when there is one. Outside a command this is a
+    // plain print. A tagged reply outside a batch still goes through the
+    // batch buffer and out as one write, so a full TX queue drops the tag
+    // and its text together.
+    static void send_reply(app_t *app, const char *text)
     {
-        static char buffer[128];
-        snprintf(buffer, sizeof(buffer),
-                 "STATE=%d TIME=%lu TELEMETRY_MS=%lu HEARTBEAT_MS=%lu FAULTS=%lu",
-                 (int)app->state,
-                 (unsigned long)(now_ms - app->boot_ms),
-                 (unsigned long)app->telemetry_period_ms,
-                 (unsigned long)HEARTBEAT_PERIOD_MS,
-                 (unsigned long)app->fault_count);
+        static const char k_eol[] = "\r\n";
+        app_reply_batch_t *b = &app->reply;
+        if (!b->active && !b->tagged)
+        {
+            app->serial->hal_serial_print(text);
+            return;
+        }
+
+        char tag[tag_format_t::max_len + 1];
+        size_t tag_len = b->tagged ? tag_format_t::write(tag, sizeof(tag), b->tag) : 0;
+        size_t len = strlen(text);
+        size_t eol_len = b->active ? sizeof(k_eol) - 1 : 0; // unbatched: the bytes of a plain print
+        size_t need = tag_len + len + eol_len;
+        if (b->len + need > sizeof(b->buf))
+            batch_flush(app);
+        if (need > sizeof(b->buf))
+        {
+            // Longer than a whole batch: on its own, in pieces.
+            util::tx_iov_t parts[3] = {{tag, tag_len}, {text, len}, {k_eol, eol_len}};
+            for (const util::tx_iov_t &part : parts)
+                app->serial->hal_serial_write((const uint8_t *)part.data, part.len);
+            return;
+        }
+        memcpy(b->buf + b->len, tag, tag_len);
+        memcpy(b->buf + b->len + tag_len, text, len);
+        memcpy(b->buf + b->len + tag_len + len, k_eol, eol_len);
+        b->len += need;
+        if (!b->active)
+            batch_flush(app);
+    }
+
+    static size_t format_status(const app_snapshot_t *snap, uint64_t now_us, char *out, size_t cap)
+    {
+        return status_format_t::write(out, cap,
+                                      (int)snap->state,
+                                      (now_us - snap->boot_us) / US_PER_MS,
+                                      snap->telemetry_period_ms,
+                                      HEARTBEAT_PERIOD_MS,
+                                      snap->fault_count);
+    }
+
+    static void fill_record(const app_snapshot_t *snap, pkt_telemetry_t *rec)
+    {
+        rec->state = snap->state;
+        rec->telemetry_period_ms = snap->telemetry_period_ms;
+        rec->heartbeat_period_ms = HEARTBEAT_PERIOD_MS;
+        rec->fault_count = snap->fault_count;
+    }
+
+    // Telemetry payload for the snapshot's binary mode; sets *type to match.
+    static size_t pack_telemetry(const app_snapshot_t *snap, pkt_delta_t *delta, uint8_t *payload, size_t cap, uint8_t *type)
+    {
+        pkt_telemetry_t rec;
+        fill_record(snap, &rec);
+
+        *type = PKT_TYPE_TELEMETRY;
+        bool delta_mode = snap->telemetry_mode == APP_TELEMETRY_DELTA || snap->telemetry_mode == APP_TELEMETRY_CHANGES;
+        if (delta_mode && delta != NULL)
+            return pkt_telemetry_pack_delta(delta, &rec, payload, cap, type);
+        return pkt_telemetry_pack(&rec, payload, cap);
+    }
+
+    static size_t format_frame(const app_snapshot_t *snap, uint64_t now_us, uint16_t seq, pkt_delta_t *delta, uint8_t *out, size_t cap)
+    {
+        uint8_t payload[PKT_DELTA_MAX_PAYLOAD];
+        pkt_t pkt;
+        pkt.seq = seq;
+        pkt.timestamp_us = now_us - snap->boot_us;
+        pkt.payload = payload;
+        pkt.payload_len = pack_telemetry(snap, delta, payload, sizeof(payload), &pkt.type);
+
+        return pkt_encode(&pkt, out, cap);
+    }
+
+    size_t app_format_telemetry(const app_snapshot_t *snap, uint64_t now_us, uint16_t seq, pkt_delta_t *delta, uint8_t *out, size_t cap)
+    {
+        if (snap == NULL || out == NULL || cap == 0)
+            return 0;
+        if (snap->telemetry_mode != APP_TELEMETRY_TEXT)
+            return format_frame(snap, now_us, seq, delta, out, cap);
+        return format_status(snap, now_us, (char *)out, cap);
+    }
+
+    // Status line, prefixed with "" or k_status_reply_prefix. Built straight
+    // into a serial message block when the HAL lends one; otherwise
+    // formatted on the stack and copied out through the logger.
+    static void log_status(const app_t *app, uint64_t now_us, const char *prefix)
+    {
+        static const char k_eol[] = "\r\n";
+        app_snapshot_t snap;
+        fill_snapshot(app, &snap);
+
+        size_t prefix_len = strlen(prefix);
+        size_t need = prefix_len + status_format_t::max_len + sizeof(k_eol);
+        uint8_t *block = app->serial->hal_serial_alloc(need);
+        if (block != NULL)
+        {
+            char *line = (char *)block;
+            memcpy(line, prefix, prefix_len);
+            size_t len = prefix_len + format_status(&snap, now_us, line + prefix_len, need - prefix_len);
+            memcpy(line + len, k_eol, sizeof(k_eol) - 1);
+            app->serial->hal_serial_send(block, len + sizeof(k_eol) - 1);
+            return;
+        }
+
+        // One line for the logger, so the prefix and the status are queued
+        // or dropped together.
+        char line[sizeof(k_status_reply_prefix) - 1 + status_format_t::max_len + 1];
+        if (prefix_len > sizeof(k_status_reply_prefix) - 1)
+            prefix_len = sizeof(k_status_reply_prefix) - 1;
+        memcpy(line, prefix, prefix_len);
+        format_status(&snap, now_us, line + prefix_len, sizeof(line) - prefix_len);
         if (app->logger)
-            app->logger->log(buffer);
+            app->logger->log(line);
+    }
+
+    // Frame a packet and queue it: encoded straight into a serial message
+    // block when the HAL lends one, otherwise on the stack and copied out.
+    // Returns the frame length, 0 if the packet did not encode.
+    static size_t send_frame(app_t *app, uint8_t type, uint16_t seq, uint64_t timestamp_us, const uint8_t *payload,
+                             size_t payload_len)
+    {
+        pkt_t pkt;
+        pkt.type = type;
+        pkt.seq = seq;
+        pkt.timestamp_us = timestamp_us;
+        pkt.payload = payload;
+        pkt.payload_len = payload_len;
+
+        uint8_t *block = app->serial->hal_serial_alloc(PKT_MAX_FRAME);
+        if (block != NULL)
+        {
+            size_t len = pkt_encode(&pkt, block, PKT_MAX_FRAME);
+            app->serial->hal_serial_send(block, len); // len 0 just returns the block
+            return len;
+        }
+
+        uint8_t frame[PKT_MAX_FRAME];
+        size_t len = pkt_encode(&pkt, frame, sizeof(frame));
+        if (len > 0)
+            app->serial->hal_serial_write(frame, len);
+        return len;
+    }
+
+    static void send_binary_telemetry(app_t *app, uint64_t now_us)
+    {
+        app_snapshot_t snap;
+        fill_snapshot(app, &snap);
+
+        uint8_t payload[PKT_DELTA_MAX_PAYLOAD];
+        uint8_t type;
+        size_t len = pack_telemetry(&snap, &app->telemetry_delta, payload, sizeof(payload), &type);
+        send_frame(app, type, app->telemetry_seq++, now_us - snap.boot_us, payload, len);
+    }
+
+    // Record and the latest value of the first PKT_CHANGES_MAX_CHANNELS
+    // channels (0 until a channel has a sample).
+    static void fill_changes(const app_t *app, const app_snapshot_t *snap, pkt_changes_t *cur)
+    {
+        memset(cur, 0, sizeof(*cur));
+        fill_record(snap, &cur->rec);
+        if (app->sensors == NULL)
+            return;
+
+        uint8_t n = app->sensors->channel_count;
+        cur->channels = n < PKT_CHANGES_MAX_CHANNELS ? n : (uint8_t)PKT_CHANGES_MAX_CHANNELS;
+        for (uint8_t ch = 0; ch < cur->channels; ch++)
+        {
+            sensors::sample_t sample;
+            if (sensors::sensor_registry_latest(app->sensors, ch, &sample))
+                cur->value[ch] = sample.value;
+        }
+    }
+
+    // Publish on change: a period with no dirty field and no keyframe due
+    // sends nothing and takes no seq.
+    static void send_changes(app_t *app, uint64_t now_us)
+    {
+        app_snapshot_t snap;
+        fill_snapshot(app, &snap);
+        pkt_changes_t cur;
+        fill_changes(app, &snap, &cur);
+
+        pkt_changes_t rec;
+        bool key = false;
+        if (!changes::changes_period(&app->changes, &cur, &rec, &key))
+            return;
+        if (key)
+            pkt_delta_request_key(&app->telemetry_delta);
+
+        uint8_t payload[PKT_CHANGES_MAX_PAYLOAD];
+        uint8_t type;
+        size_t len = pkt_changes_pack(&app->telemetry_delta, &rec, payload, sizeof(payload), &type);
+        send_frame(app, type, app->telemetry_seq++, now_us - snap.boot_us, payload, len);
+    }
+
+    // No host listening: keep the record in the spool for a later REPLAY.
+    // Spooled records are always full binary records, whatever the mode.
+    static void spool_telemetry(app_t *app, uint64_t now_us)
+    {
+        app_snapshot_t snap;
+        fill_snapshot(app, &snap);
+        pkt_telemetry_t rec;
+        fill_record(&snap, &rec);
+
+        uint8_t data[SPOOL_RECORD_SIZE];
+        uint64_t ts = now_us - snap.boot_us;
+        for (unsigned i = 0; i < SPOOL_TS_SIZE; i++)
+            data[i] = (uint8_t)(ts >> (8 * i));
+        pkt_telemetry_pack(&rec, &data[SPOOL_TS_SIZE], PKT_TELEMETRY_PAYLOAD_SIZE);
+
+        if (spool::spool_append(app->spool, data, sizeof(data)) && ++app->spooled_since_sync >= SPOOL_SYNC_RECORDS)
+        {
+            spool::spool_sync(app->spool);
+            app->spooled_since_sync = 0;
+        }
+    }
+
+    // Periodic telemetry goes out in the selected mode; STATUS replies stay text.
+    static void emit_telemetry(app_t *app, uint64_t now_us)
+    {
+        if (app->spool && !app->link_up)
+            spool_telemetry(app, now_us);
+        else if (app->telemetry_mode == APP_TELEMETRY_CHANGES)
+            send_changes(app, now_us);
+        else if (app->telemetry_mode != APP_TELEMETRY_TEXT)
+            send_binary_telemetry(app, now_us);
+        else
+            log_status(app, now_us, "");
+    }
+
+    // Frame one spooled record as PKT_TYPE_TELEMETRY_REPLAY and queue it.
+    static size_t send_replay_record(app_t *app, uint32_t spool_seq, const uint8_t *data)
+    {
+        pkt_telemetry_t rec;
+        if (!pkt_telemetry_unpack(&data[SPOOL_TS_SIZE], PKT_TELEMETRY_PAYLOAD_SIZE, &rec))
+            return 0;
+
+        uint64_t ts = 0;
+        for (unsigned i = 0; i < SPOOL_TS_SIZE; i++)
+            ts |= (uint64_t)data[i] << (8 * i);
+
+        uint8_t payload[PKT_REPLAY_PAYLOAD_SIZE];
+        size_t len = pkt_replay_pack(spool_seq, &rec, payload, sizeof(payload));
+        return send_frame(app, PKT_TYPE_TELEMETRY_REPLAY, (uint16_t)spool_seq, ts, payload, len);
+    }
+
+    // Queue the next replayed records, as many as the TX side takes now
+    // (up to REPLAY_BURST_BYTES), so a replay runs at link speed without
+    // crowding out replies or dropping frames.
+    static void replay_step(app_t *app)
+    {
+        app_replay_t *r = &app->replay;
+        size_t budget = REPLAY_BURST_BYTES;
+
+        while (budget >= PKT_MAX_FRAME && app->serial->hal_serial_tx_free() >= PKT_MAX_FRAME)
+        {
+            uint8_t data[SPOOL_MAX_RECORD];
+            uint32_t seq = r->end_seq;
+            size_t n = r->cursor.seq < r->end_seq ? spool::spool_read(app->spool, &r->cursor, &seq, data, sizeof(data)) : 0;
+            if (n == 0 || seq >= r->end_seq)
+            {
+                r->active = false;
+                char reply[replay_done_format_t::max_len + 1];
+                replay_done_format_t::write(reply, sizeof(reply), r->sent, r->end_seq);
+                send_reply(app, reply);
+                return;
+            }
+            if (n != SPOOL_RECORD_SIZE)
+                continue;
+
+            budget -= send_replay_record(app, seq, data);
+            r->sent++;
+        }
+    }
+
+    // Nearest integer, saturated to the target range.
+    static int32_t sat_i32(float v)
+    {
+        if (v >= 2147483647.0f)
+            return INT32_MAX;
+        if (v <= -2147483648.0f)
+            return INT32_MIN;
+        return (int32_t)(v >= 0.0f ? v + 0.5f : v - 0.5f);
+    }
+
+    static uint32_t sat_u32(float v)
+    {
+        if (v >= 4294967295.0f)
+            return UINT32_MAX;
+        return v > 0.0f ? (uint32_t)(v + 0.5f) : 0u;
+    }
+
+    typedef struct
+    {
+        app_t *app;
+        uint64_t now_us;
+    } summary_ctx_t;
+
+    // One closed window: a text line in TEXT mode, otherwise a
+    // PKT_TYPE_SUMMARY frame (mean and deviation in 1/256 units).
+    static void emit_summary(void *ctx, const stats::window_summary_t *s)
+    {
+        app_t *app = ((summary_ctx_t *)ctx)->app;
+        uint64_t now_us = ((summary_ctx_t *)ctx)->now_us;
+
+        if (app->telemetry_mode == APP_TELEMETRY_TEXT)
+        {
+            char line[summary_format_t::max_len + 1];
+            summary_format_t::write(line, sizeof(line), s->channel, s->count, s->min, s->max,
+                                    sat_i32(s->mean), sat_u32(s->variance), s->p50, s->p90, s->p99, s->lost);
+            if (app->logger)
+                app->logger->log(line);
+            return;
+        }
+
+        pkt_summary_t sum;
+        sum.channel = s->channel;
+        sum.window_ms = s->window_ms;
+        sum.count = s->count;
+        sum.lost = s->lost;
+        sum.min = s->min;
+        sum.max = s->max;
+        sum.mean_q8 = sat_i32(s->mean * 256.0f);
+        sum.stddev_q8 = sat_u32(sqrtf(s->variance) * 256.0f);
+        sum.p50 = s->p50;
+        sum.p90 = s->p90;
+        sum.p99 = s->p99;
+
+        uint8_t payload[PKT_SUMMARY_PAYLOAD_SIZE];
+        size_t len = pkt_summary_pack(&sum, payload, sizeof(payload));
+        send_frame(app, PKT_TYPE_SUMMARY, app->summary_seq++, now_us - app->boot_us, payload, len);
+    }
+
+    // Values of subscribed channels due in the same tick: one "CH" line in
+    // TEXT mode, otherwise one PKT_TYPE_CHANNELS frame.
+    static void send_channels(app_t *app, const pkt_channel_value_t *values, size_t count, uint64_t now_us)
+    {
+        if (app->telemetry_mode == APP_TELEMETRY_TEXT)
+        {
+            char line[2 + PKT_CHANNELS_MAX_VALUES * channel_format_t::max_len + 1];
+            size_t len = 2;
+            memcpy(line, "CH", 2);
+            for (size_t i = 0; i < count; i++)
+                len += channel_format_t::write(line + len, sizeof(line) - len, values[i].channel, values[i].value);
+            line[len] = '\0';
+            if (app->logger)
+                app->logger->log(line);
+            return;
+        }
+
+        uint8_t payload[PKT_MAX_PAYLOAD];
+        size_t len = pkt_channels_pack(values, count, payload, sizeof(payload));
+        send_frame(app, PKT_TYPE_CHANNELS, app->channels_seq++, now_us - app->boot_us, payload, len);
+    }
+
+    // Every subscription whose period came up, packed into as few records
+    // as fit. Subscriptions are live data: nothing is spooled.
+    static void subs_step(app_t *app, uint64_t now_us)
+    {
+        subs::subs_mask_t due;
+        if (subs::subs_collect(&app->subs, now_us, &due) == 0 || (app->spool && !app->link_up))
+            return;
+
+        pkt_channel_value_t values[PKT_CHANNELS_MAX_VALUES];
+        size_t n = 0;
+        for (int ch = subs::subs_next(&due, 0); ch >= 0; ch = subs::subs_next(&due, ch + 1))
+        {
+            sensors::sample_t sample;
+            if (!sensors::sensor_registry_latest(app->sensors, (uint8_t)ch, &sample))
+                continue; // not sampled yet
+            values[n].channel = (uint8_t)ch;
+            values[n].value = sample.value;
+            if (++n == PKT_CHANNELS_MAX_VALUES)
+            {
+                send_channels(app, values, n, now_us);
+                n = 0;
+            }
+        }
+        if (n > 0)
+            send_channels(app, values, n, now_us);
+    }
+
+    // Periodic sampling runs unless a stream has the sensors to itself.
+    static bool sampling(const app_t *app)
+    {
+        return app->sensors != NULL && !stream::stream_active(app->stream);
+    }
+
+    // One block of streamed samples as a PKT_TYPE_STREAM frame.
+    static void send_stream_block(app_t *app, const stream::stream_block_t *b, uint64_t now_us)
+    {
+        const stream::stream_t *s = app->stream;
+        pkt_stream_t blk;
+        blk.channel = s->channel;
+        blk.count = (uint8_t)b->count;
+        blk.rate_hz = (uint16_t)s->rate_hz;
+        blk.first_index = b->first_index;
+        blk.lost = s->lost.load(std::memory_order_relaxed);
+        blk.samples = b->samples;
+
+        uint8_t payload[PKT_MAX_PAYLOAD];
+        size_t len = pkt_stream_pack(&blk, payload, sizeof(payload));
+        send_frame(app, PKT_TYPE_STREAM, app->stream_seq++, now_us - app->boot_us, payload, len);
+    }
+
+    // Send the block the timer has filled, if the TX side can take it
+    // whole. Otherwise it waits, and the timer counts an overrun if it
+    // fills the other block first: nothing is dropped silently.
+    static void stream_step(app_t *app, uint64_t now_us)
+    {
+        const stream::stream_block_t *b = stream::stream_peek(app->stream);
+        if (b == NULL || app->serial->hal_serial_tx_free() < PKT_MAX_FRAME)
+            return;
+        send_stream_block(app, b, now_us);
+        stream::stream_release(app->stream);
+    }
+
+    // Scheduler jobs
+    static void heartbeat_job(void *ctx, uint64_t now_us)
+    {
+        (void)now_us;
+        app_t *app = (app_t *)ctx;
+
+        // Manual LED control suspends the heartbeat blink.
+        if (!app->led_override)
+            app->led->hal_led_toggle();
+    }
+
+    static void telemetry_job(void *ctx, uint64_t now_us)
+    {
+        app_t *app = (app_t *)ctx;
+        INSTR_CALL(instr::instr_telemetry(&app->instr, now_us, app->telemetry_period_ms * US_PER_MS));
+        emit_telemetry(app, now_us);
     }
 
-    void app_init(app_t *app, uint32_t now_ms, hal::led::IHalLed* led, hal::time::IHalTime* time, hal::serial::ISerialIo* serial, hal::logging::ILogger* logger)
+    void app_init(app_t *app, uint64_t now_us, hal::led::IHalLed* led, hal::time::IHalTime* time, hal::serial::ISerialIo* serial, hal::logging::ILogger* logger)
     {
         memset(app, 0, sizeof(*app));
         app->state = APP_BOOT;
-        app->boot_ms = now_ms;
+        app->boot_us = now_us;
         app->telemetry_period_ms = (uint32_t)TELEMETRY_DEFAULT_PERIOD_MS;
-        app->last_telemetry_ms = now_ms;
-        app->last_heartbeat_ms = now_ms;
+        app->telemetry_mode = APP_TELEMETRY_TEXT;
+        pkt_delta_init(&app->telemetry_delta, (uint16_t)TELEMETRY_DELTA_KEY_INTERVAL);
+        changes::changes_init(&app->changes, (uint16_t)TELEMETRY_CHANGES_KEY_PERIODS);
         app->led = led;
         app->time = time;
         app->serial = serial;
         app->logger = logger;
+        app->link_up = serial->hal_serial_connected();
+        stats::stats_init(&app->stats);
+        subs::subs_init(&app->subs);
+        INSTR_CALL(instr::instr_reset(&app->instr, now_us));
+
+        // Periodic jobs, phase-anchored to boot
+        sched::sched_init(&app->sched);
+        const uint32_t heartbeat_us = HEARTBEAT_PERIOD_MS * US_PER_MS;
+        const uint32_t telemetry_us = app->telemetry_period_ms * US_PER_MS;
+        app->heartbeat_task = sched::sched_add(&app->sched, now_us + heartbeat_us, heartbeat_us, heartbeat_job, app);
+        app->telemetry_task = sched::sched_add(&app->sched, now_us + telemetry_us, telemetry_us, telemetry_job, app);
 
         // Initialize LED
         led->hal_led_init();
@@ -49,165 +633,905 @@ namespace app
         app->state = APP_IDLE;
     }
 
-    void app_tick(app_t *app, uint32_t now_ms)
+    void app_attach_sensors(app_t *app, sensors::sensor_registry_t *sensors)
+    {
+        app->sensors = sensors;
+    }
+
+    void app_attach_spool(app_t *app, spool::spool_t *spool)
+    {
+        app->spool = spool;
+    }
+
+    void app_publish(const app_t *app)
+    {
+        if (app->published == NULL)
+            return;
+
+        app_snapshot_t snap;
+        fill_snapshot(app, &snap);
+        app->published->write(snap);
+    }
+
+    void app_offload_acquisition(app_t *app, util::Seqlock<app_snapshot_t> *channel)
+    {
+        // Sampling and telemetry framing now happen on the other side.
+        sched::sched_cancel(&app->sched, app->telemetry_task);
+        app->telemetry_task = -1;
+        app->sensors = NULL;
+
+        app->published = channel;
+        app_publish(app);
+    }
+
+    void app_attach_stream(app_t *app, stream::stream_t *stream)
+    {
+        app->stream = stream;
+    }
+
+    void app_tick(app_t *app, uint64_t now_us)
     {
-        // Heartbeat LED: do not block, just toggle when due.
+        INSTR_START(t_tick);
+        INSTR_CALL(instr::instr_tick(&app->instr, now_us));
+        app->loop.iterations++;
+
+        // Sample every sensor channel that is due (one read each, non-blocking).
+        // The registry runs on wrap-safe 32-bit milliseconds.
+        // New samples then feed any window summaries.
+        if (sampling(app))
+        {
+            uint32_t now_ms = (uint32_t)(now_us / US_PER_MS);
+            sensors::sensor_registry_poll(app->sensors, now_ms);
+
+            summary_ctx_t ctx = {app, now_us};
+            stats::stats_poll(&app->stats, app->sensors, now_ms, emit_summary, &ctx);
+
+            subs_step(app, now_us);
+        }
+
+        // Manual LED override is applied every tick.
         if (app->led_override)
         {
             app->led->hal_led_set(app->led_override_value);
         }
-        else
+
+        // Host went away or came back. On return, make everything spooled
+        // while it was gone durable before anyone asks for a replay.
+        bool up = app->serial->hal_serial_connected();
+        if (up && !app->link_up && app->spool)
         {
-            if ((uint32_t)(now_ms - app->last_heartbeat_ms) >= HEARTBEAT_PERIOD_MS)
-            {
-                app->last_heartbeat_ms = now_ms;
-                app->led->hal_led_toggle();
-            }
+            spool::spool_sync(app->spool);
+            app->spooled_since_sync = 0;
         }
+        app->link_up = up;
+
+        // Heartbeat and telemetry: run whatever is due, drift-free.
+        sched::sched_run(&app->sched, now_us);
 
-        // Telemetry: emit a line when due.
-        if ((uint32_t)(now_ms - app->last_telemetry_ms) >= app->telemetry_period_ms)
+        if (app->replay.active)
+            replay_step(app);
+
+        if (app->stream != NULL)
+            stream_step(app, now_us);
+
+        // Drain queued replies, logs and telemetry without blocking.
+        app->serial->hal_serial_flush(TX_FLUSH_BUDGET_BYTES);
+        INSTR_STOP(&app->instr, instr::INSTR_TICK, t_tick);
+    }
+
+    bool app_next_deadline(const app_t *app, uint64_t now_us, uint64_t *deadline_us)
+    {
+        uint64_t due = 0;
+        bool have = sched::sched_next_deadline(&app->sched, &due);
+
+        uint64_t sensor_due;
+        if (sampling(app) && sensors::sensor_registry_next_due_us(app->sensors, now_us, &sensor_due))
         {
-            app->last_telemetry_ms = now_ms;
-            log_status(app, now_ms);
+            if (!have || sensor_due < due)
+                due = sensor_due;
+            have = true;
         }
+
+        // A window summary is due when its window ends.
+        uint32_t window_end_ms;
+        if (sampling(app) && stats::stats_next_due(&app->stats, &window_end_ms))
+        {
+            uint64_t now_ms = now_us / US_PER_MS;
+            int32_t ahead = (int32_t)(window_end_ms - (uint32_t)now_ms);
+            uint64_t window_due = ahead > 0 ? (now_ms + (uint32_t)ahead) * US_PER_MS : now_us;
+            if (!have || window_due < due)
+                due = window_due;
+            have = true;
+        }
+
+        uint64_t sub_due;
+        if (sampling(app) && subs::subs_next_due(&app->subs, &sub_due))
+        {
+            if (!have || sub_due < due)
+                due = sub_due;
+            have = true;
+        }
+
+        if (have)
+            *deadline_us = due;
+        return have;
     }
 
-    void app_handle_command(app_t *app, const char *line)
+    void app_idle(app_t *app, uint64_t now_us)
     {
-        if (app == NULL || line == NULL)
+        // Unread commands, a replay to feed or a streamed block to send: go
+        // round the loop again instead.
+        if (app->serial->hal_serial_pending() || app->replay.active ||
+            (app->stream != NULL && stream::stream_peek(app->stream) != NULL))
             return;
 
-        // Skip leading whitespace (helps if host sends " LED ON")
-        while (*line == ' ' || *line == '\t')
+        uint64_t deadline = now_us + (uint64_t)APP_IDLE_MAX_SLEEP_MS * US_PER_MS;
+        uint64_t due;
+        if (app_next_deadline(app, now_us, &due) && due < deadline)
+            deadline = due;
+
+        // Unsent output: wake when the link can take the next flush budget,
+        // not before; the TX side drains on its own meanwhile.
+        uint32_t tx_wait = app->serial->hal_serial_tx_wait_us(TX_FLUSH_BUDGET_BYTES);
+        if (tx_wait != 0 && now_us + tx_wait < deadline)
+            deadline = now_us + tx_wait;
+
+        if (deadline <= now_us)
+            return;
+
+        app->time->hal_sleep_until(deadline);
+
+        uint64_t woke = app->time->hal_monotonic_us();
+        app->loop.sleeps++;
+        app->loop.idle_us += woke - now_us;
+        INSTR_CALL(instr::instr_slept(&app->instr, woke - now_us));
+        if (woke < deadline)
+            app->loop.early_wakeups++;
+    }
+
+    // ------------------------------------------------------------------------
+    // Command handlers. args is the rest of the line after the command token
+    // with leading whitespace skipped.
+    // ------------------------------------------------------------------------
+
+    static void cmd_help(app_t *app, const char *args);
+
+    static void cmd_status(app_t *app, const char *args)
+    {
+        (void)args;
+        uint64_t now_us = app->time->hal_monotonic_us();
+        if (!app->reply.active && !app->reply.tagged)
         {
-            line++;
+            log_status(app, now_us, k_status_reply_prefix);
+            return;
         }
 
-        // Ignore empty lines
-        if (*line == '\0')
+        app_snapshot_t snap;
+        fill_snapshot(app, &snap);
+        static const size_t prefix_len = sizeof(k_status_reply_prefix) - 1;
+        char line[prefix_len + status_format_t::max_len + 1];
+        memcpy(line, k_status_reply_prefix, prefix_len);
+        format_status(&snap, now_us, line + prefix_len, sizeof(line) - prefix_len);
+        send_reply(app, line);
+    }
+
+    static void cmd_loop(app_t *app, const char *args)
+    {
+        (void)args;
+        char buffer[loop_format_t::max_len + 1];
+        loop_format_t::write(buffer, sizeof(buffer),
+                             app->loop.iterations,
+                             app->loop.sleeps,
+                             app->loop.early_wakeups,
+                             app->loop.idle_us / US_PER_MS,
+                             (app->time->hal_monotonic_us() - app->boot_us) / US_PER_MS);
+        send_reply(app, buffer);
+    }
+
+    static void cmd_arm(app_t *app, const char *args)
+    {
+        (void)args;
+        app->state = APP_ARMED;
+        send_reply(app, "OK ARMED");
+    }
+
+    static void cmd_disarm(app_t *app, const char *args)
+    {
+        (void)args;
+        app->state = APP_IDLE;
+        send_reply(app, "OK IDLE");
+    }
+
+    static void cmd_fault(app_t *app, const char *args)
+    {
+        (void)args;
+        app->fault_count++;
+        app->state = APP_FAULT;
+        send_reply(app, "OK FAULT");
+    }
+
+    static void cmd_led(app_t *app, const char *arg)
+    {
+        if (strcmp(arg, "ON") == 0)
+        {
+            app->led_override = true;       // manual mode enabled
+            app->led_override_value = true; // manual value
+            app->led->hal_led_set(true);
+            send_reply(app, "OK LED ON");
             return;
+        }
 
-        // HELP
-        if (strcmp(line, "HELP") == 0)
+        if (strcmp(arg, "OFF") == 0)
         {
-            app->serial->hal_serial_print("OK Commands: HELP STATUS LED ON|OFF|AUTO RATE <ms> ARM DISARM FAULT");
+            app->led_override = true;        // manual mode enabled
+            app->led_override_value = false; // manual value
+            app->led->hal_led_set(false);
+            send_reply(app, "OK LED OFF");
             return;
         }
 
-        // STATUS
-        if (strcmp(line, "STATUS") == 0)
+        if (strcmp(arg, "AUTO") == 0)
         {
-            app->serial->hal_serial_print("OK ");
-            log_status(app, app->time->hal_millis());
+            app->led_override = false; // return control to heartbeat
+            send_reply(app, "OK LED AUTO");
             return;
         }
 
-        // ARM / DISARM
-        if (strcmp(line, "ARM") == 0)
+        send_reply(app, "ERR LED expects ON OFF AUTO");
+    }
+
+    static void cmd_rate(app_t *app, const char *p)
+    {
+        char *end = NULL;
+        long ms = strtol(p, &end, 10);
+
+        // Validate parse: must have at least one digit and no trailing junk
+        if (end == p)
         {
-            app->state = APP_ARMED;
-            app->serial->hal_serial_print("OK ARMED");
+            send_reply(app, "ERR RATE expects an integer");
+            return;
+        }
+        while (*end == ' ' || *end == '\t')
+        {
+            end++;
+        }
+        if (*end != '\0')
+        {
+            send_reply(app, "ERR RATE expects only an integer");
             return;
         }
 
-        if (strcmp(line, "DISARM") == 0)
+        // Clamp to reasonable bounds for MVP
+        if (ms < 10 || ms > 60000)
         {
-            app->state = APP_IDLE;
-            app->serial->hal_serial_print("OK IDLE");
+            send_reply(app, "ERR RATE out of range (10..60000)");
             return;
         }
 
-        // FAULT
-        if (strcmp(line, "FAULT") == 0)
+        app->telemetry_period_ms = (uint32_t)ms;
+        sched::sched_set_period(&app->sched, app->telemetry_task, app->telemetry_period_ms * US_PER_MS, app->time->hal_monotonic_us());
+        send_reply(app, "OK RATE SET");
+    }
+
+    // arg is word, optionally followed by whitespace and more; *rest is
+    // what follows the whitespace.
+    static bool mode_arg(const char *arg, const char *word, const char **rest)
+    {
+        size_t n = strlen(word);
+        if (strncmp(arg, word, n) != 0 || (arg[n] != '\0' && arg[n] != ' ' && arg[n] != '\t'))
+            return false;
+        const char *p = arg + n;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        *rest = p;
+        return true;
+    }
+
+    // Optional keyframe interval (1..1000); *interval keeps its value when
+    // text is empty.
+    static bool parse_interval(const char *text, long *interval)
+    {
+        if (*text == '\0')
+            return true;
+        char *end = NULL;
+        long v = strtol(text, &end, 10);
+        while (end != text && (*end == ' ' || *end == '\t'))
+            end++;
+        if (end == text || *end != '\0' || v < 1 || v > 1000)
+            return false;
+        *interval = v;
+        return true;
+    }
+
+    static void cmd_telemetry(app_t *app, const char *arg)
+    {
+        if (strcmp(arg, "BINARY") == 0)
         {
-            app->fault_count++;
-            app->state = APP_FAULT;
-            app->serial->hal_serial_print("OK FAULT");
+            app->telemetry_mode = APP_TELEMETRY_BINARY;
+            send_reply(app, "OK TELEMETRY BINARY");
             return;
         }
 
-        // LED commands
-        if (strncmp(line, "LED ", 4) == 0)
+        if (strcmp(arg, "TEXT") == 0)
         {
-            const char *arg = line + 4;
+            app->telemetry_mode = APP_TELEMETRY_TEXT;
+            send_reply(app, "OK TELEMETRY TEXT");
+            return;
+        }
 
-            while (*arg == ' ' || *arg == '\t')
+        // DELTA [keyframe interval]; (re)starting delta mode always opens with a keyframe.
+        const char *p = NULL;
+        long interval = 0;
+        if (mode_arg(arg, "DELTA", &p))
+        {
+            interval = (long)app->telemetry_delta.key_interval;
+            if (!parse_interval(p, &interval))
             {
-                arg++;
+                send_reply(app, "ERR TELEMETRY DELTA keyframe interval out of range (1..1000)");
+                return;
             }
 
-            if (strcmp(arg, "ON") == 0)
+            pkt_delta_init(&app->telemetry_delta, (uint16_t)interval);
+            app->delta_generation++;
+            app->telemetry_mode = APP_TELEMETRY_DELTA;
+
+            char reply[delta_format_t::max_len + 1];
+            delta_format_t::write(reply, sizeof(reply), (uint32_t)interval);
+            send_reply(app, reply);
+            return;
+        }
+
+        // CHANGES [periods per keyframe]; deadbands (DEADBAND) are kept.
+        if (mode_arg(arg, "CHANGES", &p))
+        {
+            interval = (long)app->changes.key_periods;
+            if (!parse_interval(p, &interval))
             {
-                app->led_override = true;       // manual mode enabled
-                app->led_override_value = true; // manual value
-                app->led->hal_led_set(true);
-                app->serial->hal_serial_print("OK LED ON");
+                send_reply(app, "ERR TELEMETRY CHANGES keyframe interval out of range (1..1000)");
                 return;
             }
 
-            if (strcmp(arg, "OFF") == 0)
+            changes::changes_restart(&app->changes, (uint16_t)interval);
+            pkt_delta_init(&app->telemetry_delta, (uint16_t)interval);
+            app->delta_generation++;
+            app->telemetry_mode = APP_TELEMETRY_CHANGES;
+
+            char reply[changes_format_t::max_len + 1];
+            changes_format_t::write(reply, sizeof(reply), (uint32_t)interval);
+            send_reply(app, reply);
+            return;
+        }
+
+        // KEY: the next record is a keyframe (a host lost track).
+        if (strcmp(arg, "KEY") == 0)
+        {
+            if (app->telemetry_mode == APP_TELEMETRY_CHANGES)
+                changes::changes_request_key(&app->changes);
+            else if (app->telemetry_mode == APP_TELEMETRY_DELTA)
+                pkt_delta_request_key(&app->telemetry_delta);
+            else
             {
-                app->led_override = true;        // manual mode enabled
-                app->led_override_value = false; // manual value
-                app->led->hal_led_set(false);
-                app->serial->hal_serial_print("OK LED OFF");
+                send_reply(app, "ERR TELEMETRY KEY needs DELTA or CHANGES");
                 return;
             }
+            send_reply(app, "OK TELEMETRY KEY");
+            return;
+        }
+
+        send_reply(app, "ERR TELEMETRY expects BINARY TEXT DELTA CHANGES KEY");
+    }
 
-            if (strcmp(arg, "AUTO") == 0)
+    // DEADBAND <ch> <counts>: CHANGES mode reports channel ch only once it
+    // moved by more than counts from the value last sent.
+    static void cmd_deadband(app_t *app, const char *args)
+    {
+        char *end = NULL;
+        unsigned long ch = strtoul(args, &end, 10);
+        const char *p = end;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (end == args || *args == '-' || p == end || *p == '\0' || *p == '-')
+        {
+            send_reply(app, "ERR DEADBAND expects <channel> <counts>");
+            return;
+        }
+        unsigned long counts = strtoul(p, &end, 10);
+        while (end != p && (*end == ' ' || *end == '\t'))
+            end++;
+        if (end == p || *end != '\0')
+        {
+            send_reply(app, "ERR DEADBAND expects <channel> <counts>");
+            return;
+        }
+        if (ch >= PKT_CHANGES_MAX_CHANNELS)
+        {
+            send_reply(app, "ERR DEADBAND channel out of range (0..3)");
+            return;
+        }
+        if (counts > INT32_MAX)
+        {
+            send_reply(app, "ERR DEADBAND counts out of range");
+            return;
+        }
+
+        app->changes.deadband[ch] = (uint32_t)counts;
+        char reply[deadband_format_t::max_len + 1];
+        deadband_format_t::write(reply, sizeof(reply), (uint32_t)ch, (uint32_t)counts);
+        send_reply(app, reply);
+    }
+
+    static void cmd_replay(app_t *app, const char *args)
+    {
+        if (app->spool == NULL)
+        {
+            send_reply(app, "ERR REPLAY no spool");
+            return;
+        }
+
+        // Default: everything still in the spool.
+        uint32_t from = spool::spool_first_seq(app->spool);
+        if (*args != '\0')
+        {
+            char *end = NULL;
+            unsigned long seq = strtoul(args, &end, 10);
+            while (end != args && (*end == ' ' || *end == '\t'))
+                end++;
+            if (end == args || *end != '\0' || *args == '-' || seq > 0xFFFFFFFFul)
             {
-                app->led_override = false; // return control to heartbeat
-                app->serial->hal_serial_print("OK LED AUTO");
+                send_reply(app, "ERR REPLAY expects a sequence number");
                 return;
             }
+            from = (uint32_t)seq;
+        }
+
+        app_replay_t *r = &app->replay;
+        spool::spool_seek(app->spool, from, &r->cursor);
+        r->end_seq = spool::spool_next_seq(app->spool);
+        r->sent = 0;
+        r->active = true;
+
+        char reply[replay_format_t::max_len + 1];
+        replay_format_t::write(reply, sizeof(reply), r->cursor.seq, r->end_seq);
+        send_reply(app, reply);
+    }
 
-            app->serial->hal_serial_print("ERR LED expects ON OFF AUTO");
+    // SUMMARY <channel> <window ms> | SUMMARY <channel> OFF
+    static void cmd_summary(app_t *app, const char *args)
+    {
+        if (app->sensors == NULL)
+        {
+            send_reply(app, "ERR SUMMARY no sensors");
             return;
         }
 
-        // RATE <ms>
-        if (strncmp(line, "RATE ", 5) == 0)
+        char *end = NULL;
+        unsigned long ch = strtoul(args, &end, 10);
+        const char *p = end;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (end == args || *args == '-' || p == end || *p == '\0')
         {
-            const char *p = line + 5;
+            send_reply(app, "ERR SUMMARY expects <channel> <ms>|OFF");
+            return;
+        }
+        if (ch >= app->sensors->channel_count)
+        {
+            send_reply(app, "ERR SUMMARY no such channel");
+            return;
+        }
 
-            while (*p == ' ' || *p == '\t')
+        if (strcmp(p, "OFF") == 0)
+        {
+            stats::stats_disable(&app->stats, (uint8_t)ch);
+            char reply[summary_off_format_t::max_len + 1];
+            summary_off_format_t::write(reply, sizeof(reply), (uint32_t)ch);
+            send_reply(app, reply);
+            return;
+        }
+
+        const char *ms_text = p;
+        long ms = strtol(ms_text, &end, 10);
+        while (end != ms_text && (*end == ' ' || *end == '\t'))
+            end++;
+        if (end == ms_text || *end != '\0')
+        {
+            send_reply(app, "ERR SUMMARY expects <channel> <ms>|OFF");
+            return;
+        }
+        if (ms < SUMMARY_MIN_WINDOW_MS || ms > SUMMARY_MAX_WINDOW_MS)
+        {
+            char reply[summary_range_format_t::max_len + 1];
+            summary_range_format_t::write(reply, sizeof(reply), SUMMARY_MIN_WINDOW_MS, SUMMARY_MAX_WINDOW_MS);
+            send_reply(app, reply);
+            return;
+        }
+
+        uint32_t now_ms = (uint32_t)(app->time->hal_monotonic_us() / US_PER_MS);
+        if (!stats::stats_configure(&app->stats, app->sensors, (uint8_t)ch, (uint32_t)ms, now_ms))
+        {
+            send_reply(app, "ERR SUMMARY all windows in use");
+            return;
+        }
+
+        char reply[summary_on_format_t::max_len + 1];
+        summary_on_format_t::write(reply, sizeof(reply), (uint32_t)ch, (uint32_t)ms);
+        send_reply(app, reply);
+    }
+
+    // SUB <channel> <ms>: send channel's latest sample every ms. Channels
+    // at the same period share one grid, so they always share a record.
+    // Subscribing again changes the period.
+    static void cmd_sub(app_t *app, const char *args)
+    {
+        if (app->sensors == NULL)
+        {
+            send_reply(app, "ERR SUB no sensors");
+            return;
+        }
+
+        char *end = NULL;
+        unsigned long ch = strtoul(args, &end, 10);
+        const char *p = end;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (end == args || *args == '-' || p == end || *p == '\0')
+        {
+            send_reply(app, "ERR SUB expects <channel> <ms>");
+            return;
+        }
+        if (ch >= app->sensors->channel_count || ch >= SUBS_MAX_CHANNELS)
+        {
+            send_reply(app, "ERR SUB no such channel");
+            return;
+        }
+
+        long ms = strtol(p, &end, 10);
+        while (end != p && (*end == ' ' || *end == '\t'))
+            end++;
+        if (end == p || *end != '\0')
+        {
+            send_reply(app, "ERR SUB expects <channel> <ms>");
+            return;
+        }
+        if (ms < 10 || ms > 60000)
+        {
+            send_reply(app, "ERR SUB period out of range (10..60000)");
+            return;
+        }
+
+        if (!subs::subs_add(&app->subs, (uint8_t)ch, (uint32_t)ms * US_PER_MS, app->time->hal_monotonic_us()))
+        {
+            send_reply(app, "ERR SUB too many different periods");
+            return;
+        }
+
+        char reply[sub_format_t::max_len + 1];
+        sub_format_t::write(reply, sizeof(reply), (uint32_t)ch, (uint32_t)ms);
+        send_reply(app, reply);
+    }
+
+    // UNSUB <channel> | UNSUB ALL
+    static void cmd_unsub(app_t *app, const char *args)
+    {
+        if (strcmp(args, "ALL") == 0)
+        {
+            subs::subs_clear(&app->subs);
+            send_reply(app, "OK UNSUB ALL");
+            return;
+        }
+
+        char *end = NULL;
+        unsigned long ch = strtoul(args, &end, 10);
+        while (end != args && (*end == ' ' || *end == '\t'))
+            end++;
+        if (end == args || *args == '-' || *end != '\0')
+        {
+            send_reply(app, "ERR UNSUB expects <channel>|ALL");
+            return;
+        }
+        if (ch > 0xFFu || !subs::subs_remove(&app->subs, (uint8_t)ch))
+        {
+            send_reply(app, "ERR UNSUB not subscribed");
+            return;
+        }
+
+        char reply[unsub_format_t::max_len + 1];
+        unsub_format_t::write(reply, sizeof(reply), (uint32_t)ch);
+        send_reply(app, reply);
+    }
+
+    // STREAM START <hz> [channel] | STREAM STOP | STREAM (counters)
+    static void cmd_stream(app_t *app, const char *args)
+    {
+        stream::stream_t *s = app->stream;
+        if (s == NULL)
+        {
+            send_reply(app, "ERR STREAM not available");
+            return;
+        }
+
+        if (*args == '\0')
+        {
+            if (!stream::stream_active(s))
             {
-                p++;
+                send_reply(app, "OK STREAM OFF");
+                return;
             }
+            char reply[stream_format_t::max_len + 1];
+            stream_format_t::write(reply, sizeof(reply), s->channel, s->rate_hz, s->samples.load(),
+                                   s->blocks_sent, s->lost.load(), s->overruns.load());
+            send_reply(app, reply);
+            return;
+        }
 
-            char *end = NULL;
-            long ms = strtol(p, &end, 10);
-
-            // Validate parse: must have at least one digit and no trailing junk
-            if (end == p)
+        if (strcmp(args, "STOP") == 0)
+        {
+            if (!stream::stream_active(s))
             {
-                app->serial->hal_serial_print("ERR RATE expects an integer");
+                send_reply(app, "ERR STREAM not running");
                 return;
             }
-            while (*end == ' ' || *end == '\t')
+            stream::stream_stop(s);
+
+            // Whatever was sampled goes out ahead of the reply; what the
+            // TX side has no room for counts as lost.
+            uint64_t now_us = app->time->hal_monotonic_us();
+            stream::stream_block_t partial;
+            const stream::stream_block_t *b = stream::stream_peek(s);
+            bool have_partial = stream::stream_take_partial(s, &partial);
+            if (b != NULL)
             {
-                end++;
+                if (app->serial->hal_serial_tx_free() >= PKT_MAX_FRAME)
+                {
+                    send_stream_block(app, b, now_us);
+                    stream::stream_release(s);
+                }
+                else
+                    stream::stream_discard(s);
             }
-            if (*end != '\0')
+            if (have_partial)
             {
-                app->serial->hal_serial_print("ERR RATE expects only an integer");
+                if (app->serial->hal_serial_tx_free() >= PKT_MAX_FRAME)
+                {
+                    send_stream_block(app, &partial, now_us);
+                    s->blocks_sent++;
+                }
+                else
+                {
+                    s->lost.fetch_add(partial.count);
+                    s->overruns.fetch_add(1);
+                }
+            }
+
+            char reply[stream_off_format_t::max_len + 1];
+            stream_off_format_t::write(reply, sizeof(reply), s->samples.load(), s->blocks_sent, s->lost.load(),
+                                       s->overruns.load());
+            send_reply(app, reply);
+            return;
+        }
+
+        if (strncmp(args, "START", 5) != 0 || (args[5] != ' ' && args[5] != '\t'))
+        {
+            send_reply(app, "ERR STREAM expects START <hz> [ch]|STOP");
+            return;
+        }
+
+        const char *p = args + 5;
+        char *end = NULL;
+        long hz = strtol(p, &end, 10);
+        if (end == p)
+        {
+            send_reply(app, "ERR STREAM expects START <hz> [ch]|STOP");
+            return;
+        }
+        p = end;
+        unsigned long ch = 0;
+        bool have_ch = false;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p != '\0')
+        {
+            have_ch = true;
+            ch = strtoul(p, &end, 10);
+            while (end != p && (*end == ' ' || *end == '\t'))
+                end++;
+            if (end == p || *p == '-' || *end != '\0')
+            {
+                send_reply(app, "ERR STREAM expects START <hz> [ch]|STOP");
                 return;
             }
+        }
 
-            // Clamp to reasonable bounds for MVP
-            if (ms < 10 || ms > 60000)
+        if (hz < 1 || hz > STREAM_MAX_HZ)
+        {
+            send_reply(app, "ERR STREAM rate out of range (1..20000)");
+            return;
+        }
+        if (app->sensors == NULL)
+        {
+            send_reply(app, "ERR STREAM no sensors");
+            return;
+        }
+        const sensors::sensor_registry_t *reg = app->sensors;
+        if (!have_ch)
+        {
+            // The first channel the timer may sample (an ADC input).
+            while (ch < reg->channel_count && !reg->source[ch]->hal_sensor_streamable(reg->source_channel[ch]))
+                ch++;
+            if (ch >= reg->channel_count)
             {
-                app->serial->hal_serial_print("ERR RATE out of range (10..60000)");
+                send_reply(app, "ERR STREAM no streamable channel");
                 return;
             }
+        }
+        if (ch >= reg->channel_count)
+        {
+            send_reply(app, "ERR STREAM no such channel");
+            return;
+        }
+        if (!reg->source[ch]->hal_sensor_streamable(reg->source_channel[ch]))
+        {
+            send_reply(app, "ERR STREAM channel not streamable");
+            return;
+        }
+        if (stream::stream_active(s))
+        {
+            send_reply(app, "ERR STREAM already running");
+            return;
+        }
+        if (!stream::stream_start(s, app->sensors->source[ch], app->sensors->source_channel[ch], (uint8_t)ch,
+                                  (uint32_t)hz))
+        {
+            send_reply(app, "ERR STREAM timer unavailable");
+            return;
+        }
+        app->stream_seq = 0;
 
-            app->telemetry_period_ms = (uint32_t)ms;
-            app->serial->hal_serial_print("OK RATE SET");
+        char reply[stream_on_format_t::max_len + 1];
+        stream_on_format_t::write(reply, sizeof(reply), (uint32_t)ch, (uint32_t)hz, s->period_us);
+        send_reply(app, reply);
+    }
+
+#if APP_INSTRUMENT
+    static void print_path_stats(app_t *app, const char *name, const util::LogHistogram &h, bool cycles)
+    {
+        // Cycle histograms are reported in ns, microsecond ones as they are.
+        auto conv = [cycles](uint32_t v) { return cycles ? instr::instr_cycles_to_ns(v) : v; };
+
+        char line[24 + stats_path_format_t::max_len + 1];
+        size_t n = strlen(name);
+        memcpy(line, name, n);
+        stats_path_format_t::write(line + n, sizeof(line) - n, h.count(), conv(h.mean()), conv(h.percentile(500)),
+                                   conv(h.percentile(900)), conv(h.percentile(990)), conv(h.max()));
+        send_reply(app, line);
+    }
+
+    // STATS: loop rate and stall, then one line per hot path (ns) and the
+    // telemetry jitter (us). STATS RESET starts a new measurement period.
+    static void cmd_stats(app_t *app, const char *args)
+    {
+        instr::instr_t *in = &app->instr;
+        uint64_t now_us = app->time->hal_monotonic_us();
+
+        if (strcmp(args, "RESET") == 0)
+        {
+            instr::instr_reset(in, now_us);
+            send_reply(app, "OK STATS RESET");
+            return;
+        }
+        if (*args != '\0')
+        {
+            send_reply(app, "ERR STATS expects RESET or nothing");
             return;
         }
 
-        app->serial->hal_serial_print("ERR Unknown command");
+        uint64_t up_us = now_us - in->since_us;
+        uint32_t loop_hz = up_us > 0 ? (uint32_t)((uint64_t)in->ticks * 1000000u / up_us) : 0;
+
+        char line[stats_format_t::max_len + 1];
+        stats_format_t::write(line, sizeof(line), up_us / US_PER_MS, in->ticks, loop_hz, in->max_stall_us);
+        send_reply(app, line);
+        print_path_stats(app, "STATS TICK_NS", in->path[instr::INSTR_TICK], true);
+        print_path_stats(app, "STATS COMMAND_NS", in->path[instr::INSTR_COMMAND], true);
+        print_path_stats(app, "STATS READLINE_NS", in->path[instr::INSTR_READLINE], true);
+        print_path_stats(app, "STATS JITTER_US", in->jitter_us, false);
+    }
+#endif
+
+    // Command registration table. Order here is the order HELP lists them;
+    // lookup goes through a hash index built at compile time.
+    static constexpr util::CmdEntry<app_t> k_command_list[] = {
+        {"HELP", "", false, cmd_help},
+        {"STATUS", "", false, cmd_status},
+        {"LED", "ON|OFF|AUTO", true, cmd_led},
+        {"RATE", "<ms>", true, cmd_rate},
+        {"ARM", "", false, cmd_arm},
+        {"DISARM", "", false, cmd_disarm},
+        {"FAULT", "", false, cmd_fault},
+        {"TELEMETRY", "BINARY|TEXT|DELTA [n]|CHANGES [n]|KEY", true, cmd_telemetry},
+        {"DEADBAND", "<ch> <counts>", true, cmd_deadband},
+        {"LOOP", "", false, cmd_loop},
+        {"REPLAY", "[seq]", true, cmd_replay},
+        {"SUMMARY", "<ch> <ms>|OFF", true, cmd_summary},
+        {"SUB", "<ch> <ms>", true, cmd_sub},
+        {"UNSUB", "<ch>|ALL", true, cmd_unsub},
+        {"STREAM", "START <hz> [ch]|STOP", true, cmd_stream},
+#if APP_INSTRUMENT
+        {"STATS", "[RESET]", true, cmd_stats},
+#endif
+    };
+
+    static constexpr util::CmdTable<app_t, sizeof(k_command_list) / sizeof(k_command_list[0])>
+        k_commands(k_command_list);
+
+    static void cmd_help(app_t *app, const char *args)
+    {
+        (void)args;
+        char text[384];
+        k_commands.help_text(text, sizeof(text), "OK Commands: ");
+        send_reply(app, text);
+    }
+
+    // "#<tag>" at text (after the '#'): decimal, up to 32 bits, followed by
+    // whitespace or the end of the line. *rest is what follows the tag.
+    static bool parse_tag(const char *text, uint32_t *tag, const char **rest)
+    {
+        uint64_t v = 0;
+        const char *p = text;
+        while (*p >= '0' && *p <= '9' && p - text < 10)
+            v = v * 10u + (uint64_t)(*p++ - '0');
+        if (p == text || v > UINT32_MAX || (*p != '\0' && !util::cmd_is_space(*p)))
+            return false;
+        *tag = (uint32_t)v;
+        *rest = p;
+        return true;
+    }
+
+    void app_begin_batch(app_t *app)
+    {
+        app->reply.active = true;
+        app->reply.len = 0;
+    }
+
+    void app_end_batch(app_t *app)
+    {
+        batch_flush(app);
+        app->reply.active = false;
+    }
+
+    void app_handle_command(app_t *app, const char *line)
+    {
+        if (app == NULL || line == NULL)
+            return;
+        INSTR_START(t_command);
+
+        // Leading whitespace is skipped and empty lines are ignored. A tag
+        // without a command, or a malformed one, is an unknown command.
+        while (util::cmd_is_space(*line))
+            line++;
+        util::cmd_result_t result = util::CMD_UNKNOWN;
+        if (*line != '#')
+            result = k_commands.dispatch(app, line);
+        else if (parse_tag(line + 1, &app->reply.tag, &line))
+        {
+            app->reply.tagged = true;
+            result = k_commands.dispatch(app, line);
+            if (result == util::CMD_BLANK)
+                result = util::CMD_UNKNOWN;
+        }
+
+        if (result == util::CMD_UNKNOWN)
+        {
+            send_reply(app, "ERR Unknown command");
+        }
+        else if (result == util::CMD_HANDLED && app->published)
+        {
+            // Let the acquisition core pick up RATE/TELEMETRY/state changes now.
+            app_publish(app);
+            app->time->hal_wake();
+        }
+        app->reply.tagged = false;
+        INSTR_STOP(&app->instr, instr::INSTR_COMMAND, t_command);
     }
 
 } // namespace app
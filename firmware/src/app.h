@@ -2,11 +2,29 @@
 #pragma once
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "hal/led/hal_led.h"
 #include "hal/time/hal_time.h"
 #include "hal/serial/serial_io.h"
 #include "hal/logging/logging.h"
+#include "sensors/sensor_registry.h"
+#include "sched/scheduler.h"
+#include "spool/flash_spool.h"
+#include "stats/window_stats.h"
+#include "instr/instrument.h"
+#include "stream/stream.h"
+#include "changes/change_detect.h"
+#include "subs/subscriptions.h"
+#include "seqlock.h"
+#include "packet.h"
+
+// Reply bytes gathered from the commands of one loop pass before they go
+// out as a single write (app_begin_batch()). A batch must fit one datagram
+// of the UDP transport (udp_link.h): -D APP_REPLY_BATCH_BYTES=480
+#ifndef APP_REPLY_BATCH_BYTES
+#define APP_REPLY_BATCH_BYTES 480
+#endif
 
 namespace app
 {
@@ -18,6 +36,57 @@ namespace app
         APP_FAULT
     } app_state_t;
 
+    typedef enum
+    {
+        APP_TELEMETRY_TEXT = 0, // ASCII status lines via the logger
+        APP_TELEMETRY_BINARY,   // COBS framed packets (firmware/lib/protocol)
+        APP_TELEMETRY_DELTA,    // framed keyframe/delta varint records
+        APP_TELEMETRY_CHANGES   // framed records of changed fields and channels only
+    } app_telemetry_mode_t;
+
+    // Core0-owned state published to the acquisition core (see
+    // app_offload_acquisition()). Read through a seqlock, so readers always
+    // see one consistent command-time view.
+    typedef struct
+    {
+        uint64_t boot_us;
+        uint32_t telemetry_period_ms;
+        uint32_t fault_count;
+        uint16_t delta_key_interval; // records per keyframe in APP_TELEMETRY_DELTA / _CHANGES
+        uint8_t delta_generation;    // bumped whenever the delta encoder restarts
+        uint8_t state;          // app_state_t
+        uint8_t telemetry_mode; // app_telemetry_mode_t
+    } app_snapshot_t;
+
+    // Main loop counters for idle duty cycle: idle_us / (now - boot_us).
+    typedef struct
+    {
+        uint32_t iterations;    // app_tick() calls
+        uint32_t sleeps;        // app_idle() calls that actually slept
+        uint32_t early_wakeups; // sleeps ended by an event before the deadline
+        uint64_t idle_us;       // total time spent asleep
+    } app_loop_stats_t;
+
+    // Spool replay in progress (REPLAY command), paced by app_tick().
+    typedef struct
+    {
+        spool::spool_cursor_t cursor;
+        uint32_t end_seq; // exclusive: spool_next_seq() when REPLAY was issued
+        uint32_t sent;    // records sent so far
+        bool active;
+    } app_replay_t;
+
+    // Replies of the commands handled between app_begin_batch() and
+    // app_end_batch(), as "[#<tag> ]<reply>\r\n" lines.
+    typedef struct
+    {
+        char buf[APP_REPLY_BATCH_BYTES];
+        size_t len;
+        bool active;   // inside app_begin_batch()/app_end_batch()
+        bool tagged;   // the command being handled carried "#<tag>"
+        uint32_t tag;
+    } app_reply_batch_t;
+
     typedef struct
     {
         app_state_t state;
@@ -25,20 +94,101 @@ namespace app
         bool led_override;            // true = manual LED control
         bool led_override_value;      // only meaningful when led_override == true
         uint32_t telemetry_period_ms; // telemetry send period
-        uint32_t last_heartbeat_ms;   // last heartbeat time
-        uint32_t last_telemetry_ms;   // last telemetry time
-        uint32_t boot_ms;             // boot time in ms
+        uint64_t boot_us;             // boot time on the monotonic clock
         uint32_t fault_count;         // number of faults occurred
+        app_telemetry_mode_t telemetry_mode; // text, binary or delta telemetry
+        uint16_t telemetry_seq;       // sequence number of next binary packet
+        pkt_delta_t telemetry_delta;  // delta encoder (APP_TELEMETRY_DELTA / _CHANGES)
+        uint8_t delta_generation;     // restarts of telemetry_delta, published
+        changes::change_detect_t changes; // dirty fields and deadbands (APP_TELEMETRY_CHANGES)
 
         // Injected HAL interfaces
         hal::led::IHalLed *led;
         hal::time::IHalTime *time;
         hal::serial::ISerialIo *serial;
         hal::logging::ILogger *logger;
+
+        // Optional sensor sampling (NULL = no sensors attached)
+        sensors::sensor_registry_t *sensors;
+
+        // Per-channel window summaries (SUMMARY command), fed from sensors
+        stats::stats_table_t stats;
+        uint16_t summary_seq;         // sequence number of next PKT_TYPE_SUMMARY packet
+
+        // Per-channel subscriptions (SUB / UNSUB), fed from sensors
+        subs::subs_table_t subs;
+        uint16_t channels_seq;        // sequence number of next PKT_TYPE_CHANNELS packet
+
+        // Optional flash spool: telemetry is recorded there instead of sent
+        // while no host is listening (NULL = no spool)
+        spool::spool_t *spool;
+        bool link_up;                 // hal_serial_connected() at the last tick
+        uint32_t spooled_since_sync;  // records appended since the last spool_sync()
+        app_replay_t replay;
+
+        // Optional high-rate streaming (STREAM command, NULL = none); its
+        // timer callback samples, app_tick() sends the blocks
+        stream::stream_t *stream;
+        uint16_t stream_seq;          // sequence number of next PKT_TYPE_STREAM packet
+
+        app_reply_batch_t reply;      // command replies of the current loop pass
+
+        // Periodic jobs (heartbeat, telemetry)
+        sched::scheduler_t sched;
+        int heartbeat_task;
+        int telemetry_task;
+
+        app_loop_stats_t loop;
+#if APP_INSTRUMENT
+        instr::instr_t instr;         // hot-path latency histograms (STATS)
+#endif
+
+        // Snapshot channel to the acquisition core (NULL = single-core mode)
+        util::Seqlock<app_snapshot_t> *published;
     } app_t;
 
-    void app_init(app_t *app, uint32_t now_ms, hal::led::IHalLed* led, hal::time::IHalTime* time, hal::serial::ISerialIo* serial, hal::logging::ILogger* logger);
-    void app_tick(app_t *app, uint32_t now_ms);
+    // All now_us values come from time->hal_monotonic_us().
+    void app_init(app_t *app, uint64_t now_us, hal::led::IHalLed* led, hal::time::IHalTime* time, hal::serial::ISerialIo* serial, hal::logging::ILogger* logger);
+    void app_attach_sensors(app_t *app, sensors::sensor_registry_t *sensors);
+
+    // Record telemetry into spool (already mounted) while the link is down,
+    // and serve REPLAY from it.
+    void app_attach_spool(app_t *app, spool::spool_t *spool);
+
+    // Serve STREAM from stream (already initialized with its timer). Periodic
+    // sampling of the attached sensors pauses while a stream runs.
+    void app_attach_stream(app_t *app, stream::stream_t *stream);
+    void app_tick(app_t *app, uint64_t now_us);
+    bool app_next_deadline(const app_t *app, uint64_t now_us, uint64_t *deadline_us);
+
+    // Sleep until the next deadline (scheduler or sensor), capped at
+    // APP_IDLE_MAX_SLEEP_MS. Returns immediately while serial I/O is pending;
+    // serial RX and hal_wake() end the sleep early.
+    void app_idle(app_t *app, uint64_t now_us);
+
+    // Handle one command line. A leading "#<tag> " (decimal, 32 bits) is
+    // echoed at the start of every reply line, so a host can pipeline
+    // commands and match the replies: "#42 RATE 100" -> "#42 OK RATE SET".
     void app_handle_command(app_t *app, const char *line);
 
+    // Gather the replies of the commands handled in between and send them as
+    // one write, each terminated by "\r\n" (a batch that fills up is sent
+    // early). Without a batch each reply is printed as it is made.
+    void app_begin_batch(app_t *app);
+    void app_end_batch(app_t *app);
+
+    // Dual-core mode: stop sampling and periodic telemetry here and publish
+    // a snapshot to channel after every handled command instead. The
+    // acquisition side (acq::) formats telemetry from that snapshot.
+    void app_offload_acquisition(app_t *app, util::Seqlock<app_snapshot_t> *channel);
+    void app_publish(const app_t *app);
+
+    // Format one telemetry record for snap in its telemetry_mode: a status
+    // line (no line ending, NUL-terminated) or a complete binary frame.
+    // Delta mode encodes through delta (the caller's encoder state); with
+    // delta NULL it sends a full record instead. Changes mode is formatted
+    // as delta mode here: the snapshot carries no channel values.
+    // Returns the number of bytes written, 0 if it does not fit.
+    size_t app_format_telemetry(const app_snapshot_t *snap, uint64_t now_us, uint16_t seq, pkt_delta_t *delta, uint8_t *out, size_t cap);
+
 } // namespace app
\ No newline at end of file
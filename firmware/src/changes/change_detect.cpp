@@ -0,0 +1,102 @@
+// change_detect.cpp
+#include "changes/change_detect.h"
+
+#include <string.h>
+
+namespace changes
+{
+    void changes_init(change_detect_t *cd, uint16_t key_periods)
+    {
+        memset(cd, 0, sizeof(*cd));
+        changes_restart(cd, key_periods);
+    }
+
+    void changes_restart(change_detect_t *cd, uint16_t key_periods)
+    {
+        cd->key_periods = key_periods == 0 ? 1 : key_periods;
+        cd->since_key = 0;
+        cd->have_sent = false;
+        cd->key_requested = false;
+    }
+
+    void changes_request_key(change_detect_t *cd)
+    {
+        cd->key_requested = true;
+    }
+
+    uint8_t changes_dirty(const change_detect_t *cd, const pkt_changes_t *cur)
+    {
+        const uint8_t all = (uint8_t)((1u << (PKT_TELEMETRY_FIELDS + cur->channels)) - 1u);
+        if (!cd->have_sent || cur->channels != cd->sent.channels)
+            return all;
+
+        const pkt_telemetry_t *a = &cur->rec;
+        const pkt_telemetry_t *b = &cd->sent.rec;
+        uint8_t dirty = 0;
+        if (a->state != b->state)
+            dirty |= 1u << 0;
+        if (a->telemetry_period_ms != b->telemetry_period_ms)
+            dirty |= 1u << 1;
+        if (a->heartbeat_period_ms != b->heartbeat_period_ms)
+            dirty |= 1u << 2;
+        if (a->fault_count != b->fault_count)
+            dirty |= 1u << 3;
+
+        for (uint8_t i = 0; i < cur->channels; i++)
+        {
+            int64_t diff = (int64_t)cur->value[i] - (int64_t)cd->sent.value[i];
+            if (diff < 0)
+                diff = -diff;
+            if (diff > (int64_t)cd->deadband[i])
+                dirty |= (uint8_t)(1u << (PKT_TELEMETRY_FIELDS + i));
+        }
+        return dirty;
+    }
+
+    bool changes_period(change_detect_t *cd, const pkt_changes_t *cur, pkt_changes_t *out, bool *key)
+    {
+        cd->periods++;
+        if (cd->since_key < UINT16_MAX)
+            cd->since_key++;
+
+        uint8_t dirty = changes_dirty(cd, cur);
+        bool keyframe = !cd->have_sent || cd->key_requested || cd->since_key >= cd->key_periods ||
+                        cur->channels != cd->sent.channels;
+
+        if (keyframe)
+        {
+            cd->sent = *cur;
+            cd->have_sent = true;
+            cd->key_requested = false;
+            cd->since_key = 0;
+            cd->keyframes++;
+        }
+        else if (dirty == 0)
+        {
+            cd->quiet++;
+            return false;
+        }
+        else
+        {
+            // Only dirty fields move; the rest stay at what the receiver has.
+            if (dirty & (1u << 0))
+                cd->sent.rec.state = cur->rec.state;
+            if (dirty & (1u << 1))
+                cd->sent.rec.telemetry_period_ms = cur->rec.telemetry_period_ms;
+            if (dirty & (1u << 2))
+                cd->sent.rec.heartbeat_period_ms = cur->rec.heartbeat_period_ms;
+            if (dirty & (1u << 3))
+                cd->sent.rec.fault_count = cur->rec.fault_count;
+            for (uint8_t i = 0; i < cur->channels; i++)
+            {
+                if (dirty & (1u << (PKT_TELEMETRY_FIELDS + i)))
+                    cd->sent.value[i] = cur->value[i];
+            }
+            cd->deltas++;
+        }
+
+        *out = cd->sent;
+        *key = keyframe;
+        return true;
+    }
+} // namespace changes
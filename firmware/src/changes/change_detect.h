@@ -0,0 +1,68 @@
+// change_detect.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "packet.h"
+
+/*
+    Publish-on-Change Telemetry
+
+    Responsibilities:
+    - Once per telemetry period, compare the current record and channel
+      values against the last ones sent and mark each field dirty that
+      changed: record fields on any change, analog channels only when they
+      moved by more than their deadband (ADC noise is not news).
+    - Decide whether the period sends anything: a delta with just the dirty
+      fields, a full keyframe (every key_periods periods, on request, or
+      when the channel count changed), or nothing at all.
+
+    Invariants:
+    - sent always holds what a receiver that saw every record has: clean
+      fields keep their last sent value, so drift inside a deadband is never
+      reported piecemeal and cannot add up unseen. A channel that keeps
+      creeping is sent once it leaves the band around that value.
+    - A quiet period changes nothing but the counters, so its record is not
+      numbered (see PKT_TYPE_CHANGES_* in packet.h).
+    - The caller encodes exactly the record changes_period() returns, as a
+      keyframe when it says so; nothing here touches the wire.
+*/
+
+namespace changes
+{
+    typedef struct
+    {
+        pkt_changes_t sent;  // last record sent (valid once have_sent)
+        bool have_sent;
+        uint32_t deadband[PKT_CHANGES_MAX_CHANNELS]; // counts a channel must move by, 0 = any change
+
+        uint16_t key_periods;   // periods per keyframe
+        uint16_t since_key;     // periods since the last keyframe
+        bool key_requested;
+
+        // Counters since changes_init()
+        uint32_t periods;
+        uint32_t keyframes;
+        uint32_t deltas;
+        uint32_t quiet; // periods that sent nothing
+    } change_detect_t;
+
+    // Clears deadbands and counters; key_periods 0 is treated as 1. The
+    // first period always sends a keyframe.
+    void changes_init(change_detect_t *cd, uint16_t key_periods);
+
+    // Start over with a new keyframe interval, keeping the deadbands.
+    void changes_restart(change_detect_t *cd, uint16_t key_periods);
+
+    // Send a keyframe at the next period whatever changed.
+    void changes_request_key(change_detect_t *cd);
+
+    // Dirty bits of cur against the last record sent: bit i is delta
+    // field i (record fields first, then channels). All set before the
+    // first record.
+    uint8_t changes_dirty(const change_detect_t *cd, const pkt_changes_t *cur);
+
+    // One telemetry period. False if nothing is to be sent. Otherwise *out
+    // is the record to encode and *key tells whether it must be a keyframe.
+    bool changes_period(change_detect_t *cd, const pkt_changes_t *cur, pkt_changes_t *out, bool *key);
+} // namespace changes
@@ -0,0 +1,64 @@
+// hal/flash/hal_flash.cpp
+#include "hal/flash/hal_flash.h"
+
+#include <Arduino.h>
+#include <string.h>
+#include <hardware/flash.h>
+
+namespace hal::flash
+{
+    flash_geometry_t HalFlashPico::hal_flash_geometry()
+    {
+        flash_geometry_t g;
+        g.page_size = FLASH_PAGE_SIZE;
+        g.sector_size = FLASH_SECTOR_SIZE;
+        g.sector_count = size_ / FLASH_SECTOR_SIZE;
+        return g;
+    }
+
+    bool HalFlashPico::hal_flash_read(uint32_t offset, void *out, size_t len)
+    {
+        if (out == NULL || offset > size_ || len > size_ - offset)
+            return false;
+
+        // The region is memory mapped; the SDK routines flush the XIP cache
+        // after every program/erase, so plain loads see fresh data.
+        memcpy(out, (const void *)(uintptr_t)(XIP_BASE + offset_ + offset), len);
+        return true;
+    }
+
+    /*
+     * Flash cannot be read (or executed from) while it is being written, so
+     * both operations run with interrupts off and, if asked, the other core
+     * parked, as arduino-pico's EEPROM emulation does.
+     */
+    bool HalFlashPico::hal_flash_program(uint32_t offset, const uint8_t *page)
+    {
+        if (page == NULL || offset % FLASH_PAGE_SIZE != 0 || offset >= size_)
+            return false;
+
+        noInterrupts();
+        if (pause_other_core_)
+            rp2040.idleOtherCore();
+        flash_range_program(offset_ + offset, page, FLASH_PAGE_SIZE);
+        if (pause_other_core_)
+            rp2040.resumeOtherCore();
+        interrupts();
+        return true;
+    }
+
+    bool HalFlashPico::hal_flash_erase(uint32_t sector)
+    {
+        if (sector >= size_ / FLASH_SECTOR_SIZE)
+            return false;
+
+        noInterrupts();
+        if (pause_other_core_)
+            rp2040.idleOtherCore();
+        flash_range_erase(offset_ + sector * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+        if (pause_other_core_)
+            rp2040.resumeOtherCore();
+        interrupts();
+        return true;
+    }
+} // namespace hal::flash
@@ -0,0 +1,75 @@
+// hal_flash.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+namespace hal::flash
+{
+    // Region layout as seen through IHalFlash (offsets are region-relative).
+    typedef struct
+    {
+        uint32_t page_size;    // program granularity
+        uint32_t sector_size;  // erase granularity, a multiple of page_size
+        uint32_t sector_count; // sectors in the region
+    } flash_geometry_t;
+
+    /*
+        IHalFlash Interface
+
+        Responsibilities:
+        - Expose one NOR flash region for log-structured storage: read any
+          bytes, program whole pages, erase whole sectors.
+
+        Invariants:
+        - Erased bytes read as 0xFF. Programming can only clear bits: the
+          result is old & data, so a page may be programmed again with more
+          bytes filled in as long as already written bytes are unchanged.
+        - hal_flash_program() takes a page-aligned offset and exactly one
+          page; hal_flash_erase() takes a sector index. Both block until the
+          operation is done and return false on bad arguments.
+        - Reads are valid immediately after a program or erase returns.
+    */
+    class IHalFlash
+    {
+    public:
+        virtual ~IHalFlash() = default;
+        virtual flash_geometry_t hal_flash_geometry() = 0;
+        virtual bool hal_flash_read(uint32_t offset, void *out, size_t len) = 0;
+        virtual bool hal_flash_program(uint32_t offset, const uint8_t *page) = 0;
+        virtual bool hal_flash_erase(uint32_t sector) = 0;
+    };
+
+    /*
+        HalFlashPico Implementation
+
+        Responsibilities:
+        - Map a region of the on-board QSPI flash (past the firmware image)
+          onto IHalFlash: reads through the XIP window, program/erase
+          through the boot ROM routines with interrupts disabled.
+
+        Invariants:
+        - offset and size are multiples of the 4 KiB sector and lie inside
+          the flash chip.
+        - While a program or erase runs, XIP is unavailable: interrupts are
+          off, and with pause_other_core the other core is parked in RAM
+          (required when it runs code, as in dual-core mode). A sector erase
+          takes tens of milliseconds.
+    */
+    class HalFlashPico : public IHalFlash
+    {
+    public:
+        HalFlashPico(uint32_t offset, uint32_t size, bool pause_other_core)
+            : offset_(offset), size_(size), pause_other_core_(pause_other_core) {}
+
+        flash_geometry_t hal_flash_geometry() override;
+        bool hal_flash_read(uint32_t offset, void *out, size_t len) override;
+        bool hal_flash_program(uint32_t offset, const uint8_t *page) override;
+        bool hal_flash_erase(uint32_t sector) override;
+
+    private:
+        uint32_t offset_; // region start from the beginning of flash
+        uint32_t size_;
+        bool pause_other_core_;
+    };
+} // namespace hal::flash
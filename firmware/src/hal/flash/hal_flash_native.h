@@ -0,0 +1,137 @@
+// hal_flash_native.h
+#pragma once
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "hal/flash/hal_flash.h"
+
+namespace hal::flash
+{
+    // Physical operation counters kept by the emulator.
+    typedef struct
+    {
+        uint64_t pages_programmed;
+        uint64_t bytes_programmed;
+        uint64_t sectors_erased;
+        uint64_t bytes_read;
+        uint32_t bad_programs; // programs that tried to set a cleared bit (fail on real NOR)
+    } flash_wear_stats_t;
+
+    /*
+        HalFlashFile Implementation
+
+        Responsibilities:
+        - Stand in for HalFlashPico on native builds: the region is a file
+          mapped with mmap, so contents survive a "reboot" (a new instance
+          over the same file) and tests can inspect or corrupt it directly.
+        - Enforce NOR semantics (program ANDs into the old bytes, erase sets
+          a sector to 0xFF) and count every page program and sector erase,
+          per sector too, for write amplification and wear measurements.
+
+        Invariants:
+        - A new or resized file starts fully erased.
+        - ok() is false if the file could not be opened or mapped; every
+          operation then fails.
+    */
+    class HalFlashFile : public IHalFlash
+    {
+    public:
+        HalFlashFile(const char *path, uint32_t page_size, uint32_t sector_size, uint32_t sector_count)
+            : erases_(sector_count, 0)
+        {
+            geometry_.page_size = page_size;
+            geometry_.sector_size = sector_size;
+            geometry_.sector_count = sector_count;
+            size_ = (size_t)sector_size * sector_count;
+
+            fd_ = open(path, O_RDWR | O_CREAT, 0644);
+            if (fd_ < 0)
+                return;
+
+            struct stat st;
+            bool fresh = fstat(fd_, &st) != 0 || (size_t)st.st_size != size_;
+            if (fresh && ftruncate(fd_, (off_t)size_) != 0)
+                return;
+
+            void *p = mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (p == MAP_FAILED)
+                return;
+            mem_ = static_cast<uint8_t *>(p);
+            if (fresh)
+                memset(mem_, 0xFF, size_);
+        }
+
+        ~HalFlashFile() override
+        {
+            if (mem_ != NULL)
+                munmap(mem_, size_);
+            if (fd_ >= 0)
+                close(fd_);
+        }
+
+        HalFlashFile(const HalFlashFile &) = delete;
+        HalFlashFile &operator=(const HalFlashFile &) = delete;
+
+        bool ok() const { return mem_ != NULL; }
+
+        flash_geometry_t hal_flash_geometry() override { return geometry_; }
+
+        bool hal_flash_read(uint32_t offset, void *out, size_t len) override
+        {
+            if (mem_ == NULL || out == NULL || offset > size_ || len > size_ - offset)
+                return false;
+            memcpy(out, mem_ + offset, len);
+            stats_.bytes_read += len;
+            return true;
+        }
+
+        bool hal_flash_program(uint32_t offset, const uint8_t *page) override
+        {
+            if (mem_ == NULL || page == NULL || offset % geometry_.page_size != 0 || offset >= size_)
+                return false;
+
+            uint8_t *dst = mem_ + offset;
+            uint8_t set_bits = 0;
+            for (uint32_t i = 0; i < geometry_.page_size; i++)
+            {
+                set_bits |= (uint8_t)(page[i] & ~dst[i]);
+                dst[i] &= page[i];
+            }
+            if (set_bits)
+                stats_.bad_programs++;
+            stats_.pages_programmed++;
+            stats_.bytes_programmed += geometry_.page_size;
+            return true;
+        }
+
+        bool hal_flash_erase(uint32_t sector) override
+        {
+            if (mem_ == NULL || sector >= geometry_.sector_count)
+                return false;
+            memset(mem_ + (size_t)sector * geometry_.sector_size, 0xFF, geometry_.sector_size);
+            erases_[sector]++;
+            stats_.sectors_erased++;
+            return true;
+        }
+
+        // Raw contents, for tests that simulate torn writes or bit rot.
+        uint8_t *data() { return mem_; }
+        size_t size() const { return size_; }
+
+        const flash_wear_stats_t &stats() const { return stats_; }
+        // Erases per sector since this instance was created.
+        const std::vector<uint32_t> &erase_counts() const { return erases_; }
+
+    private:
+        flash_geometry_t geometry_;
+        size_t size_ = 0;
+        int fd_ = -1;
+        uint8_t *mem_ = NULL;
+        flash_wear_stats_t stats_ = {};
+        std::vector<uint32_t> erases_;
+    };
+} // namespace hal::flash
@@ -1,19 +1,27 @@
 // serial_logger.h
 #pragma once
 #include "hal/logging/logging.h"
+#include "hal/serial/serial_io.h"
 
 namespace hal::logging
 {
+    // Logs through the serial TX queue so log lines and command replies share
+    // one ordered, non-blocking output path.
     class HalSerialLogger : public ILogger
     {
     public:
+        explicit HalSerialLogger(hal::serial::HalSerial &serial) : serial_(serial) {}
+
         void log(const char* message) override
         {
             if (message)
             {
-                Serial.println(message);
+                serial_.hal_serial_println(message);
             }
         }
+
+    private:
+        hal::serial::HalSerial &serial_;
     };
 
 } // namespace hal::logging
@@ -0,0 +1,27 @@
+// udp_logger.h
+#pragma once
+#include "hal/logging/logging.h"
+#include "hal/transport/udp_link.h"
+
+namespace hal::logging
+{
+    // Logs through the open datagram so log lines and command replies share
+    // one ordered output path, as HalSerialLogger does on the UART.
+    class HalUdpLogger : public ILogger
+    {
+    public:
+        explicit HalUdpLogger(hal::transport::HalUdp &link) : link_(link) {}
+
+        void log(const char* message) override
+        {
+            if (message)
+            {
+                link_.hal_udp_println(message);
+            }
+        }
+
+    private:
+        hal::transport::HalUdp &link_;
+    };
+
+} // namespace hal::logging
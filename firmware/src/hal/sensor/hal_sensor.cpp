@@ -0,0 +1,47 @@
+// hal/sensor/hal_sensor.cpp
+#include "hal/sensor/hal_sensor.h"
+
+#include <Arduino.h>
+
+namespace hal::sensor
+{
+    /*
+     * Configure the ADC for 12-bit reads.
+     */
+    void HalSensorAdc::hal_sensor_init(void)
+    {
+        analogReadResolution(12);
+    }
+
+    /*
+     * Read one ADC channel as raw counts.
+     */
+    bool HalSensorAdc::hal_sensor_read(uint8_t channel, int32_t *value)
+    {
+        if (channel >= count_ || value == nullptr)
+            return false;
+
+        *value = (int32_t)analogRead(pins_[channel]);
+        return true;
+    }
+
+    /*
+     * The temperature sensor shares the ADC; nothing extra to set up.
+     */
+    void HalSensorTemp::hal_sensor_init(void)
+    {
+        analogReadResolution(12);
+    }
+
+    /*
+     * Read the on-chip temperature in milli-degrees Celsius.
+     */
+    bool HalSensorTemp::hal_sensor_read(uint8_t channel, int32_t *value)
+    {
+        if (channel != 0 || value == nullptr)
+            return false;
+
+        *value = (int32_t)(analogReadTemp() * 1000.0f);
+        return true;
+    }
+} // namespace hal::sensor
@@ -0,0 +1,86 @@
+// hal_sensor.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+    HAL Sensor Interface
+
+    Responsibilities:
+    - Abstract sampling of one or more analog/digital sensor channels.
+
+    Invariants:
+    - hal_sensor_init() must be called before other methods.
+    - hal_sensor_read() must be non-blocking (single conversion, no waits
+      beyond the ADC conversion time) and returns false on failure.
+    - Values are integers in channel units (raw ADC counts, milli-degC, ...).
+*/
+namespace hal::sensor
+{
+  /*
+    ISensor Interface
+
+    Responsibilities:
+    - Define sensor hardware abstraction methods.
+
+    Invariants:
+    - Channels are numbered 0 .. hal_sensor_channel_count() - 1.
+  */
+  class ISensor {
+    public:
+    virtual ~ISensor() = default;
+    virtual void hal_sensor_init() = 0;
+    virtual uint8_t hal_sensor_channel_count() = 0;
+    virtual bool hal_sensor_read(uint8_t channel, int32_t *value) = 0;
+
+    // Whether channel may be sampled from a timer interrupt (STREAM): its
+    // read never blocks and its values fit int16.
+    virtual bool hal_sensor_streamable(uint8_t channel)
+    {
+      (void)channel;
+      return false;
+    }
+  };
+
+
+  /*
+    HalSensorAdc Implementation
+
+    Responsibilities:
+    - Read RP2350 ADC inputs (GPIO26..29) as 12-bit raw counts.
+
+    Invariants:
+    - pins points to storage that outlives the sensor.
+  */
+  class HalSensorAdc : public ISensor {
+  public:
+  HalSensorAdc(const uint8_t *pins, uint8_t count) : pins_(pins), count_(count) {}
+  void hal_sensor_init() override;
+  uint8_t hal_sensor_channel_count() override { return count_; }
+  bool hal_sensor_read(uint8_t channel, int32_t *value) override; // raw counts 0..4095
+  bool hal_sensor_streamable(uint8_t channel) override { return channel < count_; }
+
+  private:
+  const uint8_t *pins_;
+  uint8_t count_;
+  };
+
+
+  /*
+    HalSensorTemp Implementation
+
+    Responsibilities:
+    - Read the RP2350 on-chip temperature sensor.
+
+    Invariants:
+    - Single channel, value in milli-degrees Celsius.
+    - Not streamable: the float conversion is too slow for interrupt
+      context and the value outgrows int16 above 32.767 degC.
+  */
+  class HalSensorTemp : public ISensor {
+  public:
+  void hal_sensor_init() override;
+  uint8_t hal_sensor_channel_count() override { return 1; }
+  bool hal_sensor_read(uint8_t channel, int32_t *value) override;
+  };
+} // namespace hal::sensor
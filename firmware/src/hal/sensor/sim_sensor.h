@@ -0,0 +1,61 @@
+// sim_sensor.h
+#pragma once
+#include "hal/sensor/hal_sensor.h"
+
+namespace hal::sensor
+{
+  /*
+    HalSensorSim Implementation
+
+    Responsibilities:
+    - Provide deterministic synthetic channels for native builds, tests and
+      benchmarks (no hardware, no libm).
+
+    Invariants:
+    - Channel c produces a triangle wave (period 64 + 16*c reads) with
+      amplitude 1000 around 2048 plus +/-8 counts of LCG noise.
+    - The sequence depends only on the channel and how many times it has
+      been read, so runs are exactly reproducible.
+  */
+  class HalSensorSim : public ISensor {
+  public:
+  static const uint8_t MAX_CHANNELS = 32;
+
+  explicit HalSensorSim(uint8_t count) : count_(count > MAX_CHANNELS ? MAX_CHANNELS : count) {}
+
+  void hal_sensor_init() override
+  {
+    for (uint8_t c = 0; c < MAX_CHANNELS; c++)
+    {
+      reads_[c] = 0;
+      noise_[c] = 0x9E3779B9u * (c + 1u);
+    }
+  }
+
+  uint8_t hal_sensor_channel_count() override { return count_; }
+  bool hal_sensor_streamable(uint8_t channel) override { return channel < count_; } // ADC-like counts
+
+  bool hal_sensor_read(uint8_t channel, int32_t *value) override
+  {
+    if (channel >= count_ || value == nullptr)
+      return false;
+
+    uint32_t period = 64u + 16u * channel;
+    uint32_t phase = reads_[channel]++ % period;
+    uint32_t half = period / 2u;
+    int32_t tri = (int32_t)(phase < half ? phase : period - phase); // 0..half
+    int32_t wave = (tri * 2000) / (int32_t)half - 1000;
+
+    noise_[channel] = noise_[channel] * 1664525u + 1013904223u;
+    int32_t noise = (int32_t)(noise_[channel] >> 28) - 8;
+
+    *value = 2048 + wave + noise;
+    return true;
+  }
+
+  private:
+  uint8_t count_;
+  uint32_t reads_[MAX_CHANNELS] = {};
+  uint32_t noise_[MAX_CHANNELS] = {};
+  };
+} // namespace hal::sensor
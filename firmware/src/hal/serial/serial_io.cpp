@@ -4,65 +4,182 @@
 #include <Arduino.h>
 #include <string.h>
 
+#include "line_assembler.h"
+#include "spsc_ring.h"
+
 namespace hal::serial {
+// RX ring between the UART and the line assembler. The UART FIFO is drained
+// in bulk into it so bursts larger than the hardware FIFO are not lost.
+static util::SpscRing<uint8_t, 512> s_rx;
+
 // Internal line accumulator
 // This avoids blocking while waiting for '\n'.
-static char s_line[128];
-static size_t s_len = 0;
+static util::LineAssembler<128> s_line;
+
+// TX queue between every writer (replies, logger, telemetry) and the UART.
+static util::TxQueue<1024, 32> s_tx(util::TX_DROP_NEWEST);
+
+// Blocks for messages built in place and queued in s_tx by reference.
+typedef util::MsgPool<SERIAL_MSG_BLOCK_SIZE, SERIAL_MSG_BLOCKS> msg_pool_t;
+static msg_pool_t s_pool;
+
+// Move everything the UART has buffered into the RX ring in bulk reads.
+static void rx_pump()
+{
+    uint8_t chunk[64];
+    int avail = Serial.available();
+
+    while (avail > 0)
+    {
+        size_t want = (size_t)avail < sizeof(chunk) ? (size_t)avail : sizeof(chunk);
+        size_t got = Serial.readBytes(chunk, want);
+        if (got == 0)
+            break;
+
+        s_rx.write(chunk, got); // counts overflow if the ring is full
+        avail -= (int)got;
+    }
+}
 
 bool HalSerial::serial_readline(char *out, size_t out_cap)
 {
     if (out == NULL || out_cap == 0)
         return false;
 
-    while (Serial.available() > 0)
+    rx_pump();
+
+    size_t n;
+    const uint8_t *span;
+    while ((span = s_rx.peek_span(&n)) != NULL)
     {
-        int ch = Serial.read();
-        if (ch < 0)
-            break; // No more data
-
-        char c = (char)ch;
-
-        // Ignore carriage return so both \n and \r\n line endings work
-        if (c == '\r')
-            continue;
-
-        if (c == '\n')
-        {
-            // Complete line raedy.
-            s_line[s_len] = '\0'; // Null-terminate
-
-            // Copy into caller buffer safely.
-            strncpy(out, s_line, out_cap - 1);
-            out[out_cap - 1] = '\0'; // Ensure null-termination
-
-            // Reset accumulator for next line.
-            s_len = 0;
-            return true;
-        }
-
-        // Append if space remains, else drop the line (simple overflow policy).
-        if (s_len < sizeof(s_line) - 1)
-        {
-            s_line[s_len++] = c;
-        }
-        else
-        {
-            // Overflow: reset and return false (line was too long).
-            s_len = 0;
-            return false;
-        }
+        bool complete;
+        s_rx.consume(s_line.feed(span, n, &complete));
+
+        if (!complete)
+            continue; // span exhausted without a newline; look at the next one
+
+        // Copy into caller buffer safely.
+        strncpy(out, s_line.line(), out_cap - 1);
+        out[out_cap - 1] = '\0'; // Ensure null-termination
+
+        // Reset accumulator for next line.
+        s_line.clear();
+        return true;
     }
 
     return false;
 }
 
+serial_rx_stats_t HalSerial::rx_stats()
+{
+    serial_rx_stats_t stats;
+    stats.rx_buffered = s_rx.size();
+    stats.rx_high_water = s_rx.high_water();
+    stats.rx_overflows = s_rx.overflows();
+    stats.lines_dropped = s_line.lines_dropped();
+    return stats;
+}
+
 void HalSerial::hal_serial_print(const char *str)
 {
     if (str != NULL)
     {
-        Serial.print(str);
+        s_tx.enqueue(str, strlen(str));
+    }
+}
+
+void HalSerial::hal_serial_println(const char *str)
+{
+    if (str != NULL)
+    {
+        util::tx_iov_t iov[2] = {{str, strlen(str)}, {"\r\n", 2}};
+        s_tx.enqueue(iov, 2);
+    }
+}
+
+void HalSerial::hal_serial_write(const uint8_t *data, size_t len)
+{
+    if (data != NULL && len > 0)
+    {
+        s_tx.enqueue(data, len);
+    }
+}
+
+uint8_t *HalSerial::hal_serial_alloc(size_t len)
+{
+    if (len > msg_pool_t::block_size())
+        return NULL;
+    return s_pool.alloc();
+}
+
+void HalSerial::hal_serial_send(uint8_t *block, size_t len)
+{
+    if (block != NULL)
+    {
+        s_tx.enqueue_ref(block, len, msg_pool_t::release, &s_pool);
     }
 }
 
-} // namespace hal::serial
\ No newline at end of file
+bool HalSerial::hal_serial_connected()
+{
+    return (bool)Serial;
+}
+
+size_t HalSerial::hal_serial_tx_free()
+{
+    return s_tx.free_bytes();
+}
+
+size_t HalSerial::hal_serial_flush(size_t max_bytes)
+{
+    // Only offer what fits in the UART/USB buffer so Serial.write() never blocks.
+    return s_tx.flush([](const uint8_t *data, size_t len) -> size_t
+                      {
+                          int room = Serial.availableForWrite();
+                          if (room <= 0)
+                              return 0;
+                          if (len > (size_t)room)
+                              len = (size_t)room;
+                          return Serial.write(data, len);
+                      },
+                      max_bytes);
+}
+
+bool HalSerial::hal_serial_pending()
+{
+    return !s_rx.empty() || Serial.available() > 0;
+}
+
+uint32_t HalSerial::hal_serial_tx_wait_us(size_t max_bytes)
+{
+    size_t queued = s_tx.queued_bytes();
+    if (queued == 0)
+        return 0;
+
+    // Room Serial must make before a flush can move the next max_bytes:
+    // that many bytes leave the wire first, 10 bits each (8N1).
+    size_t want = queued < max_bytes ? queued : max_bytes;
+    int room = Serial.availableForWrite();
+    if (room > 0 && (size_t)room >= want)
+        return 1;
+    size_t short_by = want - (room > 0 ? (size_t)room : 0);
+    uint64_t us = ((uint64_t)short_by * 10u * 1000000u + SERIAL_BAUD - 1) / SERIAL_BAUD;
+    return us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+
+void HalSerial::set_tx_policy(util::tx_policy_t policy)
+{
+    s_tx.set_policy(policy);
+}
+
+const util::tx_queue_stats_t &HalSerial::tx_stats()
+{
+    return s_tx.stats();
+}
+
+const util::msg_pool_stats_t &HalSerial::pool_stats()
+{
+    return s_pool.stats();
+}
+
+} // namespace hal::serial
@@ -1,25 +1,124 @@
 // serial_io.h
 #pragma once
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 
+#include "msg_pool.h"
+#include "tx_queue.h"
+
+// Outbound message blocks owned by the serial HAL (see hal_serial_alloc()).
+// A block must hold the largest frame or reply line built in place:
+// -D SERIAL_MSG_BLOCK_SIZE=160 -D SERIAL_MSG_BLOCKS=8
+#ifndef SERIAL_MSG_BLOCK_SIZE
+#define SERIAL_MSG_BLOCK_SIZE 160
+#endif
+#ifndef SERIAL_MSG_BLOCKS
+#define SERIAL_MSG_BLOCKS 8
+#endif
+
+// Line rate of the serial link; the idle path also uses it to estimate
+// how long queued output takes to drain (USB CDC drains faster; raise it
+// there to sleep less while output backs up): -D SERIAL_BAUD=115200
+#ifndef SERIAL_BAUD
+#define SERIAL_BAUD 115200
+#endif
+
 namespace hal::serial
 {
+    // RX path counters (see HalSerial::rx_stats()).
+    typedef struct
+    {
+        size_t rx_buffered;     // bytes waiting in the RX ring
+        size_t rx_high_water;   // peak RX ring occupancy
+        uint32_t rx_overflows;  // bytes dropped because the RX ring was full
+        uint32_t lines_dropped; // lines longer than the line buffer
+    } serial_rx_stats_t;
+
+    // The node's link to its host, whatever carries it: HalSerial (USB
+    // serial, below) or hal::transport::HalUdp (datagrams, udp_link.h).
     class ISerialIo
     {
     public:
         virtual ~ISerialIo() = default;
         virtual bool serial_readline(char *out, size_t out_cap) = 0;
         virtual void hal_serial_print(const char *str) = 0;
+        virtual void hal_serial_write(const uint8_t *data, size_t len) = 0; // raw bytes (binary frames)
+        virtual size_t hal_serial_flush(size_t max_bytes) = 0;               // send queued output, never blocks
+        virtual bool hal_serial_pending() = 0;                               // received bytes waiting
+
+        // Zero-copy output: hal_serial_alloc() lends a block of at least len
+        // bytes (nullptr if none is free or len is too large), the caller
+        // builds its message in place and hands the block back with
+        // hal_serial_send(), which takes ownership whatever happens to the
+        // message. Implementations without a pool return nullptr, and
+        // callers fall back to hal_serial_print()/hal_serial_write().
+        virtual uint8_t *hal_serial_alloc(size_t len)
+        {
+            (void)len;
+            return nullptr;
+        }
+        virtual void hal_serial_send(uint8_t *block, size_t len) { hal_serial_write(block, len); }
+
+        // Flow control for bulk output (spool replay): whether a host is
+        // listening, and how many bytes can be queued right now without
+        // dropping anything. Defaults suit links that are always up and
+        // never fill.
+        virtual bool hal_serial_connected() { return true; }
+        virtual size_t hal_serial_tx_free() { return SIZE_MAX; }
+
+        // Pacing for the idle path: 0 when no output is queued, otherwise
+        // the microseconds (at least 1) until the link can take max_bytes
+        // of it, or all of it if less. The default suits links that never
+        // back up.
+        virtual uint32_t hal_serial_tx_wait_us(size_t max_bytes)
+        {
+            (void)max_bytes;
+            return 0;
+        }
     };
 
     // Reads a single line from Serial into out (null-terminated).
     // Returns true only when a full line is available.
     // Non-blocking: returns false if no full line has arrived yet.
+    // Bytes are drained from the UART in bulk into an SPSC ring first, so one
+    // call can be repeated to pick up several queued lines.
+    //
+    // Output is queued, not written: hal_serial_print(), hal_serial_write()
+    // and hal_serial_println() only copy into a bounded TX queue, and
+    // hal_serial_flush() moves at most max_bytes of it to the UART, limited
+    // further to what Serial can accept without blocking.
+    //
+    // hal_serial_alloc() blocks come from a fixed pool; hal_serial_send()
+    // queues them by reference and the pool gets them back once the UART
+    // has taken the last byte, so in-place frames and replies are never
+    // copied. Pool exhaustion is counted in pool_stats().
+    //
+    // hal_serial_pending() tells the idle path whether it may sleep: it is
+    // true while received bytes are unread. Queued output does not keep the
+    // loop awake; hal_serial_tx_wait_us() estimates from SERIAL_BAUD when
+    // Serial will have room for the next flush, and the loop sleeps until
+    // then.
     class HalSerial : public ISerialIo
     {
     public:
         bool serial_readline(char *out, size_t out_cap) override;
+        serial_rx_stats_t rx_stats();
         void hal_serial_print(const char *str) override;
+        void hal_serial_write(const uint8_t *data, size_t len) override;
+        size_t hal_serial_flush(size_t max_bytes) override;
+        bool hal_serial_pending() override;
+        uint8_t *hal_serial_alloc(size_t len) override;
+        void hal_serial_send(uint8_t *block, size_t len) override;
+        bool hal_serial_connected() override; // USB CDC: host has the port open (DTR)
+        size_t hal_serial_tx_free() override;
+        uint32_t hal_serial_tx_wait_us(size_t max_bytes) override;
+
+        // Queue str followed by "\r\n" as one message (used by the logger).
+        void hal_serial_println(const char *str);
+
+        void set_tx_policy(util::tx_policy_t policy);
+        const util::tx_queue_stats_t &tx_stats();
+        const util::msg_pool_stats_t &pool_stats();
     };
 } // namespace hal::serial
\ No newline at end of file
@@ -0,0 +1,58 @@
+// cycle_counter.h
+#pragma once
+#include <stdint.h>
+
+/*
+    Cycle Counter
+
+    Responsibilities:
+    - Time short code paths (tens of cycles to milliseconds) for the
+      latency instrumentation, more finely and more cheaply than
+      hal_micros().
+
+    Backends:
+    - Device (arduino-pico): the Cortex-M33 DWT cycle counter (CYCCNT), one
+      load per reading. cycles_init() enables it (trace enable in DEMCR,
+      CYCCNTENA in DWT_CTRL).
+    - Native: std::chrono::steady_clock; one "cycle" is one nanosecond.
+
+    Invariants:
+    - cycles_now() is a free-running 32-bit counter: differences are exact
+      for intervals below 2^32 cycles (~28 s at 150 MHz), longer ones wrap.
+*/
+#if defined(ARDUINO_ARCH_RP2040)
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+namespace hal::time
+{
+#if defined(ARDUINO_ARCH_RP2040)
+    static volatile uint32_t *const k_demcr = (volatile uint32_t *)0xE000EDFCu;
+    static volatile uint32_t *const k_dwt_ctrl = (volatile uint32_t *)0xE0001000u;
+    static volatile uint32_t *const k_dwt_cyccnt = (volatile uint32_t *)0xE0001004u;
+
+    static inline void cycles_init()
+    {
+        *k_demcr |= 1u << 24; // TRCENA
+        *k_dwt_cyccnt = 0;
+        *k_dwt_ctrl |= 1u;    // CYCCNTENA
+    }
+
+    static inline uint32_t cycles_now() { return *k_dwt_cyccnt; }
+
+    static inline uint32_t cycles_per_us() { return (uint32_t)(F_CPU / 1000000u); }
+#else
+    static inline void cycles_init() {}
+
+    static inline uint32_t cycles_now()
+    {
+        return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    static inline uint32_t cycles_per_us() { return 1000u; }
+#endif
+} // namespace hal::time
@@ -2,6 +2,8 @@
 #include "hal/time/hal_time.h"
 
 #include <Arduino.h>
+#include <pico/time.h>
+#include <hardware/sync.h>
 
 namespace hal::time
 {
@@ -9,4 +11,35 @@ namespace hal::time
     {
         return (uint32_t)millis();
     }
-} // namespace hal::time
\ No newline at end of file
+
+    uint32_t HalTime::hal_micros(void)
+    {
+        return time_us_32();
+    }
+
+    /*
+     * The RP2350 timer is 64 bits wide and the SDK reads it with a
+     * high/low/high sequence, so this is safe from either core.
+     */
+    uint64_t HalTime::hal_monotonic_us(void)
+    {
+        return time_us_64();
+    }
+
+    /*
+     * Sleep in WFE until the deadline alarm fires or any event arrives.
+     * USB/UART RX interrupts and hal_wake() (SEV) end the wait early.
+     */
+    void HalTime::hal_sleep_until(uint64_t deadline_us)
+    {
+        if (deadline_us <= time_us_64())
+            return;
+
+        best_effort_wfe_or_timeout(from_us_since_boot(deadline_us));
+    }
+
+    void HalTime::hal_wake(void)
+    {
+        __sev();
+    }
+} // namespace hal::time
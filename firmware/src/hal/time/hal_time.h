@@ -4,15 +4,61 @@
 
 namespace hal::time
 {
+    // Extends a free-running 32-bit microsecond counter (wraps every ~71.6
+    // minutes) to 64 bits. Must be sampled at least once per wrap period.
+    typedef struct
+    {
+        uint32_t last_raw; // previous 32-bit reading
+        uint32_t wraps;    // completed 32-bit wraps
+    } time_wrap_t;
+
+    static inline uint64_t time_wrap_extend(time_wrap_t *w, uint32_t raw)
+    {
+        if (raw < w->last_raw)
+            w->wraps++;
+        w->last_raw = raw;
+        return ((uint64_t)w->wraps << 32) | raw;
+    }
+
+    /*
+        IHalTime Interface
+
+        Responsibilities:
+        - Provide the time base: 32-bit millis/micros counters and a 64-bit
+          monotonic microsecond clock that never wraps in practice.
+        - Let the main loop idle until its next deadline instead of spinning.
+
+        Invariants:
+        - hal_monotonic_us() never goes backwards. The default implementation
+          extends hal_micros() wraparound and needs to be called at least once
+          per ~71 minutes from a single context; backends with a native 64-bit
+          counter override it.
+        - hal_sleep_until() returns no later than deadline_us (it may return
+          immediately if the deadline has passed) and may return early when
+          an event arrives: serial RX, hal_wake() from another context, or
+          any interrupt. Callers re-check their work and sleep again.
+        - hal_wake() is safe to call from interrupts and other cores.
+    */
     class IHalTime {
         public:
         virtual ~IHalTime() = default;
         virtual uint32_t hal_millis() = 0;
+        virtual uint32_t hal_micros() = 0;
+        virtual uint64_t hal_monotonic_us() { return time_wrap_extend(&wrap_, hal_micros()); }
+        virtual void hal_sleep_until(uint64_t deadline_us) = 0;
+        virtual void hal_wake() = 0;
+
+        protected:
+        time_wrap_t wrap_ = {0, 0};
     };
 
     class HalTime : public IHalTime {
     public:
-        uint32_t hal_millis() override; // Get current time in milliseconds
+        uint32_t hal_millis() override;                      // Get current time in milliseconds
+        uint32_t hal_micros() override;                      // 32-bit hardware timer
+        uint64_t hal_monotonic_us() override;                // 64-bit hardware timer, no extension needed
+        void hal_sleep_until(uint64_t deadline_us) override; // WFE until deadline or event
+        void hal_wake() override;                            // SEV
     };
 
-} // namespace hal::time
\ No newline at end of file
+} // namespace hal::time
@@ -0,0 +1,66 @@
+// hal_time_native.h
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <time.h>
+
+#include "hal/time/hal_time.h"
+
+namespace hal::time
+{
+    /*
+        HalTimeNative Implementation
+
+        Responsibilities:
+        - Stand in for HalTime on native builds: CLOCK_MONOTONIC time base
+          (zero at construction, like time since boot) and a condition
+          variable in place of WFE/SEV.
+
+        Invariants:
+        - hal_wake() from any thread ends a pending hal_sleep_until(); a wake
+          that arrives while nobody sleeps is latched (like the WFE event
+          register) and ends the next sleep immediately.
+    */
+    class HalTimeNative : public IHalTime {
+    public:
+        HalTimeNative() : start_us_(clock_us()) {}
+
+        uint32_t hal_millis() override { return (uint32_t)(hal_monotonic_us() / 1000u); }
+        uint32_t hal_micros() override { return (uint32_t)hal_monotonic_us(); }
+        uint64_t hal_monotonic_us() override { return clock_us() - start_us_; }
+
+        void hal_sleep_until(uint64_t deadline_us) override
+        {
+            uint64_t now = hal_monotonic_us();
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (deadline_us > now && !event_)
+            {
+                cv_.wait_for(lock, std::chrono::microseconds(deadline_us - now), [this]() { return event_; });
+            }
+            event_ = false;
+        }
+
+        void hal_wake() override
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                event_ = true;
+            }
+            cv_.notify_one();
+        }
+
+    private:
+        static uint64_t clock_us()
+        {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+        }
+
+        uint64_t start_us_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool event_ = false;
+    };
+} // namespace hal::time
@@ -0,0 +1,45 @@
+// hal/timer/hal_timer.cpp
+#include "hal/timer/hal_timer.h"
+
+#include <Arduino.h>
+#include <pico/time.h>
+
+namespace hal::timer
+{
+    static repeating_timer_t s_timer;
+    static bool s_running = false;
+    static timer_callback_t s_callback = nullptr;
+    static void *s_ctx = nullptr;
+
+    static bool on_alarm(repeating_timer_t *rt)
+    {
+        (void)rt;
+        s_callback(s_ctx);
+        return true; // keep repeating
+    }
+
+    /*
+     * A negative delay makes the SDK schedule each callback relative to
+     * the previous due time rather than to when the last one finished.
+     */
+    bool HalTimerPico::hal_timer_start(uint32_t period_us, timer_callback_t callback, void *ctx)
+    {
+        if (callback == nullptr || period_us == 0 || period_us > INT32_MAX)
+            return false;
+
+        hal_timer_stop();
+        s_callback = callback;
+        s_ctx = ctx;
+        s_running = add_repeating_timer_us(-(int64_t)period_us, on_alarm, nullptr, &s_timer);
+        return s_running;
+    }
+
+    void HalTimerPico::hal_timer_stop()
+    {
+        if (s_running)
+        {
+            cancel_repeating_timer(&s_timer);
+            s_running = false;
+        }
+    }
+} // namespace hal::timer
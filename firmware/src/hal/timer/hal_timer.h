@@ -0,0 +1,53 @@
+// hal_timer.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+namespace hal::timer
+{
+    // Called from interrupt context on every period.
+    typedef void (*timer_callback_t)(void *ctx);
+
+    /*
+        IHalTimer Interface
+
+        Responsibilities:
+        - Run a callback at a fixed rate from a hardware timer, independent
+          of main loop latency (high-rate sampling, see stream::).
+
+        Invariants:
+        - One periodic callback at a time; hal_timer_start() while running
+          replaces it.
+        - Fixed rate: callback n is due at start + n * period_us, so late
+          callbacks do not push later ones back.
+        - The callback runs in interrupt context: it must not block, and
+          state it shares with the main loop must be published with
+          atomics.
+        - After hal_timer_stop() returns, the callback is not running and
+          will not run again.
+    */
+    class IHalTimer
+    {
+    public:
+        virtual ~IHalTimer() = default;
+        virtual bool hal_timer_start(uint32_t period_us, timer_callback_t callback, void *ctx) = 0;
+        virtual void hal_timer_stop() = 0;
+    };
+
+    /*
+        HalTimerPico Implementation
+
+        Responsibilities:
+        - Drive IHalTimer from the SDK's default alarm pool (a hardware
+          alarm of the 64-bit system timer, alarm IRQ on core0).
+
+        Invariants:
+        - Periods are whole microseconds (1 us .. 2^31 us).
+    */
+    class HalTimerPico : public IHalTimer
+    {
+    public:
+        bool hal_timer_start(uint32_t period_us, timer_callback_t callback, void *ctx) override;
+        void hal_timer_stop() override;
+    };
+} // namespace hal::timer
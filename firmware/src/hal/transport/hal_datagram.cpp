@@ -0,0 +1,57 @@
+// hal/transport/hal_datagram.cpp
+#include "hal/transport/hal_datagram.h"
+
+// Serial builds leave WiFi and lwIP out of the image entirely.
+#if APP_TRANSPORT == APP_TRANSPORT_UDP
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+namespace hal::transport
+{
+    // One UDP endpoint per node; the gateway address is resolved once at
+    // boot so sending never waits on DNS.
+    static WiFiUDP s_udp;
+    static IPAddress s_gateway;
+
+    bool HalUdpSocketPico::hal_udp_begin()
+    {
+        WiFi.mode(WIFI_STA);
+        if (WiFi.begin(ssid_, password_) != WL_CONNECTED)
+            return false;
+        if (!WiFi.hostByName(host_, s_gateway))
+            return false;
+        return s_udp.begin(port_) == 1;
+    }
+
+    bool HalUdpSocketPico::dgram_send(const uint8_t *data, size_t len)
+    {
+        if (data == NULL || len == 0 || !dgram_link_up())
+            return false;
+        if (s_udp.beginPacket(s_gateway, port_) != 1)
+            return false;
+        if (s_udp.write(data, len) != len)
+            return false;
+        return s_udp.endPacket() == 1;
+    }
+
+    size_t HalUdpSocketPico::dgram_recv(uint8_t *out, size_t cap)
+    {
+        if (out == NULL || cap == 0)
+            return 0;
+        // parsePacket() moves to the next datagram and drops what is left
+        // of the previous one, so an over-long datagram is cut to cap.
+        if (s_udp.parsePacket() <= 0)
+            return 0;
+        int got = s_udp.read(out, cap);
+        return got > 0 ? (size_t)got : 0;
+    }
+
+    bool HalUdpSocketPico::dgram_link_up()
+    {
+        return WiFi.status() == WL_CONNECTED;
+    }
+} // namespace hal::transport
+
+#endif // APP_TRANSPORT == APP_TRANSPORT_UDP
@@ -0,0 +1,75 @@
+// hal_datagram.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Link the app talks over; every translation unit sees the choice through
+// build_flags: -D APP_TRANSPORT=APP_TRANSPORT_UDP
+#define APP_TRANSPORT_SERIAL 0
+#define APP_TRANSPORT_UDP 1
+#ifndef APP_TRANSPORT
+#define APP_TRANSPORT APP_TRANSPORT_SERIAL
+#endif
+
+namespace hal::transport
+{
+    /*
+        IDatagramSocket Interface
+
+        Responsibilities:
+        - Exchange whole datagrams with one peer (the gateway): the socket
+          behind HalUdp (see udp_link.h).
+
+        Invariants:
+        - Never blocks. dgram_send() hands one datagram to the network stack
+          and returns false if it was refused (no buffer, link down);
+          nothing is retried.
+        - dgram_recv() returns the length of the next datagram received, or
+          0 if none is waiting; a datagram longer than cap is cut to cap.
+        - dgram_link_up() is false while the node is off the network;
+          datagrams sent then are lost.
+    */
+    class IDatagramSocket
+    {
+    public:
+        virtual ~IDatagramSocket() = default;
+        virtual bool dgram_send(const uint8_t *data, size_t len) = 0;
+        virtual size_t dgram_recv(uint8_t *out, size_t cap) = 0;
+        virtual bool dgram_link_up() { return true; }
+    };
+
+    /*
+        HalUdpSocketPico Implementation
+
+        Responsibilities:
+        - UDP over the Pico 2W's WiFi (CYW43, lwIP through arduino-pico's
+          WiFiUDP): join the network as a station, send to the gateway at
+          host:port and receive on the same local port, which is where the
+          gateway sends commands back to.
+
+        Invariants:
+        - hal_udp_begin() is called once from setup(); it waits for the
+          association (bounded by the WiFi library's timeout) and returns
+          whether the node got on the network. Later link loss shows up in
+          dgram_link_up().
+        - host is an IPv4 address in dotted form or a name to resolve.
+    */
+    class HalUdpSocketPico : public IDatagramSocket
+    {
+    public:
+        HalUdpSocketPico(const char *ssid, const char *password, const char *host, uint16_t port)
+            : ssid_(ssid), password_(password), host_(host), port_(port) {}
+
+        bool hal_udp_begin();
+        bool dgram_send(const uint8_t *data, size_t len) override;
+        size_t dgram_recv(uint8_t *out, size_t cap) override;
+        bool dgram_link_up() override;
+
+    private:
+        const char *ssid_;
+        const char *password_;
+        const char *host_;
+        uint16_t port_;
+    };
+} // namespace hal::transport
@@ -0,0 +1,85 @@
+// hal_datagram_native.h
+#pragma once
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "hal/transport/hal_datagram.h"
+
+namespace hal::transport
+{
+    /*
+        HalUdpSocketPosix Implementation
+
+        Responsibilities:
+        - Stand in for HalUdpSocketPico on native builds: a non-blocking
+          UDP socket connected to the gateway, so simulated nodes can run
+          the firmware link code against a real collector on loopback.
+
+        Invariants:
+        - ok() is false if the socket could not be created, bound or
+          connected; every operation then fails.
+        - Being connected, the socket only receives from the gateway
+          address; the local port is ephemeral unless local_port is given.
+    */
+    class HalUdpSocketPosix : public IDatagramSocket
+    {
+    public:
+        HalUdpSocketPosix(const char *host, uint16_t port, uint16_t local_port = 0)
+        {
+            fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd_ < 0)
+                return;
+
+            sockaddr_in local;
+            memset(&local, 0, sizeof(local));
+            local.sin_family = AF_INET;
+            local.sin_port = htons(local_port);
+            local.sin_addr.s_addr = htonl(INADDR_ANY);
+
+            sockaddr_in peer;
+            memset(&peer, 0, sizeof(peer));
+            peer.sin_family = AF_INET;
+            peer.sin_port = htons(port);
+            if (inet_pton(AF_INET, host, &peer.sin_addr) != 1 ||
+                bind(fd_, (const sockaddr *)&local, sizeof(local)) != 0 ||
+                connect(fd_, (const sockaddr *)&peer, sizeof(peer)) != 0)
+            {
+                close(fd_);
+                fd_ = -1;
+            }
+        }
+
+        ~HalUdpSocketPosix() override
+        {
+            if (fd_ >= 0)
+                close(fd_);
+        }
+
+        HalUdpSocketPosix(const HalUdpSocketPosix &) = delete;
+        HalUdpSocketPosix &operator=(const HalUdpSocketPosix &) = delete;
+
+        bool ok() const { return fd_ >= 0; }
+        int fd() const { return fd_; }
+
+        bool dgram_send(const uint8_t *data, size_t len) override
+        {
+            if (fd_ < 0 || data == NULL || len == 0)
+                return false;
+            return send(fd_, data, len, 0) == (ssize_t)len;
+        }
+
+        size_t dgram_recv(uint8_t *out, size_t cap) override
+        {
+            if (fd_ < 0 || out == NULL || cap == 0)
+                return 0;
+            ssize_t got = recv(fd_, out, cap, 0);
+            return got > 0 ? (size_t)got : 0;
+        }
+
+    private:
+        int fd_ = -1;
+    };
+} // namespace hal::transport
@@ -0,0 +1,155 @@
+// hal/transport/udp_link.cpp
+#include "hal/transport/udp_link.h"
+
+#include <string.h>
+
+namespace hal::transport
+{
+    static const size_t k_payload_max = UDP_DATAGRAM_SIZE - PKT_DGRAM_HEADER_SIZE;
+
+    HalUdp::HalUdp(IDatagramSocket &socket, uint16_t node) : socket_(socket), tx_len_(PKT_DGRAM_HEADER_SIZE)
+    {
+        header_.node = node;
+        header_.seq = 0;
+    }
+
+    bool HalUdp::serial_readline(char *out, size_t out_cap)
+    {
+        if (out == NULL || out_cap == 0)
+            return false;
+
+        for (;;)
+        {
+            if (rx_pos_ == rx_len_)
+            {
+                // One byte spare so a datagram without a final newline can
+                // be given one: the datagram boundary ends the line.
+                rx_len_ = socket_.dgram_recv(rx_, sizeof(rx_) - 1);
+                rx_pos_ = 0;
+                if (rx_len_ == 0)
+                    return false;
+                stats_.datagrams_received++;
+                if (rx_[rx_len_ - 1] != '\n')
+                    rx_[rx_len_++] = '\n';
+            }
+
+            bool complete;
+            rx_pos_ += line_.feed(&rx_[rx_pos_], rx_len_ - rx_pos_, &complete);
+            stats_.lines_dropped = line_.lines_dropped();
+            if (!complete)
+                continue; // the rest was an over-long line
+
+            strncpy(out, line_.line(), out_cap - 1);
+            out[out_cap - 1] = '\0';
+            line_.clear();
+            return true;
+        }
+    }
+
+    uint8_t *HalUdp::reserve(size_t len)
+    {
+        if (lent_ || len > k_payload_max)
+            return NULL;
+        if (tx_len_ + len > sizeof(tx_))
+            send_open();
+        return &tx_[tx_len_];
+    }
+
+    size_t HalUdp::send_open()
+    {
+        if (tx_len_ == PKT_DGRAM_HEADER_SIZE)
+            return 0;
+
+        pkt_dgram_header_pack(&header_, tx_, PKT_DGRAM_HEADER_SIZE);
+        bool ok = socket_.dgram_send(tx_, tx_len_);
+        if (ok)
+            stats_.datagrams_sent++;
+        else
+            stats_.send_errors++;
+        header_.seq++;
+
+        size_t sent = tx_len_;
+        tx_len_ = PKT_DGRAM_HEADER_SIZE;
+        return ok ? sent : 0;
+    }
+
+    void HalUdp::hal_serial_print(const char *str)
+    {
+        if (str != NULL)
+            hal_serial_write((const uint8_t *)str, strlen(str));
+    }
+
+    void HalUdp::hal_udp_println(const char *str)
+    {
+        if (str == NULL)
+            return;
+
+        size_t len = strlen(str);
+        uint8_t *p = reserve(len + 2);
+        if (p == NULL)
+        {
+            stats_.messages_dropped++;
+            return;
+        }
+        memcpy(p, str, len);
+        memcpy(p + len, "\r\n", 2);
+        tx_len_ += len + 2;
+    }
+
+    void HalUdp::hal_serial_write(const uint8_t *data, size_t len)
+    {
+        if (data == NULL || len == 0)
+            return;
+
+        uint8_t *p = reserve(len);
+        if (p == NULL)
+        {
+            stats_.messages_dropped++;
+            return;
+        }
+        memcpy(p, data, len);
+        tx_len_ += len;
+    }
+
+    uint8_t *HalUdp::hal_serial_alloc(size_t len)
+    {
+        uint8_t *p = reserve(len);
+        if (p != NULL)
+            lent_ = true;
+        return p;
+    }
+
+    void HalUdp::hal_serial_send(uint8_t *block, size_t len)
+    {
+        // Only the block lent last can come back; it is already in place.
+        if (!lent_ || block != &tx_[tx_len_])
+            return;
+        lent_ = false;
+        if (len <= sizeof(tx_) - tx_len_)
+            tx_len_ += len;
+    }
+
+    size_t HalUdp::hal_serial_flush(size_t max_bytes)
+    {
+        (void)max_bytes; // a datagram cannot be sent in parts
+        if (lent_)
+            return 0;
+        return send_open();
+    }
+
+    bool HalUdp::hal_serial_pending()
+    {
+        return rx_pos_ < rx_len_;
+    }
+
+    uint32_t HalUdp::hal_serial_tx_wait_us(size_t max_bytes)
+    {
+        (void)max_bytes;
+        return tx_len_ > PKT_DGRAM_HEADER_SIZE ? 1u : 0u; // the next flush sends it at once
+    }
+
+    size_t HalUdp::hal_serial_tx_free()
+    {
+        return lent_ ? 0 : k_payload_max;
+    }
+} // namespace hal::transport
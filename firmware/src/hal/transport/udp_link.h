@@ -0,0 +1,100 @@
+// udp_link.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hal/serial/serial_io.h"
+#include "hal/transport/hal_datagram.h"
+#include "line_assembler.h"
+#include "packet.h"
+
+// Largest datagram sent or received, header included. Below the usual
+// 1472-byte UDP payload of a 1500-byte MTU so nothing is fragmented:
+// -D UDP_DATAGRAM_SIZE=512
+#ifndef UDP_DATAGRAM_SIZE
+#define UDP_DATAGRAM_SIZE 512
+#endif
+
+namespace hal::transport
+{
+    // HalUdp counters (see HalUdp::stats()).
+    typedef struct
+    {
+        uint32_t datagrams_sent;
+        uint32_t datagrams_received;
+        uint32_t send_errors;      // datagrams the socket refused; their seq is used up
+        uint32_t messages_dropped; // messages larger than one datagram
+        uint32_t lines_dropped;    // inbound lines longer than the line buffer
+    } udp_link_stats_t;
+
+    /*
+        HalUdp Implementation
+
+        Responsibilities:
+        - Carry the node's link (ISerialIo: command lines in, replies and
+          frames out) over UDP datagrams instead of the UART, so the app,
+          its spool and its reply batching work unchanged on WiFi.
+        - Pack outbound messages into one open datagram behind a
+          PKT_DGRAM_HEADER_SIZE header (node id and a per-datagram seq, see
+          packet.h); hal_serial_flush() sends it, and a message that does
+          not fit sends it first. One flush per loop pass therefore sends
+          one datagram with everything that pass produced.
+        - Split each inbound datagram into command lines; the end of a
+          datagram also ends a line.
+
+        Invariants:
+        - A message is never split across datagrams, so a collector can
+          parse every datagram on its own. Messages longer than
+          UDP_DATAGRAM_SIZE - PKT_DGRAM_HEADER_SIZE are dropped and counted.
+        - hal_serial_alloc() lends the tail of the open datagram, so frames
+          and replies are built in place. One block is lent at a time;
+          until it is sent, other output is dropped and counted.
+        - A message that fits a datagram is always taken (it may send the
+          open one first), so hal_serial_tx_free() is a datagram's payload
+          size; bulk output is paced by the app's own budgets.
+        - Datagram seq starts at 0 and counts every datagram handed to the
+          socket, sent or refused.
+        - No heap use, no blocking.
+    */
+    class HalUdp : public hal::serial::ISerialIo
+    {
+    public:
+        HalUdp(IDatagramSocket &socket, uint16_t node);
+
+        bool serial_readline(char *out, size_t out_cap) override;
+        void hal_serial_print(const char *str) override;
+        void hal_serial_write(const uint8_t *data, size_t len) override;
+        size_t hal_serial_flush(size_t max_bytes) override; // sends the open datagram; max_bytes is not a limit
+        bool hal_serial_pending() override;
+        uint8_t *hal_serial_alloc(size_t len) override;
+        void hal_serial_send(uint8_t *block, size_t len) override;
+        bool hal_serial_connected() override { return socket_.dgram_link_up(); }
+        size_t hal_serial_tx_free() override;
+        uint32_t hal_serial_tx_wait_us(size_t max_bytes) override;
+
+        // Queue str followed by "\r\n" as one message (used by the logger).
+        void hal_udp_println(const char *str);
+
+        const udp_link_stats_t &stats() const { return stats_; }
+        uint16_t node() const { return header_.node; }
+        uint32_t next_seq() const { return header_.seq; }
+
+    private:
+        uint8_t *reserve(size_t len); // room for len bytes, sending the open datagram if needed
+        size_t send_open();
+
+        IDatagramSocket &socket_;
+        pkt_dgram_t header_;
+        uint8_t tx_[UDP_DATAGRAM_SIZE];
+        size_t tx_len_;
+        bool lent_ = false;
+
+        uint8_t rx_[UDP_DATAGRAM_SIZE];
+        size_t rx_len_ = 0;
+        size_t rx_pos_ = 0;
+        util::LineAssembler<128> line_;
+
+        udp_link_stats_t stats_ = {};
+    };
+} // namespace hal::transport
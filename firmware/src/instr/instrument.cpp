@@ -0,0 +1,54 @@
+// instrument.cpp
+#include "instr/instrument.h"
+
+namespace instr
+{
+    void instr_reset(instr_t *in, uint64_t now_us)
+    {
+        for (unsigned i = 0; i < INSTR_PATHS; i++)
+            in->path[i].reset();
+        in->jitter_us.reset();
+        in->since_us = now_us;
+        in->ticks = 0;
+        in->max_stall_us = 0;
+        in->last_tick_us = 0;
+        in->slept_us = 0;
+        in->last_telemetry_us = 0;
+        in->telemetry_period_us = 0;
+    }
+
+    void instr_tick(instr_t *in, uint64_t now_us)
+    {
+        in->ticks++;
+
+        // Time since the previous tick that was not spent asleep: commands,
+        // the tick itself, TX draining.
+        if (in->last_tick_us != 0 && now_us > in->last_tick_us)
+        {
+            uint64_t gap = now_us - in->last_tick_us;
+            uint64_t busy = gap > in->slept_us ? gap - in->slept_us : 0;
+            uint32_t busy32 = busy > UINT32_MAX ? UINT32_MAX : (uint32_t)busy;
+            in->max_stall_us = busy32 > in->max_stall_us ? busy32 : in->max_stall_us;
+        }
+        in->last_tick_us = now_us;
+        in->slept_us = 0;
+    }
+
+    void instr_slept(instr_t *in, uint64_t slept_us)
+    {
+        in->slept_us += slept_us;
+    }
+
+    void instr_telemetry(instr_t *in, uint64_t now_us, uint32_t period_us)
+    {
+        // The first emission after a reset or a RATE change has no interval.
+        if (in->last_telemetry_us != 0 && in->telemetry_period_us == period_us && now_us > in->last_telemetry_us)
+        {
+            uint64_t interval = now_us - in->last_telemetry_us;
+            uint64_t off = interval > period_us ? interval - period_us : period_us - interval;
+            in->jitter_us.record(off > UINT32_MAX ? UINT32_MAX : (uint32_t)off);
+        }
+        in->last_telemetry_us = now_us;
+        in->telemetry_period_us = period_us;
+    }
+} // namespace instr
@@ -0,0 +1,91 @@
+// instrument.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hal/time/cycle_counter.h"
+#include "log_histogram.h"
+
+/*
+    Hot-Path Instrumentation
+
+    Responsibilities:
+    - Time the main loop's hot paths (app_tick(), app_handle_command(),
+      serial_readline()) with the cycle counter into log-scale histograms.
+    - Track how far telemetry emission jitters from its period, the loop
+      rate, and the longest stall (loop pass busy without sleeping).
+    - Back the STATS / STATS RESET command.
+
+    Cost:
+    - A timed path costs two cycle counter reads and one histogram record
+      (a clz, a shift and a few adds); nothing allocates or blocks.
+    - With -D APP_INSTRUMENT=0 the INSTR_* macros expand to nothing, app_t
+      carries no instr_t and STATS is not registered.
+
+    Invariants:
+    - Path histograms are in cycles (nanoseconds natively); jitter and stall
+      are in microseconds on the monotonic clock.
+    - Single context: everything here runs on the main loop (core0).
+*/
+
+// Latency instrumentation on/off: -D APP_INSTRUMENT=0
+#ifndef APP_INSTRUMENT
+#define APP_INSTRUMENT 1
+#endif
+
+namespace instr
+{
+    typedef enum
+    {
+        INSTR_TICK = 0,
+        INSTR_COMMAND,
+        INSTR_READLINE,
+        INSTR_PATHS
+    } instr_path_t;
+
+    typedef struct
+    {
+        util::LogHistogram path[INSTR_PATHS]; // cycles per call
+        util::LogHistogram jitter_us;         // |telemetry interval - period|
+
+        uint64_t since_us;          // last reset
+        uint32_t ticks;             // app_tick() calls since reset
+        uint32_t max_stall_us;      // longest loop pass, sleep excluded
+        uint64_t last_tick_us;      // 0 = no tick since reset
+        uint64_t slept_us;          // asleep since the last tick
+        uint64_t last_telemetry_us; // 0 = none since reset or period change
+        uint32_t telemetry_period_us;
+    } instr_t;
+
+    void instr_reset(instr_t *in, uint64_t now_us);
+
+    // Loop bookkeeping: every app_tick(), every app_idle() sleep, every
+    // periodic telemetry emission.
+    void instr_tick(instr_t *in, uint64_t now_us);
+    void instr_slept(instr_t *in, uint64_t slept_us);
+    void instr_telemetry(instr_t *in, uint64_t now_us, uint32_t period_us);
+
+    static inline uint32_t instr_cycles_to_ns(uint32_t cycles)
+    {
+        return (uint32_t)((uint64_t)cycles * 1000u / hal::time::cycles_per_us());
+    }
+} // namespace instr
+
+#if APP_INSTRUMENT
+#define INSTR_START(var) const uint32_t var = hal::time::cycles_now()
+#define INSTR_STOP(in, which, var) (in)->path[which].record(hal::time::cycles_now() - (var))
+#define INSTR_CALL(call) call
+#else
+#define INSTR_START(var) \
+    do                   \
+    {                    \
+    } while (0)
+#define INSTR_STOP(in, which, var) \
+    do                             \
+    {                              \
+    } while (0)
+#define INSTR_CALL(call) \
+    do                   \
+    {                    \
+    } while (0)
+#endif
@@ -1,10 +1,24 @@
 // main.cpp
 #include <Arduino.h>
+#include <atomic>
 #include "app.h"
 #include "hal/led/hal_led.h"
 #include "hal/time/hal_time.h"
 #include "hal/serial/serial_io.h"
 #include "hal/logging/serial_logger.h"
+#include "hal/logging/udp_logger.h"
+#include "hal/transport/hal_datagram.h"
+#include "hal/transport/udp_link.h"
+#include "hal/sensor/hal_sensor.h"
+#include "sensors/sensor_registry.h"
+#include "acq/acquisition.h"
+#include "hal/flash/hal_flash.h"
+#include "spool/flash_spool.h"
+#include <hardware/flash.h>
+#include "hal/time/cycle_counter.h"
+#include "instr/instrument.h"
+#include "hal/timer/hal_timer.h"
+#include "stream/stream.h"
 
 /*
     Main application entry point for the embedded telemetry node.
@@ -18,9 +32,86 @@
     - setup() is called once at boot.
     - loop() is called repeatedly thereafter.
     - All operations must be non-blocking to maintain responsiveness.
+    - The only wait is app_idle() at the end of loop(), which sleeps until
+      the next deadline and is cut short by serial RX.
+    - Telemetry produced while no host has the port open goes to a flash
+      spool (single-core mode) and comes back with REPLAY.
+
+    Transport (-D APP_TRANSPORT=...):
+    - APP_TRANSPORT_SERIAL (default): commands and output on USB serial.
+    - APP_TRANSPORT_UDP: the same traffic in UDP datagrams over WiFi to a
+      gateway (host/gateway), for many nodes into one collector. "No host"
+      then means off the network, and the spool covers that instead.
+
+    Dual-core mode (-D APP_DUAL_CORE=1):
+    - core0 (setup/loop): commands, LED heartbeat, serial TX.
+    - core1 (setup1/loop1): sensor sampling and telemetry framing (acq::),
+      handing finished records to core0 through a lock-free queue.
 */
 
+// -D APP_DUAL_CORE=1 moves acquisition and framing to core1.
+#ifndef APP_DUAL_CORE
+#define APP_DUAL_CORE 0
+#endif
+
+#if APP_TRANSPORT == APP_TRANSPORT_UDP // hal_datagram.h
+// A reply batch goes out as one write, and HalUdp never splits a message.
+static_assert(APP_REPLY_BATCH_BYTES <= UDP_DATAGRAM_SIZE - PKT_DGRAM_HEADER_SIZE,
+              "a reply batch must fit one datagram");
+
+// Network and gateway for the UDP transport; NODE_ID tells nodes apart at
+// the gateway: -D WIFI_SSID=\"lab\" -D WIFI_PASSWORD=\"...\"
+// -D GATEWAY_HOST=\"192.168.1.10\" -D GATEWAY_PORT=47000 -D NODE_ID=1
+#ifndef WIFI_SSID
+#define WIFI_SSID ""
+#endif
+#ifndef WIFI_PASSWORD
+#define WIFI_PASSWORD ""
+#endif
+#ifndef GATEWAY_HOST
+#define GATEWAY_HOST "192.168.1.10"
+#endif
+#ifndef GATEWAY_PORT
+#define GATEWAY_PORT 47000
+#endif
+#ifndef NODE_ID
+#define NODE_ID 1
+#endif
+#endif
+
 static app::app_t g_app; // Global app state
+static sensors::sensor_registry_t g_sensors; // Sample rings for all channels
+#if APP_DUAL_CORE
+static acq::acq_t g_acq;                   // core1 state and the queues between cores
+static std::atomic<bool> g_core0_ready{false}; // set once g_acq is initialized
+#endif
+
+// Telemetry spool: the SPOOL_FLASH_SIZE bytes of flash just below the
+// filesystem/EEPROM area at the end of the chip; 0 disables it:
+// -D SPOOL_FLASH_SIZE=262144
+#ifndef SPOOL_FLASH_SIZE
+#define SPOOL_FLASH_SIZE (256u * 1024u)
+#endif
+
+extern "C" uint8_t _FS_start;          // arduino-pico linker script: filesystem start
+extern "C" uint8_t __flash_binary_end; // end of the firmware image
+
+#if !APP_DUAL_CORE
+static spool::spool_t g_spool;
+static stream::stream_t g_stream; // STREAM: timer-driven sampling of one channel
+#endif
+
+// ADC inputs sampled by default (GPIO26..28 = ADC0..2).
+static const uint8_t ADC_PINS[] = {26, 27, 28};
+static const uint32_t ADC_PERIOD_MS = 100;
+static const uint32_t TEMP_PERIOD_MS = 1000;
+
+// Upper bound on command lines handled per loop() pass, so a burst of host
+// traffic cannot starve app_tick(). Pipelined hosts keep several commands
+// in flight; their replies leave together: -D CMD_LINES_PER_LOOP=8
+#ifndef CMD_LINES_PER_LOOP
+#define CMD_LINES_PER_LOOP 8
+#endif
 
 /*
     Arduino setup function
@@ -29,35 +120,120 @@ static app::app_t g_app; // Global app state
 */
 void setup()
 {
-    Serial.begin(115200);                   // Initialize serial communication
+    Serial.begin(SERIAL_BAUD);              // Initialize serial communication
 
     static hal::led::HalLedPico hLed;
     static hal::time::HalTime hTime;
-    static hal::serial::HalSerial hSerial;
-    static hal::logging::HalSerialLogger hLogger;
+#if APP_TRANSPORT == APP_TRANSPORT_UDP
+    static hal::transport::HalUdpSocketPico hSocket(WIFI_SSID, WIFI_PASSWORD, GATEWAY_HOST, GATEWAY_PORT);
+    static hal::transport::HalUdp hLink(hSocket, NODE_ID);
+    static hal::logging::HalUdpLogger hLogger(hLink); // logs into the open datagram
+    hSocket.hal_udp_begin(); // off the network: the spool keeps telemetry
+#else
+    static hal::serial::HalSerial hLink;
+    static hal::logging::HalSerialLogger hLogger(hLink); // logs via the TX queue
+#endif
+    static hal::sensor::HalSensorAdc hAdc(ADC_PINS, sizeof(ADC_PINS));
+    static hal::sensor::HalSensorTemp hTemp;
 
     hLed.hal_led_init();               // Initialize LED hardware
-    uint32_t now = hTime.hal_millis(); // Get current time
-    app::app_init(&g_app, now, &hLed, &hTime, &hSerial, &hLogger);  // Init app state
+    INSTR_CALL(hal::time::cycles_init()); // DWT cycle counter for STATS
+    uint64_t now_us = hTime.hal_monotonic_us(); // Get current time
+    uint32_t now = (uint32_t)(now_us / 1000u);  // sensor registry runs in ms
+    app::app_init(&g_app, now_us, &hLed, &hTime, &hLink, &hLogger);  // Init app state
+
+    // Sensor channels: on-chip temperature first, then the ADC inputs.
+    hAdc.hal_sensor_init();
+    hTemp.hal_sensor_init();
+    sensors::sensor_registry_init(&g_sensors);
+    sensors::sensor_registry_add(&g_sensors, &hTemp, 0, TEMP_PERIOD_MS, now);
+    for (uint8_t i = 0; i < sizeof(ADC_PINS); i++)
+    {
+        sensors::sensor_registry_add(&g_sensors, &hAdc, i, ADC_PERIOD_MS, now);
+    }
+#if APP_DUAL_CORE
+    app::app_offload_acquisition(&g_app, &g_acq.config);
+    acq::acq_init(&g_acq, now_us, &hTime, &g_sensors);
+    g_core0_ready.store(true, std::memory_order_release);
+#else
+    app::app_attach_sensors(&g_app, &g_sensors);
+
+    static hal::timer::HalTimerPico hTimer;
+    stream::stream_init(&g_stream, &hTimer, &hTime);
+    app::app_attach_stream(&g_app, &g_stream);
+
+    // Spool only if the region clears the firmware image.
+    const uint32_t spool_end = (uint32_t)((uintptr_t)&_FS_start - XIP_BASE);
+    const uint32_t image_end = (uint32_t)((uintptr_t)&__flash_binary_end - XIP_BASE);
+    if (SPOOL_FLASH_SIZE > 0 && spool_end >= SPOOL_FLASH_SIZE && spool_end - SPOOL_FLASH_SIZE >= image_end)
+    {
+        static hal::flash::HalFlashPico hFlash(spool_end - SPOOL_FLASH_SIZE, SPOOL_FLASH_SIZE, false);
+        if (spool::spool_mount(&g_spool, &hFlash))
+            app::app_attach_spool(&g_app, &g_spool);
+    }
+#endif
+#if APP_TRANSPORT == APP_TRANSPORT_UDP
+    hLogger.log("BOOT OK"); // leaves with the first datagram
+#else
     Serial.println("BOOT OK");
+#endif
 }
 
 /*
         Arduino loop function
-        - Reads serial commands and passes them to the app handler.
+        - Reads queued serial commands and passes them to the app handler.
     - Calls app_tick() to run periodic tasks.
+    - Calls app_idle() to sleep until something is due.
 */
 void loop()
 {
-    uint32_t now = g_app.time->hal_millis(); // Current time
+    uint64_t now = g_app.time->hal_monotonic_us(); // Current time
 
-    // Read one line if available (non-blocking).
+    // Read queued lines (non-blocking), up to the per-pass budget; their
+    // replies go out as one write.
     char line[96]; // Buff for incoming command
-    if (g_app.serial->serial_readline(line, sizeof(line)))
+    app::app_begin_batch(&g_app);
+    for (int i = 0; i < CMD_LINES_PER_LOOP; i++)
     {
+        INSTR_START(t_read);
+        bool got = g_app.serial->serial_readline(line, sizeof(line));
+        INSTR_STOP(&g_app.instr, instr::INSTR_READLINE, t_read);
+        if (!got)
+            break;
         app::app_handle_command(&g_app, line); // handle command
     }
+    app::app_end_batch(&g_app);
 
     // Run periodic tasks.
     app::app_tick(&g_app, now);
+
+#if APP_DUAL_CORE
+    // Forward telemetry framed on core1; stay awake while more is queued.
+    acq::acq_drain(&g_acq, g_app.serial, g_app.logger, CMD_LINES_PER_LOOP);
+    if (acq::acq_pending(&g_acq))
+        return;
+#endif
+
+    // Nothing due and no serial traffic: sleep (WFE) until the next deadline.
+    app::app_idle(&g_app, g_app.time->hal_monotonic_us());
+}
+
+#if APP_DUAL_CORE
+/*
+        core1 entry points (arduino-pico)
+        - Wait for core0 to finish setup(), then sample and frame telemetry.
+*/
+void setup1()
+{
+    while (!g_core0_ready.load(std::memory_order_acquire))
+    {
+    }
+}
+
+void loop1()
+{
+    uint64_t now = g_acq.time->hal_monotonic_us();
+    acq::acq_tick(&g_acq, now);
+    acq::acq_idle(&g_acq, g_acq.time->hal_monotonic_us());
 }
+#endif
@@ -0,0 +1,178 @@
+// scheduler.cpp
+#include "sched/scheduler.h"
+
+#include <string.h>
+
+namespace sched
+{
+    static bool heap_less(const scheduler_t *s, uint16_t i, uint16_t j)
+    {
+        return s->tasks[s->heap[i]].deadline_us < s->tasks[s->heap[j]].deadline_us;
+    }
+
+    static void heap_swap(scheduler_t *s, uint16_t i, uint16_t j)
+    {
+        uint16_t a = s->heap[i];
+        uint16_t b = s->heap[j];
+        s->heap[i] = b;
+        s->heap[j] = a;
+        s->heap_pos[b] = i;
+        s->heap_pos[a] = j;
+    }
+
+    static void sift_up(scheduler_t *s, uint16_t i)
+    {
+        while (i > 0)
+        {
+            uint16_t parent = (uint16_t)((i - 1) / 2);
+            if (!heap_less(s, i, parent))
+                break;
+            heap_swap(s, i, parent);
+            i = parent;
+        }
+    }
+
+    static void sift_down(scheduler_t *s, uint16_t i)
+    {
+        for (;;)
+        {
+            uint16_t l = (uint16_t)(2 * i + 1);
+            uint16_t r = (uint16_t)(l + 1);
+            uint16_t min = i;
+            if (l < s->heap_len && heap_less(s, l, min))
+                min = l;
+            if (r < s->heap_len && heap_less(s, r, min))
+                min = r;
+            if (min == i)
+                break;
+            heap_swap(s, i, min);
+            i = min;
+        }
+    }
+
+    static void heap_remove(scheduler_t *s, uint16_t pos)
+    {
+        uint16_t last = (uint16_t)(s->heap_len - 1);
+        if (pos != last)
+        {
+            heap_swap(s, pos, last);
+            s->heap_len--;
+            sift_down(s, pos);
+            sift_up(s, pos);
+        }
+        else
+        {
+            s->heap_len--;
+        }
+    }
+
+    void sched_init(scheduler_t *s)
+    {
+        memset(s, 0, sizeof(*s));
+    }
+
+    int sched_add(scheduler_t *s, uint64_t first_deadline_us, uint32_t period_us, sched_fn_t fn, void *ctx)
+    {
+        if (s == NULL || fn == NULL)
+            return -1;
+
+        for (uint16_t id = 0; id < SCHED_MAX_TASKS; id++)
+        {
+            sched_task_t *t = &s->tasks[id];
+            if (t->active)
+                continue;
+
+            t->deadline_us = first_deadline_us;
+            t->period_us = period_us;
+            t->fn = fn;
+            t->ctx = ctx;
+            t->runs = 0;
+            t->skipped = 0;
+            t->active = true;
+
+            uint16_t pos = s->heap_len++;
+            s->heap[pos] = id;
+            s->heap_pos[id] = pos;
+            sift_up(s, pos);
+            return id;
+        }
+
+        return -1;
+    }
+
+    bool sched_set_period(scheduler_t *s, int id, uint32_t period_us, uint64_t now_us)
+    {
+        if (s == NULL || id < 0 || id >= SCHED_MAX_TASKS || !s->tasks[id].active)
+            return false;
+
+        sched_task_t *t = &s->tasks[id];
+        t->period_us = period_us;
+        t->deadline_us = now_us + period_us;
+
+        uint16_t pos = s->heap_pos[id];
+        sift_down(s, pos);
+        sift_up(s, pos);
+        return true;
+    }
+
+    bool sched_cancel(scheduler_t *s, int id)
+    {
+        if (s == NULL || id < 0 || id >= SCHED_MAX_TASKS || !s->tasks[id].active)
+            return false;
+
+        s->tasks[id].active = false;
+        heap_remove(s, s->heap_pos[id]);
+        return true;
+    }
+
+    uint32_t sched_run(scheduler_t *s, uint64_t now_us)
+    {
+        if (s == NULL)
+            return 0;
+
+        uint32_t ran = 0;
+
+        // Bounded by the number of tasks: each runs at most once per call.
+        for (uint16_t n = s->heap_len; n > 0 && s->heap_len > 0; n--)
+        {
+            uint16_t id = s->heap[0];
+            sched_task_t *t = &s->tasks[id];
+            if (now_us < t->deadline_us)
+                break;
+
+            if (t->period_us == 0)
+            {
+                // One-shot: retire before calling so fn may re-add itself.
+                t->active = false;
+                heap_remove(s, 0);
+            }
+            else
+            {
+                // Next deadline on the original phase, skipping whole missed periods.
+                // The division only runs when a whole period was missed.
+                uint64_t late = now_us - t->deadline_us;
+                uint32_t missed = late < t->period_us ? 0 : (uint32_t)(late / t->period_us);
+                t->skipped += missed;
+                t->deadline_us += (uint64_t)(missed + 1) * t->period_us;
+                sift_down(s, 0);
+            }
+
+            t->runs++;
+            t->fn(t->ctx, now_us);
+            ran++;
+        }
+
+        return ran;
+    }
+
+    bool sched_next_deadline(const scheduler_t *s, uint64_t *deadline_us)
+    {
+        if (s == NULL || s->heap_len == 0)
+            return false;
+
+        if (deadline_us)
+            *deadline_us = s->tasks[s->heap[0]].deadline_us;
+        return true;
+    }
+
+} // namespace sched
@@ -0,0 +1,77 @@
+// scheduler.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+    Deadline Scheduler
+
+    Responsibilities:
+    - Run periodic jobs (heartbeat, telemetry, ...) when their deadline is
+      reached, replacing hand-written last_*_ms checks.
+    - Keep periods drift-free: each deadline is the previous deadline plus
+      the period, never "now" plus the period, so late loop passes do not
+      shift the phase.
+    - Answer next_deadline() so the main loop knows how long it may idle.
+
+    Implementation:
+    - Binary min-heap of task indices keyed by deadline: O(log n) insert,
+      cancel, reschedule and expire, O(1) next_deadline().
+    - Task storage is stable (task id = slot index); heap_pos[] maps a task
+      back to its heap slot for O(log n) updates.
+
+    Invariants:
+    - No heap allocation; capacity is SCHED_MAX_TASKS.
+    - Time is the 64-bit monotonic microsecond clock (IHalTime::
+      hal_monotonic_us()), which does not wrap in practice, so deadlines
+      compare as plain integers. Periods are 32-bit (up to ~71 minutes).
+    - A task that fell more than one period behind runs once and skips the
+      missed deadlines (counted in skipped) instead of bursting.
+*/
+
+// Build-time capacity:
+// -D SCHED_MAX_TASKS=16
+#ifndef SCHED_MAX_TASKS
+#define SCHED_MAX_TASKS 16
+#endif
+
+namespace sched
+{
+    typedef void (*sched_fn_t)(void *ctx, uint64_t now_us);
+
+    typedef struct
+    {
+        uint64_t deadline_us; // next time the task is due
+        uint32_t period_us;   // 0 = one-shot
+        sched_fn_t fn;
+        void *ctx;
+        uint32_t runs;        // times fn was called
+        uint32_t skipped;     // deadlines dropped because the task ran late
+        bool active;
+    } sched_task_t;
+
+    typedef struct
+    {
+        sched_task_t tasks[SCHED_MAX_TASKS];
+        uint16_t heap[SCHED_MAX_TASKS];     // task ids, min-heap on deadline
+        uint16_t heap_pos[SCHED_MAX_TASKS]; // task id -> index in heap
+        uint16_t heap_len;
+    } scheduler_t;
+
+    void sched_init(scheduler_t *s);
+
+    // Add a task first due at first_deadline_us. Returns its id or -1 if full.
+    int sched_add(scheduler_t *s, uint64_t first_deadline_us, uint32_t period_us, sched_fn_t fn, void *ctx);
+
+    // Change a task's period; the new phase starts at now_us + period_us.
+    bool sched_set_period(scheduler_t *s, int id, uint32_t period_us, uint64_t now_us);
+
+    bool sched_cancel(scheduler_t *s, int id);
+
+    // Run every task whose deadline has been reached. Returns the number of runs.
+    uint32_t sched_run(scheduler_t *s, uint64_t now_us);
+
+    // Earliest pending deadline; false if no task is scheduled.
+    bool sched_next_deadline(const scheduler_t *s, uint64_t *deadline_us);
+
+} // namespace sched
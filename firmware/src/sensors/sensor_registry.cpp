@@ -0,0 +1,156 @@
+// sensor_registry.cpp
+#include "sensors/sensor_registry.h"
+
+#include <string.h>
+
+namespace sensors
+{
+    static const uint32_t RING_MASK = SENSOR_RING_DEPTH - 1;
+
+    void sensor_registry_init(sensor_registry_t *reg)
+    {
+        memset(reg, 0, sizeof(*reg));
+    }
+
+    int sensor_registry_add(sensor_registry_t *reg, hal::sensor::ISensor *source, uint8_t source_channel,
+                            uint32_t period_ms, uint32_t now_ms)
+    {
+        if (reg == NULL || source == NULL || period_ms == 0)
+            return -1;
+        if (reg->channel_count >= SENSOR_MAX_CHANNELS)
+            return -1;
+        if (source_channel >= source->hal_sensor_channel_count())
+            return -1;
+
+        uint8_t ch = reg->channel_count++;
+        reg->source[ch] = source;
+        reg->source_channel[ch] = source_channel;
+        reg->period_ms[ch] = period_ms;
+        reg->next_due_ms[ch] = now_ms + period_ms;
+        reg->read_errors[ch] = 0;
+        reg->missed[ch] = 0;
+        reg->ring[ch].count = 0;
+        return ch;
+    }
+
+    bool sensor_registry_set_period(sensor_registry_t *reg, uint8_t channel, uint32_t period_ms, uint32_t now_ms)
+    {
+        if (reg == NULL || channel >= reg->channel_count || period_ms == 0)
+            return false;
+
+        reg->period_ms[channel] = period_ms;
+        reg->next_due_ms[channel] = now_ms + period_ms;
+        return true;
+    }
+
+    static void sample_channel(sensor_registry_t *reg, uint8_t ch, uint32_t now_ms)
+    {
+        int32_t value;
+        if (!reg->source[ch]->hal_sensor_read(reg->source_channel[ch], &value))
+        {
+            reg->read_errors[ch]++;
+            return;
+        }
+
+        sample_ring_t *ring = &reg->ring[ch];
+        uint32_t idx = ring->count & RING_MASK;
+        ring->timestamp_ms[idx] = now_ms;
+        ring->value[idx] = value;
+        ring->count++;
+    }
+
+    uint32_t sensor_registry_poll(sensor_registry_t *reg, uint32_t now_ms)
+    {
+        if (reg == NULL)
+            return 0;
+
+        uint32_t taken = 0;
+        const uint8_t n = reg->channel_count;
+
+        for (uint8_t ch = 0; ch < n; ch++)
+        {
+            // Wrap-safe "deadline reached" test.
+            if ((int32_t)(now_ms - reg->next_due_ms[ch]) < 0)
+                continue;
+
+            sample_channel(reg, ch, now_ms);
+            taken++;
+
+            // Advance on the original phase; skip (and count) deadlines that
+            // were missed entirely instead of bursting to catch up.
+            uint32_t period = reg->period_ms[ch];
+            uint32_t late = now_ms - reg->next_due_ms[ch];
+            uint32_t skipped = late / period;
+            reg->missed[ch] += skipped;
+            reg->next_due_ms[ch] += (skipped + 1) * period;
+        }
+
+        return taken;
+    }
+
+    bool sensor_registry_next_due(const sensor_registry_t *reg, uint32_t *due_ms)
+    {
+        if (reg == NULL || reg->channel_count == 0 || due_ms == NULL)
+            return false;
+
+        uint32_t earliest = reg->next_due_ms[0];
+        for (uint8_t ch = 1; ch < reg->channel_count; ch++)
+        {
+            if ((int32_t)(reg->next_due_ms[ch] - earliest) < 0)
+                earliest = reg->next_due_ms[ch];
+        }
+
+        *due_ms = earliest;
+        return true;
+    }
+
+    bool sensor_registry_next_due_us(const sensor_registry_t *reg, uint64_t now_us, uint64_t *due_us)
+    {
+        uint32_t due_ms;
+        if (due_us == NULL || !sensor_registry_next_due(reg, &due_ms))
+            return false;
+
+        uint64_t now_ms = now_us / 1000u;
+        int32_t ahead = (int32_t)(due_ms - (uint32_t)now_ms);
+        *due_us = ahead > 0 ? (now_ms + (uint32_t)ahead) * 1000u : now_us;
+        return true;
+    }
+
+    bool sensor_registry_latest(const sensor_registry_t *reg, uint8_t channel, sample_t *out)
+    {
+        if (reg == NULL || out == NULL || channel >= reg->channel_count)
+            return false;
+
+        const sample_ring_t *ring = &reg->ring[channel];
+        if (ring->count == 0)
+            return false;
+
+        uint32_t idx = (ring->count - 1) & RING_MASK;
+        out->timestamp_ms = ring->timestamp_ms[idx];
+        out->value = ring->value[idx];
+        return true;
+    }
+
+    size_t sensor_registry_recent(const sensor_registry_t *reg, uint8_t channel,
+                                  uint32_t *timestamps_ms, int32_t *values, size_t max)
+    {
+        if (reg == NULL || channel >= reg->channel_count)
+            return 0;
+
+        const sample_ring_t *ring = &reg->ring[channel];
+        size_t avail = ring->count < SENSOR_RING_DEPTH ? ring->count : SENSOR_RING_DEPTH;
+        size_t n = avail < max ? avail : max;
+
+        uint32_t start = ring->count - (uint32_t)n;
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t idx = (start + (uint32_t)i) & RING_MASK;
+            if (timestamps_ms)
+                timestamps_ms[i] = ring->timestamp_ms[idx];
+            if (values)
+                values[i] = ring->value[idx];
+        }
+        return n;
+    }
+
+} // namespace sensors
@@ -0,0 +1,105 @@
+// sensor_registry.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "hal/sensor/hal_sensor.h"
+
+/*
+    Sensor Registry
+
+    Responsibilities:
+    - Map logical telemetry channels onto (ISensor, source channel) pairs.
+    - Sample each channel at its own period, anchored to its first deadline
+      so periods do not drift with loop latency.
+    - Keep the most recent samples of every channel in a fixed-size ring.
+
+    Layout:
+    - Structure-of-arrays throughout. The per-tick due scan walks one
+      contiguous next_due_ms[] array; each channel's ring keeps timestamps
+      and values in separate arrays so consumers that only want values
+      (statistics, packing) stream through one array.
+
+    Invariants:
+    - No heap allocation; capacity is fixed at compile time.
+    - Rings overwrite their oldest sample when full.
+    - sensor_registry_poll() performs at most one read per due channel per
+      call and never blocks.
+*/
+
+// Build-time capacity:
+// -D SENSOR_MAX_CHANNELS=32 -D SENSOR_RING_DEPTH=64
+#ifndef SENSOR_MAX_CHANNELS
+#define SENSOR_MAX_CHANNELS 32
+#endif
+
+#ifndef SENSOR_RING_DEPTH
+#define SENSOR_RING_DEPTH 64 // samples per channel, power of two
+#endif
+
+namespace sensors
+{
+    static_assert((SENSOR_RING_DEPTH & (SENSOR_RING_DEPTH - 1)) == 0, "SENSOR_RING_DEPTH must be a power of two");
+
+    typedef struct
+    {
+        uint32_t timestamp_ms;
+        int32_t value;
+    } sample_t;
+
+    // Sample ring for one channel (structure of arrays).
+    typedef struct
+    {
+        uint32_t timestamp_ms[SENSOR_RING_DEPTH];
+        int32_t value[SENSOR_RING_DEPTH];
+        uint32_t count; // total samples ever written; head = count % depth
+    } sample_ring_t;
+
+    typedef struct
+    {
+        uint8_t channel_count;
+
+        // Scheduling (hot, scanned every poll)
+        uint32_t next_due_ms[SENSOR_MAX_CHANNELS];
+        uint32_t period_ms[SENSOR_MAX_CHANNELS];
+
+        // Source mapping
+        hal::sensor::ISensor *source[SENSOR_MAX_CHANNELS];
+        uint8_t source_channel[SENSOR_MAX_CHANNELS];
+
+        // Per-channel counters
+        uint32_t read_errors[SENSOR_MAX_CHANNELS];
+        uint32_t missed[SENSOR_MAX_CHANNELS]; // deadlines skipped because poll ran late
+
+        sample_ring_t ring[SENSOR_MAX_CHANNELS];
+    } sensor_registry_t;
+
+    void sensor_registry_init(sensor_registry_t *reg);
+
+    // Register a channel. Returns its index or -1 if full / invalid.
+    // The first sample is due at now_ms + period_ms.
+    int sensor_registry_add(sensor_registry_t *reg, hal::sensor::ISensor *source, uint8_t source_channel,
+                            uint32_t period_ms, uint32_t now_ms);
+
+    bool sensor_registry_set_period(sensor_registry_t *reg, uint8_t channel, uint32_t period_ms, uint32_t now_ms);
+
+    // Sample every channel that is due. Returns the number of samples taken.
+    uint32_t sensor_registry_poll(sensor_registry_t *reg, uint32_t now_ms);
+
+    // Earliest next_due_ms over all channels (wrap-safe). False if there are
+    // no channels.
+    bool sensor_registry_next_due(const sensor_registry_t *reg, uint32_t *due_ms);
+
+    // Same, mapped onto the 64-bit microsecond clock at now_us (overdue
+    // channels report now_us).
+    bool sensor_registry_next_due_us(const sensor_registry_t *reg, uint64_t now_us, uint64_t *due_us);
+
+    // Most recent sample of a channel; false if it has none yet.
+    bool sensor_registry_latest(const sensor_registry_t *reg, uint8_t channel, sample_t *out);
+
+    // Copy up to max most recent samples, oldest first. Returns the number copied.
+    size_t sensor_registry_recent(const sensor_registry_t *reg, uint8_t channel,
+                                  uint32_t *timestamps_ms, int32_t *values, size_t max);
+
+} // namespace sensors
@@ -0,0 +1,432 @@
+// flash_spool.cpp
+#include "spool/flash_spool.h"
+
+#include <string.h>
+
+#include "crc16.h"
+
+namespace spool
+{
+    static const uint32_t SPOOL_MAGIC = 0x314C5053u; // "SPL1"
+    static const uint8_t ERASED = 0xFFu;
+
+    typedef struct
+    {
+        uint32_t sector_seq;
+        uint32_t erase_count;
+        uint32_t first_seq;
+    } sector_header_t;
+
+    static uint32_t get_u32le(const uint8_t *p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static void put_u32le(uint8_t *p, uint32_t v)
+    {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+        p[2] = (uint8_t)(v >> 16);
+        p[3] = (uint8_t)(v >> 24);
+    }
+
+    static uint32_t sector_base(const spool_t *s, uint32_t sector)
+    {
+        return sector * s->geo.sector_size;
+    }
+
+    static uint32_t next_sector(const spool_t *s, uint32_t sector)
+    {
+        return sector + 1 == s->geo.sector_count ? 0 : sector + 1;
+    }
+
+    static uint32_t prev_sector(const spool_t *s, uint32_t sector)
+    {
+        return sector == 0 ? s->geo.sector_count - 1 : sector - 1;
+    }
+
+    static bool read_header(spool_t *s, uint32_t sector, sector_header_t *h)
+    {
+        uint8_t raw[SPOOL_HEADER_SIZE];
+        if (!s->flash->hal_flash_read(sector_base(s, sector), raw, sizeof(raw)))
+            return false;
+        if (get_u32le(&raw[0]) != SPOOL_MAGIC)
+            return false;
+
+        h->sector_seq = get_u32le(&raw[4]);
+        h->erase_count = get_u32le(&raw[8]);
+        h->first_seq = get_u32le(&raw[12]);
+        return true;
+    }
+
+    // Log bytes as they will be once the current page is programmed.
+    static bool read_log(spool_t *s, uint32_t sector, uint32_t off, uint8_t *out, size_t len)
+    {
+        if (!s->flash->hal_flash_read(sector_base(s, sector) + off, out, len))
+            return false;
+
+        if (sector == s->head_sector && s->page_dirty)
+        {
+            uint32_t page_base = s->head_off - s->head_off % s->geo.page_size;
+            uint32_t lo = off > page_base ? off : page_base;
+            uint32_t hi = off + (uint32_t)len < page_base + s->geo.page_size ? off + (uint32_t)len : page_base + s->geo.page_size;
+            if (lo < hi)
+                memcpy(out + (lo - off), &s->page[lo - page_base], hi - lo);
+        }
+        return true;
+    }
+
+    static bool program_page(spool_t *s)
+    {
+        uint32_t page_base = s->head_off - s->head_off % s->geo.page_size;
+        if (!s->flash->hal_flash_program(sector_base(s, s->head_sector) + page_base, s->page))
+            return false;
+        s->stats.pages_programmed++;
+        s->page_dirty = false;
+        return true;
+    }
+
+    static bool sector_blank(spool_t *s, uint32_t sector)
+    {
+        uint8_t chunk[64];
+        for (uint32_t off = 0; off < s->geo.sector_size; off += sizeof(chunk))
+        {
+            if (!s->flash->hal_flash_read(sector_base(s, sector) + off, chunk, sizeof(chunk)))
+                return false;
+            for (size_t i = 0; i < sizeof(chunk); i++)
+            {
+                if (chunk[i] != ERASED)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Erase sector (unless it already is) and start it with a header whose
+    // first record will be next_seq. The header page is programmed at once
+    // so the sector's place in the ring survives a reset.
+    static bool open_sector(spool_t *s, uint32_t sector)
+    {
+        sector_header_t old;
+        uint32_t erase_count = read_header(s, sector, &old) ? old.erase_count : 0;
+
+        if (!sector_blank(s, sector))
+        {
+            if (!s->flash->hal_flash_erase(sector))
+                return false;
+            s->stats.sectors_erased++;
+            erase_count++;
+        }
+        if (erase_count > s->stats.max_erase_count)
+            s->stats.max_erase_count = erase_count;
+
+        s->head_sector = sector;
+        s->head_sector_seq++;
+        s->head_off = 0;
+        s->sealed = false;
+
+        memset(s->page, ERASED, s->geo.page_size);
+        put_u32le(&s->page[0], SPOOL_MAGIC);
+        put_u32le(&s->page[4], s->head_sector_seq);
+        put_u32le(&s->page[8], erase_count);
+        put_u32le(&s->page[12], s->next_seq);
+        if (!program_page(s))
+            return false;
+
+        s->head_off = SPOOL_HEADER_SIZE;
+        return true;
+    }
+
+    // Move appends to the next sector, dropping the oldest one if the ring is full.
+    static bool advance_head(spool_t *s)
+    {
+        if (s->page_dirty && !program_page(s))
+            return false;
+
+        uint32_t next = next_sector(s, s->head_sector);
+        if (next == s->tail_sector)
+        {
+            uint32_t new_tail = next_sector(s, next);
+            sector_header_t h;
+            uint32_t new_first = read_header(s, new_tail, &h) ? h.first_seq : s->next_seq;
+            s->stats.dropped += new_first - s->first_seq;
+            s->tail_sector = new_tail;
+            s->first_seq = new_first;
+        }
+        return open_sector(s, next);
+    }
+
+    static bool write_bytes(spool_t *s, const uint8_t *data, size_t len)
+    {
+        const uint32_t page = s->geo.page_size;
+        while (len > 0)
+        {
+            uint32_t in_page = s->head_off % page;
+            size_t n = page - in_page < len ? page - in_page : len;
+            memcpy(&s->page[in_page], data, n);
+            s->page_dirty = true;
+            data += n;
+            len -= n;
+
+            if (in_page + n == page)
+            {
+                // Page full: program it, then continue in a fresh image.
+                if (!program_page(s))
+                    return false;
+                memset(s->page, ERASED, page);
+            }
+            s->head_off += (uint32_t)n;
+        }
+        return true;
+    }
+
+    bool spool_mount(spool_t *s, hal::flash::IHalFlash *flash)
+    {
+        memset(s, 0, sizeof(*s));
+        s->flash = flash;
+        s->geo = flash->hal_flash_geometry();
+
+        const hal::flash::flash_geometry_t &g = s->geo;
+        if (g.page_size < SPOOL_HEADER_SIZE || g.page_size > SPOOL_MAX_PAGE || g.sector_size % g.page_size != 0 ||
+            g.sector_count < 2 || g.sector_size < SPOOL_HEADER_SIZE + SPOOL_RECORD_OVERHEAD + SPOOL_MAX_RECORD)
+            return false;
+
+        // Newest sector: highest sector_seq (wrap-safe compare).
+        bool found = false;
+        sector_header_t head = {0, 0, 0};
+        for (uint32_t i = 0; i < g.sector_count; i++)
+        {
+            sector_header_t h;
+            if (!read_header(s, i, &h))
+                continue;
+            if (h.erase_count > s->stats.max_erase_count)
+                s->stats.max_erase_count = h.erase_count;
+            if (!found || (int32_t)(h.sector_seq - head.sector_seq) > 0)
+            {
+                found = true;
+                head = h;
+                s->head_sector = i;
+            }
+        }
+
+        if (!found)
+        {
+            s->head_sector_seq = 0;
+            s->next_seq = 0;
+            s->tail_sector = 0;
+            s->first_seq = 0;
+            return open_sector(s, 0);
+        }
+        s->head_sector_seq = head.sector_seq;
+
+        // Oldest sector: walk back while the headers continue the sequence.
+        s->tail_sector = s->head_sector;
+        s->first_seq = head.first_seq;
+        for (uint32_t k = 1; k < g.sector_count; k++)
+        {
+            uint32_t p = prev_sector(s, s->tail_sector);
+            sector_header_t h;
+            if (!read_header(s, p, &h) || h.sector_seq != head.sector_seq - k)
+                break;
+            s->tail_sector = p;
+            s->first_seq = h.first_seq;
+        }
+
+        // End of the head sector's records.
+        uint32_t off = SPOOL_HEADER_SIZE;
+        uint32_t seq = head.first_seq;
+        uint8_t rec[SPOOL_MAX_RECORD + SPOOL_RECORD_OVERHEAD];
+        while (off + SPOOL_RECORD_OVERHEAD <= g.sector_size)
+        {
+            if (!flash->hal_flash_read(sector_base(s, s->head_sector) + off, rec, 1))
+                return false;
+            if (rec[0] == ERASED)
+                break;
+
+            uint32_t len = rec[0];
+            uint32_t total = len + SPOOL_RECORD_OVERHEAD;
+            bool ok = len > 0 && len <= SPOOL_MAX_RECORD && off + total <= g.sector_size &&
+                      flash->hal_flash_read(sector_base(s, s->head_sector) + off, rec, total) &&
+                      get_u32le(&rec[1]) == seq &&
+                      crc16_ccitt(rec, len + 5) == (uint16_t)((rec[len + 5] << 8) | rec[len + 6]);
+            if (!ok)
+            {
+                s->stats.corrupt++;
+                s->sealed = true;
+                break;
+            }
+            off += total;
+            seq++;
+        }
+        s->head_off = off;
+        s->next_seq = seq;
+
+        // Continue in the page image of head_off; any programmed byte past
+        // the records (interrupted program) means the sector is done.
+        uint32_t page_base = off - off % g.page_size;
+        if (off < g.sector_size)
+        {
+            if (!flash->hal_flash_read(sector_base(s, s->head_sector) + page_base, s->page, g.page_size))
+                return false;
+            for (uint32_t i = off - page_base; i < g.page_size; i++)
+            {
+                if (s->page[i] != ERASED)
+                    s->sealed = true;
+            }
+        }
+        else
+        {
+            s->sealed = true;
+        }
+        return true;
+    }
+
+    bool spool_append(spool_t *s, const uint8_t *data, size_t len)
+    {
+        if (data == NULL || len == 0 || len > SPOOL_MAX_RECORD)
+        {
+            s->stats.rejected++;
+            return false;
+        }
+
+        uint32_t total = (uint32_t)len + SPOOL_RECORD_OVERHEAD;
+        if ((s->sealed || s->head_off + total > s->geo.sector_size) && !advance_head(s))
+        {
+            s->sealed = true;
+            s->stats.rejected++;
+            return false;
+        }
+
+        uint8_t rec[SPOOL_MAX_RECORD + SPOOL_RECORD_OVERHEAD];
+        rec[0] = (uint8_t)len;
+        put_u32le(&rec[1], s->next_seq);
+        memcpy(&rec[5], data, len);
+        uint16_t crc = crc16_ccitt(rec, len + 5);
+        rec[len + 5] = (uint8_t)(crc >> 8);
+        rec[len + 6] = (uint8_t)crc;
+
+        if (!write_bytes(s, rec, total))
+        {
+            s->sealed = true;
+            s->stats.rejected++;
+            return false;
+        }
+
+        s->next_seq++;
+        s->stats.appends++;
+        s->stats.append_bytes += (uint32_t)len;
+        return true;
+    }
+
+    void spool_sync(spool_t *s)
+    {
+        if (s->page_dirty && program_page(s))
+            s->stats.syncs++;
+    }
+
+    // Step c to the start of the next sector; false at the head.
+    static bool cursor_next_sector(spool_t *s, spool_cursor_t *c)
+    {
+        if (c->sector == s->head_sector)
+            return false;
+
+        c->sector = next_sector(s, c->sector);
+        c->off = SPOOL_HEADER_SIZE;
+        sector_header_t h;
+        if (read_header(s, c->sector, &h))
+            c->seq = h.first_seq;
+        return true;
+    }
+
+    // Length and sequence number of the record at c, moving c across
+    // sector ends. False at the end of the log.
+    static bool cursor_peek(spool_t *s, spool_cursor_t *c, uint32_t *len, uint32_t *seq)
+    {
+        for (;;)
+        {
+            if (c->sector == s->head_sector && c->off >= s->head_off)
+                return false;
+
+            uint8_t hdr[5];
+            if (c->off + SPOOL_RECORD_OVERHEAD <= s->geo.sector_size && read_log(s, c->sector, c->off, hdr, sizeof(hdr)) &&
+                hdr[0] != ERASED && hdr[0] != 0 && hdr[0] <= SPOOL_MAX_RECORD &&
+                c->off + hdr[0] + SPOOL_RECORD_OVERHEAD <= s->geo.sector_size)
+            {
+                *len = hdr[0];
+                *seq = get_u32le(&hdr[1]);
+                return true;
+            }
+
+            if (!cursor_next_sector(s, c))
+                return false;
+        }
+    }
+
+    void spool_seek(spool_t *s, uint32_t seq, spool_cursor_t *c)
+    {
+        if (seq < s->first_seq)
+            seq = s->first_seq;
+        if (seq > s->next_seq)
+            seq = s->next_seq;
+
+        // Last sector, oldest to newest, whose first record is <= seq.
+        c->sector = s->tail_sector;
+        c->seq = s->first_seq;
+        for (uint32_t x = s->tail_sector;; x = next_sector(s, x))
+        {
+            sector_header_t h;
+            if (read_header(s, x, &h) && h.first_seq <= seq)
+            {
+                c->sector = x;
+                c->seq = h.first_seq;
+            }
+            if (x == s->head_sector)
+                break;
+        }
+        c->off = SPOOL_HEADER_SIZE;
+
+        // Hop record by record (no CRC check) up to seq.
+        uint32_t len, rseq;
+        while (cursor_peek(s, c, &len, &rseq) && rseq < seq)
+        {
+            c->off += len + SPOOL_RECORD_OVERHEAD;
+            c->seq = rseq + 1;
+        }
+        c->seq = seq;
+    }
+
+    size_t spool_read(spool_t *s, spool_cursor_t *c, uint32_t *seq, uint8_t *out, size_t cap)
+    {
+        // The ring wrapped under the cursor: continue with what is left.
+        if (c->seq < s->first_seq)
+            spool_seek(s, s->first_seq, c);
+
+        uint8_t rec[SPOOL_MAX_RECORD + SPOOL_RECORD_OVERHEAD];
+        uint32_t len, rseq;
+        while (cursor_peek(s, c, &len, &rseq))
+        {
+            uint32_t total = len + SPOOL_RECORD_OVERHEAD;
+            if (!read_log(s, c->sector, c->off, rec, total) ||
+                crc16_ccitt(rec, len + 5) != (uint16_t)((rec[len + 5] << 8) | rec[len + 6]))
+            {
+                // Torn or damaged: nothing after it in this sector is trusted.
+                s->stats.corrupt++;
+                if (!cursor_next_sector(s, c))
+                    return 0;
+                continue;
+            }
+
+            c->off += total;
+            c->seq = rseq + 1;
+            if (len > cap)
+                continue;
+
+            memcpy(out, &rec[5], len);
+            if (seq != NULL)
+                *seq = rseq;
+            return len;
+        }
+        return 0;
+    }
+
+} // namespace spool
@@ -0,0 +1,130 @@
+// flash_spool.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "hal/flash/hal_flash.h"
+
+/*
+    Flash Spool
+
+    Responsibilities:
+    - Keep records (telemetry produced while nobody reads the link) in an
+      append-only log in flash, each tagged with a 32-bit sequence number,
+      so a host can later replay them from any sequence number and resume
+      after an interrupted replay.
+    - Survive reboots: spool_mount() finds the newest sector and the end of
+      its records, and continues appending there.
+
+    Layout:
+    - The region is a ring of sectors used in order. Each sector starts
+      with a header {magic, sector_seq, erase_count, first_seq}, followed by
+      records [len:1][seq:4 LE][data:len][crc16:2 BE]; an 0xFF length byte
+      marks the end of the written part. Records never cross sectors.
+    - sector_seq grows by one per sector opened, so the newest sector and
+      the run of older ones behind it are found from the headers alone.
+
+    Wear:
+    - Sectors are erased strictly round robin, only when the ring wraps,
+      so every sector sees the same number of erase cycles; the header
+      carries each sector's erase count.
+    - Appends fill a RAM image of the current page and program it once it
+      is full. spool_sync() programs a partly filled page early (the page is
+      programmed again when it fills, which NOR flash allows because the
+      bytes already written do not change); how often callers sync trades
+      write amplification for how much an unexpected reset can lose.
+
+    Invariants:
+    - No heap allocation. Flash operations block (a sector erase takes tens
+      of milliseconds on the device); an append erases at most one sector.
+    - When the ring is full the oldest sector is erased and its records are
+      counted in stats.dropped; first_seq moves past them.
+    - A record that fails its CRC (torn write at reset) ends its sector:
+      readers skip to the next sector and appends start a new one.
+*/
+
+// Largest record data and largest flash page the spool supports:
+// -D SPOOL_MAX_RECORD=64 -D SPOOL_MAX_PAGE=256
+#ifndef SPOOL_MAX_RECORD
+#define SPOOL_MAX_RECORD 64
+#endif
+
+#ifndef SPOOL_MAX_PAGE
+#define SPOOL_MAX_PAGE 256
+#endif
+
+#define SPOOL_HEADER_SIZE 16u
+#define SPOOL_RECORD_OVERHEAD 7u // len + seq + crc16
+
+namespace spool
+{
+    typedef struct
+    {
+        uint32_t appends;          // records appended
+        uint32_t append_bytes;     // record data bytes appended (excluding overhead)
+        uint32_t dropped;          // records lost when the ring wrapped
+        uint32_t rejected;         // appends refused (too large, flash error)
+        uint32_t pages_programmed; // page programs issued, syncs included
+        uint32_t sectors_erased;
+        uint32_t syncs;            // spool_sync() calls that programmed a page
+        uint32_t corrupt;          // records that failed their CRC (mount and reads)
+        uint32_t max_erase_count;  // highest sector erase count seen
+    } spool_stats_t;
+
+    typedef struct
+    {
+        hal::flash::IHalFlash *flash;
+        hal::flash::flash_geometry_t geo;
+
+        // Write side: records go to head_sector at head_off.
+        uint32_t head_sector;
+        uint32_t head_off;
+        uint32_t head_sector_seq;
+        uint32_t next_seq; // sequence number of the next record
+
+        // Oldest sector still holding records, and its first record.
+        uint32_t tail_sector;
+        uint32_t first_seq;
+
+        uint8_t page[SPOOL_MAX_PAGE]; // RAM image of the page holding head_off
+        bool page_dirty;              // page has bytes not yet programmed
+        bool sealed;                  // head sector takes no more records
+
+        spool_stats_t stats;
+    } spool_t;
+
+    // Replay position; valid across appends. A cursor that fell behind
+    // first_seq (ring wrapped under it) restarts at first_seq.
+    typedef struct
+    {
+        uint32_t sector;
+        uint32_t off;
+        uint32_t seq; // next record to return
+    } spool_cursor_t;
+
+    // Recover the log from flash, or start a new one if none is found.
+    // Returns false if the geometry is unsupported (fewer than two sectors,
+    // page larger than SPOOL_MAX_PAGE, ...) or flash access fails.
+    bool spool_mount(spool_t *s, hal::flash::IHalFlash *flash);
+
+    // Append one record of len (1..SPOOL_MAX_RECORD) bytes with sequence
+    // number spool_next_seq(). Returns false if rejected.
+    bool spool_append(spool_t *s, const uint8_t *data, size_t len);
+
+    // Program the partly filled current page, if any, so a reset cannot
+    // lose the records in it.
+    void spool_sync(spool_t *s);
+
+    static inline uint32_t spool_first_seq(const spool_t *s) { return s->first_seq; }
+    static inline uint32_t spool_next_seq(const spool_t *s) { return s->next_seq; }
+
+    // Position c at the first stored record with sequence number >= seq.
+    void spool_seek(spool_t *s, uint32_t seq, spool_cursor_t *c);
+
+    // Read the record at c into out and advance. Returns its length (its
+    // sequence number in *seq), or 0 at the end of the log. Records larger
+    // than cap are skipped.
+    size_t spool_read(spool_t *s, spool_cursor_t *c, uint32_t *seq, uint8_t *out, size_t cap);
+
+} // namespace spool
@@ -0,0 +1,344 @@
+// window_stats.cpp
+#include "stats/window_stats.h"
+
+#include <string.h>
+
+namespace stats
+{
+    static const float k_quantiles[STATS_QUANTILES] = {0.50f, 0.90f, 0.99f};
+    static const uint32_t RING_MASK = SENSOR_RING_DEPTH - 1;
+
+    // Nearest integer, saturated to the int32 range.
+    static int32_t round_i32(float v)
+    {
+        if (v >= 2147483647.0f)
+            return INT32_MAX;
+        if (v <= -2147483648.0f)
+            return INT32_MIN;
+        return (int32_t)(v >= 0.0f ? v + 0.5f : v - 0.5f);
+    }
+
+    // ------------------------------------------------------------------------
+    // P-square quantile estimator
+    // ------------------------------------------------------------------------
+
+    void p2_init(p2_quantile_t *pq, float p)
+    {
+        memset(pq, 0, sizeof(*pq));
+        pq->p = p;
+    }
+
+    // Piecewise-parabolic prediction of marker i moved by d (+1 / -1).
+    static float p2_parabolic(const p2_quantile_t *pq, int i, float d)
+    {
+        const float *q = pq->q;
+        const int32_t *n = pq->n;
+        float span = (float)(n[i + 1] - n[i - 1]);
+        float right = (float)(n[i] - n[i - 1]) + d;
+        float left = (float)(n[i + 1] - n[i]) - d;
+        return q[i] + d / span * (right * (q[i + 1] - q[i]) / (float)(n[i + 1] - n[i]) + left * (q[i] - q[i - 1]) / (float)(n[i] - n[i - 1]));
+    }
+
+    static float p2_linear(const p2_quantile_t *pq, int i, int d)
+    {
+        return pq->q[i] + (float)d * (pq->q[i + d] - pq->q[i]) / (float)(pq->n[i + d] - pq->n[i]);
+    }
+
+    static void sort5(float *v, uint32_t count)
+    {
+        for (uint32_t i = 1; i < count; i++)
+        {
+            float x = v[i];
+            uint32_t j = i;
+            for (; j > 0 && v[j - 1] > x; j--)
+                v[j] = v[j - 1];
+            v[j] = x;
+        }
+    }
+
+    void p2_add(p2_quantile_t *pq, float x)
+    {
+        float *q = pq->q;
+        int32_t *n = pq->n;
+        const float p = pq->p;
+
+        if (pq->count < 5)
+        {
+            q[pq->count++] = x;
+            if (pq->count == 5)
+            {
+                sort5(q, 5);
+                for (int i = 0; i < 5; i++)
+                    n[i] = i + 1;
+                pq->np[0] = 1.0f;
+                pq->np[1] = 1.0f + 2.0f * p;
+                pq->np[2] = 1.0f + 4.0f * p;
+                pq->np[3] = 3.0f + 2.0f * p;
+                pq->np[4] = 5.0f;
+            }
+            return;
+        }
+        pq->count++;
+
+        // Cell k holds x; extremes move the end markers.
+        int k;
+        if (x < q[0])
+        {
+            q[0] = x;
+            k = 0;
+        }
+        else if (x >= q[4])
+        {
+            q[4] = x;
+            k = 3;
+        }
+        else
+        {
+            k = 0;
+            while (x >= q[k + 1])
+                k++;
+        }
+
+        for (int i = k + 1; i < 5; i++)
+            n[i]++;
+        pq->np[1] += p * 0.5f;
+        pq->np[2] += p;
+        pq->np[3] += (1.0f + p) * 0.5f;
+        pq->np[4] += 1.0f;
+
+        // Move interior markers that drifted a whole position from where
+        // they should be, keeping heights ordered.
+        for (int i = 1; i <= 3; i++)
+        {
+            float d = pq->np[i] - (float)n[i];
+            if ((d >= 1.0f && n[i + 1] - n[i] > 1) || (d <= -1.0f && n[i - 1] - n[i] < -1))
+            {
+                int step = d >= 0.0f ? 1 : -1;
+                float h = p2_parabolic(pq, i, (float)step);
+                if (q[i - 1] < h && h < q[i + 1])
+                    q[i] = h;
+                else
+                    q[i] = p2_linear(pq, i, step);
+                n[i] += step;
+            }
+        }
+    }
+
+    float p2_value(const p2_quantile_t *pq)
+    {
+        if (pq->count >= 5)
+            return pq->q[2];
+        if (pq->count == 0)
+            return 0.0f;
+
+        // Too few samples for the markers: exact nearest rank.
+        float v[5];
+        memcpy(v, pq->q, pq->count * sizeof(float));
+        sort5(v, pq->count);
+        uint32_t rank = (uint32_t)(pq->p * (float)pq->count + 0.999999f); // ceil
+        rank = rank < 1 ? 1 : (rank > pq->count ? pq->count : rank);
+        return v[rank - 1];
+    }
+
+    // ------------------------------------------------------------------------
+    // Window accumulator
+    // ------------------------------------------------------------------------
+
+    void stats_reset(window_stats_t *ws)
+    {
+        memset(&ws->w, 0, sizeof(ws->w));
+        for (int i = 0; i < STATS_QUANTILES; i++)
+            p2_init(&ws->quantile[i], k_quantiles[i]);
+    }
+
+    void stats_add(window_stats_t *ws, int32_t value)
+    {
+        welford_t *w = &ws->w;
+        float x = (float)value;
+
+        if (w->count == 0)
+        {
+            w->min = value;
+            w->max = value;
+        }
+        else
+        {
+            w->min = value < w->min ? value : w->min;
+            w->max = value > w->max ? value : w->max;
+        }
+
+        w->count++;
+        float delta = x - w->mean;
+        w->mean += delta / (float)w->count;
+        w->m2 += delta * (x - w->mean);
+
+        for (int i = 0; i < STATS_QUANTILES; i++)
+            p2_add(&ws->quantile[i], x);
+    }
+
+    void stats_summarize(const window_stats_t *ws, window_summary_t *out)
+    {
+        const welford_t *w = &ws->w;
+        out->count = w->count;
+        out->min = w->min;
+        out->max = w->max;
+        out->mean = w->mean;
+        out->variance = w->count > 1 ? w->m2 / (float)(w->count - 1) : 0.0f;
+
+        // Estimates can stray just outside the observed range; clamp.
+        int32_t pv[STATS_QUANTILES];
+        for (int i = 0; i < STATS_QUANTILES; i++)
+        {
+            int32_t v = round_i32(p2_value(&ws->quantile[i]));
+            pv[i] = v < w->min ? w->min : (v > w->max ? w->max : v);
+        }
+        out->p50 = pv[0];
+        out->p90 = pv[1];
+        out->p99 = pv[2];
+    }
+
+    // ------------------------------------------------------------------------
+    // Tumbling windows over registry channels
+    // ------------------------------------------------------------------------
+
+    void stats_init(stats_table_t *t)
+    {
+        memset(t, 0, sizeof(*t));
+    }
+
+    static stats_window_t *find(stats_table_t *t, uint8_t channel)
+    {
+        for (int i = 0; i < STATS_MAX_WINDOWS; i++)
+        {
+            if (t->win[i].active && t->win[i].channel == channel)
+                return &t->win[i];
+        }
+        return NULL;
+    }
+
+    bool stats_configure(stats_table_t *t, const sensors::sensor_registry_t *reg, uint8_t channel,
+                         uint32_t window_ms, uint32_t now_ms)
+    {
+        if (t == NULL || reg == NULL || channel >= reg->channel_count || window_ms == 0)
+            return false;
+
+        stats_window_t *w = find(t, channel);
+        for (int i = 0; w == NULL && i < STATS_MAX_WINDOWS; i++)
+        {
+            if (!t->win[i].active)
+                w = &t->win[i];
+        }
+        if (w == NULL)
+            return false;
+
+        w->active = true;
+        w->channel = channel;
+        w->window_ms = window_ms;
+        w->window_start_ms = now_ms;
+        w->consumed = reg->ring[channel].count;
+        w->lost = 0;
+        stats_reset(&w->stats);
+        return true;
+    }
+
+    bool stats_disable(stats_table_t *t, uint8_t channel)
+    {
+        stats_window_t *w = t != NULL ? find(t, channel) : NULL;
+        if (w == NULL)
+            return false;
+        w->active = false;
+        return true;
+    }
+
+    bool stats_enabled(const stats_table_t *t, uint8_t channel)
+    {
+        return find((stats_table_t *)t, channel) != NULL;
+    }
+
+    // Close the window that at_ms falls past: emit it if it saw anything,
+    // then move to the window holding at_ms (skipping empty ones).
+    static void close_window(stats_table_t *t, stats_window_t *w, uint32_t at_ms, stats_emit_fn emit, void *ctx)
+    {
+        if (w->stats.w.count > 0)
+        {
+            window_summary_t s;
+            stats_summarize(&w->stats, &s);
+            s.channel = w->channel;
+            s.end_ms = w->window_start_ms + w->window_ms;
+            s.window_ms = w->window_ms;
+            s.lost = w->lost;
+            if (emit)
+                emit(ctx, &s);
+            t->summaries++;
+            w->lost = 0;
+        }
+
+        uint32_t elapsed = at_ms - w->window_start_ms;
+        w->window_start_ms += (elapsed / w->window_ms) * w->window_ms;
+        stats_reset(&w->stats);
+    }
+
+    static bool window_ended(const stats_window_t *w, uint32_t at_ms)
+    {
+        return at_ms - w->window_start_ms >= w->window_ms && (int32_t)(at_ms - w->window_start_ms) >= 0;
+    }
+
+    uint32_t stats_poll(stats_table_t *t, const sensors::sensor_registry_t *reg, uint32_t now_ms,
+                        stats_emit_fn emit, void *ctx)
+    {
+        if (t == NULL || reg == NULL)
+            return 0;
+
+        uint32_t fed = 0;
+        for (int i = 0; i < STATS_MAX_WINDOWS; i++)
+        {
+            stats_window_t *w = &t->win[i];
+            if (!w->active)
+                continue;
+
+            const sensors::sample_ring_t *ring = &reg->ring[w->channel];
+            uint32_t pending = ring->count - w->consumed;
+            if (pending > SENSOR_RING_DEPTH)
+            {
+                w->lost += pending - SENSOR_RING_DEPTH;
+                w->consumed = ring->count - SENSOR_RING_DEPTH;
+            }
+
+            for (; w->consumed != ring->count; w->consumed++)
+            {
+                uint32_t idx = w->consumed & RING_MASK;
+                if (window_ended(w, ring->timestamp_ms[idx]))
+                    close_window(t, w, ring->timestamp_ms[idx], emit, ctx);
+                stats_add(&w->stats, ring->value[idx]);
+                fed++;
+            }
+
+            if (window_ended(w, now_ms))
+                close_window(t, w, now_ms, emit, ctx);
+        }
+
+        t->samples += fed;
+        return fed;
+    }
+
+    bool stats_next_due(const stats_table_t *t, uint32_t *due_ms)
+    {
+        bool have = false;
+        uint32_t earliest = 0;
+        for (int i = 0; i < STATS_MAX_WINDOWS; i++)
+        {
+            const stats_window_t *w = &t->win[i];
+            if (!w->active)
+                continue;
+            uint32_t end = w->window_start_ms + w->window_ms;
+            if (!have || (int32_t)(end - earliest) < 0)
+                earliest = end;
+            have = true;
+        }
+
+        if (have && due_ms)
+            *due_ms = earliest;
+        return have;
+    }
+
+} // namespace stats
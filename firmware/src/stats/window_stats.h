@@ -0,0 +1,147 @@
+// window_stats.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sensors/sensor_registry.h"
+
+/*
+    Windowed Channel Statistics
+
+    Responsibilities:
+    - Summarize a channel's samples over tumbling windows: count, min, max,
+      mean, variance and approximate p50/p90/p99, so the node can send one
+      summary record per window instead of every sample.
+    - Read samples straight out of the sensor registry rings; sampling is
+      unchanged and does not know aggregation exists.
+
+    Method:
+    - Mean and variance use Welford's incremental update, which stays
+      accurate where sum / sum-of-squares would cancel. Single precision:
+      the RP2350's FPU does float in hardware, double in software.
+    - Percentiles use the P-square algorithm (Jain & Chlamtac): five markers
+      per quantile, moved by piecewise-parabolic interpolation. O(1) time
+      per sample and a fixed 68 bytes per quantile whatever the window
+      length. Windows with fewer than five samples report exact
+      nearest-rank values.
+
+    Invariants:
+    - No heap allocation; at most STATS_MAX_WINDOWS channels aggregate at
+      once.
+    - Windows are back to back on the grid set by stats_configure() and
+      each sample lands in exactly one, by its timestamp. A window with no
+      samples emits nothing.
+    - Samples overwritten in a ring before stats_poll() read them are
+      counted in the summary's lost field, not silently skipped.
+*/
+
+// Channels that can aggregate at the same time: -D STATS_MAX_WINDOWS=8
+#ifndef STATS_MAX_WINDOWS
+#define STATS_MAX_WINDOWS 8
+#endif
+
+#define STATS_QUANTILES 3 // p50, p90, p99
+
+namespace stats
+{
+    // Running count / min / max / mean / M2 (Welford).
+    typedef struct
+    {
+        uint32_t count;
+        int32_t min;
+        int32_t max;
+        float mean;
+        float m2; // sum of squared differences from the running mean
+    } welford_t;
+
+    // One P-square quantile estimator. Until five samples arrived, q[]
+    // holds the samples themselves.
+    typedef struct
+    {
+        float q[5];   // marker heights
+        float np[5];  // desired marker positions
+        int32_t n[5]; // actual marker positions (1-based)
+        float p;      // quantile, 0..1
+        uint32_t count;
+    } p2_quantile_t;
+
+    // Everything accumulated for one window.
+    typedef struct
+    {
+        welford_t w;
+        p2_quantile_t quantile[STATS_QUANTILES];
+    } window_stats_t;
+
+    typedef struct
+    {
+        uint8_t channel;
+        uint32_t end_ms;    // window end on the registry clock
+        uint32_t window_ms;
+        uint32_t count;
+        uint32_t lost;      // samples overwritten before they were read
+        int32_t min;
+        int32_t max;
+        float mean;
+        float variance;     // sample variance (n - 1); 0 for a single sample
+        int32_t p50;
+        int32_t p90;
+        int32_t p99;
+    } window_summary_t;
+
+    // Tumbling window over one registry channel.
+    typedef struct
+    {
+        bool active;
+        uint8_t channel;
+        uint32_t window_ms;
+        uint32_t window_start_ms;
+        uint32_t consumed; // ring count already fed
+        uint32_t lost;     // in the current window
+        window_stats_t stats;
+    } stats_window_t;
+
+    typedef struct
+    {
+        stats_window_t win[STATS_MAX_WINDOWS];
+        uint32_t samples;   // samples fed, all windows
+        uint32_t summaries; // summaries emitted
+    } stats_table_t;
+
+    typedef void (*stats_emit_fn)(void *ctx, const window_summary_t *summary);
+
+    // Single window accumulator.
+    void stats_reset(window_stats_t *ws);
+    void stats_add(window_stats_t *ws, int32_t value);
+    // Fill count/min/max/mean/variance/percentiles; other fields untouched.
+    void stats_summarize(const window_stats_t *ws, window_summary_t *out);
+
+    void p2_init(p2_quantile_t *pq, float p);
+    void p2_add(p2_quantile_t *pq, float x);
+    float p2_value(const p2_quantile_t *pq); // 0 before the first sample
+
+    void stats_init(stats_table_t *t);
+
+    // Aggregate channel over windows of window_ms, the first one starting at
+    // now_ms. Samples already in the ring are not included. Reconfiguring a
+    // channel restarts its window. Returns false if the channel does not
+    // exist, window_ms is 0 or every slot is taken.
+    bool stats_configure(stats_table_t *t, const sensors::sensor_registry_t *reg, uint8_t channel,
+                         uint32_t window_ms, uint32_t now_ms);
+
+    // Stop aggregating channel; the open window is discarded. False if it
+    // was not configured.
+    bool stats_disable(stats_table_t *t, uint8_t channel);
+
+    bool stats_enabled(const stats_table_t *t, uint8_t channel);
+
+    // Feed every sample taken since the last call and emit a summary for
+    // each window that ended by now_ms. Call after sensor_registry_poll().
+    // Returns the number of samples fed.
+    uint32_t stats_poll(stats_table_t *t, const sensors::sensor_registry_t *reg, uint32_t now_ms,
+                        stats_emit_fn emit, void *ctx);
+
+    // Earliest window end over active windows (wrap-safe). False if none.
+    bool stats_next_due(const stats_table_t *t, uint32_t *due_ms);
+
+} // namespace stats
@@ -0,0 +1,162 @@
+// stream.cpp
+#include "stream/stream.h"
+
+#include <string.h>
+
+namespace stream
+{
+    static void reset_block(stream_block_t *b, uint32_t first_index)
+    {
+        b->first_index = first_index;
+        b->count = 0;
+    }
+
+    void stream_init(stream_t *s, hal::timer::IHalTimer *timer, hal::time::IHalTime *waker)
+    {
+        s->timer = timer;
+        s->waker = waker;
+        s->source = nullptr;
+        s->source_channel = 0;
+        s->channel = 0;
+        s->rate_hz = 0;
+        s->period_us = 0;
+        reset_block(&s->block[0], 0);
+        reset_block(&s->block[1], 0);
+        s->fill = 0;
+        s->next_index = 0;
+        s->ready[0].store(false, std::memory_order_relaxed);
+        s->ready[1].store(false, std::memory_order_relaxed);
+        s->active.store(false, std::memory_order_relaxed);
+        s->samples.store(0, std::memory_order_relaxed);
+        s->lost.store(0, std::memory_order_relaxed);
+        s->overruns.store(0, std::memory_order_relaxed);
+        s->read_errors.store(0, std::memory_order_relaxed);
+        s->blocks_sent = 0;
+    }
+
+    bool stream_start(stream_t *s, hal::sensor::ISensor *source, uint8_t source_channel, uint8_t channel,
+                      uint32_t rate_hz)
+    {
+        if (s->timer == nullptr || source == nullptr || rate_hz == 0 || stream_active(s))
+            return false;
+
+        uint32_t period_us = (1000000u + rate_hz / 2u) / rate_hz;
+        if (period_us == 0)
+            return false;
+
+        stream_init(s, s->timer, s->waker);
+        s->source = source;
+        s->source_channel = source_channel;
+        s->channel = channel;
+        s->rate_hz = rate_hz;
+        s->period_us = period_us;
+
+        // The callback may run as soon as the timer starts.
+        s->active.store(true, std::memory_order_release);
+        if (!s->timer->hal_timer_start(period_us, stream_on_timer, s))
+        {
+            s->active.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void stream_stop(stream_t *s)
+    {
+        if (!stream_active(s))
+            return;
+        s->timer->hal_timer_stop();
+        s->active.store(false, std::memory_order_release);
+    }
+
+    void stream_on_timer(void *ctx)
+    {
+        stream_t *s = (stream_t *)ctx;
+        if (!s->active.load(std::memory_order_acquire))
+            return;
+
+        int32_t v;
+        if (!s->source->hal_sensor_read(s->source_channel, &v))
+        {
+            s->read_errors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        stream_block_t *b = &s->block[s->fill];
+        b->samples[b->count++] = (int16_t)(v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : v);
+        s->next_index++;
+        s->samples.fetch_add(1, std::memory_order_relaxed);
+
+        if (b->count < STREAM_BLOCK_SAMPLES)
+            return;
+
+        uint8_t other = s->fill ^ 1u;
+        if (s->ready[other].load(std::memory_order_acquire))
+        {
+            // The main loop has not sent the other block yet: drop this one.
+            s->lost.fetch_add(b->count, std::memory_order_relaxed);
+            s->overruns.fetch_add(1, std::memory_order_relaxed);
+            reset_block(b, s->next_index);
+            return;
+        }
+
+        s->ready[s->fill].store(true, std::memory_order_release);
+        s->fill = other;
+        reset_block(&s->block[other], s->next_index);
+        if (s->waker != nullptr)
+            s->waker->hal_wake();
+    }
+
+    const stream_block_t *stream_peek(stream_t *s)
+    {
+        for (unsigned i = 0; i < 2; i++)
+        {
+            if (s->ready[i].load(std::memory_order_acquire))
+                return &s->block[i];
+        }
+        return nullptr;
+    }
+
+    // Hand the ready block back to the timer; false if there is none.
+    static bool give_back(stream_t *s, uint32_t *count)
+    {
+        for (unsigned i = 0; i < 2; i++)
+        {
+            if (s->ready[i].load(std::memory_order_relaxed))
+            {
+                *count = s->block[i].count;
+                s->ready[i].store(false, std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void stream_release(stream_t *s)
+    {
+        uint32_t count;
+        if (give_back(s, &count))
+            s->blocks_sent++;
+    }
+
+    void stream_discard(stream_t *s)
+    {
+        uint32_t count;
+        if (give_back(s, &count))
+        {
+            s->lost.fetch_add(count, std::memory_order_relaxed);
+            s->overruns.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool stream_take_partial(stream_t *s, stream_block_t *out)
+    {
+        stream_block_t *b = &s->block[s->fill];
+        if (stream_active(s) || b->count == 0)
+            return false;
+
+        memcpy(out, b, sizeof(*out));
+        reset_block(b, s->next_index);
+        return true;
+    }
+} // namespace stream
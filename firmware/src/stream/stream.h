@@ -0,0 +1,134 @@
+// stream.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <atomic>
+
+#include "hal/sensor/hal_sensor.h"
+#include "hal/time/hal_time.h"
+#include "hal/timer/hal_timer.h"
+#include "packet.h"
+
+/*
+    High-Rate Sample Streaming
+
+    Responsibilities:
+    - Sample one sensor channel from a hardware timer interrupt at rates the
+      main loop cannot reach (STREAM START <hz>, well past the 10 ms RATE
+      floor), into two alternating blocks of samples.
+    - Hand full blocks to the main loop, which frames each one as a
+      PKT_TYPE_STREAM packet.
+    - Count overruns (a block filled while the other still waits to be sent)
+      and the samples they cost, and report them in every block and in the
+      STREAM replies instead of dropping samples silently.
+
+    Double buffering:
+    - The timer callback (interrupt context) appends to block[fill]. When
+      it is full and the other block has been released, it marks it ready,
+      switches to the other one and wakes the main loop.
+    - If the other block is still ready (not yet sent), the full block is
+      dropped: its samples count as lost, and filling restarts on it. The
+      block already waiting is never overwritten, so what is sent is always
+      contiguous within a block and first_index shows the gap.
+
+    Invariants:
+    - Single producer (timer callback), single consumer (main loop). ready[]
+      flags hand a block over with release/acquire ordering; the main loop
+      never touches block[fill].
+    - At most one block is ready at a time.
+    - Samples are saturated to int16. Only sources that report
+      hal_sensor_streamable() for the channel (raw ADC counts, read without
+      blocking) may be streamed; the app refuses the rest, so saturation
+      only guards against a misbehaving source.
+    - While streaming, nothing else may read the source sensor (the app
+      pauses periodic sampling; see app_tick()).
+*/
+
+// Samples per block; one block is one PKT_TYPE_STREAM packet:
+// -D STREAM_BLOCK_SAMPLES=48
+#ifndef STREAM_BLOCK_SAMPLES
+#define STREAM_BLOCK_SAMPLES 48
+#endif
+
+// Highest STREAM START rate; the timer callback must finish well inside
+// one period: -D STREAM_MAX_HZ=20000
+#ifndef STREAM_MAX_HZ
+#define STREAM_MAX_HZ 20000
+#endif
+
+namespace stream
+{
+    static_assert(STREAM_MAX_HZ <= 65535, "PKT_TYPE_STREAM carries the rate in 16 bits");
+    static_assert(STREAM_BLOCK_SAMPLES > 0 && STREAM_BLOCK_SAMPLES <= PKT_STREAM_MAX_SAMPLES,
+                  "STREAM_BLOCK_SAMPLES must fit one PKT_TYPE_STREAM payload");
+
+    typedef struct
+    {
+        int16_t samples[STREAM_BLOCK_SAMPLES];
+        uint32_t first_index; // sample number of samples[0]
+        uint32_t count;
+    } stream_block_t;
+
+    typedef struct
+    {
+        hal::timer::IHalTimer *timer;
+        hal::time::IHalTime *waker; // hal_wake() when a block is ready (may be NULL)
+
+        // Set by stream_start(), read by the timer callback
+        hal::sensor::ISensor *source;
+        uint8_t source_channel;
+        uint8_t channel; // logical channel reported in packets
+        uint32_t rate_hz;
+        uint32_t period_us;
+
+        // Owned by the timer callback while running
+        stream_block_t block[2];
+        uint8_t fill;       // block being filled
+        uint32_t next_index; // sample number of the next sample
+
+        std::atomic<bool> ready[2];
+        std::atomic<bool> active;
+
+        // Written by the timer callback, read anywhere
+        std::atomic<uint32_t> samples;     // samples taken
+        std::atomic<uint32_t> lost;        // samples dropped on overruns
+        std::atomic<uint32_t> overruns;    // blocks dropped
+        std::atomic<uint32_t> read_errors; // failed reads (sample skipped)
+
+        // Main loop
+        uint32_t blocks_sent;
+    } stream_t;
+
+    void stream_init(stream_t *s, hal::timer::IHalTimer *timer, hal::time::IHalTime *waker);
+
+    // Start sampling source_channel of source at rate_hz (period rounded to
+    // whole microseconds). Resets blocks and counters. False if already
+    // active or the timer cannot run at that period.
+    bool stream_start(stream_t *s, hal::sensor::ISensor *source, uint8_t source_channel, uint8_t channel,
+                      uint32_t rate_hz);
+
+    // Stop the timer. Samples of the block being filled stay available
+    // through stream_take_partial().
+    void stream_stop(stream_t *s);
+
+    static inline bool stream_active(const stream_t *s)
+    {
+        return s != nullptr && s->active.load(std::memory_order_relaxed);
+    }
+
+    // Timer callback (interrupt context): take one sample.
+    void stream_on_timer(void *ctx);
+
+    // Main loop: the ready block, or NULL. Release it once it is sent; the
+    // timer can then fill it again.
+    const stream_block_t *stream_peek(stream_t *s);
+    void stream_release(stream_t *s);
+
+    // Main loop: drop the ready block unsent. Its samples count as lost and
+    // the block as an overrun, as when the timer callback drops one.
+    void stream_discard(stream_t *s);
+
+    // After stream_stop(): copy out the partly filled block and empty it.
+    // False if it holds no samples.
+    bool stream_take_partial(stream_t *s, stream_block_t *out);
+} // namespace stream
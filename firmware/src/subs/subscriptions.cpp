@@ -0,0 +1,170 @@
+// subscriptions.cpp
+#include "subs/subscriptions.h"
+
+#include <string.h>
+
+namespace subs
+{
+    static const uint64_t k_none = UINT64_MAX;
+    static const uint8_t k_no_group = 0xFF;
+
+    static void recompute_earliest(subs_table_t *t)
+    {
+        uint64_t earliest = k_none;
+        for (int g = 0; g < SUBS_MAX_GROUPS; g++)
+        {
+            if (t->group[g].count > 0 && t->group[g].next_due_us < earliest)
+                earliest = t->group[g].next_due_us;
+        }
+        t->earliest_us = earliest;
+    }
+
+    // Take channel out of its group; an emptied group is freed.
+    static void leave_group(subs_table_t *t, uint8_t channel)
+    {
+        subs_group_t *g = &t->group[t->group_of[channel]];
+        g->members.word[channel / 64] &= ~(1ull << (channel % 64));
+        if (--g->count == 0)
+            g->period_us = 0;
+        t->group_of[channel] = k_no_group;
+    }
+
+    void subs_init(subs_table_t *t)
+    {
+        memset(t, 0, sizeof(*t));
+        memset(t->group_of, k_no_group, sizeof(t->group_of));
+        t->earliest_us = k_none;
+    }
+
+    static int find_group(const subs_table_t *t, uint32_t period_us)
+    {
+        for (int g = 0; g < SUBS_MAX_GROUPS; g++)
+        {
+            if (t->group[g].count > 0 && t->group[g].period_us == period_us)
+                return g;
+        }
+        return -1;
+    }
+
+    static int free_group(const subs_table_t *t)
+    {
+        for (int g = 0; g < SUBS_MAX_GROUPS; g++)
+        {
+            if (t->group[g].count == 0)
+                return g;
+        }
+        return -1;
+    }
+
+    bool subs_add(subs_table_t *t, uint8_t channel, uint32_t period_us, uint64_t now_us)
+    {
+        if (!subs_in_range(channel) || period_us == 0)
+            return false;
+
+        bool was = subs_active(t, channel);
+        if (was && t->group[t->group_of[channel]].period_us == period_us)
+            return true; // already there
+
+        // A new period needs a free group; moving out of a group of one frees it.
+        bool frees = was && t->group[t->group_of[channel]].count == 1;
+        if (find_group(t, period_us) < 0 && free_group(t) < 0 && !frees)
+            return false;
+
+        if (was)
+            leave_group(t, channel);
+        else
+        {
+            t->active.word[channel / 64] |= 1ull << (channel % 64);
+            t->count++;
+        }
+
+        int gi = find_group(t, period_us);
+        if (gi < 0)
+        {
+            gi = free_group(t);
+            memset(&t->group[gi], 0, sizeof(t->group[gi]));
+            t->group[gi].period_us = period_us;
+            t->group[gi].next_due_us = now_us + period_us;
+        }
+
+        subs_group_t *g = &t->group[gi];
+        g->members.word[channel / 64] |= 1ull << (channel % 64);
+        g->count++;
+        t->group_of[channel] = (uint8_t)gi;
+        recompute_earliest(t);
+        return true;
+    }
+
+    bool subs_remove(subs_table_t *t, uint8_t channel)
+    {
+        if (!subs_active(t, channel))
+            return false;
+
+        leave_group(t, channel);
+        t->active.word[channel / 64] &= ~(1ull << (channel % 64));
+        t->count--;
+        recompute_earliest(t);
+        return true;
+    }
+
+    void subs_clear(subs_table_t *t)
+    {
+        subs_init(t);
+    }
+
+    bool subs_next_due(const subs_table_t *t, uint64_t *due_us)
+    {
+        if (t->count == 0)
+            return false;
+        *due_us = t->earliest_us;
+        return true;
+    }
+
+    uint32_t subs_collect(subs_table_t *t, uint64_t now_us, subs_mask_t *due)
+    {
+        memset(due, 0, sizeof(*due));
+        if (t->count == 0 || now_us < t->earliest_us)
+            return 0;
+
+        uint32_t n = 0;
+        uint64_t earliest = k_none;
+        for (int i = 0; i < SUBS_MAX_GROUPS; i++)
+        {
+            subs_group_t *g = &t->group[i];
+            if (g->count == 0)
+                continue;
+            if (g->next_due_us <= now_us)
+            {
+                // Advance on the original phase, skipping missed periods.
+                uint64_t skipped = (now_us - g->next_due_us) / g->period_us;
+                t->missed += (uint32_t)skipped;
+                g->next_due_us += (skipped + 1) * g->period_us;
+                for (int w = 0; w < SUBS_WORDS; w++)
+                    due->word[w] |= g->members.word[w];
+                n += g->count;
+            }
+            if (g->next_due_us < earliest)
+                earliest = g->next_due_us;
+        }
+        t->earliest_us = earliest;
+        return n;
+    }
+
+    int subs_next(const subs_mask_t *mask, int from)
+    {
+        if (from < 0)
+            from = 0;
+        for (int w = from / 64; w < SUBS_WORDS; w++)
+        {
+            uint64_t bits = mask->word[w];
+            if (w == from / 64)
+                bits &= ~0ull << (from % 64);
+            if (bits != 0)
+            {
+                int ch = w * 64 + __builtin_ctzll(bits);
+                return ch < SUBS_MAX_CHANNELS ? ch : -1;
+            }
+        }
+        return -1;
+    }
+} // namespace subs
@@ -0,0 +1,115 @@
+// subscriptions.h
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+    Per-Channel Subscriptions
+
+    Responsibilities:
+    - Keep the host's subscription table (SUB <channel> <ms>, UNSUB): which
+      channels it wants and how often each one.
+    - Once per tick, collect every channel whose period came up into one
+      due mask, so the caller can pack them all into a single record.
+
+    Method:
+    - Subscriptions with the same period share one group: one deadline on
+      one drift-free grid and a bitmask of member channels (64-bit words).
+      A tick ORs the masks of the groups that are due, so its cost follows
+      the number of distinct periods, not the number of channels, and
+      channels at the same rate always go out in the same record.
+    - The earliest group deadline is cached: a tick with nothing due, the
+      common case, is one compare.
+    - Due masks are walked with count-trailing-zeros (subs_next()), visiting
+      only the channels that are set.
+
+    Invariants:
+    - A group's grid is anchored where its first member subscribed; a
+      channel joining later gets its first value at the group's next
+      deadline. A tick that comes late sends the group once and counts the
+      periods it skipped in missed, instead of bursting.
+    - A channel is in at most one group; a group with no members is free.
+    - No heap allocation; at most SUBS_MAX_CHANNELS channels (0..max-1) and
+      SUBS_MAX_GROUPS distinct periods.
+*/
+
+// Channels the table can hold: -D SUBS_MAX_CHANNELS=64
+#ifndef SUBS_MAX_CHANNELS
+#define SUBS_MAX_CHANNELS 64
+#endif
+
+// Distinct subscription periods at the same time: -D SUBS_MAX_GROUPS=8
+#ifndef SUBS_MAX_GROUPS
+#define SUBS_MAX_GROUPS 8
+#endif
+
+#define SUBS_WORDS ((SUBS_MAX_CHANNELS + 63) / 64)
+
+namespace subs
+{
+    static_assert(SUBS_MAX_CHANNELS > 0 && SUBS_MAX_CHANNELS <= 256, "channels are numbered in one byte");
+    static_assert(SUBS_MAX_GROUPS > 0 && SUBS_MAX_GROUPS < 255, "group indexes are one byte, 0xFF = none");
+
+    typedef struct
+    {
+        uint64_t word[SUBS_WORDS];
+    } subs_mask_t;
+
+    typedef struct
+    {
+        subs_mask_t members;
+        uint32_t period_us; // 0 = free
+        uint16_t count;     // members
+        uint64_t next_due_us;
+    } subs_group_t;
+
+    typedef struct
+    {
+        subs_mask_t active;
+        uint8_t group_of[SUBS_MAX_CHANNELS]; // 0xFF = not subscribed
+        subs_group_t group[SUBS_MAX_GROUPS];
+        uint64_t earliest_us; // min next_due_us over groups in use
+        uint16_t count;       // active subscriptions
+        uint32_t missed;      // group periods skipped because a tick came late
+    } subs_table_t;
+
+    void subs_init(subs_table_t *t);
+
+    // Subscribe channel at period_us (> 0). A new period starts a grid one
+    // period from now_us; an existing one is joined. Subscribing again at
+    // another period moves the channel. False if the channel is out of
+    // range or every group holds another period.
+    bool subs_add(subs_table_t *t, uint8_t channel, uint32_t period_us, uint64_t now_us);
+
+    // False if channel was not subscribed.
+    bool subs_remove(subs_table_t *t, uint8_t channel);
+    void subs_clear(subs_table_t *t);
+
+    // Whether the table can hold channel. At SUBS_MAX_CHANNELS=256 every
+    // byte is in range, and the compare is left out (-Wtype-limits).
+    static inline bool subs_in_range(uint8_t channel)
+    {
+#if SUBS_MAX_CHANNELS < 256
+        return channel < SUBS_MAX_CHANNELS;
+#else
+        (void)channel;
+        return true;
+#endif
+    }
+
+    static inline bool subs_active(const subs_table_t *t, uint8_t channel)
+    {
+        return subs_in_range(channel) && (t->active.word[channel / 64] >> (channel % 64)) & 1u;
+    }
+
+    // Earliest deadline of any subscription; false if there are none.
+    bool subs_next_due(const subs_table_t *t, uint64_t *due_us);
+
+    // Set due to the channels due at now_us and move their groups to the
+    // next period. Returns how many channels are due.
+    uint32_t subs_collect(subs_table_t *t, uint64_t now_us, subs_mask_t *due);
+
+    // Next set channel in mask at or after from; -1 if none.
+    int subs_next(const subs_mask_t *mask, int from);
+} // namespace subs
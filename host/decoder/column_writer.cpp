@@ -0,0 +1,112 @@
+// column_writer.cpp
+#include "column_writer.h"
+
+#include <string.h>
+
+namespace host
+{
+    bool write_csv_header(FILE *f)
+    {
+        return fputs("seq,timestamp_us,type,payload_len,state,telemetry_period_ms,heartbeat_period_ms,fault_count\n", f) >= 0;
+    }
+
+    bool write_csv_rows(FILE *f, const TelemetryColumns &cols)
+    {
+        for (size_t i = 0; i < cols.rows(); i++)
+        {
+            int n;
+            if (cols.has_record[i])
+            {
+                n = fprintf(f, "%u,%llu,%u,%u,%u,%lu,%lu,%lu\n",
+                            (unsigned)cols.seq[i], (unsigned long long)cols.timestamp_us[i],
+                            (unsigned)cols.type[i], (unsigned)cols.payload_len[i], (unsigned)cols.state[i],
+                            (unsigned long)cols.telemetry_period_ms[i], (unsigned long)cols.heartbeat_period_ms[i],
+                            (unsigned long)cols.fault_count[i]);
+            }
+            else
+            {
+                n = fprintf(f, "%u,%llu,%u,%u,,,,\n",
+                            (unsigned)cols.seq[i], (unsigned long long)cols.timestamp_us[i],
+                            (unsigned)cols.type[i], (unsigned)cols.payload_len[i]);
+            }
+            if (n < 0)
+                return false;
+        }
+        return true;
+    }
+
+    bool write_csv(FILE *f, const TelemetryColumns &cols)
+    {
+        return write_csv_header(f) && write_csv_rows(f, cols);
+    }
+
+    template <typename T>
+    static bool put_le(FILE *f, T v)
+    {
+        uint8_t b[sizeof(T)];
+        for (size_t i = 0; i < sizeof(T); i++)
+            b[i] = (uint8_t)((uint64_t)v >> (8 * i));
+        return fwrite(b, 1, sizeof(b), f) == sizeof(b);
+    }
+
+    template <typename T>
+    static bool put_column(FILE *f, const std::vector<T> &col)
+    {
+        for (T v : col)
+        {
+            if (!put_le(f, v))
+                return false;
+        }
+        return true;
+    }
+
+    struct ColumnDesc
+    {
+        const char *name;
+        uint8_t width;
+    };
+
+    // Same order as write_columns_block() writes them.
+    static const ColumnDesc k_columns[] = {
+        {"seq", 2},
+        {"timestamp_us", 8},
+        {"type", 1},
+        {"payload_len", 2},
+        {"has_record", 1},
+        {"state", 1},
+        {"telemetry_period_ms", 4},
+        {"heartbeat_period_ms", 4},
+        {"fault_count", 4},
+    };
+
+    bool write_columns_header(FILE *f)
+    {
+        const uint16_t ncols = (uint16_t)(sizeof(k_columns) / sizeof(k_columns[0]));
+        bool ok = fwrite(COLUMN_FILE_MAGIC, 1, 4, f) == 4 &&
+                  put_le<uint16_t>(f, COLUMN_FILE_VERSION) &&
+                  put_le<uint16_t>(f, ncols);
+
+        for (const ColumnDesc &d : k_columns)
+        {
+            uint8_t len = (uint8_t)strlen(d.name);
+            ok = ok && put_le<uint8_t>(f, len) && fwrite(d.name, 1, len, f) == len && put_le<uint8_t>(f, d.width);
+        }
+        return ok;
+    }
+
+    bool write_columns_block(FILE *f, const TelemetryColumns &cols)
+    {
+        if (cols.rows() == 0)
+            return true; // no empty blocks
+        return put_le<uint64_t>(f, cols.rows()) &&
+               put_column(f, cols.seq) && put_column(f, cols.timestamp_us) && put_column(f, cols.type) &&
+               put_column(f, cols.payload_len) && put_column(f, cols.has_record) && put_column(f, cols.state) &&
+               put_column(f, cols.telemetry_period_ms) && put_column(f, cols.heartbeat_period_ms) &&
+               put_column(f, cols.fault_count);
+    }
+
+    bool write_columns(FILE *f, const TelemetryColumns &cols)
+    {
+        return write_columns_header(f) && write_columns_block(f, cols);
+    }
+} // namespace host
@@ -0,0 +1,43 @@
+// column_writer.h
+#pragma once
+#include <stdio.h>
+
+#include "decoder.h"
+
+/*
+    Columnar Output
+
+    Both formats are a header followed by any number of row blocks, so a
+    capture of any size is written window by window: decode a window, write
+    its rows, clear the columns.
+
+    CSV:
+    - Header row, then one row per packet:
+        seq,timestamp_us,type,payload_len,state,telemetry_period_ms,heartbeat_period_ms,fault_count
+    - The telemetry record fields are empty for packets without a record.
+
+    Binary column file (little-endian):
+        "TLMC" [version:u16 = 2] [columns:u16]
+        per column: [name_len:u8] [name] [width:u8]      (width in bytes: 1, 2, 4 or 8)
+        blocks until end of file:
+            [rows:u64]
+            per column, in the same order: rows * width bytes of packed values
+    - Within a block each column is contiguous, so a reader can pick one
+      field out of each block without touching the rest.
+
+    All writers return false on any I/O error. write_csv() and
+    write_columns() write a header and a single block.
+*/
+namespace host
+{
+    static const char COLUMN_FILE_MAGIC[4] = {'T', 'L', 'M', 'C'};
+    static const uint16_t COLUMN_FILE_VERSION = 2;
+
+    bool write_csv_header(FILE *f);
+    bool write_csv_rows(FILE *f, const TelemetryColumns &cols);
+    bool write_csv(FILE *f, const TelemetryColumns &cols);
+
+    bool write_columns_header(FILE *f);
+    bool write_columns_block(FILE *f, const TelemetryColumns &cols);
+    bool write_columns(FILE *f, const TelemetryColumns &cols);
+} // namespace host
@@ -0,0 +1,170 @@
+// decoder.cpp
+#include "decoder.h"
+
+#include "crc16.h"
+#include "frame_scan.h"
+
+#include <string.h>
+
+namespace host
+{
+    static const uint8_t k_delim = PKT_FRAME_DELIM;
+
+    // cobs_decode() for a segment already known to contain no delimiter.
+    // Without 0xFF blocks the decoded bytes are the input shifted by one with
+    // each later code byte replaced by the implied zero, so copy once and walk
+    // the code chain instead of looping per block (telemetry fields are full
+    // of zeros, so blocks are short and their lengths unpredictable).
+    // Returns 0 for anything else, including valid 0xFF blocks, which cannot
+    // occur in frames of at most PKT_MAX_RAW bytes.
+    static size_t cobs_decode_segment(const uint8_t *in, size_t len, uint8_t *out, size_t out_cap)
+    {
+        if (len < 2 || len - 1 > out_cap)
+            return 0;
+
+        memcpy(out, in + 1, len - 1);
+        size_t code = 0;
+        for (;;)
+        {
+            size_t next = code + in[code];
+            if (next >= len)
+                return next == len ? len - 1 : 0; // last block, or truncated
+            if (in[code] == 0xFF)
+                return 0;
+            out[next - 1] = 0;
+            code = next;
+        }
+    }
+
+    void TelemetryColumns::clear()
+    {
+        type.clear();
+        seq.clear();
+        timestamp_us.clear();
+        payload_len.clear();
+        has_record.clear();
+        state.clear();
+        telemetry_period_ms.clear();
+        heartbeat_period_ms.clear();
+        fault_count.clear();
+    }
+
+    void TelemetryColumns::reserve(size_t n)
+    {
+        type.reserve(n);
+        seq.reserve(n);
+        timestamp_us.reserve(n);
+        payload_len.reserve(n);
+        has_record.reserve(n);
+        state.reserve(n);
+        telemetry_period_ms.reserve(n);
+        heartbeat_period_ms.reserve(n);
+        fault_count.reserve(n);
+    }
+
+    void TelemetryColumns::append(const pkt_t *pkt)
+    {
+        pkt_telemetry_t rec = {0, 0, 0, 0};
+        bool ok = pkt_telemetry_unpack_delta(&delta, pkt, &rec);
+
+        type.push_back(pkt->type);
+        seq.push_back(pkt->seq);
+        timestamp_us.push_back(pkt->timestamp_us);
+        payload_len.push_back((uint16_t)pkt->payload_len);
+        has_record.push_back(ok ? 1 : 0);
+        state.push_back(rec.state);
+        telemetry_period_ms.push_back(rec.telemetry_period_ms);
+        heartbeat_period_ms.push_back(rec.heartbeat_period_ms);
+        fault_count.push_back(rec.fault_count);
+    }
+
+    bool TelemetryColumns::operator==(const TelemetryColumns &o) const
+    {
+        return type == o.type && seq == o.seq && timestamp_us == o.timestamp_us &&
+               payload_len == o.payload_len && has_record == o.has_record && state == o.state &&
+               telemetry_period_ms == o.telemetry_period_ms && heartbeat_period_ms == o.heartbeat_period_ms &&
+               fault_count == o.fault_count;
+    }
+
+    Decoder::Decoder(TelemetryColumns *out) : out_(out)
+    {
+        parser_init(&slow_, on_parser_frame, this);
+    }
+
+    void Decoder::on_parser_frame(void *ctx, const pkt_t *pkt)
+    {
+        static_cast<Decoder *>(ctx)->out_->append(pkt);
+    }
+
+    // One complete frame body (no delimiters), starting from a clean parser state.
+    void Decoder::segment(const uint8_t *seg, size_t len)
+    {
+        if (len <= PKT_COBS_MAX(PKT_MAX_RAW))
+        {
+            uint8_t raw[PKT_MAX_RAW];
+            size_t n = cobs_decode_segment(seg, len, raw, sizeof(raw));
+            if (n >= PKT_HEADER_SIZE + PKT_CRC_SIZE && crc16_update(crc16_init(), raw, n) == 0)
+            {
+                pkt_t pkt;
+                pkt_view_raw(raw, n, &pkt);
+                out_->append(&pkt);
+                fast_frames_++;
+                return;
+            }
+        }
+
+        // Rejected: let the firmware parser classify (and count) it.
+        parser_feed(&slow_, seg, len);
+        parser_feed(&slow_, &k_delim, 1);
+    }
+
+    void Decoder::feed(const uint8_t *data, size_t len)
+    {
+        if (data == NULL || len == 0)
+            return;
+        bytes_in_ += len;
+
+        DelimScanner scan(data, data + len);
+        size_t pos = 0;
+        size_t d = scan.next();
+
+        // Finish a frame that started in an earlier chunk.
+        if (in_slow_)
+        {
+            size_t stop = d == SIZE_MAX ? len : d + 1;
+            parser_feed(&slow_, data, stop);
+            if (d == SIZE_MAX)
+                return;
+            in_slow_ = false;
+            pos = d + 1;
+            d = scan.next();
+        }
+
+        for (; d != SIZE_MAX; d = scan.next())
+        {
+            if (d > pos)
+                segment(data + pos, d - pos);
+            pos = d + 1;
+        }
+
+        // Unterminated tail: keep it pending in the parser.
+        if (pos < len)
+        {
+            parser_feed(&slow_, data + pos, len - pos);
+            in_slow_ = true;
+        }
+    }
+
+    DecodeStats Decoder::stats() const
+    {
+        DecodeStats s;
+        s.frames_ok = fast_frames_ + slow_.stats.frames_ok;
+        s.crc_errors = slow_.stats.crc_errors;
+        s.framing_errors = slow_.stats.framing_errors;
+        s.overruns = slow_.stats.overruns;
+        s.resyncs = slow_.stats.resyncs;
+        s.bytes_in = bytes_in_;
+        s.fast_frames = fast_frames_;
+        return s;
+    }
+} // namespace host
@@ -0,0 +1,89 @@
+// decoder.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "packet.h"
+#include "parser.h"
+
+/*
+    Host Telemetry Decoder
+
+    Responsibilities:
+    - Decode captured telemetry streams (COBS frames from firmware/lib/protocol)
+      at memory bandwidth: find delimiters with DelimScanner, COBS decode and
+      CRC check each frame in one pass.
+    - Collect decoded packets into columns (TelemetryColumns) for CSV or
+      binary column output.
+
+    Equivalence with the firmware parser:
+    - The fast path only accepts frames the firmware parser would deliver
+      (complete COBS, length in range, CRC residue 0). Every other frame,
+      and every frame split across feed() calls, is handed to an embedded
+      parser_t, so stats and output are exactly what parser_feed() over the
+      same bytes would produce, for any chunking of the input.
+    - A trailing frame without its closing delimiter stays pending, as in
+      the firmware parser.
+*/
+namespace host
+{
+    // One column per field; row i of every column is the i-th packet.
+    // Payload fields are only meaningful where has_record[i] is 1.
+    // Keyframe/delta records are expanded through a receiver-side delta
+    // decoder; deltas after a lost packet have no record until the next keyframe.
+    struct TelemetryColumns
+    {
+        TelemetryColumns() { pkt_delta_init(&delta, 1); }
+
+        std::vector<uint8_t> type;
+        std::vector<uint16_t> seq;
+        std::vector<uint64_t> timestamp_us;
+        std::vector<uint16_t> payload_len;
+        std::vector<uint8_t> has_record; // PKT_TYPE_TELEMETRY payload unpacked
+        std::vector<uint8_t> state;
+        std::vector<uint32_t> telemetry_period_ms;
+        std::vector<uint32_t> heartbeat_period_ms;
+        std::vector<uint32_t> fault_count;
+        pkt_delta_t delta; // decoder state, not a column
+
+        size_t rows() const { return seq.size(); }
+        void clear(); // drops rows; the delta decoder keeps following the stream
+        void reserve(size_t n);
+        void append(const pkt_t *pkt);
+        bool operator==(const TelemetryColumns &other) const;
+    };
+
+    // parser_stats_t widened to 64 bits for multi-GB captures.
+    struct DecodeStats
+    {
+        uint64_t frames_ok = 0;
+        uint64_t crc_errors = 0;
+        uint64_t framing_errors = 0;
+        uint64_t overruns = 0;
+        uint64_t resyncs = 0;
+        uint64_t bytes_in = 0;
+        uint64_t fast_frames = 0; // frames taken by the fast path (subset of frames_ok)
+    };
+
+    class Decoder
+    {
+    public:
+        explicit Decoder(TelemetryColumns *out);
+
+        // Decode the next chunk of the stream.
+        void feed(const uint8_t *data, size_t len);
+
+        DecodeStats stats() const;
+
+    private:
+        static void on_parser_frame(void *ctx, const pkt_t *pkt);
+        void segment(const uint8_t *seg, size_t len);
+
+        TelemetryColumns *out_;
+        parser_t slow_;           // classifies rejected frames, spans chunk boundaries
+        bool in_slow_ = false;    // the frame in progress is inside slow_
+        uint64_t fast_frames_ = 0;
+        uint64_t bytes_in_ = 0;
+    };
+} // namespace host
@@ -0,0 +1,113 @@
+// frame_scan.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/*
+    Vectorized Frame Delimiter Scan
+
+    Responsibilities:
+    - Find every 0x00 frame delimiter in a large buffer.
+    - Compare 64 bytes per step (SSE2 on x86-64, NEON on AArch64, scalar
+      elsewhere) into a bitmask, then hand out positions with count-trailing-
+      zeros, so short frames do not pay a search call each.
+
+    Invariants:
+    - Never reads outside [begin, end); the final partial block is scanned
+      bytewise.
+    - next() returns delimiter offsets in increasing order, then SIZE_MAX.
+*/
+namespace host
+{
+    class DelimScanner
+    {
+    public:
+        DelimScanner(const uint8_t *begin, const uint8_t *end)
+            : begin_(begin), end_(end), block_(begin), mask_(0)
+        {
+            refill();
+        }
+
+        // Offset of the next delimiter from begin, or SIZE_MAX when none remain.
+        size_t next()
+        {
+            while (mask_ == 0)
+            {
+                if (block_ >= end_)
+                    return SIZE_MAX;
+                refill();
+            }
+            unsigned bit = (unsigned)__builtin_ctzll(mask_);
+            mask_ &= mask_ - 1;
+            return (size_t)(block_ - 64 - begin_) + bit;
+        }
+
+    private:
+        static const uint8_t DELIM = 0x00;
+
+        // Scan the 64 bytes at block_ into mask_ and advance block_.
+        void refill()
+        {
+            const uint8_t *p = block_;
+            if (end_ - p >= 64)
+            {
+                mask_ = mask64(p);
+            }
+            else
+            {
+                mask_ = 0;
+                for (ptrdiff_t i = 0; i < end_ - p; i++)
+                {
+                    if (p[i] == DELIM)
+                        mask_ |= 1ull << i;
+                }
+            }
+            block_ = p + 64;
+        }
+
+        static uint64_t mask64(const uint8_t *p)
+        {
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            uint64_t m0 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 0)), zero));
+            uint64_t m1 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), zero));
+            uint64_t m2 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), zero));
+            uint64_t m3 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), zero));
+            return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+#elif defined(__ARM_NEON)
+            // Weight each matching lane by its bit and sum each half.
+            static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+            const uint8x16_t w = vld1q_u8(weights);
+            uint64_t mask = 0;
+            for (int k = 0; k < 4; k++)
+            {
+                uint8x16_t bits = vandq_u8(vceqzq_u8(vld1q_u8(p + 16 * k)), w);
+                uint64_t lo = vaddv_u8(vget_low_u8(bits));
+                uint64_t hi = vaddv_u8(vget_high_u8(bits));
+                mask |= (lo | (hi << 8)) << (16 * k);
+            }
+            return mask;
+#else
+            uint64_t mask = 0;
+            for (int i = 0; i < 64; i++)
+            {
+                if (p[i] == DELIM)
+                    mask |= 1ull << i;
+            }
+            return mask;
+#endif
+        }
+
+        const uint8_t *begin_;
+        const uint8_t *end_;
+        const uint8_t *block_; // one past the block mask_ describes
+        uint64_t mask_;
+    };
+} // namespace host
@@ -0,0 +1,100 @@
+// mapped_file.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+    Read-Only Memory-Mapped File
+
+    Responsibilities:
+    - Map a whole capture file so the decoder reads it in place, with no
+      read() copies and no buffer management.
+    - Hint the kernel that access is sequential so readahead keeps up.
+
+    Invariants:
+    - data() is NULL (and size() 0) when the file could not be mapped or is
+      empty; callers check ok().
+    - The mapping lives until the object is destroyed.
+*/
+namespace host
+{
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const char *path)
+        {
+#if defined(_WIN32)
+            file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (file_ == INVALID_HANDLE_VALUE)
+                return;
+            LARGE_INTEGER sz;
+            if (!GetFileSizeEx(file_, &sz) || sz.QuadPart == 0)
+                return;
+            map_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (map_ == NULL)
+                return;
+            void *p = MapViewOfFile(map_, FILE_MAP_READ, 0, 0, 0);
+            if (p == NULL)
+                return;
+            data_ = static_cast<const uint8_t *>(p);
+            size_ = (size_t)sz.QuadPart;
+#else
+            int fd = open(path, O_RDONLY);
+            if (fd < 0)
+                return;
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED)
+                {
+                    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+                    data_ = static_cast<const uint8_t *>(p);
+                    size_ = (size_t)st.st_size;
+                }
+            }
+            close(fd); // the mapping keeps its own reference
+#endif
+        }
+
+        ~MappedFile()
+        {
+#if defined(_WIN32)
+            if (data_ != NULL)
+                UnmapViewOfFile(data_);
+            if (map_ != NULL)
+                CloseHandle(map_);
+            if (file_ != INVALID_HANDLE_VALUE)
+                CloseHandle(file_);
+#else
+            if (data_ != NULL)
+                munmap(const_cast<uint8_t *>(data_), size_);
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool ok() const { return data_ != NULL; }
+        const uint8_t *data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        const uint8_t *data_ = NULL;
+        size_t size_ = 0;
+#if defined(_WIN32)
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE map_ = NULL;
+#endif
+    };
+} // namespace host
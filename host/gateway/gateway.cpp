@@ -0,0 +1,237 @@
+// gateway.cpp
+#include "gateway.h"
+
+#include <arpa/inet.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace host
+{
+    Gateway::Gateway(const GatewayConfig &cfg)
+        : batch_(cfg.batch == 0 ? 1 : (cfg.batch > GATEWAY_MAX_BATCH ? GATEWAY_MAX_BATCH : cfg.batch))
+    {
+        buf_.resize((size_t)batch_ * GATEWAY_MAX_DATAGRAM);
+        msgs_.resize(batch_);
+        iov_.resize(batch_);
+        from_.resize(batch_);
+        for (unsigned i = 0; i < batch_; i++)
+        {
+            iov_[i].iov_base = &buf_[(size_t)i * GATEWAY_MAX_DATAGRAM];
+            iov_[i].iov_len = GATEWAY_MAX_DATAGRAM;
+            msghdr &h = msgs_[i].msg_hdr;
+            memset(&h, 0, sizeof(h));
+            h.msg_iov = &iov_[i];
+            h.msg_iovlen = 1;
+            h.msg_name = &from_[i];
+        }
+
+        fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd_ < 0)
+            return;
+
+        // Past net.core.rmem_max only with CAP_NET_ADMIN; otherwise capped.
+        int rcvbuf = cfg.rcvbuf_bytes;
+        if (setsockopt(fd_, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) != 0)
+            setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(cfg.port);
+        socklen_t addr_len = sizeof(addr);
+        if (inet_pton(AF_INET, cfg.bind_addr, &addr.sin_addr) != 1 ||
+            bind(fd_, (const sockaddr *)&addr, sizeof(addr)) != 0 ||
+            getsockname(fd_, (sockaddr *)&addr, &addr_len) != 0)
+        {
+            close(fd_);
+            fd_ = -1;
+            return;
+        }
+        port_ = ntohs(addr.sin_port);
+
+        epfd_ = epoll_create1(EPOLL_CLOEXEC);
+        wakefd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epfd_ < 0 || wakefd_ < 0)
+            return;
+
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd_;
+        epoll_ctl(epfd_, EPOLL_CTL_ADD, fd_, &ev);
+        ev.data.fd = wakefd_;
+        epoll_ctl(epfd_, EPOLL_CTL_ADD, wakefd_, &ev);
+    }
+
+    Gateway::~Gateway()
+    {
+        if (fd_ >= 0)
+            close(fd_);
+        if (epfd_ >= 0)
+            close(epfd_);
+        if (wakefd_ >= 0)
+            close(wakefd_);
+    }
+
+    size_t Gateway::poll(int timeout_ms)
+    {
+        if (!ok())
+            return 0;
+
+        epoll_event ev[2];
+        int n = epoll_wait(epfd_, ev, 2, timeout_ms);
+        size_t handled = 0;
+        for (int i = 0; i < n; i++)
+        {
+            if (ev[i].data.fd == wakefd_)
+            {
+                uint64_t count;
+                if (read(wakefd_, &count, sizeof(count)) < 0)
+                    continue; // already reset by an earlier poll
+            }
+            else
+            {
+                stats_.wakeups++;
+                handled += drain();
+            }
+        }
+        return handled;
+    }
+
+    void Gateway::wake()
+    {
+        uint64_t one = 1;
+        if (wakefd_ >= 0 && write(wakefd_, &one, sizeof(one)) < 0)
+            return; // counter saturated: a wake is pending anyway
+    }
+
+    // Take datagrams batch_ at a time until a call comes back short: the
+    // socket is empty, so the next epoll_wait() would block.
+    size_t Gateway::drain()
+    {
+        size_t handled = 0;
+        for (;;)
+        {
+            for (unsigned i = 0; i < batch_; i++)
+                msgs_[i].msg_hdr.msg_namelen = sizeof(from_[i]); // the kernel overwrites it
+
+            int got = recvmmsg(fd_, msgs_.data(), batch_, MSG_DONTWAIT, NULL);
+            stats_.recv_calls++;
+            if (got <= 0)
+                return handled;
+
+            for (int i = 0; i < got; i++)
+            {
+                if (msgs_[i].msg_hdr.msg_flags & MSG_TRUNC)
+                {
+                    stats_.truncated++;
+                    continue;
+                }
+                handle(&buf_[(size_t)i * GATEWAY_MAX_DATAGRAM], msgs_[i].msg_len, from_[i]);
+            }
+            handled += (size_t)got;
+            if ((unsigned)got < batch_)
+                return handled;
+        }
+    }
+
+    void Gateway::handle(const uint8_t *data, size_t len, const sockaddr_in &from)
+    {
+        stats_.datagrams++;
+        stats_.bytes += len;
+
+        pkt_dgram_t h;
+        if (!pkt_dgram_header_unpack(data, len, &h))
+        {
+            stats_.foreign++;
+            return;
+        }
+
+        if (h.node >= nodes_.size())
+            nodes_.resize((size_t)h.node + 1);
+        std::unique_ptr<NodeStats> &slot = nodes_[h.node];
+        bool first = !slot;
+        if (first)
+        {
+            slot.reset(new NodeStats());
+            node_count_++;
+        }
+
+        NodeStats *n = slot.get();
+        n->addr = from;
+        n->bytes += len;
+        n->seq.track(h.seq);
+        if (first && on_node)
+            on_node(h.node);
+        parse(h.node, n, data + PKT_DGRAM_HEADER_SIZE, len - PKT_DGRAM_HEADER_SIZE);
+    }
+
+    // Messages in a datagram: frames are 00 <cobs> 00, anything else is a
+    // text line up to "\r\n" (or a delimiter, or the end of the datagram).
+    void Gateway::parse(uint16_t id, NodeStats *n, const uint8_t *p, size_t len)
+    {
+        size_t i = 0;
+        while (i < len)
+        {
+            if (p[i] == PKT_FRAME_DELIM)
+            {
+                while (i < len && p[i] == PKT_FRAME_DELIM)
+                    i++;
+                if (i == len)
+                    break;
+                const uint8_t *end = (const uint8_t *)memchr(p + i, PKT_FRAME_DELIM, len - i);
+                size_t frame_len = end != NULL ? (size_t)(end - (p + i)) : len - i;
+
+                pkt_t pkt;
+                if (pkt_decode(p + i, frame_len, scratch_, sizeof(scratch_), &pkt))
+                {
+                    n->frames++;
+                    if (on_packet)
+                        on_packet(id, &pkt);
+                }
+                else
+                {
+                    n->bad_frames++;
+                }
+                i += frame_len + (end != NULL ? 1 : 0);
+                continue;
+            }
+
+            size_t start = i;
+            while (i < len && p[i] != '\n' && p[i] != PKT_FRAME_DELIM)
+                i++;
+            size_t line_len = i - start;
+            if (line_len > 0 && p[start + line_len - 1] == '\r')
+                line_len--;
+            if (i < len && p[i] == '\n')
+                i++;
+            n->lines++;
+            if (on_line)
+                on_line(id, (const char *)p + start, line_len);
+        }
+    }
+
+    bool Gateway::send_command(uint16_t node, const char *line)
+    {
+        const NodeStats *n = this->node(node);
+        if (n == NULL || line == NULL || fd_ < 0)
+            return false;
+
+        size_t len = strlen(line);
+        iovec iov[2] = {{(void *)line, len}, {(void *)"\n", 1}};
+        msghdr h;
+        memset(&h, 0, sizeof(h));
+        h.msg_name = (void *)&n->addr;
+        h.msg_namelen = sizeof(n->addr);
+        h.msg_iov = iov;
+        h.msg_iovlen = 2;
+        return sendmsg(fd_, &h, 0) == (ssize_t)(len + 1);
+    }
+
+    const NodeStats *Gateway::node(uint16_t id) const
+    {
+        return id < nodes_.size() ? nodes_[id].get() : NULL;
+    }
+} // namespace host
@@ -0,0 +1,125 @@
+// gateway.h
+#pragma once
+#include <netinet/in.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "packet.h"
+#include "seq_tracker.h"
+
+/*
+    Multi-Node UDP Gateway
+
+    Responsibilities:
+    - Collect the datagrams of many nodes (firmware HalUdp, APP_TRANSPORT_UDP)
+      on one UDP socket: epoll for readiness, then recvmmsg() to take up to
+      batch datagrams per system call until the socket is drained.
+    - Tell nodes apart by the datagram header (packet.h), keep a SeqTracker
+      per node for loss, reordering and duplicates, and split each datagram
+      into its messages: frames go through pkt_decode() (the firmware
+      protocol library) to on_packet, text lines to on_line.
+    - Send command lines back to a node at the address it last sent from.
+
+    Invariants:
+    - Single-threaded: poll() does all the work on the calling thread; only
+      wake() may be called from another thread, to end a poll() early.
+    - Datagrams carry whole messages (HalUdp never splits one), so each is
+      parsed on its own and no per-node reassembly state is kept.
+    - Datagrams are handled in arrival order; reordering is counted, not
+      undone.
+    - Node slots are allocated on first contact and indexed directly by
+      node id; steady-state ingestion does not allocate.
+*/
+// Datagrams one recvmmsg() call can take, and the receive buffer per
+// datagram (larger than UDP_DATAGRAM_SIZE, so truncation means a foreign
+// sender).
+#define GATEWAY_MAX_BATCH 256u
+#define GATEWAY_MAX_DATAGRAM 2048u
+
+namespace host
+{
+    struct GatewayConfig
+    {
+        const char *bind_addr = "0.0.0.0";
+        uint16_t port = 47000;           // 0: any free port (see Gateway::port())
+        unsigned batch = 64;             // datagrams per recvmmsg(), 1..GATEWAY_MAX_BATCH
+        int rcvbuf_bytes = 4 * 1024 * 1024; // socket receive buffer (the kernel may cap it)
+    };
+
+    struct NodeStats
+    {
+        SeqTracker seq;
+        uint64_t bytes = 0;      // datagram bytes, headers included
+        uint64_t frames = 0;     // frames that decoded
+        uint64_t bad_frames = 0; // frames that did not (CRC, COBS, length)
+        uint64_t lines = 0;
+        sockaddr_in addr;        // source of its latest datagram
+    };
+
+    struct GatewayStats
+    {
+        uint64_t datagrams = 0;
+        uint64_t bytes = 0;
+        uint64_t wakeups = 0;    // epoll_wait() returns with the socket readable
+        uint64_t recv_calls = 0; // recvmmsg() calls, including the last, short one
+        uint64_t foreign = 0;    // datagrams without a valid header
+        uint64_t truncated = 0;  // longer than GATEWAY_MAX_DATAGRAM
+    };
+
+    class Gateway
+    {
+    public:
+        explicit Gateway(const GatewayConfig &cfg);
+        ~Gateway();
+
+        Gateway(const Gateway &) = delete;
+        Gateway &operator=(const Gateway &) = delete;
+
+        // False if the socket could not be set up; poll() then returns 0.
+        bool ok() const { return fd_ >= 0 && epfd_ >= 0 && wakefd_ >= 0; }
+        uint16_t port() const { return port_; }
+
+        // Wait up to timeout_ms (-1: forever) for datagrams, then take all
+        // that are queued. Returns the number of datagrams handled.
+        size_t poll(int timeout_ms);
+
+        // End the current (or next) poll() early. Thread-safe.
+        void wake();
+
+        // Send line (a newline is added) to a node heard from before.
+        bool send_command(uint16_t node, const char *line);
+
+        const NodeStats *node(uint16_t id) const;
+        size_t nodes() const { return node_count_; } // nodes heard from
+        const GatewayStats &stats() const { return stats_; }
+
+        std::function<void(uint16_t node)> on_node; // first datagram of a node
+        std::function<void(uint16_t node, const pkt_t *pkt)> on_packet;
+        std::function<void(uint16_t node, const char *line, size_t len)> on_line;
+
+    private:
+        size_t drain();
+        void handle(const uint8_t *data, size_t len, const sockaddr_in &from);
+        void parse(uint16_t id, NodeStats *n, const uint8_t *p, size_t len);
+
+        int fd_ = -1;
+        int epfd_ = -1;
+        int wakefd_ = -1;
+        uint16_t port_ = 0;
+        unsigned batch_;
+
+        std::vector<uint8_t> buf_; // batch_ datagram buffers
+        std::vector<mmsghdr> msgs_;
+        std::vector<iovec> iov_;
+        std::vector<sockaddr_in> from_;
+
+        std::vector<std::unique_ptr<NodeStats>> nodes_; // by node id
+        size_t node_count_ = 0;
+        GatewayStats stats_;
+        uint8_t scratch_[PKT_MAX_RAW];
+    };
+} // namespace host
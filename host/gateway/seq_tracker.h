@@ -0,0 +1,121 @@
+// seq_tracker.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    Per-Node Datagram Sequence Tracking
+
+    Responsibilities:
+    - Follow one node's datagram seq (packet.h, PKT_DGRAM_HEADER_SIZE) and
+      tell in-order, reordered, duplicate and lost datagrams apart, the way
+      RTP receivers and IPsec replay windows do: a bitmap of the last
+      SEQ_WINDOW seqs below the highest one seen.
+    - Count a datagram lost only once it falls out of the window unseen;
+      holes still inside the window are missing(), since a late datagram
+      may yet fill them.
+
+    Invariants:
+    - Seqs compare with serial-number arithmetic, so the 32-bit wrap is
+      seamless.
+    - A datagram older than the window that was already counted lost is
+      counted late and taken back out of lost; one further back than
+      SEQ_RESTART_GAP means the node rebooted and restarts tracking (a
+      reboot within its first SEQ_RESTART_GAP datagrams looks like
+      duplicates and late datagrams until the seq passes the old one).
+    - received counts distinct datagrams; received + lost() is the number
+      of seqs the node has used since the (last) start.
+    - O(1) per datagram, no allocation.
+*/
+#define SEQ_WINDOW 64u
+#define SEQ_RESTART_GAP 1024u
+
+namespace host
+{
+    struct SeqTracker
+    {
+        bool started = false;
+        uint32_t highest = 0; // highest seq seen
+        uint64_t window = 0;  // bit k: highest - k was received
+        uint64_t received = 0;
+        uint64_t dropped = 0;    // fell out of the window unseen
+        uint64_t reordered = 0;  // arrived after a higher seq, still in time
+        uint64_t late = 0;       // arrived after being counted lost
+        uint64_t duplicates = 0;
+        uint32_t restarts = 0;
+
+        void track(uint32_t seq)
+        {
+            if (!started)
+            {
+                start(seq);
+                return;
+            }
+
+            int32_t d = (int32_t)(seq - highest);
+            if (d > 0)
+            {
+                // Everything shifted out of the window unseen is lost.
+                if ((uint32_t)d >= SEQ_WINDOW)
+                {
+                    dropped += (uint64_t)__builtin_popcountll(~window) + ((uint32_t)d - SEQ_WINDOW);
+                    window = 1;
+                }
+                else
+                {
+                    dropped += (uint64_t)__builtin_popcountll(~window & (~0ull << (SEQ_WINDOW - (uint32_t)d)));
+                    window = (window << d) | 1u;
+                }
+                highest = seq;
+                received++;
+                return;
+            }
+
+            uint32_t back = highest - seq;
+            if (back == 0)
+            {
+                duplicates++;
+            }
+            else if (back >= SEQ_RESTART_GAP)
+            {
+                dropped += missing();
+                restarts++;
+                start(seq);
+            }
+            else if (back >= SEQ_WINDOW)
+            {
+                // Counted lost when it left the window (a duplicate of an
+                // old one cannot be told apart here and is taken as late).
+                late++;
+                if (dropped > 0)
+                    dropped--;
+                received++;
+            }
+            else if (window & (1ull << back))
+            {
+                duplicates++;
+            }
+            else
+            {
+                window |= 1ull << back;
+                reordered++;
+                received++;
+            }
+        }
+
+        // Holes still inside the window.
+        uint64_t missing() const { return started ? (uint64_t)__builtin_popcountll(~window) : 0; }
+
+        // Lost for good plus still missing.
+        uint64_t lost() const { return dropped + missing(); }
+
+    private:
+        void start(uint32_t seq)
+        {
+            started = true;
+            highest = seq;
+            window = ~0ull; // nothing before the first datagram is missing
+            received++;
+        }
+    };
+} // namespace host
@@ -0,0 +1,32 @@
+// bench_common.h
+#pragma once
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+    Native benchmark helpers
+
+    Responsibilities:
+    - Provide a monotonic wall clock for timing native benchmarks.
+    - Keep the compiler from optimizing away benchmarked work.
+
+    Invariants:
+    - Benchmarks are plain executables; they are not registered with CTest.
+*/
+namespace bench
+{
+    inline uint64_t now_ns()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // Forces value to be materialized so the work producing it is kept.
+    template <typename T>
+    inline void do_not_optimize(const T &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+} // namespace bench
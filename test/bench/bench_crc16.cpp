@@ -0,0 +1,95 @@
+// bench_crc16.cpp
+//
+// Native benchmark: CRC16 throughput (MB/s) for each engine across buffer
+// sizes, cross-checked against the bitwise reference.
+#include <string.h>
+#include <vector>
+#include "bench_common.h"
+#include "crc16.h"
+
+typedef uint16_t (*crc16_update_fn)(uint16_t crc, const uint8_t *data, size_t len);
+
+struct Engine
+{
+    const char *name;
+    crc16_update_fn update;
+};
+
+static const Engine k_engines[] = {
+    {"bitwise", crc16_update_bitwise},
+    {"table", crc16_update_table},
+    {"slice4", crc16_update_slice4},
+    {"slice8", crc16_update_slice8},
+};
+
+int main()
+{
+    const size_t sizes[] = {16, 64, 256, 4096, 65536};
+    const size_t total_bytes = 64u * 1024u * 1024u; // processed per engine and size
+
+    std::vector<uint8_t> buf(65536 + 7);
+    uint32_t x = 0x12345678;
+    for (auto &b : buf)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        b = (uint8_t)x;
+    }
+
+    int mismatches = 0;
+
+    // Cross-check every engine on unaligned starts and odd lengths first.
+    for (size_t off = 0; off < 8; off++)
+    {
+        for (size_t len = 0; len < 2048; len += 13)
+        {
+            uint16_t ref = crc16_update_bitwise(crc16_init(), &buf[off], len);
+            for (const Engine &e : k_engines)
+            {
+                if (e.update(crc16_init(), &buf[off], len) != ref)
+                {
+                    printf("MISMATCH %s off=%zu len=%zu\n", e.name, off, len);
+                    mismatches++;
+                }
+            }
+        }
+    }
+
+    printf("%-8s", "size");
+    for (const Engine &e : k_engines)
+        printf("%12s", e.name);
+    printf("   (MB/s)\n");
+
+    for (size_t size : sizes)
+    {
+        printf("%-8zu", size);
+        for (const Engine &e : k_engines)
+        {
+            size_t iters = total_bytes / size;
+            if (e.update == crc16_update_bitwise)
+                iters /= 8; // reference is slow; keep the run short
+
+            uint16_t crc = crc16_init();
+            uint64_t start = bench::now_ns();
+            for (size_t i = 0; i < iters; i++)
+            {
+                crc = e.update(crc, &buf[i & 7], size);
+            }
+            uint64_t elapsed = bench::now_ns() - start;
+            bench::do_not_optimize(crc);
+
+            double mb = (double)(iters * size) / (1024.0 * 1024.0);
+            printf("%12.1f", mb / ((double)elapsed / 1e9));
+        }
+        printf("\n");
+    }
+
+    printf("selected engine: CRC16_IMPL=%d\n", CRC16_IMPL);
+    if (mismatches)
+    {
+        printf("FAILED: %d mismatches against reference\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
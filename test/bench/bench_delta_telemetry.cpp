@@ -0,0 +1,158 @@
+// bench_delta_telemetry.cpp
+//
+// Native benchmark: compression ratio and encode cost of delta + zig-zag
+// varint telemetry records against the fixed 4-bytes-per-field layout, on
+// simulated traces:
+//   status   - the current record (state, periods, fault count), mostly idle
+//   sensors  - status plus 4 simulated ADC channels (HalSensorSim), changing
+//              every record
+// Sizes are reported for the payload alone and for the complete wire frame
+// (header, CRC, COBS and delimiters), for several keyframe intervals.
+#include <string.h>
+#include <vector>
+#include "bench_common.h"
+#include "hal/sensor/sim_sensor.h"
+#include "packet.h"
+
+static const size_t k_records = 200000;
+
+struct Trace
+{
+    const char *name;
+    size_t fields;
+    std::vector<uint32_t> data; // k_records * fields
+};
+
+static Trace make_status_trace()
+{
+    Trace t = {"status", PKT_TELEMETRY_FIELDS, {}};
+    uint32_t state = 1, faults = 0, period = 1000;
+    uint32_t x = 0x2545F491;
+    for (size_t i = 0; i < k_records; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        if (x % 500 == 0)
+            state = 1 + (x >> 8) % 3; // ARM / DISARM / FAULT now and then
+        if (state == 3 && x % 7 == 0)
+            faults++;
+        if (x % 5000 == 1)
+            period = 100 + (x >> 12) % 1000; // RATE changes are rare
+        const uint32_t rec[] = {state, period, 2000, faults};
+        t.data.insert(t.data.end(), rec, rec + PKT_TELEMETRY_FIELDS);
+    }
+    return t;
+}
+
+static Trace make_sensor_trace()
+{
+    Trace t = {"sensors", PKT_TELEMETRY_FIELDS + 4, {}};
+    Trace status = make_status_trace();
+    hal::sensor::HalSensorSim sim(4);
+    sim.hal_sensor_init();
+    for (size_t i = 0; i < k_records; i++)
+    {
+        t.data.insert(t.data.end(), &status.data[i * PKT_TELEMETRY_FIELDS], &status.data[(i + 1) * PKT_TELEMETRY_FIELDS]);
+        for (uint8_t ch = 0; ch < 4; ch++)
+        {
+            int32_t v = 0;
+            sim.hal_sensor_read(ch, &v);
+            t.data.push_back((uint32_t)v);
+        }
+    }
+    return t;
+}
+
+// Fixed layout: one byte of state, 4 bytes per other field.
+static size_t pack_fixed(const uint32_t *f, size_t n, uint8_t *out)
+{
+    out[0] = (uint8_t)f[0];
+    size_t o = 1;
+    for (size_t i = 1; i < n; i++, o += 4)
+    {
+        out[o] = (uint8_t)f[i];
+        out[o + 1] = (uint8_t)(f[i] >> 8);
+        out[o + 2] = (uint8_t)(f[i] >> 16);
+        out[o + 3] = (uint8_t)(f[i] >> 24);
+    }
+    return o;
+}
+
+static size_t frame_len(uint8_t type, uint16_t seq, const uint8_t *payload, size_t len)
+{
+    pkt_t pkt = {type, seq, (uint64_t)seq * 1000000u, payload, len};
+    uint8_t frame[PKT_MAX_FRAME];
+    return pkt_encode(&pkt, frame, sizeof(frame));
+}
+
+static void run(const Trace &t)
+{
+    uint8_t payload[PKT_DELTA_MAX_PAYLOAD + 32];
+
+    // Fixed-layout baseline.
+    uint64_t fixed_payload = 0, fixed_wire = 0;
+    uint64_t start = bench::now_ns();
+    for (size_t i = 0; i < k_records; i++)
+        fixed_payload += pack_fixed(&t.data[i * t.fields], t.fields, payload);
+    double fixed_ns = (double)(bench::now_ns() - start) / k_records;
+    bench::do_not_optimize(fixed_payload);
+    for (size_t i = 0; i < k_records; i++)
+    {
+        size_t n = pack_fixed(&t.data[i * t.fields], t.fields, payload);
+        fixed_wire += frame_len(PKT_TYPE_TELEMETRY, (uint16_t)i, payload, n);
+    }
+
+    printf("%-8s %-10s %9.2f %9.2f %7s %7s %10.1f\n", t.name, "fixed", (double)fixed_payload / k_records,
+           (double)fixed_wire / k_records, "1.00", "1.00", fixed_ns);
+
+    const uint16_t intervals[] = {1, 8, 32, 128};
+    for (uint16_t interval : intervals)
+    {
+        pkt_delta_t enc;
+        pkt_delta_init(&enc, interval);
+        uint64_t delta_payload = 0;
+        start = bench::now_ns();
+        for (size_t i = 0; i < k_records; i++)
+        {
+            bool key;
+            delta_payload += pkt_delta_encode(&enc, &t.data[i * t.fields], t.fields, payload, sizeof(payload), &key);
+        }
+        double delta_ns = (double)(bench::now_ns() - start) / k_records;
+        bench::do_not_optimize(delta_payload);
+
+        // Second pass for wire size, cross-checked through the decoder.
+        pkt_delta_t rx;
+        pkt_delta_init(&enc, interval);
+        pkt_delta_init(&rx, 1);
+        uint64_t delta_wire = 0;
+        size_t mismatches = 0;
+        for (size_t i = 0; i < k_records; i++)
+        {
+            bool key;
+            size_t n = pkt_delta_encode(&enc, &t.data[i * t.fields], t.fields, payload, sizeof(payload), &key);
+            delta_wire += frame_len(key ? PKT_TYPE_TELEMETRY_KEY : PKT_TYPE_TELEMETRY_DELTA, (uint16_t)i, payload, n);
+
+            uint32_t out[PKT_DELTA_MAX_FIELDS];
+            if (!pkt_delta_decode(&rx, key, (uint16_t)i, payload, n, out, t.fields) ||
+                memcmp(out, &t.data[i * t.fields], t.fields * sizeof(uint32_t)) != 0)
+                mismatches++;
+        }
+
+        char label[16];
+        snprintf(label, sizeof(label), "delta/%u", (unsigned)interval);
+        printf("%-8s %-10s %9.2f %9.2f %7.2f %7.2f %10.1f%s\n", t.name, label, (double)delta_payload / k_records,
+               (double)delta_wire / k_records, (double)fixed_payload / (double)delta_payload,
+               (double)fixed_wire / (double)delta_wire, delta_ns, mismatches ? "  DECODE MISMATCH" : "");
+    }
+}
+
+int main()
+{
+    printf("%-8s %-10s %9s %9s %7s %7s %10s\n", "trace", "encoding", "payload", "wire", "ratio", "wire", "ns/rec");
+    printf("%-8s %-10s %9s %9s %7s %7s %10s\n", "", "", "B/rec", "B/rec", "payload", "ratio", "encode");
+    run(make_status_trace());
+    run(make_sensor_trace());
+    printf("115200 baud ~ 11520 B/s: records/s = 11520 / wire B/rec\n");
+    return 0;
+}
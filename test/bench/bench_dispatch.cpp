@@ -0,0 +1,112 @@
+// bench_dispatch.cpp
+//
+// Native benchmark: commands/sec for a linear strcmp chain (the original
+// app_handle_command() structure) versus util::CmdTable, with 10, 50 and
+// 200 registered commands.
+#include <string.h>
+#include "bench_common.h"
+#include "cmd_dispatch.h"
+
+struct Ctx
+{
+    uint32_t hits;
+};
+
+static void handler(Ctx *ctx, const char *args)
+{
+    ctx->hits += (uint32_t)(args[0] != '\0') + 1;
+}
+
+// Command names shaped like real ones: short upper-case words, with shared
+// prefixes so strcmp cannot reject on the first character.
+static char g_names[200][16];
+
+static void make_names()
+{
+    static const char *stems[] = {"SET", "GET", "CAL", "LOG", "SENS", "CFG", "NET", "PWR"};
+    for (int i = 0; i < 200; i++)
+    {
+        snprintf(g_names[i], sizeof(g_names[i]), "%s%c%d", stems[i % 8], 'A' + (i / 8) % 26, i);
+    }
+}
+
+template <size_t N>
+static void run(const char *const *lines, size_t line_count, uint32_t iterations)
+{
+    static util::CmdEntry<Ctx> entries[N];
+    for (size_t i = 0; i < N; i++)
+    {
+        entries[i] = {g_names[i], "", true, handler};
+    }
+    static const util::CmdTable<Ctx, N> table(entries);
+
+    Ctx ctx = {0};
+
+    // Linear chain: tokenize, then strcmp against each registered name in turn.
+    uint64_t start = bench::now_ns();
+    for (uint32_t it = 0; it < iterations; it++)
+    {
+        const char *line = lines[it % line_count];
+        util::cmd_token_t name = {nullptr, 0};
+        const char *args = "";
+        char token[16];
+        if (!util::cmd_split(line, &name, &args) || name.len >= sizeof(token))
+            continue; // blank, or longer than any registered name
+
+        memcpy(token, name.ptr, name.len);
+        token[name.len] = '\0';
+        for (size_t i = 0; i < N; i++)
+        {
+            if (strcmp(token, g_names[i]) == 0)
+            {
+                handler(&ctx, args);
+                break;
+            }
+        }
+    }
+    uint64_t chain_ns = bench::now_ns() - start;
+
+    start = bench::now_ns();
+    for (uint32_t it = 0; it < iterations; it++)
+    {
+        table.dispatch(&ctx, lines[it % line_count]);
+    }
+    uint64_t table_ns = bench::now_ns() - start;
+    bench::do_not_optimize(ctx.hits);
+
+    printf("%4zu commands  chain %12.0f cmd/s  table %12.0f cmd/s  speedup %5.1fx  max probe %zu\n",
+           N,
+           iterations / ((double)chain_ns / 1e9),
+           iterations / ((double)table_ns / 1e9),
+           (double)chain_ns / (double)table_ns,
+           table.max_probe());
+}
+
+template <size_t N>
+static void run_uniform(uint32_t iterations)
+{
+    // Every registered command equally often, with an argument.
+    static char storage[N][24];
+    static const char *lines[N];
+    for (size_t i = 0; i < N; i++)
+    {
+        int n = snprintf(storage[i], sizeof(storage[i]), "%s 42", g_names[i]);
+        if (n < 0 || (size_t)n >= sizeof(storage[i]))
+        {
+            printf("command line too long: %s\n", g_names[i]);
+            return;
+        }
+        lines[i] = storage[i];
+    }
+    run<N>(lines, N, iterations);
+}
+
+int main()
+{
+    make_names();
+    const uint32_t iterations = 2000000;
+    run_uniform<10>(iterations);
+    run_uniform<50>(iterations);
+    run_uniform<200>(iterations);
+    return 0;
+}
@@ -0,0 +1,136 @@
+// bench_dual_core.cpp
+//
+// Native benchmark: loop passes/sec with acquisition and command/TX work on
+// one thread versus split across two threads (the RP2350 dual-core mode).
+// Each pass is one simulated millisecond: core1 samples 32 channels and
+// frames telemetry every 10 ms; core0 handles one STATUS command and
+// forwards queued telemetry.
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include "bench_common.h"
+#include "app.h"
+#include "acq/acquisition.h"
+#include "hal/sensor/sim_sensor.h"
+
+class NullLed : public hal::led::IHalLed {
+public:
+    void hal_led_init() override {}
+    void hal_led_set(bool) override {}
+    void hal_led_toggle() override {}
+};
+
+class NullTime : public hal::time::IHalTime {
+public:
+    uint32_t hal_millis() override { return 0; }
+    uint32_t hal_micros() override { return 0; }
+    void hal_sleep_until(uint64_t) override {}
+    void hal_wake() override {}
+};
+
+// Counts bytes that would go out on the link.
+class CountingSerial : public hal::serial::ISerialIo {
+public:
+    uint64_t bytes = 0;
+    bool serial_readline(char *, size_t) override { return false; }
+    void hal_serial_print(const char *str) override { bytes += strlen(str); }
+    void hal_serial_write(const uint8_t *data, size_t len) override {
+        bench::do_not_optimize(data[0]);
+        bytes += len;
+    }
+    size_t hal_serial_flush(size_t) override { return 0; }
+    bool hal_serial_pending() override { return false; }
+};
+
+class CountingLogger : public hal::logging::ILogger {
+public:
+    CountingSerial *serial = nullptr;
+    void log(const char *message) override { serial->bytes += strlen(message) + 2; }
+};
+
+static const uint8_t CHANNELS = 32;
+static acq::acq_t g_acq;
+static sensors::sensor_registry_t g_sensors;
+
+struct Result {
+    double passes_per_sec;
+    uint32_t records;
+    uint32_t dropped;
+};
+
+static Result run(bool two_threads, uint32_t passes)
+{
+    NullLed led;
+    NullTime time;
+    CountingSerial serial;
+    CountingLogger logger;
+    logger.serial = &serial;
+    hal::sensor::HalSensorSim sim(CHANNELS);
+    app::app_t app;
+
+    acq::acq_msg_t msg;
+    while (g_acq.out.pop(msg))
+    {
+    }
+    sensors::sensor_registry_init(&g_sensors);
+    for (uint8_t ch = 0; ch < CHANNELS; ch++)
+    {
+        sensors::sensor_registry_add(&g_sensors, &sim, ch, 1, 0);
+    }
+    app::app_init(&app, 0, &led, &time, &serial, &logger);
+    app::app_handle_command(&app, "TELEMETRY BINARY");
+    app::app_handle_command(&app, "RATE 10");
+    app::app_offload_acquisition(&app, &g_acq.config);
+    acq::acq_init(&g_acq, 0, &time, &g_sensors);
+
+    uint64_t start = bench::now_ns();
+    if (!two_threads)
+    {
+        for (uint32_t i = 1; i <= passes; i++)
+        {
+            acq::acq_tick(&g_acq, (uint64_t)i * 1000u);
+            app::app_handle_command(&app, "STATUS");
+            acq::acq_drain(&g_acq, &serial, &logger, 4);
+        }
+    }
+    else
+    {
+        std::atomic<bool> done{false};
+        std::thread core1([&]() {
+            for (uint32_t i = 1; i <= passes; i++)
+            {
+                acq::acq_tick(&g_acq, (uint64_t)i * 1000u);
+            }
+            done.store(true, std::memory_order_release);
+        });
+        for (uint32_t i = 0; i < passes || !done.load(std::memory_order_acquire); i++)
+        {
+            if (i < passes)
+                app::app_handle_command(&app, "STATUS");
+            acq::acq_drain(&g_acq, &serial, &logger, 4);
+        }
+        core1.join();
+    }
+    acq::acq_drain(&g_acq, &serial, &logger, (size_t)-1);
+    uint64_t elapsed = bench::now_ns() - start;
+    bench::do_not_optimize(serial.bytes);
+
+    acq::acq_stats_t stats;
+    acq::acq_read_stats(&g_acq, &stats);
+    return Result{passes / ((double)elapsed / 1e9), stats.records, stats.dropped};
+}
+
+int main()
+{
+    const uint32_t passes = 500000;
+    printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+
+    Result one = run(false, passes);
+    Result two = run(true, passes);
+
+    printf("%-8s %14s %10s %10s\n", "cores", "passes/sec", "records", "dropped");
+    printf("%-8s %14.0f %10u %10u\n", "1", one.passes_per_sec, one.records, one.dropped);
+    printf("%-8s %14.0f %10u %10u\n", "2", two.passes_per_sec, two.records, two.dropped);
+    printf("scaling 1 -> 2 cores: %.2fx\n", two.passes_per_sec / one.passes_per_sec);
+    return 0;
+}
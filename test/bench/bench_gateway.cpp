@@ -0,0 +1,224 @@
+// bench_gateway.cpp
+//
+// UDP gateway at scale: 1 to 1000 simulated nodes on loopback, each a
+// firmware HalUdp link over a native socket sending one telemetry frame
+// per datagram, into one gateway (epoll + recvmmsg, per-node seq
+// tracking, every frame CRC-checked).
+// - Live: one sender thread sends as fast as it can for 2 s while the
+//   gateway thread keeps up. Aggregate datagrams/s sent and received, loss
+//   (sent - received, and what the per-node seq trackers saw), CPU ns per
+//   datagram on each side (thread CPU time, so waiting is not counted) and
+//   datagrams per recvmmsg() call. On a single core the two threads take
+//   turns and the gateway wakes for a few datagrams at a time.
+// - Burst: bursts of BURST datagrams land in the socket buffer before the
+//   gateway drains them, so each recvmmsg() call is full: the gateway's
+//   own cost per datagram, independent of scheduling.
+// Both are repeated at 1000 nodes with batch 1 (one datagram per system
+// call) to show what batching saves.
+#include <stdio.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gateway.h"
+#include "hal/transport/hal_datagram_native.h"
+#include "hal/transport/udp_link.h"
+#include "packet.h"
+
+static uint64_t thread_cpu_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+struct Node
+{
+    Node(uint16_t port, uint16_t id) : socket("127.0.0.1", port), link(socket, id) {}
+    hal::transport::HalUdpSocketPosix socket;
+    hal::transport::HalUdp link;
+};
+
+// Datagrams queued per burst; well inside the 4 MiB receive buffer.
+static const int BURST = 2048;
+static const uint64_t BURST_TOTAL = 400000;
+
+static host::GatewayConfig config(unsigned batch)
+{
+    host::GatewayConfig cfg;
+    cfg.bind_addr = "127.0.0.1";
+    cfg.port = 0;
+    cfg.batch = batch;
+    return cfg;
+}
+
+static bool make_nodes(const host::Gateway &gw, int nodes, std::vector<std::unique_ptr<Node>> *out)
+{
+    if (!gw.ok())
+    {
+        printf("gateway: cannot bind\n");
+        return false;
+    }
+    for (int i = 0; i < nodes; i++)
+    {
+        out->emplace_back(new Node(gw.port(), (uint16_t)(i + 1)));
+        if (!out->back()->socket.ok())
+        {
+            printf("%d nodes: cannot open socket %d\n", nodes, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+// The frame a node sends every telemetry period.
+static uint8_t g_frame[PKT_MAX_FRAME];
+static size_t g_frame_len;
+
+static void make_frame()
+{
+    uint8_t payload[PKT_TELEMETRY_PAYLOAD_SIZE];
+    pkt_telemetry_t rec = {1, 1000, 500, 0};
+    pkt_t pkt = {PKT_TYPE_TELEMETRY, 0, 123456, payload, pkt_telemetry_pack(&rec, payload, sizeof(payload))};
+    g_frame_len = pkt_encode(&pkt, g_frame, sizeof(g_frame));
+}
+
+static void send_one(Node *n)
+{
+    n->link.hal_serial_write(g_frame, g_frame_len);
+    n->link.hal_serial_flush(256);
+}
+
+struct Totals
+{
+    uint64_t sent = 0;
+    uint64_t refused = 0;
+    uint64_t tracked_lost = 0;
+    uint64_t reordered = 0;
+};
+
+static Totals totals(const host::Gateway &gw, const std::vector<std::unique_ptr<Node>> &node)
+{
+    Totals t;
+    for (auto &n : node)
+    {
+        t.sent += n->link.stats().datagrams_sent;
+        t.refused += n->link.stats().send_errors;
+        const host::NodeStats *s = gw.node(n->link.node());
+        if (s != NULL)
+        {
+            t.tracked_lost += s->seq.lost();
+            t.reordered += s->seq.reordered;
+        }
+    }
+    return t;
+}
+
+static void run_live(int nodes, unsigned batch, double seconds)
+{
+    host::Gateway gw(config(batch));
+    std::vector<std::unique_ptr<Node>> node;
+    if (!make_nodes(gw, nodes, &node))
+        return;
+
+    uint64_t frames = 0;
+    gw.on_packet = [&frames](uint16_t, const pkt_t *) { frames++; };
+
+    std::atomic<bool> stop{false};
+    uint64_t gw_cpu_ns = 0;
+    std::thread gateway([&]()
+                        {
+        uint64_t t0 = thread_cpu_ns();
+        while (!stop.load(std::memory_order_relaxed))
+            gw.poll(100);
+        while (gw.poll(20) > 0) // what is still queued
+        {
+        }
+        gw_cpu_ns = thread_cpu_ns() - t0; });
+
+    uint64_t send_cpu_ns = thread_cpu_ns();
+    auto t_end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < t_end)
+    {
+        for (int r = 0; r < 16; r++)
+        {
+            for (auto &n : node)
+                send_one(n.get());
+        }
+    }
+    send_cpu_ns = thread_cpu_ns() - send_cpu_ns;
+    stop.store(true);
+    gw.wake();
+    gateway.join();
+
+    Totals t = totals(gw, node);
+    const host::GatewayStats &st = gw.stats();
+    uint64_t received = st.datagrams;
+    printf("live  %4d nodes batch=%-2u sent=%7.0f/s received=%7.0f/s lost=%5.2f%% (seq gaps %llu, reordered %llu, "
+           "refused %llu) gateway=%5.0f ns/dgram sender=%5.0f ns/dgram %5.1f dgrams/recvmmsg\n",
+           nodes, batch, (double)t.sent / seconds, (double)received / seconds,
+           t.sent > 0 ? 100.0 * (double)(t.sent - received) / (double)t.sent : 0.0,
+           (unsigned long long)t.tracked_lost, (unsigned long long)t.reordered, (unsigned long long)t.refused,
+           received > 0 ? (double)gw_cpu_ns / (double)received : 0.0,
+           t.sent > 0 ? (double)send_cpu_ns / (double)t.sent : 0.0,
+           st.recv_calls > 0 ? (double)received / (double)st.recv_calls : 0.0);
+    if (frames != received)
+        printf("  frames decoded %llu != datagrams %llu\n", (unsigned long long)frames,
+               (unsigned long long)received);
+}
+
+static void run_burst(int nodes, unsigned batch)
+{
+    host::Gateway gw(config(batch));
+    std::vector<std::unique_ptr<Node>> node;
+    if (!make_nodes(gw, nodes, &node))
+        return;
+
+    uint64_t frames = 0;
+    gw.on_packet = [&frames](uint16_t, const pkt_t *) { frames++; };
+
+    uint64_t drain_ns = 0;
+    size_t next = 0;
+    while (gw.stats().datagrams < BURST_TOTAL)
+    {
+        for (int i = 0; i < BURST; i++)
+        {
+            send_one(node[next].get());
+            next = next + 1 == node.size() ? 0 : next + 1;
+        }
+        uint64_t t0 = thread_cpu_ns();
+        size_t got = gw.poll(0);
+        drain_ns += thread_cpu_ns() - t0;
+        if (got == 0)
+            break;
+    }
+
+    Totals t = totals(gw, node);
+    const host::GatewayStats &st = gw.stats();
+    uint64_t received = st.datagrams;
+    printf("burst %4d nodes batch=%-2u %llu datagrams lost=%llu (seq gaps %llu) gateway=%5.0f ns/dgram "
+           "(%.2f M dgrams/s of CPU) %5.1f dgrams/recvmmsg\n",
+           nodes, batch, (unsigned long long)received, (unsigned long long)(t.sent - received),
+           (unsigned long long)t.tracked_lost, received > 0 ? (double)drain_ns / (double)received : 0.0,
+           drain_ns > 0 ? (double)received * 1000.0 / (double)drain_ns : 0.0,
+           st.recv_calls > 0 ? (double)received / (double)st.recv_calls : 0.0);
+    if (frames != received)
+        printf("  frames decoded %llu != datagrams %llu\n", (unsigned long long)frames,
+               (unsigned long long)received);
+}
+
+int main()
+{
+    make_frame();
+    const int counts[] = {1, 10, 100, 1000};
+    for (int n : counts)
+        run_live(n, 64, 2.0);
+    run_live(1000, 1, 2.0);
+    for (int n : counts)
+        run_burst(n, 64);
+    run_burst(1000, 1);
+    return 0;
+}
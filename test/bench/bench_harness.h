@@ -0,0 +1,158 @@
+// bench_harness.h
+#pragma once
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "bench_common.h"
+
+/*
+    Benchmark Harness (bench_suite)
+
+    Responsibilities:
+    - Time a case as repeated batches: warm-up batches are discarded, then
+      each repetition times one batch of iterations and yields ns/op.
+    - Report the median and p99 over the repetitions, print them and write
+      them as JSON:
+        {"benchmarks": [{"name": ..., "unit": "ns/op", "iterations": ...,
+                         "reps": ..., "median": ..., "p99": ..., "min": ...}]}
+    - Compare medians against a baseline file in the same format and count
+      the cases slower than the baseline by more than a threshold.
+
+    Invariants:
+    - Medians are compared, not p99s: one preempted batch moves the tail of
+      31 repetitions but not the middle.
+    - A case missing from the baseline is reported as new, never as a
+      regression; a missing baseline file only disables the check.
+    - Slowdowns under 1 ns/op are ignored regardless of the threshold, so
+      nanosecond-scale cases do not fail on timer resolution.
+*/
+namespace bench
+{
+    typedef struct
+    {
+        std::string name;
+        uint64_t iterations; // per repetition
+        uint32_t reps;
+        double median_ns; // per operation
+        double p99_ns;
+        double min_ns;
+    } result_t;
+
+    // Runs fn(iterations) warmup + reps times; fn does `iterations` operations.
+    template <typename Fn>
+    result_t measure(const char *name, uint64_t iterations, Fn &&fn, uint32_t warmup = 3, uint32_t reps = 31)
+    {
+        for (uint32_t i = 0; i < warmup; i++)
+            fn(iterations);
+
+        std::vector<double> per_op(reps);
+        for (uint32_t r = 0; r < reps; r++)
+        {
+            uint64_t start = now_ns();
+            fn(iterations);
+            per_op[r] = (double)(now_ns() - start) / (double)iterations;
+        }
+        std::sort(per_op.begin(), per_op.end());
+
+        result_t res;
+        res.name = name;
+        res.iterations = iterations;
+        res.reps = reps;
+        res.median_ns = per_op[reps / 2];
+        res.p99_ns = per_op[(size_t)ceil(0.99 * reps) - 1];
+        res.min_ns = per_op[0];
+        printf("%-32s median %10.1f ns/op   p99 %10.1f ns/op\n", name, res.median_ns, res.p99_ns);
+        return res;
+    }
+
+    inline bool write_json(const char *path, const std::vector<result_t> &results)
+    {
+        FILE *f = fopen(path, "w");
+        if (f == NULL)
+            return false;
+
+        fprintf(f, "{\n  \"benchmarks\": [\n");
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const result_t &r = results[i];
+            fprintf(f,
+                    "    {\"name\": \"%s\", \"unit\": \"ns/op\", \"iterations\": %llu, \"reps\": %u, "
+                    "\"median\": %.2f, \"p99\": %.2f, \"min\": %.2f}%s\n",
+                    r.name.c_str(), (unsigned long long)r.iterations, r.reps, r.median_ns, r.p99_ns, r.min_ns,
+                    i + 1 < results.size() ? "," : "");
+        }
+        fprintf(f, "  ]\n}\n");
+        return fclose(f) == 0;
+    }
+
+    // Reads "name" -> "median" pairs back from a file written by write_json().
+    inline bool read_baseline(const char *path, std::vector<std::pair<std::string, double>> *out)
+    {
+        FILE *f = fopen(path, "r");
+        if (f == NULL)
+            return false;
+
+        std::string text;
+        char chunk[1024];
+        size_t got;
+        while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0)
+            text.append(chunk, got);
+        fclose(f);
+
+        static const char k_name[] = "\"name\": \"";
+        static const char k_median[] = "\"median\": ";
+        size_t pos = 0;
+        while ((pos = text.find(k_name, pos)) != std::string::npos)
+        {
+            size_t start = pos + sizeof(k_name) - 1;
+            size_t end = text.find('"', start);
+            size_t med = text.find(k_median, end);
+            if (end == std::string::npos || med == std::string::npos)
+                break;
+            out->push_back(std::make_pair(text.substr(start, end - start),
+                                          strtod(text.c_str() + med + sizeof(k_median) - 1, NULL)));
+            pos = med;
+        }
+        return true;
+    }
+
+    // Returns the number of cases whose median regressed past threshold_pct.
+    inline int check_baseline(const char *path, const std::vector<result_t> &results, double threshold_pct)
+    {
+        std::vector<std::pair<std::string, double>> baseline;
+        if (!read_baseline(path, &baseline))
+        {
+            printf("baseline %s not found, regression check skipped\n", path);
+            return 0;
+        }
+
+        int regressions = 0;
+        printf("\nagainst %s (threshold +%.0f%%):\n", path, threshold_pct);
+        for (const result_t &r : results)
+        {
+            auto it = std::find_if(baseline.begin(), baseline.end(),
+                                   [&](const std::pair<std::string, double> &b)
+                                   { return b.first == r.name; });
+            if (it == baseline.end())
+            {
+                printf("  %-32s new\n", r.name.c_str());
+                continue;
+            }
+
+            double base = it->second;
+            double change = base > 0 ? (r.median_ns - base) * 100.0 / base : 0;
+            bool regressed = change > threshold_pct && r.median_ns - base >= 1.0;
+            printf("  %-32s %10.1f -> %10.1f ns/op  %+6.1f%%%s\n", r.name.c_str(), base, r.median_ns, change,
+                   regressed ? "  REGRESSION" : "");
+            if (regressed)
+                regressions++;
+        }
+        return regressions;
+    }
+} // namespace bench
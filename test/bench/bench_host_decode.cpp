@@ -0,0 +1,161 @@
+// bench_host_decode.cpp
+//
+// Native benchmark: host decoder throughput (GB/s) over a generated
+// multi-GB capture file, against the firmware parser on the same bytes.
+//
+//   bench_host_decode [capture path] [size MiB]     (default: host_capture.bin, 2048)
+//
+// The capture is generated once and reused if it already has the requested
+// size. Columns are flushed every window so memory stays bounded.
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "bench_common.h"
+#include "decoder.h"
+#include "mapped_file.h"
+#include "packet.h"
+#include "parser.h"
+
+static const size_t k_window = 64u << 20; // bytes decoded between column flushes
+
+static uint32_t xorshift(uint32_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+// Telemetry frames with a text line every 16 frames and a corrupted frame
+// every 1024, roughly what a serial capture of the node looks like.
+static bool generate(const char *path, uint64_t target)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+        return false;
+
+    std::vector<uint8_t> buf;
+    buf.reserve(k_window + 4096);
+    uint32_t x = 0xC0FFEE;
+    uint64_t written = 0;
+    uint64_t i = 0;
+    while (written < target)
+    {
+        buf.clear();
+        while (buf.size() < k_window && written + buf.size() < target)
+        {
+            uint8_t payload[PKT_TELEMETRY_PAYLOAD_SIZE];
+            pkt_telemetry_t rec = {(uint8_t)(i & 3), 100, 1000, (uint32_t)(i >> 20)};
+            pkt_telemetry_pack(&rec, payload, sizeof(payload));
+            pkt_t pkt = {PKT_TYPE_TELEMETRY, (uint16_t)i, i * 10000u, payload, sizeof(payload)};
+
+            uint8_t frame[PKT_MAX_FRAME];
+            size_t n = pkt_encode(&pkt, frame, sizeof(frame));
+            if ((i & 1023) == 1023)
+                frame[2 + xorshift(&x) % (n - 3)] ^= 0x10;
+            buf.insert(buf.end(), frame, frame + n);
+
+            if ((i & 15) == 15)
+            {
+                static const char line[] = "OK STATE=1 TIME=123456 TELEMETRY_MS=100 HEARTBEAT_MS=1000 FAULTS=0\r\n";
+                buf.insert(buf.end(), line, line + sizeof(line) - 1);
+            }
+            i++;
+        }
+        if (fwrite(buf.data(), 1, buf.size(), f) != buf.size())
+        {
+            fclose(f);
+            return false;
+        }
+        written += buf.size();
+    }
+    return fclose(f) == 0;
+}
+
+static void on_parser_frame(void *ctx, const pkt_t *pkt)
+{
+    static_cast<host::TelemetryColumns *>(ctx)->append(pkt);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "host_capture.bin";
+    uint64_t target = (uint64_t)(argc > 2 ? strtoull(argv[2], NULL, 10) : 2048u) << 20;
+
+    {
+        host::MappedFile existing(path);
+        if (!existing.ok() || existing.size() < target)
+        {
+            printf("generating %llu MiB capture at %s\n", (unsigned long long)(target >> 20), path);
+            uint64_t start = bench::now_ns();
+            if (!generate(path, target))
+            {
+                printf("FAILED: cannot write %s\n", path);
+                return 1;
+            }
+            printf("  %.1f s\n", (double)(bench::now_ns() - start) / 1e9);
+        }
+    }
+
+    host::MappedFile file(path);
+    if (!file.ok())
+    {
+        printf("FAILED: cannot map %s\n", path);
+        return 1;
+    }
+    const uint8_t *data = file.data();
+    const size_t size = (size_t)(file.size() < target ? file.size() : target);
+
+    // First pass pages the file in so both decoders read from the page cache.
+    uint64_t sum = 0;
+    for (size_t off = 0; off < size; off += 4096)
+        sum += data[off];
+    bench::do_not_optimize(sum);
+
+    host::TelemetryColumns cols;
+    cols.reserve(k_window / 24);
+    host::Decoder dec(&cols);
+    uint64_t rows = 0;
+    uint64_t start = bench::now_ns();
+    for (size_t off = 0; off < size; off += k_window)
+    {
+        size_t len = size - off < k_window ? size - off : k_window;
+        dec.feed(data + off, len);
+        rows += cols.rows();
+        cols.clear();
+    }
+    double host_s = (double)(bench::now_ns() - start) / 1e9;
+    host::DecodeStats hs = dec.stats();
+
+    // Same column output through the firmware parser's callback.
+    parser_t parser;
+    parser_init(&parser, on_parser_frame, &cols);
+    start = bench::now_ns();
+    for (size_t off = 0; off < size; off += k_window)
+    {
+        size_t len = size - off < k_window ? size - off : k_window;
+        parser_feed(&parser, data + off, len);
+        cols.clear();
+    }
+    double parser_s = (double)(bench::now_ns() - start) / 1e9;
+
+    printf("capture: %.2f GB, %llu frames, %llu crc errors, %llu resyncs\n", (double)size / 1e9,
+           (unsigned long long)hs.frames_ok, (unsigned long long)hs.crc_errors, (unsigned long long)hs.resyncs);
+    printf("%-16s%10s%12s\n", "decoder", "seconds", "GB/s");
+    printf("%-16s%10.2f%12.2f   (%llu rows, %.1f%% fast path)\n", "host", host_s, (double)size / host_s / 1e9,
+           (unsigned long long)rows, 100.0 * (double)hs.fast_frames / (double)(hs.frames_ok ? hs.frames_ok : 1));
+    printf("%-16s%10.2f%12.2f\n", "firmware parser", parser_s,
+           (double)size / parser_s / 1e9);
+
+    // Firmware counters are 32-bit; compare modulo 2^32.
+    bool same = (uint32_t)hs.frames_ok == parser.stats.frames_ok && (uint32_t)hs.crc_errors == parser.stats.crc_errors &&
+                (uint32_t)hs.framing_errors == parser.stats.framing_errors &&
+                (uint32_t)hs.overruns == parser.stats.overruns && (uint32_t)hs.resyncs == parser.stats.resyncs &&
+                (uint32_t)hs.bytes_in == parser.stats.bytes_in && rows == hs.frames_ok;
+    if (!same)
+    {
+        printf("FAILED: host decoder and firmware parser disagree\n");
+        return 1;
+    }
+    return 0;
+}
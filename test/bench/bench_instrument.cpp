@@ -0,0 +1,117 @@
+// bench_instrument.cpp
+//
+// Native benchmark for the hot-path instrumentation. Built twice, as
+// bench_instrument (APP_INSTRUMENT=1) and bench_instrument_off
+// (APP_INSTRUMENT=0); compare the two:
+// - cost of the primitives: one cycle counter read, one histogram record;
+// - app_tick() on an idle loop pass, a pass sampling four channels, and
+//   app_handle_command() for a short command, with and without the
+//   instrumentation compiled in.
+#include <cstring>
+#include "bench_common.h"
+#include "app.h"
+#include "hal/sensor/sim_sensor.h"
+
+class NullLed : public hal::led::IHalLed {
+public:
+    void hal_led_init() override {}
+    void hal_led_set(bool) override {}
+    void hal_led_toggle() override {}
+};
+
+class FixedTime : public hal::time::IHalTime {
+public:
+    uint64_t now_us = 0;
+    uint32_t hal_millis() override { return (uint32_t)(now_us / 1000u); }
+    uint32_t hal_micros() override { return (uint32_t)now_us; }
+    uint64_t hal_monotonic_us() override { return now_us; }
+    void hal_sleep_until(uint64_t) override {}
+    void hal_wake() override {}
+};
+
+class NullSerial : public hal::serial::ISerialIo {
+public:
+    bool serial_readline(char *, size_t) override { return false; }
+    void hal_serial_print(const char *str) override { bench::do_not_optimize(str[0]); }
+    void hal_serial_write(const uint8_t *data, size_t len) override { bench::do_not_optimize(data[len - 1]); }
+    size_t hal_serial_flush(size_t) override { return 0; }
+    bool hal_serial_pending() override { return false; }
+};
+
+class NullLogger : public hal::logging::ILogger {
+public:
+    void log(const char *message) override { bench::do_not_optimize(message[0]); }
+};
+
+static sensors::sensor_registry_t g_reg;
+
+static void bench_primitives()
+{
+#if APP_INSTRUMENT
+    const uint32_t n = 20000000;
+    uint32_t acc = 0;
+    uint64_t start = bench::now_ns();
+    for (uint32_t i = 0; i < n; i++)
+        acc += hal::time::cycles_now();
+    double read_ns = (double)(bench::now_ns() - start) / n;
+    bench::do_not_optimize(acc);
+
+    util::LogHistogram h;
+    h.reset();
+    start = bench::now_ns();
+    for (uint32_t i = 0; i < n; i++)
+        h.record(i * 2654435761u >> 12);
+    double record_ns = (double)(bench::now_ns() - start) / n;
+    bench::do_not_optimize(h);
+
+    printf("cycle counter read %.2f ns, histogram record %.2f ns, timed path %.2f ns\n",
+           read_ns, record_ns, 2 * read_ns + record_ns);
+#endif
+}
+
+int main()
+{
+    const uint32_t passes = 2000000;
+    NullLed led;
+    FixedTime time;
+    NullSerial serial;
+    NullLogger logger;
+    static app::app_t app;
+
+    printf("instrumentation %s (APP_INSTRUMENT=%d)\n", APP_INSTRUMENT ? "on" : "off", APP_INSTRUMENT);
+    bench_primitives();
+
+    app::app_init(&app, 0, &led, &time, &serial, &logger);
+
+    // Idle passes: nothing due, the common case between deadlines.
+    uint64_t start = bench::now_ns();
+    for (uint32_t i = 0; i < passes; i++)
+        app::app_tick(&app, 1);
+    double idle_ns = (double)(bench::now_ns() - start) / passes;
+
+    // Busy passes: four channels sampled every ms, telemetry every 10 ms.
+    hal::sensor::HalSensorSim sim(4);
+    sim.hal_sensor_init();
+    sensors::sensor_registry_init(&g_reg);
+    for (uint8_t ch = 0; ch < 4; ch++)
+        sensors::sensor_registry_add(&g_reg, &sim, ch, 1, 0);
+    app::app_attach_sensors(&app, &g_reg);
+    app::app_handle_command(&app, "TELEMETRY BINARY");
+    app::app_handle_command(&app, "RATE 10");
+    start = bench::now_ns();
+    for (uint32_t i = 1; i <= passes; i++)
+    {
+        time.now_us = (uint64_t)i * 1000u;
+        app::app_tick(&app, time.now_us);
+    }
+    double busy_ns = (double)(bench::now_ns() - start) / passes;
+
+    start = bench::now_ns();
+    for (uint32_t i = 0; i < passes; i++)
+        app::app_handle_command(&app, "ARM");
+    double command_ns = (double)(bench::now_ns() - start) / passes;
+
+    printf("app_tick idle %.1f ns, app_tick sampling %.1f ns, app_handle_command %.1f ns\n",
+           idle_ns, busy_ns, command_ns);
+    return 0;
+}
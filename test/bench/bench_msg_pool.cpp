@@ -0,0 +1,101 @@
+// bench_msg_pool.cpp
+//
+// Native benchmark: ns per outbound telemetry frame through the TX queue,
+// encoded into a stack buffer and copied in with enqueue() versus encoded
+// in place into a MsgPool block and queued with enqueue_ref(). The link
+// drains in UART-sized chunks; both paths must put identical bytes on it.
+#include <string.h>
+#include "bench_common.h"
+#include "msg_pool.h"
+#include "packet.h"
+#include "tx_queue.h"
+
+typedef util::TxQueue<1024, 32> queue_t;
+typedef util::MsgPool<160, 8> pool_t;
+
+static const size_t k_frames = 1000000;
+static const size_t k_burst = 4; // frames produced per drain
+
+static size_t encode(uint32_t i, uint8_t *out, size_t cap)
+{
+    pkt_telemetry_t rec;
+    rec.state = (uint8_t)(i & 3);
+    rec.telemetry_period_ms = 10u + (i % 1000u);
+    rec.heartbeat_period_ms = 2000;
+    rec.fault_count = i >> 10;
+
+    uint8_t payload[PKT_MAX_PAYLOAD];
+    pkt_t pkt;
+    pkt.type = PKT_TYPE_TELEMETRY;
+    pkt.seq = (uint16_t)i;
+    pkt.timestamp_us = (uint64_t)i * 1000u;
+    pkt.payload = payload;
+    pkt.payload_len = pkt_telemetry_pack(&rec, payload, sizeof(payload));
+    return pkt_encode(&pkt, out, cap);
+}
+
+struct Link
+{
+    uint64_t bytes = 0;
+    uint32_t sum = 0;
+
+    size_t operator()(const uint8_t *data, size_t len)
+    {
+        size_t n = len < 64 ? len : 64; // USB CDC packet
+        for (size_t i = 0; i < n; i++)
+            sum = sum * 31u + data[i];
+        bytes += n;
+        return n;
+    }
+};
+
+static void drain(queue_t &q, Link &link)
+{
+    while (!q.empty())
+        q.flush(link, 256);
+}
+
+int main()
+{
+    static queue_t q;
+    static pool_t pool;
+    Link copy_link, ref_link;
+
+    uint64_t start = bench::now_ns();
+    for (uint32_t i = 0; i < k_frames; i++)
+    {
+        uint8_t frame[PKT_MAX_FRAME];
+        size_t len = encode(i, frame, sizeof(frame));
+        q.enqueue(frame, len);
+        if (i % k_burst == k_burst - 1)
+            drain(q, copy_link);
+    }
+    drain(q, copy_link);
+    double copy_ns = (double)(bench::now_ns() - start) / k_frames;
+
+    start = bench::now_ns();
+    for (uint32_t i = 0; i < k_frames; i++)
+    {
+        uint8_t *block = pool.alloc();
+        size_t len = encode(i, block, pool_t::block_size());
+        q.enqueue_ref(block, len, pool_t::release, &pool);
+        if (i % k_burst == k_burst - 1)
+            drain(q, ref_link);
+    }
+    drain(q, ref_link);
+    double ref_ns = (double)(bench::now_ns() - start) / k_frames;
+
+    printf("%-22s %10s\n", "path", "ns/frame");
+    printf("%-22s %10.1f\n", "stack + enqueue", copy_ns);
+    printf("%-22s %10.1f   (%.2fx)\n", "pool + enqueue_ref", ref_ns, copy_ns / ref_ns);
+    printf("bytes/frame: %.1f   pool high water: %u/%zu   exhausted: %lu\n",
+           (double)ref_link.bytes / k_frames, (unsigned)pool.stats().high_water, pool_t::capacity(),
+           (unsigned long)pool.stats().exhausted);
+
+    if (copy_link.bytes != ref_link.bytes || copy_link.sum != ref_link.sum || pool.stats().in_use != 0)
+    {
+        printf("FAILED: link output differs or blocks leaked\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// bench_sim.cpp
+//
+// Long-horizon runs of the virtual-time node simulator (test/sim): how much
+// device time a second of wall time covers, and what the node sees over it:
+// - four weeks at the defaults with the host polling STATUS once a minute;
+// - one day of 100 ms binary telemetry with a burst of 16 commands every
+//   minute, which queue behind the per-pass line budget and spin the loop
+//   while their replies drain;
+// - command throughput of a lock-step host against pipelined windows;
+// - telemetry bandwidth per mode, idle and active (sim_telemetry_bandwidth):
+//   publish on change against the same content sent every period.
+#include "bench_common.h"
+#include "sim/sim_node.h"
+
+static const uint64_t SEC = 1000000u;
+static const uint64_t DAY = 86400u * SEC;
+
+static void run(const char *label, sim::SimNode *node, uint64_t span_us)
+{
+    uint64_t start = bench::now_ns();
+    node->run_until(span_us);
+    double wall_s = (double)(bench::now_ns() - start) / 1e9;
+
+    const sim::sim_report_t &r = node->report();
+    printf("%s: %.1f device days in %.2f s wall (%.0fx), %.0f ns per loop pass\n", label,
+           (double)span_us / DAY, wall_s, (double)span_us / 1e6 / wall_s, wall_s * 1e9 / (double)r.passes);
+    sim::sim_print_report(stdout, &r);
+}
+
+int main()
+{
+    static sim::SimNode idle(sim::sim_default_config());
+    for (uint64_t t = 30 * SEC; t < 28 * DAY; t += 60 * SEC)
+        idle.script(t, "STATUS");
+    run("4 weeks, 1 s text telemetry, STATUS every minute", &idle, 28 * DAY);
+
+    static sim::SimNode busy(sim::sim_default_config());
+    busy.script(0, "TELEMETRY BINARY");
+    busy.script(0, "RATE 100");
+    for (uint64_t t = 5 * SEC; t < DAY; t += 60 * SEC)
+        for (int i = 0; i < 16; i++)
+            busy.script(t, "STATUS");
+    run("1 day, 100 ms binary telemetry, 16-command bursts", &busy, DAY);
+
+    // Tagged commands, lock-step (window 1) against pipelined (window 8).
+    sim::sim_config_t usb = sim::sim_default_config();
+    usb.link_bytes_per_sec = 0;
+    const struct { const char *label; sim::sim_config_t cfg; uint64_t turnaround_us; } links[] = {
+        {"115200 baud", sim::sim_default_config(), 200},
+        {"USB (1 ms frames)", usb, 1000},
+    };
+    for (const auto &link : links)
+    {
+        for (uint32_t window : {1u, 4u, 8u, 16u})
+            printf("%s, window %2u: %.0f commands/s\n", link.label, window,
+                   sim::sim_command_throughput(link.cfg, "LED AUTO", 2000, window, link.turnaround_us));
+    }
+
+    // TEXT / BINARY / DELTA carry the record only; CHANGES adds the channels.
+    const struct { const char *label; const char *mode; uint32_t deadband; } modes[] = {
+        {"TEXT (record only)", "TELEMETRY TEXT", 0},
+        {"BINARY (record only)", "TELEMETRY BINARY", 0},
+        {"DELTA 100 (record only)", "TELEMETRY DELTA 100", 0},
+        {"CHANGES 1 (every field)", "TELEMETRY CHANGES 1", 0},
+        {"CHANGES 100", "TELEMETRY CHANGES 100", 0},
+        {"CHANGES 100, deadband 16", "TELEMETRY CHANGES 100", 16},
+    };
+    const uint64_t span = 3600u * SEC;
+    printf("telemetry bandwidth, 1 h at %u ms, %u channels (B/s, saved vs CHANGES 1)\n",
+           (unsigned)SIM_TELEMETRY_PERIOD_MS, (unsigned)SIM_TELEMETRY_CHANNELS);
+    for (bool active : {false, true})
+    {
+        double full = sim::sim_telemetry_bandwidth(sim::sim_default_config(), "TELEMETRY CHANGES 1", 0, active, span);
+        for (const auto &m : modes)
+        {
+            double bps = sim::sim_telemetry_bandwidth(sim::sim_default_config(), m.mode, m.deadband, active, span);
+            printf("  %-6s %-26s %8.1f B/s  %5.1f%%\n", active ? "active" : "idle", m.label, bps,
+                   100.0 * (1.0 - bps / full));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+// bench_spool.cpp
+//
+// Native benchmark for the flash spool on the file-backed flash emulator,
+// device geometry (256 B pages, 4 KiB sectors, 256 KiB region):
+// - append throughput and write amplification (flash bytes programmed per
+//   record byte) for telemetry-sized records at several sync intervals;
+// - replay throughput: read every record back and frame it as a
+//   PKT_TYPE_TELEMETRY_REPLAY packet;
+// - wear spread across sectors, and the flash busy time the same operation
+//   counts would cost on a typical QSPI NOR part.
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "hal/flash/hal_flash_native.h"
+#include "packet.h"
+#include "spool/flash_spool.h"
+
+static const uint32_t PAGE = 256;
+static const uint32_t SECTOR = 4096;
+static const uint32_t SECTORS = 64;
+static const uint32_t RECORD = 19; // [timestamp:6][telemetry record:13], as the app spools
+static const uint32_t RECORDS = 200000;
+
+// Typical datasheet timings (W25Q-class NOR): page program, 4 KiB erase.
+static const double PAGE_PROGRAM_MS = 0.4;
+static const double SECTOR_ERASE_MS = 45.0;
+
+static void make_record(uint32_t i, uint8_t *out)
+{
+    uint64_t ts = (uint64_t)i * 1000000u;
+    for (unsigned k = 0; k < 6; k++)
+        out[k] = (uint8_t)(ts >> (8 * k));
+    pkt_telemetry_t rec = {(uint8_t)(i & 3), 1000, 2000, i / 5000};
+    pkt_telemetry_pack(&rec, &out[6], PKT_TELEMETRY_PAYLOAD_SIZE);
+}
+
+static void run(const char *path, uint32_t sync_every)
+{
+    unlink(path);
+    hal::flash::HalFlashFile flash(path, PAGE, SECTOR, SECTORS);
+    spool::spool_t s;
+    if (!flash.ok() || !spool::spool_mount(&s, &flash))
+    {
+        printf("FAILED: cannot open %s\n", path);
+        exit(1);
+    }
+
+    uint8_t rec[RECORD];
+    uint64_t start = bench::now_ns();
+    for (uint32_t i = 0; i < RECORDS; i++)
+    {
+        make_record(i, rec);
+        spool::spool_append(&s, rec, sizeof(rec));
+        if (sync_every && i % sync_every == sync_every - 1)
+            spool::spool_sync(&s);
+    }
+    double append_ns = (double)(bench::now_ns() - start);
+
+    // Replay everything still held, framed as on the wire.
+    spool::spool_cursor_t c;
+    spool::spool_seek(&s, 0, &c);
+    uint8_t data[SPOOL_MAX_RECORD];
+    uint8_t frame[PKT_MAX_FRAME];
+    uint32_t seq, replayed = 0;
+    uint64_t wire = 0;
+    size_t n;
+    start = bench::now_ns();
+    while ((n = spool::spool_read(&s, &c, &seq, data, sizeof(data))) > 0)
+    {
+        pkt_telemetry_t r;
+        pkt_telemetry_unpack(&data[6], PKT_TELEMETRY_PAYLOAD_SIZE, &r);
+        uint8_t payload[PKT_REPLAY_PAYLOAD_SIZE];
+        pkt_t pkt = {PKT_TYPE_TELEMETRY_REPLAY, (uint16_t)seq, 0, payload, 0};
+        pkt.payload_len = pkt_replay_pack(seq, &r, payload, sizeof(payload));
+        wire += pkt_encode(&pkt, frame, sizeof(frame));
+        replayed++;
+    }
+    double replay_ns = (double)(bench::now_ns() - start);
+
+    const hal::flash::flash_wear_stats_t &w = flash.stats();
+    uint32_t lo = 0xFFFFFFFFu, hi = 0;
+    for (uint32_t e : flash.erase_counts())
+    {
+        lo = e < lo ? e : lo;
+        hi = e > hi ? e : hi;
+    }
+
+    double data_bytes = (double)RECORDS * RECORD;
+    double wa = (double)w.bytes_programmed / data_bytes;
+    double device_ms_per_rec = ((double)w.pages_programmed * PAGE_PROGRAM_MS + (double)w.sectors_erased * SECTOR_ERASE_MS) / RECORDS;
+
+    char label[16];
+    snprintf(label, sizeof(label), sync_every ? "%u" : "page", sync_every);
+    printf("%-6s %8.2f %10.0f %8.2f %9u %10.1f %8.1f %7u-%-4u %9.3f\n", label, wa,
+           RECORDS / (append_ns / 1e9), data_bytes / append_ns * 1e3,
+           replayed, replayed / (replay_ns / 1e9), (double)wire / replay_ns * 1e3,
+           lo, hi, device_ms_per_rec);
+
+    if (w.bad_programs != 0 || replayed == 0 || s.stats.corrupt != 0)
+    {
+        printf("FAILED: bad programs %u, corrupt %u\n", w.bad_programs, s.stats.corrupt);
+        exit(1);
+    }
+    unlink(path);
+}
+
+int main()
+{
+    char path[] = "/tmp/bench_spool_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return 1;
+    close(fd);
+
+    printf("%u records of %u bytes into a %u KiB spool (%u B pages, %u B sectors)\n", RECORDS, RECORD,
+           SECTORS * SECTOR / 1024, PAGE, SECTOR);
+    printf("%-6s %8s %10s %8s %9s %10s %8s %12s %9s\n", "sync", "WA", "append/s", "MB/s",
+           "replayed", "replay/s", "wire MB/s", "erases", "dev ms/rec");
+    const uint32_t syncs[] = {0, 64, 16, 4, 1};
+    for (uint32_t sync_every : syncs)
+        run(path, sync_every);
+    printf("WA = flash bytes programmed / record bytes; dev ms/rec = flash busy time per record at\n"
+           "%.1f ms/page program and %.0f ms/sector erase.\n",
+           PAGE_PROGRAM_MS, SECTOR_ERASE_MS);
+    return 0;
+}
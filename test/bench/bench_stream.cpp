@@ -0,0 +1,127 @@
+// bench_stream.cpp
+//
+// STREAM: what one sample and one block cost, and the highest rate the node
+// sustains without overruns.
+// - Native ns per timer callback (one synthetic sensor read into the block)
+//   and per block on the main loop (pack, frame, release). These are host
+//   numbers; on the device both are bounded by the ADC read and the link.
+// - Virtual-time search (test/sim): the highest STREAM START rate that runs
+//   a minute of device time with no overrun and no dropped frame, per link speed.
+#include "bench_harness.h"
+#include "mock_hal.h"
+#include "packet.h"
+#include "hal/sensor/sim_sensor.h"
+#include "sim/sim_node.h"
+#include "stream/stream.h"
+
+static const uint64_t SEC = 1000000u;
+
+static void bench_costs()
+{
+    MockHalTimer timer;
+    hal::sensor::HalSensorSim sensor(1);
+    sensor.hal_sensor_init();
+    static stream::stream_t s;
+    stream::stream_init(&s, &timer, nullptr);
+    stream::stream_start(&s, &sensor, 0, 0, 10000);
+
+    // Release every block at once so no tick takes the overrun path.
+    bench::measure("stream/timer_callback", 100000, [&](uint64_t n)
+                   {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            stream::stream_on_timer(&s);
+            if (stream::stream_peek(&s) != nullptr)
+                stream::stream_release(&s);
+        } });
+
+    uint8_t payload[PKT_MAX_PAYLOAD];
+    uint8_t frame[PKT_MAX_FRAME];
+    pkt_t pkt = {PKT_TYPE_STREAM, 0, 0, payload, 0};
+    bench::measure("stream/block_frame", 20000, [&](uint64_t n)
+                   {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            while (stream::stream_peek(&s) == nullptr)
+                stream::stream_on_timer(&s);
+            const stream::stream_block_t *b = stream::stream_peek(&s);
+            pkt_stream_t blk = {0, (uint8_t)b->count, 10000, b->first_index, 0, b->samples};
+            pkt.seq = (uint16_t)i;
+            pkt.payload_len = pkt_stream_pack(&blk, payload, sizeof(payload));
+            bench::do_not_optimize(pkt_encode(&pkt, frame, sizeof(frame)));
+            stream::stream_release(&s);
+        } });
+    stream::stream_stop(&s);
+}
+
+static sensors::sensor_registry_t g_reg; // large; keep off the stack
+static hal::sensor::HalSensorSim g_sensor(1);
+
+// A minute of streaming at hz (long enough to fill every buffer on the way);
+// true if nothing was lost.
+static bool sustains(const sim::sim_config_t &cfg, uint32_t hz, sim::SimNode **keep)
+{
+    sim::SimNode *node = new sim::SimNode(cfg);
+    g_sensor.hal_sensor_init();
+    sensors::sensor_registry_init(&g_reg);
+    sensors::sensor_registry_add(&g_reg, &g_sensor, 0, 1000, 0);
+    app::app_attach_sensors(&node->app, &g_reg);
+
+    char line[32];
+    snprintf(line, sizeof(line), "STREAM START %u", hz);
+    node->script(0, line);
+    node->run_until(60 * SEC);
+
+    bool ok = node->stream.overruns.load() == 0 && node->report().tx_dropped == 0 &&
+              node->stream.samples.load() > 0;
+    if (keep != nullptr)
+        *keep = node;
+    else
+        delete node;
+    return ok;
+}
+
+static void search(const char *label, uint32_t link_bytes_per_sec)
+{
+    sim::sim_config_t cfg = sim::sim_default_config();
+    cfg.link_bytes_per_sec = link_bytes_per_sec;
+
+    uint32_t lo = 1, hi = STREAM_MAX_HZ + 1; // lo sustains, hi does not
+    if (sustains(cfg, STREAM_MAX_HZ, nullptr))
+        lo = STREAM_MAX_HZ;
+    while (hi - lo > 1 && lo < STREAM_MAX_HZ)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (sustains(cfg, mid, nullptr))
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    // Frame bytes per block bound the rate by the link alone.
+    uint8_t payload[PKT_MAX_PAYLOAD];
+    uint8_t frame[PKT_MAX_FRAME];
+    int16_t zeros[STREAM_BLOCK_SAMPLES] = {};
+    pkt_stream_t blk = {0, STREAM_BLOCK_SAMPLES, 0, 0, 0, zeros};
+    pkt_t pkt = {PKT_TYPE_STREAM, 0, 0, payload, 0};
+    pkt.payload_len = pkt_stream_pack(&blk, payload, sizeof(payload));
+    size_t frame_len = pkt_encode(&pkt, frame, sizeof(frame));
+    double wire_hz = (double)link_bytes_per_sec * STREAM_BLOCK_SAMPLES / (double)frame_len;
+
+    sim::SimNode *node = nullptr;
+    sustains(cfg, lo, &node);
+    printf("%s: max sustained %u Hz (link bound %.0f Hz, %zu-byte frames of %u samples)\n", label, lo, wire_hz,
+           frame_len, (unsigned)STREAM_BLOCK_SAMPLES);
+    printf("  at %u Hz: samples=%u blocks=%u lost=%u overruns=%u\n", lo, node->stream.samples.load(),
+           node->stream.blocks_sent, node->stream.lost.load(), node->stream.overruns.load());
+    sim::sim_print_report(stdout, &node->report());
+    delete node;
+}
+
+int main()
+{
+    bench_costs();
+    search("115200 baud UART", 11520);
+    search("USB CDC (~1 MB/s)", 1000000);
+    return 0;
+}
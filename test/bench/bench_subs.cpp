@@ -0,0 +1,128 @@
+// bench_subs.cpp
+//
+// Subscriptions (SUB / UNSUB) with a 256-channel table:
+// - Native ns per subs_collect() call with every channel subscribed, for a
+//   tick with nothing due, one channel due, 16 due and all 256 due, against
+//   a plain per-channel deadline scan like the sensor registry's.
+// - Wire cost of a minute of subscriptions at mixed rates: values and bytes
+//   sent against what was asked for, packed into one PKT_TYPE_CHANNELS
+//   record per tick against one frame per channel.
+#include "bench_harness.h"
+#include "packet.h"
+#include "subs/subscriptions.h"
+
+static const int N = SUBS_MAX_CHANNELS;
+
+static void bench_scans()
+{
+    static subs::subs_table_t t;
+    static uint64_t linear_due[N];
+    subs::subs_mask_t due;
+
+    // Everything subscribed at 1 s; nothing due until then.
+    subs::subs_init(&t);
+    for (int ch = 0; ch < N; ch++)
+    {
+        subs::subs_add(&t, (uint8_t)ch, 1000000, 0);
+        linear_due[ch] = 1000000;
+    }
+    bench::measure("subs/collect_none_due", 1000000, [&](uint64_t n)
+                   {
+        for (uint64_t i = 0; i < n; i++)
+            bench::do_not_optimize(subs::subs_collect(&t, 500000, &due)); });
+
+    bench::measure("subs/linear_scan_none_due", 100000, [&](uint64_t n)
+                   {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            uint32_t found = 0;
+            for (int ch = 0; ch < N; ch++)
+                found += linear_due[ch] <= 500000;
+            bench::do_not_optimize(found);
+        } });
+
+    // k channels due per tick: k subscriptions at 1 ms, the rest far out.
+    for (int k : {1, 16, N})
+    {
+        subs::subs_init(&t);
+        for (int ch = 0; ch < N; ch++)
+            subs::subs_add(&t, (uint8_t)ch, ch % (N / k) == 0 ? 1000 : 3600000000u, 0);
+        uint64_t now = 0;
+        char name[48];
+        snprintf(name, sizeof(name), "subs/collect_%d_due", k);
+        bench::measure(name, 100000, [&](uint64_t n)
+                       {
+            for (uint64_t i = 0; i < n; i++)
+            {
+                now += 1000;
+                uint32_t got = subs::subs_collect(&t, now, &due);
+                for (int ch = subs::subs_next(&due, 0); ch >= 0; ch = subs::subs_next(&due, ch + 1))
+                    got += (uint32_t)ch;
+                bench::do_not_optimize(got);
+            } });
+    }
+}
+
+static size_t frame_bytes(const pkt_channel_value_t *v, size_t count, uint16_t seq)
+{
+    uint8_t payload[PKT_MAX_PAYLOAD];
+    uint8_t frame[PKT_MAX_FRAME];
+    pkt_t pkt = {PKT_TYPE_CHANNELS, seq, 0, payload, 0};
+    pkt.payload_len = pkt_channels_pack(v, count, payload, sizeof(payload));
+    return pkt_encode(&pkt, frame, sizeof(frame));
+}
+
+// 64 channels at 10, 20, 50 ... ms (cycling), 1 ms ticks for a minute.
+static void bench_wire()
+{
+    static const uint32_t periods_ms[] = {10, 20, 50, 100, 250, 500, 1000, 5000};
+    const int channels = 64;
+    const uint64_t span_us = 60000000u;
+
+    static subs::subs_table_t t;
+    subs::subs_init(&t);
+    double asked = 0;
+    for (int ch = 0; ch < channels; ch++)
+    {
+        uint32_t p = periods_ms[ch % 8];
+        subs::subs_add(&t, (uint8_t)ch, p * 1000u, 0);
+        asked += (double)span_us / 1000.0 / p;
+    }
+
+    uint64_t values = 0, records = 0, packed = 0, single = 0;
+    pkt_channel_value_t v[PKT_CHANNELS_MAX_VALUES];
+    subs::subs_mask_t due;
+    for (uint64_t now = 1000; now <= span_us; now += 1000)
+    {
+        if (subs::subs_collect(&t, now, &due) == 0)
+            continue;
+        size_t n = 0;
+        for (int ch = subs::subs_next(&due, 0); ch >= 0; ch = subs::subs_next(&due, ch + 1))
+        {
+            v[n] = {(uint8_t)ch, 2048 + ch};
+            single += frame_bytes(&v[n], 1, (uint16_t)values);
+            values++;
+            if (++n == PKT_CHANNELS_MAX_VALUES)
+            {
+                packed += frame_bytes(v, n, (uint16_t)records++);
+                n = 0;
+            }
+        }
+        if (n > 0)
+            packed += frame_bytes(v, n, (uint16_t)records++);
+    }
+
+    printf("subs wire, %d channels at 10..5000 ms for 60 s:\n", channels);
+    printf("  values asked %.0f, sent %llu (missed %u)\n", asked, (unsigned long long)values, t.missed);
+    printf("  packed:  %llu records, %.0f B/s, %.2f B/value\n", (unsigned long long)records,
+           (double)packed * 1e6 / span_us, (double)packed / (double)values);
+    printf("  one frame per channel: %.0f B/s, %.2f B/value\n", (double)single * 1e6 / span_us,
+           (double)single / (double)values);
+}
+
+int main()
+{
+    bench_scans();
+    bench_wire();
+    return 0;
+}
@@ -0,0 +1,216 @@
+// bench_suite.cpp
+//
+// Native benchmark suite behind the `bench` target: the main-loop hot paths
+// through the mock HALs of the app tests, serial line assembly and the
+// protocol codecs, each as warm-up + repetitions with median/p99 reporting.
+//
+//   bench_suite [--json out.json] [--baseline baseline.json] [--threshold pct]
+//
+// Exits 1 when any median is more than pct (default 20) percent slower than
+// the baseline, so the target fails the build on a regression.
+#include <cstring>
+#include "bench_harness.h"
+#include "mock_hal.h"
+#include "app.h"
+#include "line_assembler.h"
+#include "packet.h"
+#include "parser.h"
+#include "hal/sensor/sim_sensor.h"
+
+static std::vector<bench::result_t> g_results;
+
+static void add(const bench::result_t &r) { g_results.push_back(r); }
+
+static void bench_app()
+{
+    MockHalLed led;
+    MockHalTime time;
+    MockHalSerial serial;
+    MockLogger logger;
+    static app::app_t app;
+    app::app_init(&app, 0, &led, &time, &serial, &logger);
+
+    // Nothing due: the common pass between deadlines.
+    add(bench::measure("app_tick/idle", 100000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i++)
+            app::app_tick(&app, 1); }));
+
+    add(bench::measure("app_handle_command/ARM", 100000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i++)
+            app::app_handle_command(&app, "ARM"); }));
+
+    add(bench::measure("app_handle_command/RATE", 100000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i++)
+            app::app_handle_command(&app, "RATE 100"); }));
+
+    add(bench::measure("app_handle_command/unknown", 100000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i++)
+            app::app_handle_command(&app, "FROB 1"); }));
+
+    // Four channels sampled every ms, binary telemetry every 10 ms.
+    static sensors::sensor_registry_t reg;
+    hal::sensor::HalSensorSim sim(4);
+    sim.hal_sensor_init();
+    sensors::sensor_registry_init(&reg);
+    for (uint8_t ch = 0; ch < 4; ch++)
+        sensors::sensor_registry_add(&reg, &sim, ch, 1, 0);
+    app::app_attach_sensors(&app, &reg);
+    app::app_handle_command(&app, "TELEMETRY BINARY");
+    app::app_handle_command(&app, "RATE 10");
+
+    uint64_t now_us = 0;
+    add(bench::measure("app_tick/sampling", 50000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            now_us += 1000u;
+            app::app_tick(&app, now_us);
+        } }));
+}
+
+static void bench_line_assembly()
+{
+    // 16 lines of mixed length and endings, fed in 64-byte reads like rx_pump().
+    std::string stream;
+    for (int i = 0; i < 4; i++)
+        stream += "RATE 100\r\nARM\nTELEMETRY BINARY\r\nSUMMARY 3 1000\n";
+    const uint8_t *bytes = (const uint8_t *)stream.data();
+    const size_t lines = 16;
+
+    util::LineAssembler<128> la;
+    add(bench::measure("serial/line_assembly", 20000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i += lines)
+        {
+            for (size_t off = 0; off < stream.size();)
+            {
+                size_t chunk = stream.size() - off < 64 ? stream.size() - off : 64;
+                bool complete;
+                off += la.feed(bytes + off, chunk, &complete);
+                if (complete)
+                {
+                    bench::do_not_optimize(la.line()[0]);
+                    la.clear();
+                }
+            }
+        } }));
+}
+
+static void on_frame(void *ctx, const pkt_t *pkt)
+{
+    (*(uint32_t *)ctx) += pkt->payload_len;
+}
+
+static void bench_codecs()
+{
+    pkt_telemetry_t rec = {2, 100, 1000, 3};
+    uint8_t payload[PKT_MAX_PAYLOAD];
+    uint8_t frame[PKT_MAX_FRAME];
+    pkt_t pkt = {PKT_TYPE_TELEMETRY, 0, 123456789u, payload, 0};
+    pkt.payload_len = pkt_telemetry_pack(&rec, payload, sizeof(payload));
+
+    add(bench::measure("protocol/telemetry_encode", 200000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            pkt.seq = (uint16_t)i;
+            rec.fault_count = (uint32_t)i;
+            pkt.payload_len = pkt_telemetry_pack(&rec, payload, sizeof(payload));
+            bench::do_not_optimize(pkt_encode(&pkt, frame, sizeof(frame)));
+        } }));
+
+    size_t frame_len = pkt_encode(&pkt, frame, sizeof(frame));
+    uint8_t scratch[PKT_MAX_RAW];
+    add(bench::measure("protocol/telemetry_decode", 200000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            pkt_t out;
+            pkt_telemetry_t got;
+            bool ok = pkt_decode(frame, frame_len, scratch, sizeof(scratch), &out) &&
+                      pkt_telemetry_unpack(out.payload, out.payload_len, &got);
+            bench::do_not_optimize(ok);
+        } }));
+
+    // Streaming parser: 32 frames per chunk, as a host read would see them.
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 32; i++)
+        stream.insert(stream.end(), frame, frame + frame_len);
+    parser_t parser;
+    uint32_t payload_bytes = 0;
+    parser_init(&parser, on_frame, &payload_bytes);
+    add(bench::measure("protocol/parser_feed", 100000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i += 32)
+            parser_feed(&parser, stream.data(), stream.size()); }));
+    bench::do_not_optimize(payload_bytes);
+
+    pkt_delta_t enc;
+    pkt_delta_init(&enc, 16);
+    add(bench::measure("protocol/delta_encode", 200000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            uint8_t type;
+            rec.fault_count = (uint32_t)(i >> 4);
+            bench::do_not_optimize(pkt_telemetry_pack_delta(&enc, &rec, payload, sizeof(payload), &type));
+        } }));
+
+    pkt_summary_t sum = {3, 1000, 1000, 0, -120, 4000, 51200, 2560, 200, 3000, 3900};
+    add(bench::measure("protocol/summary_round_trip", 200000, [&](uint64_t n)
+                       {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            pkt_summary_t got;
+            sum.count = (uint32_t)i;
+            size_t len = pkt_summary_pack(&sum, payload, sizeof(payload));
+            bench::do_not_optimize(pkt_summary_unpack(payload, len, &got));
+        } }));
+}
+
+int main(int argc, char **argv)
+{
+    const char *json_path = NULL;
+    const char *baseline_path = NULL;
+    double threshold_pct = 20.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            json_path = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            threshold_pct = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--json out.json] [--baseline baseline.json] [--threshold pct]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bench_app();
+    bench_line_assembly();
+    bench_codecs();
+
+    if (json_path != NULL && !bench::write_json(json_path, g_results))
+    {
+        fprintf(stderr, "cannot write %s\n", json_path);
+        return 2;
+    }
+
+    if (baseline_path != NULL)
+    {
+        int regressions = bench::check_baseline(baseline_path, g_results, threshold_pct);
+        if (regressions > 0)
+        {
+            printf("%d benchmark(s) regressed more than %.0f%%\n", regressions, threshold_pct);
+            return 1;
+        }
+    }
+    return 0;
+}
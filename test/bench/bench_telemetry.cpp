@@ -0,0 +1,80 @@
+// bench_telemetry.cpp
+//
+// Native benchmark: telemetry records/sec and bytes per record for the
+// TEXT (snprintf status line) and BINARY (COBS framed packet) modes.
+#include <cstring>
+#include "bench_common.h"
+#include "app.h"
+
+class NullLed : public hal::led::IHalLed {
+public:
+    void hal_led_init() override {}
+    void hal_led_set(bool) override {}
+    void hal_led_toggle() override {}
+};
+
+class FixedTime : public hal::time::IHalTime {
+public:
+    uint32_t millis_value = 0;
+    uint32_t hal_millis() override { return millis_value; }
+    uint32_t hal_micros() override { return millis_value * 1000u; }
+    void hal_sleep_until(uint64_t) override {}
+    void hal_wake() override {}
+};
+
+// Counts bytes that would go out on the link.
+class CountingSerial : public hal::serial::ISerialIo {
+public:
+    uint64_t bytes = 0;
+    bool serial_readline(char *, size_t) override { return false; }
+    void hal_serial_print(const char *str) override { bytes += strlen(str); }
+    void hal_serial_write(const uint8_t *data, size_t len) override {
+        bench::do_not_optimize(data[0]);
+        bytes += len;
+    }
+    size_t hal_serial_flush(size_t) override { return 0; }
+    bool hal_serial_pending() override { return false; }
+};
+
+// Mirrors HalSerialLogger: each message is followed by "\r\n".
+class CountingLogger : public hal::logging::ILogger {
+public:
+    CountingSerial *serial = nullptr;
+    void log(const char *message) override { serial->bytes += strlen(message) + 2; }
+};
+
+static void run_mode(const char *mode_cmd, const char *label, uint32_t records)
+{
+    NullLed led;
+    FixedTime time;
+    CountingSerial serial;
+    CountingLogger logger;
+    logger.serial = &serial;
+    app::app_t app;
+
+    app::app_init(&app, 0, &led, &time, &serial, &logger);
+    app::app_handle_command(&app, mode_cmd);
+    app::app_handle_command(&app, "RATE 10");
+    serial.bytes = 0;
+
+    uint64_t now = 0;
+    uint64_t start = bench::now_ns();
+    for (uint32_t i = 0; i < records; i++)
+    {
+        now += (uint64_t)app.telemetry_period_ms * 1000u;
+        app::app_tick(&app, now);
+    }
+    uint64_t elapsed = bench::now_ns() - start;
+
+    double secs = (double)elapsed / 1e9;
+    printf("%-7s records=%u  %.0f records/sec  %.1f ns/record  %.1f bytes/record\n",
+           label, records, records / secs, (double)elapsed / records, (double)serial.bytes / records);
+}
+
+int main()
+{
+    const uint32_t records = 1000000;
+    run_mode("TELEMETRY TEXT", "TEXT", records);
+    run_mode("TELEMETRY BINARY", "BINARY", records);
+    return 0;
+}
@@ -0,0 +1,83 @@
+// bench_text_format.cpp
+//
+// Native benchmark: ns per telemetry status line, snprintf versus the
+// compile-time TextFormat template, over a range of realistic field values.
+// Both outputs are compared byte for byte.
+#include <string.h>
+#include "bench_common.h"
+#include "text_format.h"
+
+static constexpr char k_status_text[] = "STATE={} TIME={} TELEMETRY_MS={} HEARTBEAT_MS={} FAULTS={}";
+typedef util::TextFormat<k_status_text, int, uint64_t, uint32_t, uint32_t, uint32_t> status_format_t;
+
+struct Fields
+{
+    int state;
+    uint64_t time_ms;
+    uint32_t period_ms;
+    uint32_t faults;
+};
+
+static const size_t k_lines = 2000000;
+
+int main()
+{
+    // Uptime from seconds to months, a few periods, small fault counts.
+    static Fields fields[1024];
+    uint32_t x = 0x9E3779B9;
+    for (size_t i = 0; i < 1024; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        fields[i].state = (int)(x & 3);
+        fields[i].time_ms = (uint64_t)(x % 100000u) << (i % 16);
+        fields[i].period_ms = 10u + (x >> 8) % 60000u;
+        fields[i].faults = (x >> 4) % 20u;
+    }
+
+    char a[128], b[128];
+    size_t mismatches = 0;
+    for (const Fields &f : fields)
+    {
+        snprintf(a, sizeof(a), "STATE=%d TIME=%llu TELEMETRY_MS=%lu HEARTBEAT_MS=%lu FAULTS=%lu", f.state,
+                 (unsigned long long)f.time_ms, (unsigned long)f.period_ms, 2000ul, (unsigned long)f.faults);
+        status_format_t::write(b, sizeof(b), f.state, f.time_ms, f.period_ms, 2000u, f.faults);
+        if (strcmp(a, b) != 0)
+            mismatches++;
+    }
+
+    uint64_t bytes = 0;
+    uint64_t start = bench::now_ns();
+    for (size_t i = 0; i < k_lines; i++)
+    {
+        const Fields &f = fields[i & 1023];
+        bytes += (uint64_t)snprintf(a, sizeof(a), "STATE=%d TIME=%llu TELEMETRY_MS=%lu HEARTBEAT_MS=%lu FAULTS=%lu",
+                                    f.state, (unsigned long long)f.time_ms, (unsigned long)f.period_ms, 2000ul,
+                                    (unsigned long)f.faults);
+        bench::do_not_optimize(a);
+    }
+    double snprintf_ns = (double)(bench::now_ns() - start) / k_lines;
+
+    start = bench::now_ns();
+    for (size_t i = 0; i < k_lines; i++)
+    {
+        const Fields &f = fields[i & 1023];
+        bytes += status_format_t::write(b, sizeof(b), f.state, f.time_ms, f.period_ms, 2000u, f.faults);
+        bench::do_not_optimize(b);
+    }
+    double template_ns = (double)(bench::now_ns() - start) / k_lines;
+    bench::do_not_optimize(bytes);
+
+    printf("%-12s %10s\n", "formatter", "ns/line");
+    printf("%-12s %10.1f\n", "snprintf", snprintf_ns);
+    printf("%-12s %10.1f   (%.1fx)\n", "TextFormat", template_ns, snprintf_ns / template_ns);
+    printf("max line length: %zu bytes\n", status_format_t::max_len);
+
+    if (mismatches)
+    {
+        printf("FAILED: %zu lines differ from snprintf\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
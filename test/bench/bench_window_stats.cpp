@@ -0,0 +1,177 @@
+// bench_window_stats.cpp
+//
+// Native benchmark for per-channel window summaries:
+// - per-sample update cost of the window accumulator (Welford + three
+//   P-square quantiles), alone and fed from the sensor registry rings;
+// - link bandwidth of one PKT_TYPE_SUMMARY per window against streaming
+//   every raw sample, one frame per sample or packed into full frames;
+// - percentile error of the sketch against exact nearest-rank values on
+//   the simulated sensor.
+#include <algorithm>
+#include <vector>
+#include "bench_common.h"
+#include "hal/sensor/sim_sensor.h"
+#include "packet.h"
+#include "sensors/sensor_registry.h"
+#include "stats/window_stats.h"
+
+static sensors::sensor_registry_t g_reg;
+static stats::stats_table_t g_table;
+
+static uint32_t g_emitted;
+static void count_summary(void *ctx, const stats::window_summary_t *s)
+{
+    (void)ctx;
+    g_emitted++;
+    bench::do_not_optimize(s->p99);
+}
+
+static size_t frame_size(uint8_t type, const uint8_t *payload, size_t len)
+{
+    uint8_t frame[PKT_MAX_FRAME];
+    pkt_t pkt = {type, 0, 0, payload, len};
+    return pkt_encode(&pkt, frame, sizeof(frame));
+}
+
+static void bench_update_cost()
+{
+    const uint32_t samples = 20000000;
+    hal::sensor::HalSensorSim sim(1);
+    sim.hal_sensor_init();
+    std::vector<int32_t> values(4096);
+    for (int32_t &v : values)
+        sim.hal_sensor_read(0, &v);
+
+    stats::window_stats_t ws;
+    stats::stats_reset(&ws);
+    uint64_t start = bench::now_ns();
+    for (uint32_t i = 0; i < samples; i++)
+        stats::stats_add(&ws, values[i & 4095]);
+    double add_ns = (double)(bench::now_ns() - start) / samples;
+    bench::do_not_optimize(ws);
+
+    stats::p2_quantile_t pq;
+    stats::p2_init(&pq, 0.99f);
+    start = bench::now_ns();
+    for (uint32_t i = 0; i < samples; i++)
+        stats::p2_add(&pq, (float)values[i & 4095]);
+    double p2_ns = (double)(bench::now_ns() - start) / samples;
+    bench::do_not_optimize(pq);
+
+    printf("stats_add (Welford + 3 quantiles): %.2f ns/sample, one P-square quantile: %.2f ns/sample\n\n",
+           add_ns, p2_ns);
+}
+
+// Registry poll alone vs poll + stats_poll, every channel sampled every ms.
+static void bench_pipeline()
+{
+    const uint32_t polls = 2000000;
+    const uint8_t channel_counts[] = {1, 2, 4, 8};
+
+    printf("%-9s %14s %14s %12s\n", "channels", "poll ns/smp", "+stats ns/smp", "stats ns/smp");
+    for (uint8_t channels : channel_counts)
+    {
+        double ns[2];
+        for (int with_stats = 0; with_stats < 2; with_stats++)
+        {
+            hal::sensor::HalSensorSim sim(channels);
+            sim.hal_sensor_init();
+            sensors::sensor_registry_init(&g_reg);
+            stats::stats_init(&g_table);
+            for (uint8_t ch = 0; ch < channels; ch++)
+            {
+                sensors::sensor_registry_add(&g_reg, &sim, ch, 1, 0);
+                if (with_stats)
+                    stats::stats_configure(&g_table, &g_reg, ch, 1000, 0);
+            }
+
+            uint64_t start = bench::now_ns();
+            for (uint32_t t = 1; t <= polls / channels; t++)
+            {
+                sensors::sensor_registry_poll(&g_reg, t);
+                if (with_stats)
+                    stats::stats_poll(&g_table, &g_reg, t, count_summary, NULL);
+            }
+            ns[with_stats] = (double)(bench::now_ns() - start) / (double)(polls / channels * channels);
+        }
+        printf("%-9u %14.2f %14.2f %12.2f\n", channels, ns[0], ns[1], ns[1] - ns[0]);
+    }
+    printf("\n");
+}
+
+// Bytes on the link per channel-second at rate_hz, raw vs summarized.
+static void bench_bandwidth()
+{
+    // Raw stream: [channel:1][value:4] per sample, alone or 31 to a frame.
+    uint8_t raw[PKT_MAX_PAYLOAD] = {0};
+    const size_t per_frame = (PKT_MAX_PAYLOAD - 1) / 4;
+    double one_frame = (double)frame_size(PKT_TYPE_TELEMETRY, raw, 5);
+    double packed = (double)frame_size(PKT_TYPE_TELEMETRY, raw, 1 + 4 * per_frame) / per_frame;
+
+    pkt_summary_t sum = {0, 1000, 1000, 0, 1000, 3000, 2048 * 256, 577 * 256, 2048, 2900, 3000};
+    uint8_t payload[PKT_SUMMARY_PAYLOAD_SIZE];
+    pkt_summary_pack(&sum, payload, sizeof(payload));
+    double summary = (double)frame_size(PKT_TYPE_SUMMARY, payload, sizeof(payload));
+
+    const uint32_t rates[] = {100, 1000};
+    const uint32_t windows[] = {100, 1000, 10000};
+    printf("summary frame %.0f B; raw %.0f B/sample framed alone, %.2f B/sample packed %zu per frame\n",
+           summary, one_frame, packed, per_frame);
+    printf("%-8s %-10s %12s %12s %12s %10s %10s\n", "rate Hz", "window ms", "raw B/s", "packed B/s",
+           "summary B/s", "vs raw", "vs packed");
+    for (uint32_t hz : rates)
+    {
+        for (uint32_t w : windows)
+        {
+            double summary_bps = summary * 1000.0 / w;
+            printf("%-8u %-10u %12.0f %12.0f %12.1f %9.0fx %9.0fx\n", hz, w, one_frame * hz, packed * hz,
+                   summary_bps, one_frame * hz / summary_bps, packed * hz / summary_bps);
+        }
+    }
+    printf("\n");
+}
+
+// Worst sketch error over 1 s windows of simulated 1 kHz samples.
+static void bench_accuracy()
+{
+    hal::sensor::HalSensorSim sim(4);
+    sim.hal_sensor_init();
+    const float ps[3] = {0.5f, 0.9f, 0.99f};
+    int32_t worst[3] = {0, 0, 0};
+
+    for (int window = 0; window < 200; window++)
+    {
+        uint8_t ch = (uint8_t)(window & 3);
+        stats::window_stats_t ws;
+        stats::stats_reset(&ws);
+        std::vector<int32_t> v(1000);
+        for (int32_t &x : v)
+        {
+            sim.hal_sensor_read(ch, &x);
+            stats::stats_add(&ws, x);
+        }
+        stats::window_summary_t s;
+        stats::stats_summarize(&ws, &s);
+        const int32_t got[3] = {s.p50, s.p90, s.p99};
+
+        std::sort(v.begin(), v.end());
+        for (int i = 0; i < 3; i++)
+        {
+            size_t rank = (size_t)(ps[i] * v.size() + 0.999999f);
+            int32_t err = got[i] - v[rank - 1];
+            err = err < 0 ? -err : err;
+            worst[i] = err > worst[i] ? err : worst[i];
+        }
+    }
+    printf("P-square worst error over 200 windows of 1000 samples (values span ~2000 counts):\n"
+           "p50 %d, p90 %d, p99 %d counts\n", worst[0], worst[1], worst[2]);
+}
+
+int main()
+{
+    bench_update_cost();
+    bench_pipeline();
+    bench_bandwidth();
+    bench_accuracy();
+    return 0;
+}
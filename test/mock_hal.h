@@ -0,0 +1,132 @@
+// mock_hal.h
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "hal/led/hal_led.h"
+#include "hal/time/hal_time.h"
+#include "hal/serial/serial_io.h"
+#include "hal/logging/logging.h"
+#include "hal/timer/hal_timer.h"
+
+/*
+    Manual HAL mocks shared by the app tests and the benchmark suite.
+
+    - MockHalTime is a settable clock; sleeping advances it to the deadline.
+    - MockHalSerial has no input and keeps the last print and write; tests
+      set pending (RX) and tx_wait_us (queued output) directly.
+    - MockHalTimer never fires by itself; tests call fire() for each tick.
+*/
+
+class MockHalLed : public hal::led::IHalLed {
+    public:
+    bool init_called = false;
+    bool set_called = false;
+    bool last_set_value = false;
+    bool toggle_called = false;
+
+    void hal_led_init() override { init_called = true; }
+    void hal_led_set(bool on) override { set_called = true; last_set_value = on; }
+    void hal_led_toggle() override { toggle_called = true; }
+};
+
+class MockHalTime : public hal::time::IHalTime {
+    public:
+    uint32_t micros_value = 1000000; // raw 32-bit counter, wraps like the hardware timer
+    uint64_t last_sleep_deadline = 0;
+    uint32_t sleep_calls = 0;
+    uint32_t wake_after_us = 0; // nonzero: an event ends the next sleep this early
+    uint32_t hal_millis() override { return (uint32_t)(hal_monotonic_us() / 1000u); }
+    uint32_t hal_micros() override { return micros_value; }
+    // hal_monotonic_us(): base class extends micros_value across wraps
+
+    // Sleeping just advances the clock to the deadline (or the wake event).
+    void hal_sleep_until(uint64_t deadline_us) override {
+        sleep_calls++;
+        last_sleep_deadline = deadline_us;
+        uint64_t now = hal_monotonic_us();
+        if (wake_after_us != 0 && deadline_us > now + wake_after_us)
+            micros_value += wake_after_us;
+        else if (deadline_us > now)
+            micros_value += (uint32_t)(deadline_us - now);
+        wake_after_us = 0;
+    }
+    void hal_wake() override {}
+};
+
+class MockHalSerial : public hal::serial::ISerialIo {
+    public:
+    bool readline_called = false;
+    char last_print[256] = {0};
+    uint8_t last_write[256] = {0};
+    size_t last_write_len = 0;
+    size_t last_flush_budget = 0;
+    bool pending = false;
+    uint32_t tx_wait_us = 0;
+
+    bool serial_readline(char *out, size_t out_cap) override {
+        (void)out;
+        (void)out_cap;
+        readline_called = true;
+        // Simulate no input for simplicity
+        return false;
+    }
+
+    void hal_serial_print(const char *str) override {
+        strncpy(last_print, str, sizeof(last_print) - 1);
+        last_print[sizeof(last_print) - 1] = '\0';
+    }
+
+    void hal_serial_write(const uint8_t *data, size_t len) override {
+        last_write_len = len < sizeof(last_write) ? len : sizeof(last_write);
+        memcpy(last_write, data, last_write_len);
+    }
+
+    size_t hal_serial_flush(size_t max_bytes) override {
+        last_flush_budget = max_bytes;
+        return 0;
+    }
+
+    bool hal_serial_pending() override { return pending; }
+    uint32_t hal_serial_tx_wait_us(size_t max_bytes) override {
+        (void)max_bytes;
+        return tx_wait_us;
+    }
+};
+
+class MockLogger : public hal::logging::ILogger {
+    public:
+    char last_log[256] = {0};
+    bool log_called = false;
+
+    void log(const char *message) override {
+        log_called = true;
+        strncpy(last_log, message, sizeof(last_log) - 1);
+        last_log[sizeof(last_log) - 1] = '\0';
+    }
+};
+
+class MockHalTimer : public hal::timer::IHalTimer {
+    public:
+    hal::timer::timer_callback_t callback = nullptr;
+    void *ctx = nullptr;
+    uint32_t period_us = 0;
+    bool running = false;
+    bool refuse = false; // hal_timer_start() fails
+
+    bool hal_timer_start(uint32_t period, hal::timer::timer_callback_t cb, void *c) override {
+        if (refuse || running)
+            return false;
+        period_us = period;
+        callback = cb;
+        ctx = c;
+        running = true;
+        return true;
+    }
+    void hal_timer_stop() override { running = false; }
+
+    // n timer ticks, as the alarm interrupt would deliver them.
+    void fire(uint32_t n = 1) {
+        for (uint32_t i = 0; i < n && running; i++)
+            callback(ctx);
+    }
+};
@@ -0,0 +1,532 @@
+// sim_node.cpp
+#include "sim_node.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "packet.h"
+#include "hal/sensor/sim_sensor.h"
+
+namespace sim
+{
+    sim_config_t sim_default_config()
+    {
+        sim_config_t cfg;
+        cfg.link_bytes_per_sec = 11520; // 115200 baud, 10 bits per byte
+        cfg.tx_queue_bytes = 1024;
+        cfg.tx_fifo_bytes = 256;      // TinyUSB CDC TX buffer behind Serial
+        cfg.pass_cost_us = 10;
+        cfg.command_cost_us = 20;
+        cfg.lines_per_pass = 8;
+        cfg.heartbeat_period_ms = 2000;
+        return cfg;
+    }
+
+    // ---- HAL stand-ins ----
+
+    void SimClock::hal_sleep_until(uint64_t deadline_us)
+    {
+        // Until the deadline, input arrives, or a timer tick calls hal_wake().
+        // Each message finishing on the wire on the way is an event too: the
+        // host may answer it with input that ends the sleep.
+        SimTimer &t = node_->timer;
+        woken_ = false;
+        for (;;)
+        {
+            uint64_t wake = deadline_us;
+            uint64_t input;
+            if (node_->next_input(&input) && input > now_us && input < wake)
+                wake = input;
+
+            uint64_t step = wake;
+            if (t.running && t.next_us < step)
+                step = t.next_us;
+            uint64_t sent;
+            if (node_->wire_next_done(&sent) && sent > now_us && sent < step)
+                step = sent;
+
+            if (step >= wake)
+            {
+                if (wake > now_us)
+                    now_us = wake;
+                return;
+            }
+            if (step > now_us)
+                now_us = step;
+            node_->advance_wire(now_us);
+            node_->fire_timer(now_us);
+            if (woken_)
+                return;
+        }
+    }
+
+    bool SimTimer::hal_timer_start(uint32_t period, hal::timer::timer_callback_t callback, void *ctx)
+    {
+        if (period == 0 || running)
+            return false;
+        period_us = period;
+        callback_ = callback;
+        ctx_ = ctx;
+        next_us = *clock_ + period;
+        running = true;
+        return true;
+    }
+
+    void SimLed::hal_led_toggle()
+    {
+        node_->on_heartbeat(node_->clock.now_us);
+    }
+
+    bool SimSerial::serial_readline(char *out, size_t out_cap)
+    {
+        auto it = node_->rx_.begin();
+        if (it == node_->rx_.end() || it->first > node_->clock.now_us || out_cap == 0)
+            return false;
+
+        strncpy(out, it->second.first.c_str(), out_cap - 1);
+        out[out_cap - 1] = '\0';
+        node_->read_sent_us_ = it->second.second;
+        node_->rx_.erase(it);
+        return true;
+    }
+
+    void SimSerial::hal_serial_print(const char *str)
+    {
+        node_->capture(str, strlen(str));
+        node_->enqueue((const uint8_t *)str, strlen(str));
+    }
+
+    void SimSerial::hal_serial_write(const uint8_t *data, size_t len)
+    {
+        // A reply batch that filled up mid-command: its tail is this reply.
+        if (node_->current_command_ >= 0 && data == (const uint8_t *)node_->app.reply.buf)
+        {
+            if (len > node_->reply_mark_)
+                node_->capture((const char *)data + node_->reply_mark_, len - node_->reply_mark_);
+            node_->reply_mark_ = 0;
+        }
+
+        if (node_->in_tick_ && node_->current_command_ < 0)
+        {
+            uint8_t scratch[PKT_MAX_RAW];
+            pkt_t pkt;
+            if (pkt_decode(data, len, scratch, sizeof(scratch), &pkt) &&
+                (pkt.type == PKT_TYPE_TELEMETRY || pkt.type == PKT_TYPE_TELEMETRY_KEY ||
+                 pkt.type == PKT_TYPE_TELEMETRY_DELTA || pkt.type == PKT_TYPE_CHANGES_KEY ||
+                 pkt.type == PKT_TYPE_CHANGES_DELTA))
+                node_->on_telemetry(node_->tick_now_us_, len);
+        }
+        node_->enqueue(data, len);
+    }
+
+    size_t SimSerial::hal_serial_flush(size_t max_bytes)
+    {
+        node_->advance_wire(node_->clock.now_us);
+
+        size_t queued = node_->tx_total_ - node_->fifo_bytes_;
+        size_t room = node_->cfg_.tx_fifo_bytes - node_->fifo_bytes_;
+        size_t n = queued < max_bytes ? queued : max_bytes;
+        n = n < room ? n : room;
+        node_->fifo_bytes_ += n;
+
+        node_->advance_wire(node_->clock.now_us); // unlimited links drain at once
+        return n;
+    }
+
+    bool SimSerial::hal_serial_pending()
+    {
+        auto it = node_->rx_.begin();
+        bool rx_ready = it != node_->rx_.end() && it->first <= node_->clock.now_us;
+        return rx_ready;
+    }
+
+    uint32_t SimSerial::hal_serial_tx_wait_us(size_t max_bytes)
+    {
+        node_->advance_wire(node_->clock.now_us);
+        size_t queued = node_->tx_total_ - node_->fifo_bytes_;
+        if (queued == 0)
+            return 0;
+
+        // Like HalSerial: until the FIFO has room for the next max_bytes.
+        size_t want = queued < max_bytes ? queued : max_bytes;
+        size_t room = node_->cfg_.tx_fifo_bytes - node_->fifo_bytes_;
+        if (room >= want || node_->cfg_.link_bytes_per_sec == 0)
+            return 1;
+        double done_us = node_->wire_us_ + (double)(want - room) * 1e6 / node_->cfg_.link_bytes_per_sec;
+        double wait = ceil(done_us) - (double)node_->clock.now_us;
+        return wait < 1.0 ? 1u : (uint32_t)wait;
+    }
+
+    size_t SimSerial::hal_serial_tx_free()
+    {
+        return node_->cfg_.tx_queue_bytes - (node_->tx_total_ - node_->fifo_bytes_);
+    }
+
+    void SimLogger::log(const char *message)
+    {
+        if (node_->in_tick_ && node_->current_command_ < 0 && strncmp(message, "STATE=", 6) == 0)
+            node_->on_telemetry(node_->tick_now_us_, strlen(message) + 2);
+
+        std::string line(message);
+        line += "\r\n";
+        node_->capture(line.data(), line.size());
+        node_->enqueue((const uint8_t *)line.data(), line.size());
+    }
+
+    // ---- Simulation ----
+
+    SimNode::SimNode(const sim_config_t &cfg, uint64_t boot_us)
+        : clock(this), led(this), serial(this), logger(this), cfg_(cfg)
+    {
+        memset(&report_, 0, sizeof(report_));
+        clock.now_us = boot_us;
+        timer.clock_ = &clock.now_us;
+        rx_wire_free_us_ = boot_us;
+        wire_us_ = (double)boot_us;
+        app::app_init(&app, boot_us, &led, &clock, &serial, &logger);
+        stream::stream_init(&stream, &timer, &clock);
+        app::app_attach_stream(&app, &stream);
+        telemetry_anchor_us_ = boot_us;
+        last_heartbeat_us_ = boot_us;
+    }
+
+    void SimNode::script(uint64_t at_us, const char *line)
+    {
+        // Lines go out back to back; each is received once its "\r\n" is in.
+        uint64_t start = at_us > rx_wire_free_us_ ? at_us : rx_wire_free_us_;
+        uint64_t bytes = strlen(line) + 2;
+        uint64_t ready = start;
+        if (cfg_.link_bytes_per_sec != 0)
+            ready += (bytes * 1000000u + cfg_.link_bytes_per_sec - 1) / cfg_.link_bytes_per_sec;
+        rx_wire_free_us_ = ready;
+        rx_.insert(std::make_pair(ready, std::make_pair(std::string(line), at_us)));
+    }
+
+    bool SimNode::next_input(uint64_t *at_us) const
+    {
+        if (rx_.empty())
+            return false;
+        *at_us = rx_.begin()->first;
+        return true;
+    }
+
+    void SimNode::enqueue(const uint8_t *data, size_t len)
+    {
+        (void)data; // only the length matters on the wire
+        if (len == 0)
+            return;
+
+        // Drop newest, whole messages, like HalSerial's TX queue.
+        if (tx_total_ - fifo_bytes_ + len > cfg_.tx_queue_bytes)
+        {
+            report_.tx_dropped++;
+            return;
+        }
+
+        segment_t seg = {(uint32_t)len, attr_first_, attr_last_};
+        for (int64_t i = attr_first_; i >= 0 && i <= attr_last_; i++)
+            commands_[i].open++;
+        tx_.push_back(seg);
+        tx_total_ += len;
+    }
+
+    void SimNode::advance_wire(uint64_t now_us)
+    {
+        double now = (double)now_us;
+        double us_per_byte = cfg_.link_bytes_per_sec != 0 ? 1e6 / cfg_.link_bytes_per_sec : 0.0;
+
+        if (fifo_bytes_ == 0 && wire_us_ < now)
+            wire_us_ = now; // idle wire: the next byte starts when it is flushed
+
+        while (fifo_bytes_ > 0)
+        {
+            segment_t &seg = tx_.front();
+            size_t n = seg.left < fifo_bytes_ ? seg.left : fifo_bytes_;
+            if (wire_us_ + n * us_per_byte > now)
+                n = (size_t)((now - wire_us_) / us_per_byte); // only part of it fits
+            if (n == 0)
+                break;
+
+            wire_us_ += n * us_per_byte;
+            seg.left -= (uint32_t)n;
+            fifo_bytes_ -= n;
+            tx_total_ -= n;
+            report_.tx_bytes += n;
+
+            if (seg.left == 0)
+            {
+                segment_done(seg, (uint64_t)(wire_us_ + 0.999));
+                tx_.pop_front();
+            }
+        }
+
+        if (fifo_bytes_ == 0 && wire_us_ < now)
+            wire_us_ = now;
+    }
+
+    bool SimNode::wire_next_done(uint64_t *at_us) const
+    {
+        if (fifo_bytes_ == 0 || cfg_.link_bytes_per_sec == 0)
+            return false;
+        size_t n = tx_.front().left < fifo_bytes_ ? tx_.front().left : fifo_bytes_;
+        *at_us = (uint64_t)ceil(wire_us_ + n * 1e6 / cfg_.link_bytes_per_sec);
+        return true;
+    }
+
+    void SimNode::segment_done(const segment_t &seg, uint64_t at_us)
+    {
+        for (int64_t i = seg.first; i >= 0 && i <= seg.last; i++)
+        {
+            command_t &cmd = commands_[i];
+            cmd.open--;
+            cmd.last_us = at_us > cmd.last_us ? at_us : cmd.last_us;
+            if (cmd.open == 0 && cmd.handled)
+                command_complete(i);
+        }
+    }
+
+    void SimNode::command_done(int64_t index)
+    {
+        command_t &cmd = commands_[index];
+        cmd.handled = true;
+        cmd.last_us = clock.now_us > cmd.last_us ? clock.now_us : cmd.last_us;
+        if (cmd.open == 0)
+            command_complete(index);
+    }
+
+    void SimNode::command_complete(int64_t index)
+    {
+        const command_t &cmd = commands_[index];
+        report_.command_latency_us.record((uint32_t)(cmd.last_us - cmd.sent_us));
+        if (on_reply)
+            on_reply((uint64_t)index, cmd.last_us);
+    }
+
+    void SimNode::capture(const char *text, size_t len)
+    {
+        if (current_command_ >= 0)
+            reply_.append(text, len);
+    }
+
+    void SimNode::on_telemetry(uint64_t at_us, size_t bytes)
+    {
+        uint64_t period = (uint64_t)app.telemetry_period_ms * 1000u;
+        uint64_t offset = (at_us - telemetry_anchor_us_) % period;
+
+        // Publish on change skips quiet periods on purpose.
+        bool every_period = app.telemetry_mode != app::APP_TELEMETRY_CHANGES;
+        if (every_period && last_telemetry_us_ != 0 && at_us - last_telemetry_us_ > period + period / 2)
+            report_.telemetry_missed += (uint32_t)((at_us - last_telemetry_us_ + period / 2) / period - 1);
+
+        report_.telemetry++;
+        report_.telemetry_bytes += bytes;
+        report_.telemetry_phase_us.record((uint32_t)offset);
+        report_.telemetry_drift_us = (int64_t)offset;
+        last_telemetry_us_ = at_us;
+    }
+
+    void SimNode::on_heartbeat(uint64_t at_us)
+    {
+        uint64_t period = (uint64_t)cfg_.heartbeat_period_ms * 1000u;
+        uint64_t offset = (at_us - app.boot_us) % period;
+
+        if (at_us - last_heartbeat_us_ > period + period / 2)
+            report_.heartbeat_missed += (uint32_t)((at_us - last_heartbeat_us_ + period / 2) / period - 1);
+
+        report_.heartbeats++;
+        report_.heartbeat_phase_us.record((uint32_t)offset);
+        last_heartbeat_us_ = at_us;
+    }
+
+    void SimNode::fire_timer(uint64_t until_us)
+    {
+        // Ticks that fell due while the loop was busy run now, in order.
+        while (timer.running && timer.next_us <= until_us)
+        {
+            timer.next_us += timer.period_us;
+            timer.fired++;
+            timer.callback_(timer.ctx_);
+        }
+    }
+
+    void SimNode::run_until(uint64_t end_us)
+    {
+        while (clock.now_us < end_us)
+        {
+            // One pass of main.cpp's loop().
+            const uint64_t now = clock.now_us;
+            report_.passes++;
+            fire_timer(now);
+            advance_wire(now);
+
+            // Commands of this pass; their replies leave as one batch.
+            char line[96];
+            const int64_t batch_first = (int64_t)commands_.size();
+            app::app_begin_batch(&app);
+            for (int i = 0; i < cfg_.lines_per_pass && serial.serial_readline(line, sizeof(line)); i++)
+            {
+                command_t cmd = {read_sent_us_, 0, false, 0};
+                commands_.push_back(cmd);
+                current_command_ = (int64_t)commands_.size() - 1;
+                attr_first_ = batch_first;
+                attr_last_ = current_command_;
+                reply_.clear();
+                reply_mark_ = app.reply.len;
+
+                uint32_t period_ms = app.telemetry_period_ms;
+                app::app_handle_command(&app, line);
+                if (app.telemetry_period_ms != period_ms)
+                {
+                    // RATE restarted the telemetry phase from now.
+                    telemetry_anchor_us_ = clock.now_us;
+                    last_telemetry_us_ = 0;
+                }
+                clock.now_us += cfg_.command_cost_us;
+                if (app.reply.len > reply_mark_)
+                    reply_.append(app.reply.buf + reply_mark_, app.reply.len - reply_mark_);
+
+                while (reply_.size() >= 2 && reply_.compare(reply_.size() - 2, 2, "\r\n") == 0)
+                    reply_.resize(reply_.size() - 2);
+                replies_.push_back(reply_);
+                if (replies_.size() > SIM_REPLIES_KEPT)
+                    replies_.pop_front();
+
+                current_command_ = -1;
+                report_.commands++;
+            }
+            const int64_t batch_last = (int64_t)commands_.size() - 1;
+            attr_first_ = batch_last >= batch_first ? batch_first : -1;
+            attr_last_ = batch_last;
+            app::app_end_batch(&app);
+            attr_first_ = attr_last_ = -1;
+            for (int64_t i = batch_first; i <= batch_last; i++)
+                command_done(i);
+
+            in_tick_ = true;
+            tick_now_us_ = now;
+            app::app_tick(&app, now);
+            in_tick_ = false;
+
+            clock.now_us += cfg_.pass_cost_us;
+            report_.tx_queue_bytes.record((uint32_t)(tx_total_ - fifo_bytes_));
+
+            uint64_t before = clock.now_us;
+            app::app_idle(&app, before);
+            if (clock.now_us != before)
+            {
+                report_.sleeps++;
+                advance_wire(clock.now_us);
+            }
+        }
+    }
+
+    static void print_hist(FILE *out, const char *name, const util::LogHistogram &h)
+    {
+        fprintf(out, "  %-20s n=%u mean=%u p50=%u p99=%u max=%u\n", name, h.count(), h.mean(),
+                h.percentile(500), h.percentile(990), h.max());
+    }
+
+    void sim_print_report(FILE *out, const sim_report_t *r)
+    {
+        fprintf(out, "  passes=%llu sleeps=%llu commands=%llu tx_bytes=%llu tx_dropped=%u\n",
+                (unsigned long long)r->passes, (unsigned long long)r->sleeps, (unsigned long long)r->commands,
+                (unsigned long long)r->tx_bytes, r->tx_dropped);
+        fprintf(out, "  telemetry=%llu bytes=%llu missed=%u drift_us=%lld heartbeats=%llu missed=%u\n",
+                (unsigned long long)r->telemetry, (unsigned long long)r->telemetry_bytes, r->telemetry_missed,
+                (long long)r->telemetry_drift_us,
+                (unsigned long long)r->heartbeats, r->heartbeat_missed);
+        print_hist(out, "telemetry_phase_us", r->telemetry_phase_us);
+        print_hist(out, "heartbeat_phase_us", r->heartbeat_phase_us);
+        print_hist(out, "tx_queue_bytes", r->tx_queue_bytes);
+        print_hist(out, "command_latency_us", r->command_latency_us);
+    }
+
+    double sim_command_throughput(const sim_config_t &cfg, const char *line, uint32_t count, uint32_t window,
+                                  uint64_t turnaround_us)
+    {
+        SimNode *node = new SimNode(cfg);
+        uint32_t sent = 0;
+        uint32_t done = 0;
+        uint64_t last_us = 0;
+        auto send = [&](uint64_t at_us)
+        {
+            std::string tagged = "#" + std::to_string(sent++) + " " + line;
+            node->script(at_us, tagged.c_str());
+        };
+
+        node->on_reply = [&](uint64_t, uint64_t done_us)
+        {
+            done++;
+            last_us = done_us;
+            if (sent < count)
+                send(done_us + turnaround_us);
+        };
+        for (uint32_t i = 0; i < window && i < count; i++)
+            send(0);
+
+        // Run in slices until every reply is in (or the node stops answering).
+        for (uint64_t end = 100000; done < count && end < 3600u * 1000000u; end += 100000)
+            node->run_until(end);
+
+        delete node;
+        return done == count && last_us > 0 ? (double)count * 1e6 / (double)last_us : 0.0;
+    }
+
+    // Flat channel: 2048 plus the same +/-8 counts of noise as HalSensorSim.
+    class QuietSensor : public hal::sensor::ISensor
+    {
+    public:
+        void hal_sensor_init() override {}
+        uint8_t hal_sensor_channel_count() override { return SIM_TELEMETRY_CHANNELS; }
+        bool hal_sensor_read(uint8_t channel, int32_t *value) override
+        {
+            noise_[channel] = noise_[channel] * 1664525u + 1013904223u;
+            *value = 2048 + (int32_t)(noise_[channel] >> 28) - 8;
+            return true;
+        }
+
+    private:
+        uint32_t noise_[SIM_TELEMETRY_CHANNELS] = {1, 2, 3, 4};
+    };
+
+    double sim_telemetry_bandwidth(const sim_config_t &cfg, const char *mode, uint32_t deadband, bool active,
+                                   uint64_t span_us)
+    {
+        SimNode *node = new SimNode(cfg);
+        sensors::sensor_registry_t *reg = new sensors::sensor_registry_t;
+        QuietSensor quiet;
+        hal::sensor::HalSensorSim wave(SIM_TELEMETRY_CHANNELS);
+        wave.hal_sensor_init();
+        hal::sensor::ISensor *source = active ? (hal::sensor::ISensor *)&wave : &quiet;
+
+        sensors::sensor_registry_init(reg);
+        for (uint8_t ch = 0; ch < SIM_TELEMETRY_CHANNELS; ch++)
+            sensors::sensor_registry_add(reg, source, ch, SIM_TELEMETRY_PERIOD_MS, 0);
+        app::app_attach_sensors(&node->app, reg);
+
+        char line[32];
+        snprintf(line, sizeof(line), "RATE %u", (unsigned)SIM_TELEMETRY_PERIOD_MS);
+        node->script(0, line);
+        node->script(0, mode);
+        for (uint8_t ch = 0; ch < SIM_TELEMETRY_CHANNELS; ch++)
+        {
+            snprintf(line, sizeof(line), "DEADBAND %u %u", (unsigned)ch, (unsigned)deadband);
+            node->script(0, line);
+        }
+        if (active)
+        {
+            for (uint64_t t = 5000000u; t < span_us; t += 10000000u)
+            {
+                node->script(t, "ARM");
+                node->script(t + 4000000u, "FAULT");
+                node->script(t + 7000000u, "DISARM");
+            }
+        }
+
+        node->run_until(span_us);
+        double rate = (double)node->report().telemetry_bytes * 1e6 / (double)span_us;
+        delete reg;
+        delete node;
+        return rate;
+    }
+} // namespace sim
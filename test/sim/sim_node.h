@@ -0,0 +1,288 @@
+// sim_node.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "app.h"
+#include "stream/stream.h"
+#include "log_histogram.h"
+
+/*
+    Virtual-Time Node Simulator
+
+    Responsibilities:
+    - Run the firmware main loop (serial_readline -> app_handle_command,
+      app_tick, app_idle; see main.cpp) against a virtual clock, as a
+      discrete-event simulation: sleeps jump straight to the next deadline,
+      input arrival or output completion, so weeks of device time take
+      seconds.
+    - Deliver scripted host command lines at given times, and model the
+      serial link: a bounded TX queue (drop newest, like HalSerial), a
+      hardware FIFO fed by hal_serial_flush(), and a wire that drains the
+      FIFO (and delivers RX lines) at a fixed byte rate.
+    - Measure what the hand-set mocks in test_app.cpp cannot: telemetry
+      phase error and drift, heartbeat accuracy, TX queue occupancy and
+      drops, and command latency from host send to last reply byte.
+    - Mirror the reply batching of main.cpp: the replies of one pass leave
+      as one write, and each of its commands completes when that write has
+      left. A host hook (on_reply) can react to completions, e.g. to model
+      a lock-step or windowed host.
+    - Drive the STREAM timer: its callback runs at every period boundary,
+      before the pass that follows it, and a block it completes ends a
+      sleep early (hal_wake) as on the device.
+
+    Cost model:
+    - A loop pass costs pass_cost_us of virtual time and each handled
+      command command_cost_us; everything else is instantaneous. The loop
+      spins (no sleep) while input is unread or output is queued, exactly
+      as app_idle() decides on the device.
+
+    Invariants:
+    - Deterministic: no wall clock, no randomness. The same config and
+      script give the same report, bit for bit.
+    - hal_micros() wraps at 32 bits like the hardware timer; the app runs
+      on hal_monotonic_us(), which is the 64-bit virtual clock.
+    - Telemetry is recognized by content: "STATE=" lines outside command
+      replies in TEXT mode, PKT_TYPE_TELEMETRY* / PKT_TYPE_CHANGES_* frames
+      otherwise. Quiet periods in CHANGES mode are not missed records. Its
+      phase is measured against boot, re-anchored when RATE changes the
+      period (the scheduler restarts the phase at that point).
+*/
+// Replies kept for inspection; older ones are forgotten.
+#ifndef SIM_REPLIES_KEPT
+#define SIM_REPLIES_KEPT 256
+#endif
+
+// sim_telemetry_bandwidth(): channels published and telemetry / sample period.
+#define SIM_TELEMETRY_CHANNELS 4
+#define SIM_TELEMETRY_PERIOD_MS 100
+
+namespace sim
+{
+    typedef struct
+    {
+        uint32_t link_bytes_per_sec; // both directions; 0 = unlimited
+        size_t tx_queue_bytes;       // software TX queue (HalSerial: 1024)
+        size_t tx_fifo_bytes;        // hardware buffer hal_serial_flush() fills
+        uint32_t pass_cost_us;       // virtual CPU time of one loop pass
+        uint32_t command_cost_us;    // extra virtual CPU time per command
+        int lines_per_pass;          // CMD_LINES_PER_LOOP in main.cpp
+        uint32_t heartbeat_period_ms; // HEARTBEAT_PERIOD_MS in app.cpp
+    } sim_config_t;
+
+    // 115200 8N1, HalSerial queue, a 256-byte USB CDC buffer, eight lines per pass.
+    sim_config_t sim_default_config();
+
+    typedef struct
+    {
+        uint64_t passes;         // loop passes
+        uint64_t sleeps;         // passes that ended in a sleep
+        uint64_t telemetry;      // telemetry records emitted
+        uint32_t telemetry_missed; // periods skipped (interval > 1.5 periods)
+        int64_t telemetry_drift_us; // last record's offset from its grid slot
+        util::LogHistogram telemetry_phase_us; // lateness against the grid
+        uint64_t heartbeats;
+        uint32_t heartbeat_missed;
+        util::LogHistogram heartbeat_phase_us;  // toggle lateness
+        util::LogHistogram tx_queue_bytes;      // queue occupancy, per pass
+        uint32_t tx_dropped;     // messages dropped on a full queue
+        uint64_t tx_bytes;       // bytes that left on the wire
+        uint64_t telemetry_bytes; // of those, telemetry records (line or frame)
+        uint64_t commands;       // commands handled
+        util::LogHistogram command_latency_us; // host send -> last reply byte
+    } sim_report_t;
+
+    class SimNode;
+
+    class SimClock : public hal::time::IHalTime
+    {
+    public:
+        explicit SimClock(SimNode *node) : node_(node) {}
+        uint64_t now_us = 0;
+        uint32_t hal_millis() override { return (uint32_t)(now_us / 1000u); }
+        uint32_t hal_micros() override { return (uint32_t)now_us; }
+        uint64_t hal_monotonic_us() override { return now_us; }
+        void hal_sleep_until(uint64_t deadline_us) override; // jumps to min(deadline, next input)
+        void hal_wake() override { woken_ = true; }
+
+    private:
+        SimNode *node_;
+        bool woken_ = false;
+    };
+
+    // Repeating timer on the virtual clock; SimNode fires it.
+    class SimTimer : public hal::timer::IHalTimer
+    {
+    public:
+        bool hal_timer_start(uint32_t period_us, hal::timer::timer_callback_t callback, void *ctx) override;
+        void hal_timer_stop() override { running = false; }
+
+        bool running = false;
+        uint32_t period_us = 0;
+        uint64_t next_us = 0; // next fire
+        uint64_t fired = 0;
+
+    private:
+        friend class SimNode;
+        friend class SimClock;
+        uint64_t *clock_ = nullptr;
+        hal::timer::timer_callback_t callback_ = nullptr;
+        void *ctx_ = nullptr;
+    };
+
+    class SimLed : public hal::led::IHalLed
+    {
+    public:
+        explicit SimLed(SimNode *node) : node_(node) {}
+        void hal_led_init() override {}
+        void hal_led_set(bool) override {}
+        void hal_led_toggle() override;
+
+    private:
+        SimNode *node_;
+    };
+
+    class SimSerial : public hal::serial::ISerialIo
+    {
+    public:
+        explicit SimSerial(SimNode *node) : node_(node) {}
+        bool serial_readline(char *out, size_t out_cap) override;
+        void hal_serial_print(const char *str) override;
+        void hal_serial_write(const uint8_t *data, size_t len) override;
+        size_t hal_serial_flush(size_t max_bytes) override;
+        bool hal_serial_pending() override;
+        bool hal_serial_connected() override { return connected; }
+        size_t hal_serial_tx_free() override;
+        uint32_t hal_serial_tx_wait_us(size_t max_bytes) override;
+
+        bool connected = true;
+
+    private:
+        SimNode *node_;
+    };
+
+    // Mirrors HalSerialLogger: the message and "\r\n" as one queued message.
+    class SimLogger : public hal::logging::ILogger
+    {
+    public:
+        explicit SimLogger(SimNode *node) : node_(node) {}
+        void log(const char *message) override;
+
+    private:
+        SimNode *node_;
+    };
+
+    class SimNode
+    {
+    public:
+        explicit SimNode(const sim_config_t &cfg, uint64_t boot_us = 0);
+
+        // The host sends line (no line ending) starting at at_us.
+        void script(uint64_t at_us, const char *line);
+
+        // Run the main loop until the virtual clock reaches end_us.
+        void run_until(uint64_t end_us);
+
+        uint64_t now_us() const { return clock.now_us; }
+        const sim_report_t &report() const { return report_; }
+        const std::deque<std::string> &replies() const { return replies_; } // latest replies, oldest first
+        uint64_t commands_sent() const { return commands_.size(); }
+
+        // Called when command number index (in handling order, from 0) has
+        // its last reply byte on the wire, at done_us. It may script() more.
+        std::function<void(uint64_t index, uint64_t done_us)> on_reply;
+
+        app::app_t app;
+        SimClock clock;
+        SimLed led;
+        SimSerial serial;
+        SimLogger logger;
+        SimTimer timer;
+        stream::stream_t stream; // attached to app; STREAM needs sensors (app_attach_sensors)
+
+    private:
+        friend class SimClock;
+        friend class SimLed;
+        friend class SimSerial;
+        friend class SimLogger;
+
+        typedef struct
+        {
+            uint32_t left;    // bytes not yet on the wire
+            int64_t first;    // commands_ whose replies it carries, -1 = unsolicited
+            int64_t last;
+        } segment_t;
+
+        typedef struct
+        {
+            uint64_t sent_us;  // host started sending
+            uint32_t open;     // reply segments still queued
+            bool handled;
+            uint64_t last_us;  // last reply byte left (or handling ended)
+        } command_t;
+
+        void enqueue(const uint8_t *data, size_t len);
+        void advance_wire(uint64_t now_us);
+        bool wire_next_done(uint64_t *at_us) const; // when the next message in the FIFO has left
+        void segment_done(const segment_t &seg, uint64_t at_us);
+        void command_done(int64_t index);
+        void command_complete(int64_t index);
+        bool next_input(uint64_t *at_us) const;
+        void capture(const char *text, size_t len);
+        void on_telemetry(uint64_t at_us, size_t bytes);
+        void on_heartbeat(uint64_t at_us);
+        void fire_timer(uint64_t until_us);
+
+        sim_config_t cfg_;
+        sim_report_t report_;
+
+        // Host -> node: lines keyed by the time they are fully received.
+        std::multimap<uint64_t, std::pair<std::string, uint64_t>> rx_; // ready_us -> (line, sent_us)
+        uint64_t rx_wire_free_us_ = 0;
+        uint64_t read_sent_us_ = 0; // sent_us of the line serial_readline() returned last
+
+        // Node -> host: queue, FIFO (first fifo_bytes_ of the queue) and wire.
+        std::deque<segment_t> tx_;
+        size_t tx_total_ = 0;
+        size_t fifo_bytes_ = 0;
+        double wire_us_ = 0; // wire busy until
+
+        std::vector<command_t> commands_;
+        int64_t current_command_ = -1; // being handled; its output is its reply
+        int64_t attr_first_ = -1;      // commands output is attributed to, -1 = none
+        int64_t attr_last_ = -1;
+        size_t reply_mark_ = 0;        // app.reply.len when the current command started
+        bool in_tick_ = false;
+        uint64_t tick_now_us_ = 0;
+        std::string reply_;                 // output of the command being handled
+        std::deque<std::string> replies_;   // last SIM_REPLIES_KEPT replies
+
+        uint64_t telemetry_anchor_us_ = 0;
+        uint64_t last_telemetry_us_ = 0;
+        uint64_t last_heartbeat_us_ = 0;
+    };
+
+    void sim_print_report(FILE *out, const sim_report_t *r);
+
+    // A host sending count tagged copies of line (e.g. "LED AUTO"), keeping
+    // at most window of them unanswered (1 = lock-step) and sending the
+    // next one turnaround_us after a reply completes. Returns commands per
+    // second of device time from the first send to the last reply.
+    double sim_command_throughput(const sim_config_t &cfg, const char *line, uint32_t count, uint32_t window,
+                                  uint64_t turnaround_us);
+
+    // Telemetry bytes per second of device time over span_us in the given
+    // mode (a TELEMETRY command line), with SIM_TELEMETRY_CHANNELS channels
+    // sampled and published every SIM_TELEMETRY_PERIOD_MS and every channel's
+    // DEADBAND set to deadband. Idle: flat channels with +/-8 counts of noise
+    // and no commands. Active: HalSensorSim triangle waves and an ARM /
+    // FAULT / DISARM cycle every 10 s.
+    double sim_telemetry_bandwidth(const sim_config_t &cfg, const char *mode, uint32_t deadband, bool active,
+                                   uint64_t span_us);
+} // namespace sim
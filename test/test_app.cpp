@@ -1,60 +1,76 @@
 #include <unity.h>
 #include <cstring>
+#include <string>
 #include "app.h"
-#include "hal/led/hal_led.h"
-#include "hal/time/hal_time.h"
-#include "hal/serial/serial_io.h"
-#include "hal/logging/logging.h"
+#include "mock_hal.h"
+#include "packet.h"
+#include "hal/sensor/sim_sensor.h"
+#include "hal/flash/hal_flash_native.h"
+#include <unistd.h>
+#include <vector>
 
-
-// Manual mocks for HAL interfaces
-class MockHalLed : public hal::led::IHalLed {
+// Serial HAL that lends message blocks, like HalSerial with its pool.
+class PooledMockSerial : public MockHalSerial {
     public:
-    bool init_called = false;
-    bool set_called = false;
-    bool last_set_value = false;
-    bool toggle_called = false;
-
-    void hal_led_init() override { init_called = true; }
-    void hal_led_set(bool on) override { set_called = true; last_set_value = on; }
-    void hal_led_toggle() override { toggle_called = true; }
-};
+    util::MsgPool<SERIAL_MSG_BLOCK_SIZE, 2> pool;
+    std::string sent;
+    size_t sends = 0;
 
-class MockHalTime : public hal::time::IHalTime {
-    public:
-    uint32_t millis_value = 1000;
-    uint32_t hal_millis() override {return millis_value; }
+    uint8_t *hal_serial_alloc(size_t len) override {
+        return len <= pool.block_size() ? pool.alloc() : nullptr;
+    }
+
+    void hal_serial_send(uint8_t *block, size_t len) override {
+        sends++;
+        sent.assign((const char *)block, len);
+        pool.free(block); // "transmitted"
+    }
 };
 
-class MockHalSerial : public hal::serial::ISerialIo {
+// Serial HAL that can lose its host and keeps every frame written.
+class LinkMockSerial : public MockHalSerial {
     public:
-    bool readline_called = false;
-    char last_print[256] = {0};
+    bool connected = true;
+    std::vector<std::string> frames;
+
+    size_t tx_free = SIZE_MAX;
+
+    bool hal_serial_connected() override { return connected; }
+    size_t hal_serial_tx_free() override { return tx_free; }
 
-    bool serial_readline(char *out, size_t out_cap) override {
-        readline_called = true;
-        // Simulate no input for simplicity
-        return false;
+    void hal_serial_write(const uint8_t *data, size_t len) override {
+        MockHalSerial::hal_serial_write(data, len);
+        frames.push_back(std::string((const char *)data, len));
     }
+};
+
+// Serial HAL that keeps every printed line.
+class PrintLogSerial : public MockHalSerial {
+    public:
+    std::vector<std::string> lines;
 
     void hal_serial_print(const char *str) override {
-        strncpy(last_print, str, sizeof(last_print) - 1);
-        last_print[sizeof(last_print) - 1] = '\0';
+        MockHalSerial::hal_serial_print(str);
+        lines.push_back(str);
     }
 };
 
-class MockLogger : public hal::logging::ILogger {
+// Sensor whose channels read whatever the test last set.
+class SettableSensor : public hal::sensor::ISensor {
     public:
-    char last_log[256] = {0};
-    bool log_called = false;
+    int32_t value[2] = {};
 
-    void log(const char *message) override {
-        log_called = true;
-        strncpy(last_log, message, sizeof(last_log) - 1);
-        last_log[sizeof(last_log) - 1] = '\0';
+    void hal_sensor_init() override {}
+    uint8_t hal_sensor_channel_count() override { return 2; }
+    bool hal_sensor_read(uint8_t channel, int32_t *out) override {
+        *out = value[channel];
+        return true;
     }
 };
 
+// Test times are written in ms; the app runs on the 64-bit us clock.
+static uint64_t ms(uint64_t v) { return v * 1000u; }
+
 // Unity setup/teardown hooks
 void setUp(void) {
     // Setup code if needed
@@ -71,12 +87,12 @@ void test_app_init() {
     MockLogger mockLogger;
     app::app_t app;
 
-    mockTime.millis_value = 1000;
-    app::app_init(&app, mockTime.millis_value, &mockLed, &mockTime, &mockSerial, &mockLogger);
+    mockTime.micros_value = 1000000;
+    app::app_init(&app, mockTime.hal_monotonic_us(), &mockLed, &mockTime, &mockSerial, &mockLogger);
 
     TEST_ASSERT_EQUAL(app::app_state_t::APP_IDLE, app.state);
     TEST_ASSERT_TRUE(mockLed.init_called);
-    TEST_ASSERT_EQUAL(1000, app.boot_ms);
+    TEST_ASSERT_EQUAL_UINT64(1000000, app.boot_us);
 }
 
 void test_app_tick_led_override() {
@@ -86,11 +102,11 @@ void test_app_tick_led_override() {
     MockLogger mockLogger;
     app::app_t app;
 
-    app::app_init(&app, 1000, &mockLed, &mockTime, &mockSerial, &mockLogger);
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
     app.led_override = true;
     app.led_override_value = true;
 
-    app::app_tick(&app, 1000);
+    app::app_tick(&app, ms(1000));
 
     TEST_ASSERT_TRUE(mockLed.set_called);
     TEST_ASSERT_EQUAL(true, mockLed.last_set_value);
@@ -103,15 +119,31 @@ void test_app_tick_heartbeat() {
     MockLogger mockLogger;
     app::app_t app;
 
-    app::app_init(&app, 1000, &mockLed, &mockTime, &mockSerial, &mockLogger);
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
     app.led_override = false;
-    app.last_heartbeat_ms = 4000; // 3 seconds
 
-    app::app_tick(&app, 2001); // More than HEARTBEAT_PERIOD_MS later
+    app::app_tick(&app, ms(2999)); // Just before HEARTBEAT_PERIOD_MS
+    TEST_ASSERT_FALSE(mockLed.toggle_called);
+
+    app::app_tick(&app, ms(3001)); // HEARTBEAT_PERIOD_MS later
 
     TEST_ASSERT_TRUE(mockLed.toggle_called);
 }
 
+void test_app_tick_flushes_bounded_tx() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    MockHalSerial mockSerial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
+    app::app_tick(&app, ms(1000));
+
+    // Every tick drains queued output with a bounded budget.
+    TEST_ASSERT_GREATER_THAN(0, mockSerial.last_flush_budget);
+}
+
 void test_app_handle_command_led_off() {
     MockHalLed mockLed;
     MockHalTime mockTime;
@@ -119,7 +151,7 @@ void test_app_handle_command_led_off() {
     MockLogger mockLogger;
     app::app_t app;
 
-    app::app_init(&app, 1000, &mockLed, &mockTime, &mockSerial, &mockLogger);
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
 
     app::app_handle_command(&app, "LED OFF");
 
@@ -130,12 +162,855 @@ void test_app_handle_command_led_off() {
     TEST_ASSERT_EQUAL_STRING("OK LED OFF", mockSerial.last_print);
 }
 
+void test_app_handle_command_help_from_table() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    MockHalSerial mockSerial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
+
+    app::app_handle_command(&app, "HELP");
+    TEST_ASSERT_EQUAL_STRING("OK Commands: HELP STATUS LED ON|OFF|AUTO RATE <ms> ARM DISARM FAULT TELEMETRY BINARY|TEXT|DELTA [n]|CHANGES [n]|KEY DEADBAND <ch> <counts> LOOP REPLAY [seq] SUMMARY <ch> <ms>|OFF SUB <ch> <ms> UNSUB <ch>|ALL STREAM START <hz> [ch]|STOP STATS [RESET]",
+                             mockSerial.last_print);
+}
+
+void test_app_handle_command_dispatch() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    MockHalSerial mockSerial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
+
+    app::app_handle_command(&app, "  RATE   250 ");
+    TEST_ASSERT_EQUAL(250, app.telemetry_period_ms);
+    TEST_ASSERT_EQUAL_STRING("OK RATE SET", mockSerial.last_print);
+
+    app::app_handle_command(&app, "RATE 5");
+    TEST_ASSERT_EQUAL_STRING("ERR RATE out of range (10..60000)", mockSerial.last_print);
+
+    app::app_handle_command(&app, "ARM");
+    TEST_ASSERT_EQUAL(app::APP_ARMED, app.state);
+
+    // Arguments to a command that takes none, prefixes and unknown tokens are rejected.
+    app::app_handle_command(&app, "DISARM NOW");
+    TEST_ASSERT_EQUAL_STRING("ERR Unknown command", mockSerial.last_print);
+    TEST_ASSERT_EQUAL(app::APP_ARMED, app.state);
+    app::app_handle_command(&app, "AR");
+    TEST_ASSERT_EQUAL_STRING("ERR Unknown command", mockSerial.last_print);
+    app::app_handle_command(&app, "ARMED");
+    TEST_ASSERT_EQUAL_STRING("ERR Unknown command", mockSerial.last_print);
+
+    // Blank lines are ignored.
+    mockSerial.last_print[0] = '\0';
+    app::app_handle_command(&app, "   ");
+    TEST_ASSERT_EQUAL_STRING("", mockSerial.last_print);
+}
+
+void test_app_telemetry_binary_mode() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    MockHalSerial mockSerial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
+
+    app::app_handle_command(&app, "TELEMETRY BINARY");
+    TEST_ASSERT_EQUAL(app::APP_TELEMETRY_BINARY, app.telemetry_mode);
+    TEST_ASSERT_EQUAL_STRING("OK TELEMETRY BINARY", mockSerial.last_print);
+
+    app::app_tick(&app, ms(1000 + app.telemetry_period_ms));
+
+    // Binary mode writes a frame instead of a log line.
+    TEST_ASSERT_FALSE(mockLogger.log_called);
+    TEST_ASSERT_GREATER_THAN(0, mockSerial.last_write_len);
+
+    uint8_t scratch[PKT_MAX_RAW];
+    pkt_t pkt;
+    pkt_telemetry_t rec;
+    TEST_ASSERT_TRUE(pkt_decode(mockSerial.last_write, mockSerial.last_write_len, scratch, sizeof(scratch), &pkt));
+    TEST_ASSERT_EQUAL(PKT_TYPE_TELEMETRY, pkt.type);
+    TEST_ASSERT_EQUAL(0, pkt.seq);
+    TEST_ASSERT_EQUAL_UINT64(ms(app.telemetry_period_ms), pkt.timestamp_us);
+    TEST_ASSERT_TRUE(pkt_telemetry_unpack(pkt.payload, pkt.payload_len, &rec));
+    TEST_ASSERT_EQUAL(app::APP_IDLE, rec.state);
+
+    app::app_handle_command(&app, "TELEMETRY TEXT");
+    app::app_tick(&app, ms(1000 + 2 * app.telemetry_period_ms));
+    TEST_ASSERT_TRUE(mockLogger.log_called);
+}
+
+void test_app_telemetry_delta_mode() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    MockHalSerial mockSerial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
+
+    app::app_handle_command(&app, "TELEMETRY DELTA 0");
+    TEST_ASSERT_EQUAL_STRING("ERR TELEMETRY DELTA keyframe interval out of range (1..1000)", mockSerial.last_print);
+    TEST_ASSERT_EQUAL(app::APP_TELEMETRY_TEXT, app.telemetry_mode);
+
+    app::app_handle_command(&app, "TELEMETRY DELTA 3");
+    TEST_ASSERT_EQUAL(app::APP_TELEMETRY_DELTA, app.telemetry_mode);
+    TEST_ASSERT_EQUAL_STRING("OK TELEMETRY DELTA KEY=3", mockSerial.last_print);
+
+    // Receiver side: decode each frame through a delta decoder.
+    pkt_delta_t rx;
+    pkt_delta_init(&rx, 1);
+    const uint8_t expected_types[] = {PKT_TYPE_TELEMETRY_KEY, PKT_TYPE_TELEMETRY_DELTA, PKT_TYPE_TELEMETRY_DELTA,
+                                      PKT_TYPE_TELEMETRY_KEY, PKT_TYPE_TELEMETRY_DELTA};
+    for (uint32_t i = 0; i < 5; i++) {
+        if (i == 2)
+            app::app_handle_command(&app, "FAULT");
+        app::app_tick(&app, ms(1000 + (i + 1) * app.telemetry_period_ms));
+
+        uint8_t scratch[PKT_MAX_RAW];
+        pkt_t pkt;
+        pkt_telemetry_t rec;
+        TEST_ASSERT_TRUE(pkt_decode(mockSerial.last_write, mockSerial.last_write_len, scratch, sizeof(scratch), &pkt));
+        TEST_ASSERT_EQUAL(expected_types[i], pkt.type);
+        TEST_ASSERT_EQUAL(i, pkt.seq);
+        TEST_ASSERT_TRUE(pkt_telemetry_unpack_delta(&rx, &pkt, &rec));
+        TEST_ASSERT_EQUAL(i >= 2 ? app::APP_FAULT : app::APP_IDLE, rec.state);
+        TEST_ASSERT_EQUAL(i >= 2 ? 1 : 0, rec.fault_count);
+        TEST_ASSERT_EQUAL(app.telemetry_period_ms, rec.telemetry_period_ms);
+        if (i == 1)
+            TEST_ASSERT_EQUAL(1, pkt.payload_len); // nothing changed: mask only
+    }
+}
+
+void test_app_telemetry_changes_mode() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    LinkMockSerial serial;
+    MockLogger mockLogger;
+    app::app_t app;
+    static sensors::sensor_registry_t reg; // large; keep off the stack
+    SettableSensor sensor;
+    sensor.value[0] = 2048;
+    sensor.value[1] = 100;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &serial, &mockLogger);
+    sensors::sensor_registry_init(&reg);
+    sensors::sensor_registry_add(&reg, &sensor, 0, 100, 1000);
+    sensors::sensor_registry_add(&reg, &sensor, 1, 100, 1000);
+    app::app_attach_sensors(&app, &reg);
+
+    app::app_handle_command(&app, "DEADBAND 4 10");
+    TEST_ASSERT_EQUAL_STRING("ERR DEADBAND channel out of range (0..3)", serial.last_print);
+    app::app_handle_command(&app, "DEADBAND 0");
+    TEST_ASSERT_EQUAL_STRING("ERR DEADBAND expects <channel> <counts>", serial.last_print);
+    app::app_handle_command(&app, "DEADBAND 0 -1");
+    TEST_ASSERT_EQUAL_STRING("ERR DEADBAND expects <channel> <counts>", serial.last_print);
+    app::app_handle_command(&app, "DEADBAND 0 16");
+    TEST_ASSERT_EQUAL_STRING("OK DEADBAND CH=0 COUNTS=16", serial.last_print);
+    app::app_handle_command(&app, "TELEMETRY KEY");
+    TEST_ASSERT_EQUAL_STRING("ERR TELEMETRY KEY needs DELTA or CHANGES", serial.last_print);
+    app::app_handle_command(&app, "TELEMETRY CHANGES 1001");
+    TEST_ASSERT_EQUAL_STRING("ERR TELEMETRY CHANGES keyframe interval out of range (1..1000)", serial.last_print);
+    app::app_handle_command(&app, "TELEMETRY CHANGES 5");
+    TEST_ASSERT_EQUAL_STRING("OK TELEMETRY CHANGES KEY=5", serial.last_print);
+    TEST_ASSERT_EQUAL(app::APP_TELEMETRY_CHANGES, app.telemetry_mode);
+    TEST_ASSERT_EQUAL_UINT32(16, app.changes.deadband[0]);
+
+    // One tick per period; each returns the frame it sent, if any.
+    uint64_t now = ms(1000);
+    pkt_delta_t rx;
+    pkt_delta_init(&rx, 1);
+    pkt_changes_t got;
+    uint8_t scratch[PKT_MAX_RAW];
+    pkt_t pkt;
+    auto period = [&]() -> bool {
+        serial.frames.clear();
+        now += ms(app.telemetry_period_ms);
+        app::app_tick(&app, now);
+        if (serial.frames.empty())
+            return false;
+        TEST_ASSERT_EQUAL(1, serial.frames.size());
+        TEST_ASSERT_TRUE(pkt_decode((const uint8_t *)serial.frames[0].data(), serial.frames[0].size(), scratch,
+                                    sizeof(scratch), &pkt));
+        TEST_ASSERT_TRUE(pkt_changes_unpack(&rx, &pkt, &got));
+        return true;
+    };
+
+    TEST_ASSERT_TRUE(period());
+    TEST_ASSERT_EQUAL(PKT_TYPE_CHANGES_KEY, pkt.type);
+    TEST_ASSERT_EQUAL(2, got.channels);
+    TEST_ASSERT_EQUAL_INT32(2048, got.value[0]);
+    TEST_ASSERT_EQUAL_INT32(100, got.value[1]);
+    TEST_ASSERT_EQUAL(app::APP_IDLE, got.rec.state);
+
+    // Noise inside the deadband is not news; quiet periods take no seq.
+    sensor.value[0] = 2060;
+    TEST_ASSERT_FALSE(period());
+    sensor.value[0] = 2070;
+    TEST_ASSERT_TRUE(period());
+    TEST_ASSERT_EQUAL(PKT_TYPE_CHANGES_DELTA, pkt.type);
+    TEST_ASSERT_EQUAL(1, pkt.seq);
+    TEST_ASSERT_EQUAL(3, pkt.payload_len); // channels, mask, one varint
+    TEST_ASSERT_EQUAL_INT32(2070, got.value[0]);
+
+    app::app_handle_command(&app, "FAULT");
+    TEST_ASSERT_TRUE(period());
+    TEST_ASSERT_EQUAL(2, pkt.seq);
+    TEST_ASSERT_EQUAL(app::APP_FAULT, got.rec.state);
+    TEST_ASSERT_EQUAL_UINT32(1, got.rec.fault_count);
+
+    // Fifth period since the keyframe: a keyframe whatever changed.
+    TEST_ASSERT_FALSE(period());
+    TEST_ASSERT_TRUE(period());
+    TEST_ASSERT_EQUAL(PKT_TYPE_CHANGES_KEY, pkt.type);
+    TEST_ASSERT_FALSE(period());
+
+    app::app_handle_command(&app, "TELEMETRY KEY");
+    TEST_ASSERT_EQUAL_STRING("OK TELEMETRY KEY", serial.last_print);
+    TEST_ASSERT_TRUE(period());
+    TEST_ASSERT_EQUAL(PKT_TYPE_CHANGES_KEY, pkt.type);
+    TEST_ASSERT_EQUAL(4, pkt.seq);
+    TEST_ASSERT_EQUAL_UINT32(3, app.changes.quiet);
+}
+
+void test_app_subscriptions() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    LinkMockSerial serial;
+    MockLogger mockLogger;
+    app::app_t app;
+    static sensors::sensor_registry_t reg; // large; keep off the stack
+    SettableSensor sensor;
+    sensor.value[0] = 2048;
+    sensor.value[1] = -7;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &serial, &mockLogger);
+    app::app_handle_command(&app, "SUB 0 100");
+    TEST_ASSERT_EQUAL_STRING("ERR SUB no sensors", serial.last_print);
+
+    sensors::sensor_registry_init(&reg);
+    sensors::sensor_registry_add(&reg, &sensor, 0, 10, 1000);
+    sensors::sensor_registry_add(&reg, &sensor, 1, 10, 1000);
+    app::app_attach_sensors(&app, &reg);
+
+    app::app_handle_command(&app, "SUB 2 100");
+    TEST_ASSERT_EQUAL_STRING("ERR SUB no such channel", serial.last_print);
+    app::app_handle_command(&app, "SUB 0");
+    TEST_ASSERT_EQUAL_STRING("ERR SUB expects <channel> <ms>", serial.last_print);
+    app::app_handle_command(&app, "SUB 0 5");
+    TEST_ASSERT_EQUAL_STRING("ERR SUB period out of range (10..60000)", serial.last_print);
+    app::app_handle_command(&app, "UNSUB 1");
+    TEST_ASSERT_EQUAL_STRING("ERR UNSUB not subscribed", serial.last_print);
+    app::app_handle_command(&app, "UNSUB X");
+    TEST_ASSERT_EQUAL_STRING("ERR UNSUB expects <channel>|ALL", serial.last_print);
+
+    app::app_handle_command(&app, "SUB 0 100");
+    TEST_ASSERT_EQUAL_STRING("OK SUB CH=0 MS=100", serial.last_print);
+    app::app_handle_command(&app, "SUB 1 250");
+    TEST_ASSERT_EQUAL_STRING("OK SUB CH=1 MS=250", serial.last_print);
+    app::app_handle_command(&app, "TELEMETRY BINARY");
+
+    // The next deadline is the first subscription, not the next sample.
+    uint64_t due = 0;
+    TEST_ASSERT_TRUE(app::app_next_deadline(&app, ms(1000), &due));
+    TEST_ASSERT_TRUE(due <= ms(1010));
+    sensors::sensor_registry_set_period(&reg, 0, 1000, 1000);
+    sensors::sensor_registry_set_period(&reg, 1, 1000, 1000);
+    TEST_ASSERT_TRUE(app::app_next_deadline(&app, ms(1000), &due));
+    TEST_ASSERT_EQUAL_UINT64(ms(1100), due);
+    sensors::sensor_registry_set_period(&reg, 0, 10, 1000);
+    sensors::sensor_registry_set_period(&reg, 1, 10, 1000);
+
+    // Two seconds: 20 values of channel 0 and 8 of channel 1, in 24 records
+    // (both share one record every 500 ms).
+    serial.frames.clear();
+    for (uint64_t t = 1010; t <= 3000; t += 10)
+        app::app_tick(&app, ms(t));
+
+    uint32_t records = 0, values[2] = {0, 0};
+    for (const std::string &f : serial.frames) {
+        uint8_t scratch[PKT_MAX_RAW];
+        pkt_t pkt;
+        TEST_ASSERT_TRUE(pkt_decode((const uint8_t *)f.data(), f.size(), scratch, sizeof(scratch), &pkt));
+        if (pkt.type != PKT_TYPE_CHANNELS)
+            continue;
+        pkt_channel_value_t v[PKT_CHANNELS_MAX_VALUES];
+        size_t n = 0;
+        TEST_ASSERT_TRUE(pkt_channels_unpack(pkt.payload, pkt.payload_len, v, PKT_CHANNELS_MAX_VALUES, &n));
+        TEST_ASSERT_EQUAL(records, pkt.seq);
+        records++;
+        for (size_t i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_INT32(v[i].channel == 0 ? 2048 : -7, v[i].value);
+            values[v[i].channel]++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(24, records);
+    TEST_ASSERT_EQUAL_UINT32(20, values[0]);
+    TEST_ASSERT_EQUAL_UINT32(8, values[1]);
+
+    // TEXT mode: one line per tick.
+    app::app_handle_command(&app, "TELEMETRY TEXT");
+    app::app_tick(&app, ms(3500));
+    TEST_ASSERT_EQUAL_STRING("CH 0=2048 1=-7", mockLogger.last_log);
+
+    app::app_handle_command(&app, "UNSUB 0");
+    TEST_ASSERT_EQUAL_STRING("OK UNSUB CH=0", serial.last_print);
+    app::app_handle_command(&app, "UNSUB ALL");
+    TEST_ASSERT_EQUAL_STRING("OK UNSUB ALL", serial.last_print);
+    serial.frames.clear();
+    mockLogger.last_log[0] = '\0';
+    app::app_tick(&app, ms(3750));
+    TEST_ASSERT_EQUAL_STRING("", mockLogger.last_log);
+    TEST_ASSERT_EQUAL_UINT32(0, app.subs.count);
+}
+
+void test_app_monotonic_clock_across_micros_wrap() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    MockHalSerial mockSerial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    // The raw 32-bit counter wraps 0.5 s after boot.
+    mockTime.micros_value = 0xFFFFFFFFu - 499999u;
+    uint64_t boot = mockTime.hal_monotonic_us();
+    app::app_init(&app, boot, &mockLed, &mockTime, &mockSerial, &mockLogger);
+    app::app_handle_command(&app, "TELEMETRY BINARY");
+
+    uint64_t prev = boot;
+    uint32_t frames = 0;
+    for (int i = 0; i < 300; i++) { // 3 s in 10 ms steps
+        mockTime.micros_value += 10000;
+        uint64_t now = mockTime.hal_monotonic_us();
+        TEST_ASSERT_TRUE(now > prev);
+        prev = now;
+
+        mockSerial.last_write_len = 0;
+        app::app_tick(&app, now);
+        if (mockSerial.last_write_len == 0) {
+            continue;
+        }
+
+        uint8_t scratch[PKT_MAX_RAW];
+        pkt_t pkt;
+        TEST_ASSERT_TRUE(pkt_decode(mockSerial.last_write, mockSerial.last_write_len, scratch, sizeof(scratch), &pkt));
+        frames++;
+        TEST_ASSERT_EQUAL_UINT64(ms(1000) * frames, pkt.timestamp_us);
+    }
+
+    TEST_ASSERT_EQUAL(3, frames);
+    TEST_ASSERT_EQUAL_UINT64(boot + ms(3000), mockTime.hal_monotonic_us());
+    TEST_ASSERT_EQUAL(1, (uint32_t)(mockTime.hal_monotonic_us() >> 32)); // one wrap seen
+    TEST_ASSERT_TRUE(mockLed.toggle_called);
+}
+
+void test_app_idle_sleeps_until_next_deadline() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    MockHalSerial mockSerial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
+
+    // Telemetry (1000 ms) is due before the heartbeat (2000 ms).
+    app::app_tick(&app, ms(1000));
+    app::app_idle(&app, ms(1000));
+    TEST_ASSERT_EQUAL(1, mockTime.sleep_calls);
+    TEST_ASSERT_EQUAL_UINT64(ms(2000), mockTime.last_sleep_deadline);
+    TEST_ASSERT_EQUAL(2000, mockTime.hal_millis());
+
+    // A sensor due sooner pulls the deadline in.
+    static sensors::sensor_registry_t reg; // large; keep off the stack
+    hal::sensor::HalSensorSim sim(1);
+    sensors::sensor_registry_init(&reg);
+    sensors::sensor_registry_add(&reg, &sim, 0, 50, 2000);
+    app::app_attach_sensors(&app, &reg);
+    app::app_tick(&app, ms(2000));
+    app::app_idle(&app, ms(2000));
+    TEST_ASSERT_EQUAL_UINT64(ms(2050), mockTime.last_sleep_deadline);
+
+    // Serial RX ends the sleep early and is counted.
+    app::app_tick(&app, ms(2050));
+    mockTime.wake_after_us = ms(10);
+    app::app_idle(&app, ms(2050));
+    TEST_ASSERT_EQUAL(2060, mockTime.hal_millis());
+
+    TEST_ASSERT_EQUAL(3, app.loop.iterations);
+    TEST_ASSERT_EQUAL(3, app.loop.sleeps);
+    TEST_ASSERT_EQUAL(1, app.loop.early_wakeups);
+    TEST_ASSERT_EQUAL_UINT64(ms(1060), app.loop.idle_us);
+}
+
+void test_app_idle_skips_sleep_when_busy() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    MockHalSerial mockSerial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
+
+    // Unread serial input: no sleep.
+    mockSerial.pending = true;
+    app::app_idle(&app, ms(1000));
+    TEST_ASSERT_EQUAL(0, mockTime.sleep_calls);
+
+    // Deadline already reached: no sleep.
+    mockSerial.pending = false;
+    app::app_idle(&app, ms(2000));
+    TEST_ASSERT_EQUAL(0, mockTime.sleep_calls);
+
+    // Nothing due for a minute: sleeps are capped.
+    app::app_handle_command(&app, "RATE 60000");
+    app::app_tick(&app, ms(2000));
+    app::app_idle(&app, ms(2000));
+    TEST_ASSERT_EQUAL(1, mockTime.sleep_calls);
+    TEST_ASSERT_EQUAL_UINT64(ms(3000), mockTime.last_sleep_deadline);
+}
+
+void test_app_idle_sleeps_while_tx_drains() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    MockHalSerial mockSerial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
+    app::app_tick(&app, ms(1000));
+
+    // Output still queued: sleep until the link can take the next flush,
+    // not until telemetry is due, and not zero either.
+    mockSerial.tx_wait_us = 22000;
+    app::app_idle(&app, ms(1000));
+    TEST_ASSERT_EQUAL(1, mockTime.sleep_calls);
+    TEST_ASSERT_EQUAL_UINT64(ms(1022), mockTime.last_sleep_deadline);
+    TEST_ASSERT_EQUAL(1, app.loop.sleeps);
+    TEST_ASSERT_EQUAL(0, app.loop.early_wakeups);
+
+    // A deadline sooner than the drain still wins.
+    mockSerial.tx_wait_us = ms(5000);
+    app::app_idle(&app, ms(1022));
+    TEST_ASSERT_EQUAL_UINT64(ms(2000), mockTime.last_sleep_deadline);
+    TEST_ASSERT_EQUAL(2, app.loop.sleeps);
+}
+
+void test_app_builds_messages_in_pool_blocks() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    PooledMockSerial serial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    mockTime.micros_value = ms(1000);
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &serial, &mockLogger);
+
+    // STATUS reply: prefix, line and CRLF in one block, no logger copy.
+    mockTime.micros_value = ms(1250);
+    app::app_handle_command(&app, "STATUS");
+    TEST_ASSERT_EQUAL_STRING("OK STATE=1 TIME=250 TELEMETRY_MS=1000 HEARTBEAT_MS=2000 FAULTS=0\r\n",
+                             serial.sent.c_str());
+    TEST_ASSERT_FALSE(mockLogger.log_called);
+
+    // Without blocks the prefixed line goes to the logger as one message.
+    MockHalSerial plain;
+    app::app_t app2;
+    mockTime.micros_value = ms(1000);
+    app::app_init(&app2, ms(1000), &mockLed, &mockTime, &plain, &mockLogger);
+    mockTime.micros_value = ms(1250);
+    app::app_handle_command(&app2, "STATUS");
+    TEST_ASSERT_EQUAL_STRING("OK STATE=1 TIME=250 TELEMETRY_MS=1000 HEARTBEAT_MS=2000 FAULTS=0",
+                             mockLogger.last_log);
+    TEST_ASSERT_EQUAL_STRING("", plain.last_print);
+    mockLogger.log_called = false;
+
+    // Binary telemetry frame encoded straight into a block.
+    app::app_handle_command(&app, "TELEMETRY BINARY");
+    app::app_tick(&app, ms(2000));
+    TEST_ASSERT_EQUAL(2, serial.sends);
+    TEST_ASSERT_EQUAL(0, serial.last_write_len);
+
+    uint8_t scratch[PKT_MAX_RAW];
+    pkt_t pkt;
+    TEST_ASSERT_TRUE(pkt_decode((const uint8_t *)serial.sent.data(), serial.sent.size(), scratch, sizeof(scratch), &pkt));
+    TEST_ASSERT_EQUAL(0, pkt.seq);
+
+    // Every block came back.
+    TEST_ASSERT_EQUAL(0, serial.pool.stats().in_use);
+    TEST_ASSERT_EQUAL(0, serial.pool.stats().exhausted);
+}
+
+void test_app_spools_while_disconnected_and_replays() {
+    char path[] = "/tmp/test_app_spool_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    LinkMockSerial serial;
+    MockLogger mockLogger;
+    app::app_t app;
+    hal::flash::HalFlashFile flash(path, 256, 4096, 4);
+    spool::spool_t spool;
+    TEST_ASSERT_TRUE(spool::spool_mount(&spool, &flash));
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &serial, &mockLogger);
+    app::app_handle_command(&app, "REPLAY");
+    TEST_ASSERT_EQUAL_STRING("ERR REPLAY no spool", serial.last_print);
+    app::app_attach_spool(&app, &spool);
+
+    // Host gone: ten periods of telemetry go to flash, nothing to the link.
+    serial.connected = false;
+    const uint32_t period = app.telemetry_period_ms;
+    for (uint32_t i = 1; i <= 10; i++)
+        app::app_tick(&app, ms(1000 + i * period));
+    TEST_ASSERT_EQUAL(0, serial.frames.size());
+    TEST_ASSERT_FALSE(mockLogger.log_called);
+    TEST_ASSERT_EQUAL_UINT32(10, spool::spool_next_seq(&spool));
+
+    // Host back: resume from spool seq 4.
+    serial.connected = true;
+    app::app_tick(&app, ms(1000 + 10 * period + 1));
+    app::app_handle_command(&app, "REPLAY 4x");
+    TEST_ASSERT_EQUAL_STRING("ERR REPLAY expects a sequence number", serial.last_print);
+    app::app_handle_command(&app, "REPLAY 4");
+    TEST_ASSERT_EQUAL_STRING("OK REPLAY FROM=4 TO=10", serial.last_print);
+    TEST_ASSERT_TRUE(app.replay.active);
+
+    app::app_tick(&app, ms(1000 + 10 * period + 2));
+    TEST_ASSERT_EQUAL(6, serial.frames.size());
+    for (uint32_t k = 0; k < 6; k++) {
+        uint8_t scratch[PKT_MAX_RAW];
+        pkt_t pkt;
+        uint32_t spool_seq;
+        pkt_telemetry_t rec;
+        const std::string &f = serial.frames[k];
+        TEST_ASSERT_TRUE(pkt_decode((const uint8_t *)f.data(), f.size(), scratch, sizeof(scratch), &pkt));
+        TEST_ASSERT_EQUAL(PKT_TYPE_TELEMETRY_REPLAY, pkt.type);
+        TEST_ASSERT_TRUE(pkt_replay_unpack(pkt.payload, pkt.payload_len, &spool_seq, &rec));
+        TEST_ASSERT_EQUAL_UINT32(4 + k, spool_seq);
+        TEST_ASSERT_EQUAL_UINT64(ms((5 + k) * period), pkt.timestamp_us); // original time
+        TEST_ASSERT_EQUAL(app::APP_IDLE, rec.state);
+    }
+
+    // All six fit one burst; the end of the range is reported.
+    TEST_ASSERT_FALSE(app.replay.active);
+    TEST_ASSERT_EQUAL_STRING("OK REPLAY DONE SENT=6 NEXT=10", serial.last_print);
+
+    unlink(path);
+}
+
+void test_app_summarizes_channel_windows() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    MockHalSerial mockSerial;
+    MockLogger mockLogger;
+    app::app_t app;
+    static sensors::sensor_registry_t reg; // large; keep off the stack
+    hal::sensor::HalSensorSim sim(2);
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &mockSerial, &mockLogger);
+    app::app_handle_command(&app, "SUMMARY 0 100");
+    TEST_ASSERT_EQUAL_STRING("ERR SUMMARY no sensors", mockSerial.last_print);
+
+    sim.hal_sensor_init();
+    sensors::sensor_registry_init(&reg);
+    sensors::sensor_registry_add(&reg, &sim, 0, 10, 1000);
+    sensors::sensor_registry_add(&reg, &sim, 1, 10, 1000);
+    app::app_attach_sensors(&app, &reg);
+
+    app::app_handle_command(&app, "SUMMARY 2 100");
+    TEST_ASSERT_EQUAL_STRING("ERR SUMMARY no such channel", mockSerial.last_print);
+    app::app_handle_command(&app, "SUMMARY 0 5");
+    TEST_ASSERT_EQUAL_STRING("ERR SUMMARY window out of range (10..3600000)", mockSerial.last_print);
+    app::app_handle_command(&app, "SUMMARY 0");
+    TEST_ASSERT_EQUAL_STRING("ERR SUMMARY expects <channel> <ms>|OFF", mockSerial.last_print);
+    app::app_handle_command(&app, "SUMMARY 0 100");
+    TEST_ASSERT_EQUAL_STRING("OK SUMMARY CH=0 WINDOW_MS=100", mockSerial.last_print);
+
+    // The window end is a wake-up deadline.
+    uint64_t due = 0;
+    TEST_ASSERT_TRUE(app::app_next_deadline(&app, ms(1000), &due));
+    TEST_ASSERT_EQUAL_UINT64(ms(1010), due); // first sample
+    for (uint64_t t = 1010; t < 1100; t += 10)
+        app::app_tick(&app, ms(t));
+    TEST_ASSERT_FALSE(mockLogger.log_called);
+
+    // Text mode: one line per window, from the samples taken in it.
+    app::app_tick(&app, ms(1100));
+    TEST_ASSERT_TRUE(mockLogger.log_called);
+    TEST_ASSERT_EQUAL_STRING_LEN("SUMMARY CH=0 N=9 MIN=", mockLogger.last_log, 21);
+
+    // Binary mode: a PKT_TYPE_SUMMARY frame.
+    app::app_handle_command(&app, "TELEMETRY BINARY");
+    for (uint64_t t = 1110; t <= 1200; t += 10)
+        app::app_tick(&app, ms(t));
+    uint8_t scratch[PKT_MAX_RAW];
+    pkt_t pkt;
+    pkt_summary_t sum;
+    TEST_ASSERT_TRUE(pkt_decode(mockSerial.last_write, mockSerial.last_write_len, scratch, sizeof(scratch), &pkt));
+    TEST_ASSERT_EQUAL(PKT_TYPE_SUMMARY, pkt.type);
+    TEST_ASSERT_EQUAL(0, pkt.seq);
+    TEST_ASSERT_TRUE(pkt_summary_unpack(pkt.payload, pkt.payload_len, &sum));
+    TEST_ASSERT_EQUAL(0, sum.channel);
+    TEST_ASSERT_EQUAL_UINT32(100, sum.window_ms);
+    TEST_ASSERT_EQUAL_UINT32(10, sum.count);
+    TEST_ASSERT_TRUE(sum.min <= sum.p50 && sum.p50 <= sum.p90 && sum.p90 <= sum.p99 && sum.p99 <= sum.max);
+    TEST_ASSERT_TRUE(sum.mean_q8 >= sum.min * 256 && sum.mean_q8 <= sum.max * 256);
+
+    app::app_handle_command(&app, "SUMMARY 0 OFF");
+    TEST_ASSERT_EQUAL_STRING("OK SUMMARY CH=0 OFF", mockSerial.last_print);
+    TEST_ASSERT_FALSE(stats::stats_enabled(&app.stats, 0));
+}
+
+void test_app_stats_reports_hot_paths() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    PrintLogSerial serial;
+    MockLogger mockLogger;
+    app::app_t app;
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &serial, &mockLogger);
+    app::app_handle_command(&app, "RATE 100");
+
+    // 1 s of 10 ms loop passes, 2 ms of work each, telemetry every 100 ms.
+    for (uint64_t t = 1000; t < 2000; t += 10) {
+        app::app_tick(&app, ms(t));
+        app.instr.slept_us += ms(8);
+    }
+    mockTime.micros_value = 2000000;
+
+    serial.lines.clear();
+    app::app_handle_command(&app, "STATS");
+    TEST_ASSERT_EQUAL(5, serial.lines.size());
+    TEST_ASSERT_EQUAL_STRING("OK STATS UP_MS=1000 TICKS=100 LOOP_HZ=100 MAX_STALL_US=2000", serial.lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING_LEN("STATS TICK_NS N=100 ", serial.lines[1].c_str(), 20);
+    TEST_ASSERT_EQUAL_STRING_LEN("STATS COMMAND_NS N=1 ", serial.lines[2].c_str(), 21); // RATE; STATS is still running
+    TEST_ASSERT_EQUAL_STRING_LEN("STATS READLINE_NS N=0 ", serial.lines[3].c_str(), 22);
+    // Ticks land exactly on the telemetry grid (1100..1900 ms): 8 intervals, no jitter.
+    TEST_ASSERT_EQUAL_STRING("STATS JITTER_US N=8 MEAN=0 P50=0 P90=0 P99=0 MAX=0", serial.lines[4].c_str());
+
+    app::app_handle_command(&app, "STATS RESET");
+    TEST_ASSERT_EQUAL_STRING("OK STATS RESET", serial.last_print);
+    TEST_ASSERT_EQUAL_UINT32(0, app.instr.ticks);
+    app::app_handle_command(&app, "STATS NOW");
+    TEST_ASSERT_EQUAL_STRING("ERR STATS expects RESET or nothing", serial.last_print);
+}
+
+void test_app_streams_timer_blocks() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    LinkMockSerial serial;
+    MockLogger mockLogger;
+    MockHalTimer timer;
+    app::app_t app;
+    static sensors::sensor_registry_t reg; // large; keep off the stack
+    static stream::stream_t strm;
+    hal::sensor::HalSensorSim sim(2);
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &serial, &mockLogger);
+    app::app_handle_command(&app, "STREAM START 1000");
+    TEST_ASSERT_EQUAL_STRING("ERR STREAM not available", serial.last_print);
+
+    stream::stream_init(&strm, &timer, &mockTime);
+    app::app_attach_stream(&app, &strm);
+    app::app_handle_command(&app, "STREAM START 1000");
+    TEST_ASSERT_EQUAL_STRING("ERR STREAM no sensors", serial.last_print);
+
+    // Channel 0 is like the temperature sensor: not streamable.
+    SettableSensor temp;
+    sim.hal_sensor_init();
+    sensors::sensor_registry_init(&reg);
+    sensors::sensor_registry_add(&reg, &temp, 0, 10, 1000);
+    app::app_attach_sensors(&app, &reg);
+    app::app_handle_command(&app, "STREAM START 1000");
+    TEST_ASSERT_EQUAL_STRING("ERR STREAM no streamable channel", serial.last_print);
+    sensors::sensor_registry_add(&reg, &sim, 0, 10, 1000);
+    sensors::sensor_registry_add(&reg, &sim, 1, 10, 1000);
+
+    app::app_handle_command(&app, "STREAM");
+    TEST_ASSERT_EQUAL_STRING("OK STREAM OFF", serial.last_print);
+    app::app_handle_command(&app, "STREAM STOP");
+    TEST_ASSERT_EQUAL_STRING("ERR STREAM not running", serial.last_print);
+    app::app_handle_command(&app, "STREAM START 0");
+    TEST_ASSERT_EQUAL_STRING("ERR STREAM rate out of range (1..20000)", serial.last_print);
+    app::app_handle_command(&app, "STREAM START 1000 3");
+    TEST_ASSERT_EQUAL_STRING("ERR STREAM no such channel", serial.last_print);
+    app::app_handle_command(&app, "STREAM START 1000 0");
+    TEST_ASSERT_EQUAL_STRING("ERR STREAM channel not streamable", serial.last_print);
+    app::app_handle_command(&app, "STREAM GO");
+    TEST_ASSERT_EQUAL_STRING("ERR STREAM expects START <hz> [ch]|STOP", serial.last_print);
+
+    // Without a channel the first streamable one is used.
+    app::app_handle_command(&app, "STREAM START 5000");
+    TEST_ASSERT_EQUAL_STRING("OK STREAM START CH=1 HZ=5000 PERIOD_US=200", serial.last_print);
+    TEST_ASSERT_EQUAL_UINT32(200, timer.period_us);
+    app::app_handle_command(&app, "STREAM START 5000 1");
+    TEST_ASSERT_EQUAL_STRING("ERR STREAM already running", serial.last_print);
+
+    // Periodic sampling pauses: the timer owns the sensors.
+    uint64_t due = 0;
+    TEST_ASSERT_TRUE(app::app_next_deadline(&app, ms(1000), &due));
+    TEST_ASSERT_TRUE(due > ms(1010));
+
+    // A full block goes out on the next tick as one PKT_TYPE_STREAM frame.
+    timer.fire(STREAM_BLOCK_SAMPLES + 5);
+    serial.frames.clear();
+    app::app_tick(&app, ms(1001));
+    TEST_ASSERT_EQUAL(1, serial.frames.size());
+    uint8_t scratch[PKT_MAX_RAW];
+    pkt_t pkt;
+    pkt_stream_t blk;
+    int16_t samples[PKT_STREAM_MAX_SAMPLES];
+    TEST_ASSERT_TRUE(pkt_decode((const uint8_t *)serial.frames[0].data(), serial.frames[0].size(), scratch,
+                                sizeof(scratch), &pkt));
+    TEST_ASSERT_EQUAL(PKT_TYPE_STREAM, pkt.type);
+    TEST_ASSERT_EQUAL(0, pkt.seq);
+    TEST_ASSERT_TRUE(pkt_stream_unpack(pkt.payload, pkt.payload_len, &blk, samples, PKT_STREAM_MAX_SAMPLES));
+    TEST_ASSERT_EQUAL(1, blk.channel);
+    TEST_ASSERT_EQUAL(STREAM_BLOCK_SAMPLES, blk.count);
+    TEST_ASSERT_EQUAL_UINT16(5000, blk.rate_hz);
+    TEST_ASSERT_EQUAL_UINT32(0, blk.first_index);
+    TEST_ASSERT_EQUAL_UINT32(0, blk.lost);
+
+    mockTime.micros_value = 1002000;
+    app::app_handle_command(&app, "STREAM");
+    TEST_ASSERT_EQUAL_STRING("OK STREAM CH=1 HZ=5000 SAMPLES=53 BLOCKS=1 LOST=0 OVERRUNS=0", serial.last_print);
+
+    // STOP flushes the partial block ahead of its reply.
+    serial.frames.clear();
+    app::app_handle_command(&app, "STREAM STOP");
+    TEST_ASSERT_EQUAL_STRING("OK STREAM STOP SAMPLES=53 BLOCKS=2 LOST=0 OVERRUNS=0", serial.last_print);
+    TEST_ASSERT_FALSE(timer.running);
+    TEST_ASSERT_EQUAL(1, serial.frames.size());
+    TEST_ASSERT_TRUE(pkt_decode((const uint8_t *)serial.frames[0].data(), serial.frames[0].size(), scratch,
+                                sizeof(scratch), &pkt));
+    TEST_ASSERT_EQUAL(1, pkt.seq);
+    TEST_ASSERT_TRUE(pkt_stream_unpack(pkt.payload, pkt.payload_len, &blk, samples, PKT_STREAM_MAX_SAMPLES));
+    TEST_ASSERT_EQUAL(5, blk.count);
+    TEST_ASSERT_EQUAL_UINT32(STREAM_BLOCK_SAMPLES, blk.first_index);
+    app::app_handle_command(&app, "STREAM");
+    TEST_ASSERT_EQUAL_STRING("OK STREAM OFF", serial.last_print);
+}
+
+void test_app_stream_stop_with_tx_full() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    LinkMockSerial serial;
+    MockLogger mockLogger;
+    MockHalTimer timer;
+    app::app_t app;
+    static sensors::sensor_registry_t reg; // large; keep off the stack
+    static stream::stream_t strm;
+    hal::sensor::HalSensorSim sim(1);
+
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &serial, &mockLogger);
+    stream::stream_init(&strm, &timer, &mockTime);
+    app::app_attach_stream(&app, &strm);
+    sim.hal_sensor_init();
+    sensors::sensor_registry_init(&reg);
+    sensors::sensor_registry_add(&reg, &sim, 0, 10, 1000);
+    app::app_attach_sensors(&app, &reg);
+
+    // One full block ready and a partial one, with no room to send either:
+    // both are lost, neither counts as sent.
+    app::app_handle_command(&app, "STREAM START 1000");
+    timer.fire(STREAM_BLOCK_SAMPLES + 5);
+    serial.tx_free = 0;
+    serial.frames.clear();
+    app::app_handle_command(&app, "STREAM STOP");
+    TEST_ASSERT_EQUAL(0, serial.frames.size());
+    char expect[96];
+    snprintf(expect, sizeof(expect), "OK STREAM STOP SAMPLES=%u BLOCKS=0 LOST=%u OVERRUNS=2",
+             (unsigned)(STREAM_BLOCK_SAMPLES + 5), (unsigned)(STREAM_BLOCK_SAMPLES + 5));
+    TEST_ASSERT_EQUAL_STRING(expect, serial.last_print);
+}
+
+void test_app_tags_and_batches_replies() {
+    MockHalLed mockLed;
+    MockHalTime mockTime;
+    LinkMockSerial serial;
+    MockLogger mockLogger;
+    app::app_t app;
+    app::app_init(&app, ms(1000), &mockLed, &mockTime, &serial, &mockLogger);
+
+    // Without a batch a tagged reply goes out as it is made, tag and
+    // text in one write.
+    app::app_handle_command(&app, "#7 ARM");
+    TEST_ASSERT_EQUAL(1, serial.frames.size());
+    TEST_ASSERT_EQUAL_STRING("#7 OK ARMED", serial.frames[0].c_str());
+    serial.frames.clear();
+
+    // One pass of the loop: every reply in a single write, tags echoed.
+    app::app_begin_batch(&app);
+    app::app_handle_command(&app, "#42 RATE 100");
+    app::app_handle_command(&app, "  #4294967295 DISARM");
+    app::app_handle_command(&app, "LED AUTO");
+    app::app_handle_command(&app, "#43 FROB");
+    app::app_handle_command(&app, "#44");
+    app::app_handle_command(&app, "#x ARM");
+    app::app_handle_command(&app, "#4294967296 ARM");
+    app::app_handle_command(&app, "");
+    TEST_ASSERT_EQUAL(0, serial.frames.size());
+    app::app_end_batch(&app);
+    TEST_ASSERT_EQUAL(1, serial.frames.size());
+    TEST_ASSERT_EQUAL_STRING("#42 OK RATE SET\r\n"
+                             "#4294967295 OK IDLE\r\n"
+                             "OK LED AUTO\r\n"
+                             "#43 ERR Unknown command\r\n"
+                             "#44 ERR Unknown command\r\n"
+                             "ERR Unknown command\r\n"
+                             "ERR Unknown command\r\n",
+                             serial.frames[0].c_str());
+    TEST_ASSERT_EQUAL_UINT32(100, app.telemetry_period_ms);
+    TEST_ASSERT_EQUAL(app::APP_IDLE, app.state);
+
+    // STATUS joins the batch too; a batch that fills up goes out early.
+    serial.frames.clear();
+    app::app_begin_batch(&app);
+    app::app_handle_command(&app, "#1 STATUS");
+    app::app_handle_command(&app, "#2 HELP");
+    app::app_handle_command(&app, "#3 HELP");
+    app::app_end_batch(&app);
+    TEST_ASSERT_EQUAL(2, serial.frames.size());
+    TEST_ASSERT_EQUAL_STRING_LEN("#1 OK STATE=", serial.frames[0].c_str(), 12);
+    TEST_ASSERT_EQUAL_STRING_LEN("#3 OK Commands: HELP", serial.frames[1].c_str(), 20);
+    TEST_ASSERT_TRUE(serial.frames[0].size() <= APP_REPLY_BATCH_BYTES);
+
+    // Nothing handled: nothing written.
+    app::app_begin_batch(&app);
+    app::app_end_batch(&app);
+    TEST_ASSERT_EQUAL(2, serial.frames.size());
+}
 
 int main() {
     UNITY_BEGIN();
     RUN_TEST(test_app_init);
     RUN_TEST(test_app_tick_led_override);
     RUN_TEST(test_app_tick_heartbeat);
+    RUN_TEST(test_app_tick_flushes_bounded_tx);
     RUN_TEST(test_app_handle_command_led_off);
+    RUN_TEST(test_app_handle_command_help_from_table);
+    RUN_TEST(test_app_handle_command_dispatch);
+    RUN_TEST(test_app_telemetry_binary_mode);
+    RUN_TEST(test_app_telemetry_delta_mode);
+    RUN_TEST(test_app_telemetry_changes_mode);
+    RUN_TEST(test_app_subscriptions);
+    RUN_TEST(test_app_monotonic_clock_across_micros_wrap);
+    RUN_TEST(test_app_idle_sleeps_until_next_deadline);
+    RUN_TEST(test_app_idle_skips_sleep_when_busy);
+    RUN_TEST(test_app_idle_sleeps_while_tx_drains);
+    RUN_TEST(test_app_builds_messages_in_pool_blocks);
+    RUN_TEST(test_app_spools_while_disconnected_and_replays);
+    RUN_TEST(test_app_summarizes_channel_windows);
+    RUN_TEST(test_app_stats_reports_hot_paths);
+    RUN_TEST(test_app_streams_timer_blocks);
+    RUN_TEST(test_app_stream_stop_with_tx_full);
+    RUN_TEST(test_app_tags_and_batches_replies);
     return UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include <unity.h>
+#include <cstring>
+#include "changes/change_detect.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static pkt_changes_t make_record(int32_t a, int32_t b) {
+    pkt_changes_t c;
+    memset(&c, 0, sizeof(c));
+    c.rec = {1, 1000, 2000, 0};
+    c.channels = 2;
+    c.value[0] = a;
+    c.value[1] = b;
+    return c;
+}
+
+static const uint8_t CH0 = 1u << PKT_TELEMETRY_FIELDS;
+static const uint8_t CH1 = 1u << (PKT_TELEMETRY_FIELDS + 1);
+
+void test_changes_first_period_is_keyframe() {
+    changes::change_detect_t cd;
+    changes::changes_init(&cd, 10);
+    pkt_changes_t cur = make_record(100, 200);
+    TEST_ASSERT_EQUAL_HEX8(0x3F, changes::changes_dirty(&cd, &cur));
+
+    pkt_changes_t out;
+    bool key = false;
+    TEST_ASSERT_TRUE(changes::changes_period(&cd, &cur, &out, &key));
+    TEST_ASSERT_TRUE(key);
+    TEST_ASSERT_EQUAL_INT32(200, out.value[1]);
+
+    // Nothing changed: nothing to send.
+    TEST_ASSERT_EQUAL_HEX8(0, changes::changes_dirty(&cd, &cur));
+    TEST_ASSERT_FALSE(changes::changes_period(&cd, &cur, &out, &key));
+    TEST_ASSERT_EQUAL_UINT32(1, cd.quiet);
+}
+
+void test_changes_deadband_holds_sent_value() {
+    changes::change_detect_t cd;
+    changes::changes_init(&cd, 100);
+    cd.deadband[0] = 10;
+    pkt_changes_t cur = make_record(100, 200);
+    pkt_changes_t out;
+    bool key = false;
+    changes::changes_period(&cd, &cur, &out, &key);
+
+    // Creeping by 5 per period stays quiet until it is 15 away from what was sent.
+    cur.value[0] = 105;
+    TEST_ASSERT_FALSE(changes::changes_period(&cd, &cur, &out, &key));
+    cur.value[0] = 110;
+    TEST_ASSERT_FALSE(changes::changes_period(&cd, &cur, &out, &key));
+    cur.value[0] = 115;
+    TEST_ASSERT_EQUAL_HEX8(CH0, changes::changes_dirty(&cd, &cur));
+    TEST_ASSERT_TRUE(changes::changes_period(&cd, &cur, &out, &key));
+    TEST_ASSERT_FALSE(key);
+    TEST_ASSERT_EQUAL_INT32(115, out.value[0]);
+
+    // Channel 1 has no deadband; a clean channel 0 keeps its sent value.
+    cur.value[0] = 118;
+    cur.value[1] = 199;
+    TEST_ASSERT_EQUAL_HEX8(CH1, changes::changes_dirty(&cd, &cur));
+    TEST_ASSERT_TRUE(changes::changes_period(&cd, &cur, &out, &key));
+    TEST_ASSERT_EQUAL_INT32(115, out.value[0]);
+    TEST_ASSERT_EQUAL_INT32(199, out.value[1]);
+
+    // Record fields have no deadband.
+    cur.rec.fault_count = 1;
+    TEST_ASSERT_EQUAL_HEX8(1u << 3, changes::changes_dirty(&cd, &cur));
+    TEST_ASSERT_EQUAL_UINT32(2, cd.deltas);
+}
+
+void test_changes_keyframe_every_n_periods_and_on_request() {
+    changes::change_detect_t cd;
+    changes::changes_init(&cd, 4);
+    pkt_changes_t cur = make_record(0, 0);
+    pkt_changes_t out;
+    bool key = false;
+
+    uint32_t sent = 0;
+    for (int i = 0; i < 9; i++) {
+        if (changes::changes_period(&cd, &cur, &out, &key)) {
+            TEST_ASSERT_TRUE(key);
+            sent++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, sent); // periods 0, 4 and 8
+    TEST_ASSERT_EQUAL_UINT32(6, cd.quiet);
+
+    changes::changes_request_key(&cd);
+    TEST_ASSERT_TRUE(changes::changes_period(&cd, &cur, &out, &key));
+    TEST_ASSERT_TRUE(key);
+    TEST_ASSERT_FALSE(changes::changes_period(&cd, &cur, &out, &key));
+
+    // A different channel count cannot be a delta.
+    cur.channels = 3;
+    TEST_ASSERT_TRUE(changes::changes_period(&cd, &cur, &out, &key));
+    TEST_ASSERT_TRUE(key);
+
+    // Restart keeps deadbands but opens with a keyframe again.
+    cd.deadband[1] = 7;
+    changes::changes_restart(&cd, 2);
+    TEST_ASSERT_EQUAL_UINT32(7, cd.deadband[1]);
+    TEST_ASSERT_TRUE(changes::changes_period(&cd, &cur, &out, &key));
+    TEST_ASSERT_TRUE(key);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_changes_first_period_is_keyframe);
+    RUN_TEST(test_changes_deadband_holds_sent_value);
+    RUN_TEST(test_changes_keyframe_every_n_periods_and_on_request);
+    return UNITY_END();
+}
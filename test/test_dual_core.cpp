@@ -0,0 +1,343 @@
+#include <unity.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <utility>
+#include "app.h"
+#include "acq/acquisition.h"
+#include "hal/sensor/sim_sensor.h"
+#include "packet.h"
+#include "seqlock.h"
+
+// Manual mocks for HAL interfaces. The acquisition thread only ever calls
+// hal_wake(); everything else is used from the core0 (test) thread.
+class MockHalLed : public hal::led::IHalLed {
+    public:
+    void hal_led_init() override {}
+    void hal_led_set(bool) override {}
+    void hal_led_toggle() override {}
+};
+
+class MockHalTime : public hal::time::IHalTime {
+    public:
+    uint32_t micros_value = 0;
+    std::atomic<uint32_t> wakes{0};
+    uint32_t hal_millis() override { return micros_value / 1000u; }
+    uint32_t hal_micros() override { return micros_value; }
+    void hal_sleep_until(uint64_t) override {}
+    void hal_wake() override { wakes++; }
+};
+
+// Decodes every frame it is handed and checks the record against the set of
+// snapshots core0 actually published.
+class CheckingSerial : public hal::serial::ISerialIo {
+    public:
+    const std::set<std::pair<uint32_t, uint32_t>> *published = nullptr;
+    uint32_t frames = 0;
+    uint32_t bad_frames = 0;
+    uint32_t torn = 0;
+    uint32_t seq_errors = 0;
+    uint16_t last_seq = 0;
+
+    bool serial_readline(char *, size_t) override { return false; }
+    void hal_serial_print(const char *) override {}
+    size_t hal_serial_flush(size_t) override { return 0; }
+    bool hal_serial_pending() override { return false; }
+
+    void hal_serial_write(const uint8_t *data, size_t len) override {
+        uint8_t scratch[PKT_MAX_RAW];
+        pkt_t pkt;
+        pkt_telemetry_t rec;
+        if (!pkt_decode(data, len, scratch, sizeof(scratch), &pkt) ||
+            !pkt_telemetry_unpack(pkt.payload, pkt.payload_len, &rec)) {
+            bad_frames++;
+            return;
+        }
+        // Sequence numbers only move forward (gaps are dropped records).
+        uint16_t step = (uint16_t)(pkt.seq - last_seq);
+        if (frames > 0 && (step == 0 || step >= 0x8000)) {
+            seq_errors++;
+        }
+        frames++;
+        last_seq = pkt.seq;
+        if (published && published->count({rec.telemetry_period_ms, rec.fault_count}) == 0) {
+            torn++;
+        }
+    }
+};
+
+class MockLogger : public hal::logging::ILogger {
+    public:
+    char last_log[256] = {0};
+    uint32_t lines = 0;
+    void log(const char *message) override {
+        lines++;
+        strncpy(last_log, message, sizeof(last_log) - 1);
+    }
+};
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// ---------------------------------------------------------------------------
+// Seqlock
+// ---------------------------------------------------------------------------
+
+// Every field is derived from n, so a mix of two writes is detectable.
+struct Snapshot {
+    uint64_t n;
+    uint64_t inverted;
+    uint32_t scaled[6];
+};
+
+static Snapshot make_snapshot(uint64_t n) {
+    Snapshot s;
+    s.n = n;
+    s.inverted = ~n;
+    for (uint32_t i = 0; i < 6; i++) {
+        s.scaled[i] = (uint32_t)(n * (i + 3));
+    }
+    return s;
+}
+
+static bool consistent(const Snapshot &s) {
+    if (s.inverted != ~s.n) {
+        return false;
+    }
+    for (uint32_t i = 0; i < 6; i++) {
+        if (s.scaled[i] != (uint32_t)(s.n * (i + 3))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_seqlock_single_thread() {
+    util::Seqlock<Snapshot> lock;
+    Snapshot s;
+    TEST_ASSERT_TRUE(lock.try_read(s));
+    TEST_ASSERT_EQUAL_UINT64(0, s.n);
+    TEST_ASSERT_EQUAL(0, lock.version());
+
+    lock.write(make_snapshot(42));
+    TEST_ASSERT_EQUAL(1, lock.version());
+    TEST_ASSERT_EQUAL(0, lock.read(s));
+    TEST_ASSERT_EQUAL_UINT64(42, s.n);
+    TEST_ASSERT_TRUE(consistent(s));
+}
+
+void test_seqlock_readers_never_see_torn_values() {
+    util::Seqlock<Snapshot> lock;
+    lock.write(make_snapshot(0));
+    const uint64_t writes = 500000;
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> torn{0}, backwards{0};
+    std::atomic<uint64_t> reads{0}, retries{0};
+
+    auto reader = [&]() {
+        uint64_t last = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            Snapshot s;
+            retries += lock.read(s);
+            reads++;
+            if (!consistent(s)) {
+                torn++;
+            }
+            if (s.n < last) {
+                backwards++;
+            }
+            last = s.n;
+        }
+    };
+
+    std::thread r1(reader), r2(reader);
+    for (uint64_t n = 1; n <= writes; n++) {
+        lock.write(make_snapshot(n));
+    }
+    done.store(true, std::memory_order_release);
+    r1.join();
+    r2.join();
+
+    Snapshot final_value;
+    lock.read(final_value);
+    TEST_ASSERT_EQUAL(0, torn.load());
+    TEST_ASSERT_EQUAL(0, backwards.load());
+    TEST_ASSERT_EQUAL_UINT64(writes, final_value.n);
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "%llu writes, %llu reads, %llu retries",
+             (unsigned long long)writes, (unsigned long long)reads.load(), (unsigned long long)retries.load());
+    TEST_MESSAGE(msg);
+}
+
+// ---------------------------------------------------------------------------
+// Acquisition core
+// ---------------------------------------------------------------------------
+
+static acq::acq_t g_acq;                     // large; keep off the stack
+static sensors::sensor_registry_t g_sensors;
+
+static void reset_acq() {
+    acq::acq_msg_t msg;
+    while (g_acq.out.pop(msg)) {
+    }
+}
+
+void test_acq_frames_telemetry_from_snapshot() {
+    MockHalLed led;
+    MockHalTime time;
+    CheckingSerial serial;
+    MockLogger logger;
+    app::app_t app;
+    hal::sensor::HalSensorSim sim(2);
+
+    reset_acq();
+    sensors::sensor_registry_init(&g_sensors);
+    sensors::sensor_registry_add(&g_sensors, &sim, 0, 10, 0);
+    sensors::sensor_registry_add(&g_sensors, &sim, 1, 10, 0);
+
+    app::app_init(&app, 0, &led, &time, &serial, &logger);
+    app::app_offload_acquisition(&app, &g_acq.config);
+    acq::acq_init(&g_acq, 0, &time, &g_sensors);
+
+    // core0 no longer produces telemetry itself.
+    app::app_tick(&app, 5000000);
+    TEST_ASSERT_EQUAL(0, logger.lines);
+
+    // Text records travel through the queue and out through the logger.
+    acq::acq_tick(&g_acq, 1000000);
+    TEST_ASSERT_TRUE(acq::acq_pending(&g_acq));
+    TEST_ASSERT_EQUAL(1, acq::acq_drain(&g_acq, &serial, &logger, 8));
+    TEST_ASSERT_EQUAL_STRING("STATE=1 TIME=1000 TELEMETRY_MS=1000 HEARTBEAT_MS=2000 FAULTS=0", logger.last_log);
+    TEST_ASSERT_GREATER_THAN(0, time.wakes.load());
+
+    // Commands republish; core1 follows on its next tick.
+    app::app_handle_command(&app, "TELEMETRY BINARY");
+    app::app_handle_command(&app, "RATE 100");
+    acq::acq_tick(&g_acq, 1050000); // new period starts here
+    acq::acq_tick(&g_acq, 1150000);
+    acq::acq_tick(&g_acq, 1250000);
+    TEST_ASSERT_EQUAL(2, acq::acq_drain(&g_acq, &serial, &logger, 8));
+    TEST_ASSERT_EQUAL(2, serial.frames);
+    TEST_ASSERT_EQUAL(0, serial.bad_frames);
+
+    acq::acq_stats_t stats;
+    acq::acq_read_stats(&g_acq, &stats);
+    TEST_ASSERT_EQUAL(4, stats.iterations);
+    TEST_ASSERT_EQUAL(3, stats.records);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    TEST_ASSERT_EQUAL(1, stats.config_updates);
+    TEST_ASSERT_GREATER_THAN(0, stats.samples);
+}
+
+void test_acq_drops_when_core0_falls_behind() {
+    MockHalLed led;
+    MockHalTime time;
+    CheckingSerial serial;
+    MockLogger logger;
+    app::app_t app;
+
+    reset_acq();
+    app::app_init(&app, 0, &led, &time, &serial, &logger);
+    app::app_offload_acquisition(&app, &g_acq.config);
+    app::app_handle_command(&app, "RATE 10");
+    acq::acq_init(&g_acq, 0, &time, NULL);
+
+    for (uint64_t t = 10000; t <= 10000u * (ACQ_QUEUE_DEPTH + 5); t += 10000) {
+        acq::acq_tick(&g_acq, t);
+    }
+
+    acq::acq_stats_t stats;
+    acq::acq_read_stats(&g_acq, &stats);
+    TEST_ASSERT_EQUAL(ACQ_QUEUE_DEPTH, stats.records);
+    TEST_ASSERT_EQUAL(5, stats.dropped);
+    TEST_ASSERT_EQUAL(ACQ_QUEUE_DEPTH, acq::acq_drain(&g_acq, &serial, &logger, 1000));
+}
+
+// Two threads model the two cores: core1 samples and frames as fast as it
+// can on virtual time while core0 keeps changing the configuration and
+// drains. Every record must match a snapshot core0 published as a whole.
+void test_acq_two_threads_no_torn_records() {
+    MockHalLed led;
+    MockHalTime time;
+    CheckingSerial serial;
+    MockLogger logger;
+    app::app_t app;
+    hal::sensor::HalSensorSim sim(4);
+
+    reset_acq();
+    sensors::sensor_registry_init(&g_sensors);
+    for (uint8_t ch = 0; ch < 4; ch++) {
+        sensors::sensor_registry_add(&g_sensors, &sim, ch, 1, 0);
+    }
+
+    std::set<std::pair<uint32_t, uint32_t>> published;
+    app::app_init(&app, 0, &led, &time, &serial, &logger);
+    app::app_handle_command(&app, "TELEMETRY BINARY");
+    app::app_handle_command(&app, "RATE 10");
+    published.insert({app.telemetry_period_ms, app.fault_count});
+    app::app_offload_acquisition(&app, &g_acq.config);
+    acq::acq_init(&g_acq, 0, &time, &g_sensors);
+    serial.published = &published;
+
+    const uint32_t passes = 1000000; // ~17 minutes of virtual time
+    std::atomic<bool> done{false};
+    std::thread core1([&]() {
+        uint64_t now = 0;
+        for (uint32_t i = 0; i < passes; i++) {
+            now += 1000; // 1 ms of virtual time per pass
+            acq::acq_tick(&g_acq, now);
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    char cmd[32];
+    uint32_t commands = 0;
+    for (uint32_t i = 0; !done.load(std::memory_order_acquire); i++) {
+        acq::acq_drain(&g_acq, &serial, &logger, 4);
+        if (i % 64 != 0) {
+            continue;
+        }
+        if (commands++ % 2 == 0) {
+            uint32_t rate = 10 + (commands % 97);
+            snprintf(cmd, sizeof(cmd), "RATE %u", rate);
+            published.insert({rate, app.fault_count});
+            app::app_handle_command(&app, cmd);
+        } else {
+            published.insert({app.telemetry_period_ms, app.fault_count + 1});
+            app::app_handle_command(&app, "FAULT");
+        }
+    }
+    core1.join();
+    acq::acq_drain(&g_acq, &serial, &logger, 1000000);
+
+    acq::acq_stats_t stats;
+    acq::acq_read_stats(&g_acq, &stats);
+    TEST_ASSERT_EQUAL(0, serial.bad_frames);
+    TEST_ASSERT_EQUAL(0, serial.torn);
+    TEST_ASSERT_EQUAL(0, serial.seq_errors);
+    TEST_ASSERT_GREATER_THAN(0, serial.frames);
+    TEST_ASSERT_EQUAL(stats.records, serial.frames);
+    TEST_ASSERT_GREATER_THAN(0, stats.config_updates);
+
+    char msg[200];
+    snprintf(msg, sizeof(msg), "core1 passes %u, samples %u, records %u, dropped %u; core0 commands %u, config updates seen %u",
+             stats.iterations, stats.samples, stats.records, stats.dropped, commands, stats.config_updates);
+    TEST_MESSAGE(msg);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_seqlock_single_thread);
+    RUN_TEST(test_seqlock_readers_never_see_torn_values);
+    RUN_TEST(test_acq_frames_telemetry_from_snapshot);
+    RUN_TEST(test_acq_drops_when_core0_falls_behind);
+    RUN_TEST(test_acq_two_threads_no_torn_records);
+    return UNITY_END();
+}
@@ -0,0 +1,256 @@
+#include <unity.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "app.h"
+#include "gateway.h"
+#include "seq_tracker.h"
+#include "hal/logging/udp_logger.h"
+#include "hal/transport/hal_datagram_native.h"
+#include "hal/transport/udp_link.h"
+#include "mock_hal.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void track_all(host::SeqTracker *t, const std::vector<uint32_t> &seqs) {
+    for (uint32_t s : seqs)
+        t->track(s);
+}
+
+void test_seq_in_order_and_gaps() {
+    host::SeqTracker t;
+    TEST_ASSERT_EQUAL_UINT64(0, t.lost());
+    track_all(&t, {10, 11, 12, 15});
+    TEST_ASSERT_EQUAL_UINT64(4, t.received);
+    TEST_ASSERT_EQUAL_UINT64(2, t.missing()); // 13 and 14 may still come
+    TEST_ASSERT_EQUAL_UINT64(0, t.dropped);
+
+    // Once they leave the window they are lost for good.
+    t.track(15 + SEQ_WINDOW);
+    TEST_ASSERT_EQUAL_UINT64(2, t.dropped);
+    TEST_ASSERT_EQUAL_UINT64(SEQ_WINDOW - 1 + 2, t.lost());
+
+    // A jump past the whole window counts every seq skipped.
+    host::SeqTracker j;
+    track_all(&j, {0, 1000});
+    TEST_ASSERT_EQUAL_UINT64(999, j.lost());
+    TEST_ASSERT_EQUAL_UINT64(2 + 999, j.received + j.lost());
+}
+
+void test_seq_reorder_duplicates_and_late() {
+    host::SeqTracker t;
+    track_all(&t, {0, 1, 3, 2, 4, 4, 1});
+    TEST_ASSERT_EQUAL_UINT64(5, t.received);
+    TEST_ASSERT_EQUAL_UINT64(1, t.reordered);
+    TEST_ASSERT_EQUAL_UINT64(2, t.duplicates);
+    TEST_ASSERT_EQUAL_UINT64(0, t.lost());
+
+    // 5 goes missing, then arrives after leaving the window: late, not lost.
+    for (uint32_t s = 6; s < 6 + SEQ_WINDOW; s++)
+        t.track(s);
+    TEST_ASSERT_EQUAL_UINT64(1, t.dropped);
+    t.track(5);
+    TEST_ASSERT_EQUAL_UINT64(1, t.late);
+    TEST_ASSERT_EQUAL_UINT64(0, t.lost());
+    TEST_ASSERT_EQUAL_UINT64(6 + SEQ_WINDOW, t.received);
+}
+
+void test_seq_wraps_and_restarts() {
+    host::SeqTracker t;
+    track_all(&t, {0xFFFFFFFEu, 0xFFFFFFFFu, 1u, 0u});
+    TEST_ASSERT_EQUAL_UINT64(4, t.received);
+    TEST_ASSERT_EQUAL_UINT64(1, t.reordered);
+    TEST_ASSERT_EQUAL_UINT64(0, t.lost());
+
+    // A node that reboots starts over from 0, far behind.
+    host::SeqTracker r;
+    track_all(&r, {5000, 5002, 0, 1});
+    TEST_ASSERT_EQUAL_UINT32(1, r.restarts);
+    TEST_ASSERT_EQUAL_UINT64(1, r.dropped); // 5001 never came before the reboot
+    TEST_ASSERT_EQUAL_UINT64(4, r.received);
+    TEST_ASSERT_EQUAL_UINT64(0, r.missing());
+}
+
+// Loses every drop_every-th datagram and holds every hold_every-th one
+// back until after the next, like a lossy, reordering network.
+class LossySocket : public hal::transport::IDatagramSocket {
+public:
+    LossySocket(hal::transport::IDatagramSocket &inner, uint32_t drop_every, uint32_t hold_every)
+        : inner_(inner), drop_every_(drop_every), hold_every_(hold_every) {}
+
+    bool dgram_send(const uint8_t *data, size_t len) override {
+        n_++;
+        if (drop_every_ != 0 && n_ % drop_every_ == 0)
+            return true;
+        if (hold_every_ != 0 && n_ % hold_every_ == 0) {
+            held_.assign(data, data + len);
+            return true;
+        }
+        bool ok = inner_.dgram_send(data, len);
+        if (!held_.empty()) {
+            inner_.dgram_send(held_.data(), held_.size());
+            held_.clear();
+        }
+        return ok;
+    }
+
+    size_t dgram_recv(uint8_t *out, size_t cap) override { return inner_.dgram_recv(out, cap); }
+
+private:
+    hal::transport::IDatagramSocket &inner_;
+    uint32_t drop_every_;
+    uint32_t hold_every_;
+    uint32_t n_ = 0;
+    std::vector<uint8_t> held_;
+};
+
+static size_t poll_until(host::Gateway *gw, uint64_t datagrams) {
+    for (int i = 0; i < 100 && gw->stats().datagrams < datagrams; i++)
+        gw->poll(20);
+    return gw->stats().datagrams;
+}
+
+void test_gateway_tracks_many_nodes_on_loopback() {
+    host::GatewayConfig cfg;
+    cfg.bind_addr = "127.0.0.1";
+    cfg.port = 0;
+    cfg.batch = 16;
+    host::Gateway gw(cfg);
+    TEST_ASSERT_TRUE(gw.ok());
+
+    uint64_t packets = 0;
+    gw.on_packet = [&](uint16_t, const pkt_t *pkt) {
+        TEST_ASSERT_EQUAL(PKT_TYPE_TELEMETRY, pkt->type);
+        packets++;
+    };
+
+    const int nodes = 20;
+    const uint32_t per_node = 200;
+    std::vector<std::unique_ptr<hal::transport::HalUdpSocketPosix>> socks;
+    std::vector<std::unique_ptr<LossySocket>> lossy;
+    std::vector<std::unique_ptr<hal::transport::HalUdp>> links;
+    for (int i = 0; i < nodes; i++) {
+        socks.emplace_back(new hal::transport::HalUdpSocketPosix("127.0.0.1", gw.port()));
+        TEST_ASSERT_TRUE(socks.back()->ok());
+        lossy.emplace_back(new LossySocket(*socks.back(), 10, 7));
+        links.emplace_back(new hal::transport::HalUdp(*lossy.back(), (uint16_t)(100 + i)));
+    }
+
+    // Two telemetry frames per datagram, every node in turn.
+    uint8_t payload[PKT_TELEMETRY_PAYLOAD_SIZE];
+    pkt_telemetry_t rec = {1, 1000, 500, 0};
+    pkt_t pkt = {PKT_TYPE_TELEMETRY, 0, 0, payload, pkt_telemetry_pack(&rec, payload, sizeof(payload))};
+    uint8_t frame[PKT_MAX_FRAME];
+    size_t frame_len = pkt_encode(&pkt, frame, sizeof(frame));
+    for (uint32_t d = 0; d < per_node; d++) {
+        for (int i = 0; i < nodes; i++) {
+            links[i]->hal_serial_write(frame, frame_len);
+            links[i]->hal_serial_write(frame, frame_len);
+            links[i]->hal_serial_flush(256);
+        }
+        gw.poll(0);
+    }
+
+    // Per node: every 10th of 200 dropped, every 7th held back one datagram
+    // (70 and 140 are dropped instead). The drop of the very last one shows
+    // as no gap, as nothing was sent after it.
+    const uint64_t lost = per_node / 10, held = per_node / 7 - per_node / 70;
+    const uint64_t arrived = per_node - lost;
+    poll_until(&gw, arrived * nodes);
+    TEST_ASSERT_EQUAL(nodes, gw.nodes());
+    TEST_ASSERT_EQUAL_UINT64(arrived * nodes, gw.stats().datagrams);
+    TEST_ASSERT_EQUAL_UINT64(2 * arrived * nodes, packets);
+    TEST_ASSERT_EQUAL_UINT64(0, gw.stats().foreign);
+    TEST_ASSERT_TRUE(gw.stats().recv_calls < gw.stats().datagrams); // batched
+    for (int i = 0; i < nodes; i++) {
+        const host::NodeStats *n = gw.node((uint16_t)(100 + i));
+        TEST_ASSERT_NOT_NULL(n);
+        TEST_ASSERT_EQUAL_UINT64(arrived, n->seq.received);
+        TEST_ASSERT_EQUAL_UINT64(lost - 1, n->seq.lost());
+        TEST_ASSERT_EQUAL_UINT64(held, n->seq.reordered);
+        TEST_ASSERT_EQUAL_UINT64(2 * arrived, n->frames);
+        TEST_ASSERT_EQUAL_UINT64(0, n->bad_frames);
+    }
+    TEST_ASSERT_NULL(gw.node(99));
+}
+
+void test_gateway_runs_an_app_over_udp() {
+    host::GatewayConfig cfg;
+    cfg.bind_addr = "127.0.0.1";
+    cfg.port = 0;
+    host::Gateway gw(cfg);
+    TEST_ASSERT_TRUE(gw.ok());
+
+    std::vector<std::string> lines;
+    uint64_t telemetry = 0;
+    gw.on_line = [&](uint16_t node, const char *line, size_t len) {
+        TEST_ASSERT_EQUAL_UINT16(3, node);
+        lines.emplace_back(line, len);
+    };
+    gw.on_packet = [&](uint16_t, const pkt_t *pkt) {
+        if (pkt->type == PKT_TYPE_TELEMETRY)
+            telemetry++;
+    };
+
+    hal::transport::HalUdpSocketPosix sock("127.0.0.1", gw.port());
+    hal::transport::HalUdp link(sock, 3);
+    hal::logging::HalUdpLogger logger(link);
+    MockHalLed led;
+    MockHalTime time;
+    static app::app_t app; // large; keep off the stack
+    app::app_init(&app, time.hal_monotonic_us(), &led, &time, &link, &logger);
+
+    // One main loop pass (main.cpp): commands, tick, which sends the datagram.
+    auto pass = [&]() {
+        char line[96];
+        app::app_begin_batch(&app);
+        while (link.serial_readline(line, sizeof(line)))
+            app::app_handle_command(&app, line);
+        app::app_end_batch(&app);
+        app::app_tick(&app, time.hal_monotonic_us());
+    };
+
+    logger.log("BOOT OK");
+    pass();
+    poll_until(&gw, 1);
+    TEST_ASSERT_EQUAL(1, gw.nodes());
+    TEST_ASSERT_EQUAL_STRING("BOOT OK", lines.at(0).c_str());
+
+    // Commands come back to the address the node sent from.
+    TEST_ASSERT_TRUE(gw.send_command(3, "#7 RATE 100"));
+    TEST_ASSERT_TRUE(gw.send_command(3, "TELEMETRY BINARY"));
+    TEST_ASSERT_FALSE(gw.send_command(4, "STATUS")); // never heard from
+    for (int i = 0; i < 100 && link.stats().datagrams_received < 2; i++)
+        gw.poll(1);
+    pass();
+    poll_until(&gw, 2);
+    TEST_ASSERT_EQUAL(3, lines.size());
+    TEST_ASSERT_EQUAL_STRING("#7 OK RATE SET", lines[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("OK TELEMETRY BINARY", lines[2].c_str());
+
+    // A second of device time: ten telemetry frames, one datagram per pass.
+    for (int i = 0; i < 10; i++) {
+        time.micros_value += 100000;
+        pass();
+    }
+    poll_until(&gw, 12);
+    TEST_ASSERT_EQUAL_UINT64(10, telemetry);
+    TEST_ASSERT_EQUAL_UINT64(0, gw.node(3)->seq.lost());
+    TEST_ASSERT_EQUAL_UINT64(12, gw.node(3)->seq.received);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_seq_in_order_and_gaps);
+    RUN_TEST(test_seq_reorder_duplicates_and_late);
+    RUN_TEST(test_seq_wraps_and_restarts);
+    RUN_TEST(test_gateway_tracks_many_nodes_on_loopback);
+    RUN_TEST(test_gateway_runs_an_app_over_udp);
+    return UNITY_END();
+}
@@ -0,0 +1,87 @@
+#include <unity.h>
+#include <chrono>
+#include <thread>
+#include "hal/time/hal_time_native.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_wrap_extend_counts_wraps() {
+    hal::time::time_wrap_t w = {0, 0};
+
+    TEST_ASSERT_EQUAL_UINT64(0xFFFFFFF0ull, hal::time::time_wrap_extend(&w, 0xFFFFFFF0u));
+    TEST_ASSERT_EQUAL_UINT64(0x100000005ull, hal::time::time_wrap_extend(&w, 0x00000005u));
+    TEST_ASSERT_EQUAL_UINT64(0x100000005ull, hal::time::time_wrap_extend(&w, 0x00000005u)); // same reading
+    TEST_ASSERT_EQUAL_UINT64(0x180000000ull, hal::time::time_wrap_extend(&w, 0x80000000u));
+    TEST_ASSERT_EQUAL_UINT64(0x200000001ull, hal::time::time_wrap_extend(&w, 0x00000001u));
+}
+
+void test_native_clock_is_monotonic() {
+    hal::time::HalTimeNative t;
+
+    uint64_t prev = t.hal_monotonic_us();
+    for (int i = 0; i < 100000; i++) {
+        uint64_t now = t.hal_monotonic_us();
+        TEST_ASSERT_TRUE(now >= prev);
+        prev = now;
+    }
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)t.hal_monotonic_us() / 1000u, t.hal_micros() / 1000u);
+}
+
+void test_native_sleep_until_reaches_deadline() {
+    hal::time::HalTimeNative t;
+
+    uint64_t start = t.hal_monotonic_us();
+    t.hal_sleep_until(start + 20000);
+    TEST_ASSERT_TRUE(t.hal_monotonic_us() - start >= 20000);
+
+    // Past deadline returns at once.
+    start = t.hal_monotonic_us();
+    t.hal_sleep_until(start - 5000);
+    TEST_ASSERT_TRUE(t.hal_monotonic_us() - start < 5000);
+}
+
+void test_native_wake_ends_sleep_early() {
+    hal::time::HalTimeNative t;
+
+    std::thread waker([&t]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        t.hal_wake();
+    });
+
+    uint64_t start = t.hal_monotonic_us();
+    t.hal_sleep_until(start + 5000000);
+    uint64_t slept = t.hal_monotonic_us() - start;
+    waker.join();
+
+    TEST_ASSERT_TRUE(slept < 1000000);
+}
+
+void test_native_wake_is_latched() {
+    hal::time::HalTimeNative t;
+
+    // A wake before the sleep behaves like a pending WFE event.
+    t.hal_wake();
+    uint64_t start = t.hal_monotonic_us();
+    t.hal_sleep_until(start + 5000000);
+    TEST_ASSERT_TRUE(t.hal_monotonic_us() - start < 1000000);
+
+    // The event is consumed: the next sleep runs to its deadline.
+    start = t.hal_monotonic_us();
+    t.hal_sleep_until(start + 20000);
+    TEST_ASSERT_TRUE(t.hal_monotonic_us() - start >= 20000);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_wrap_extend_counts_wraps);
+    RUN_TEST(test_native_clock_is_monotonic);
+    RUN_TEST(test_native_sleep_until_reaches_deadline);
+    RUN_TEST(test_native_wake_ends_sleep_early);
+    RUN_TEST(test_native_wake_is_latched);
+    return UNITY_END();
+}
@@ -0,0 +1,255 @@
+#include <unity.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "packet.h"
+#include "parser.h"
+#include "frame_scan.h"
+#include "decoder.h"
+#include "column_writer.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static uint32_t xorshift(uint32_t *x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+// Telemetry frames interleaved with text lines, with optional corruption
+// (bit flips, dropped bytes, oversize runs) injected at the given rate.
+static std::vector<uint8_t> make_stream(uint32_t seed, size_t frames, int corrupt_pct) {
+    std::vector<uint8_t> s;
+    uint32_t x = seed;
+    for (size_t i = 0; i < frames; i++) {
+        uint8_t payload[PKT_MAX_PAYLOAD];
+        pkt_telemetry_t rec = {(uint8_t)(i % 3), 100u + (uint32_t)i, 1000u, (uint32_t)(i / 7)};
+        size_t plen = pkt_telemetry_pack(&rec, payload, sizeof(payload));
+        if (xorshift(&x) % 8 == 0) {
+            plen = xorshift(&x) % (PKT_MAX_PAYLOAD + 1); // other packet shapes
+            for (size_t k = 0; k < plen; k++)
+                payload[k] = (uint8_t)xorshift(&x);
+        }
+        pkt_t pkt = {(uint8_t)(xorshift(&x) % 8 ? PKT_TYPE_TELEMETRY : 0x7F), (uint16_t)i,
+                     (uint64_t)i * 1000003u, payload, plen};
+        uint8_t frame[PKT_MAX_FRAME];
+        size_t n = pkt_encode(&pkt, frame, sizeof(frame));
+        TEST_ASSERT_TRUE(n > 0);
+
+        if (corrupt_pct > 0 && (int)(xorshift(&x) % 100) < corrupt_pct) {
+            switch (xorshift(&x) % 4) {
+            case 0: frame[1 + xorshift(&x) % (n - 2)] ^= (uint8_t)(1u << (xorshift(&x) % 8)); break;
+            case 1: n -= 1 + xorshift(&x) % (n - 1); break; // truncated, no closing delimiter
+            case 2: frame[1 + xorshift(&x) % (n - 2)] = 0; break;
+            default:
+                for (int k = 0; k < 300; k++)
+                    s.push_back((uint8_t)(1 + xorshift(&x) % 255)); // overrun
+                break;
+            }
+        }
+        s.insert(s.end(), frame, frame + n);
+        if (xorshift(&x) % 4 == 0) {
+            const char *line = "OK STATE=1 TIME=5\r\n";
+            s.insert(s.end(), line, line + strlen(line));
+        }
+    }
+    return s;
+}
+
+struct Reference {
+    host::TelemetryColumns cols;
+    parser_t parser;
+};
+
+static void on_ref_frame(void *ctx, const pkt_t *pkt) {
+    static_cast<Reference *>(ctx)->cols.append(pkt);
+}
+
+// Decodes the stream with the firmware parser and with host::Decoder (in
+// chunks of the given maximum size) and checks the results are identical.
+static void check_matches_parser(const std::vector<uint8_t> &s, uint32_t chunk_seed, size_t max_chunk) {
+    Reference ref;
+    parser_init(&ref.parser, on_ref_frame, &ref);
+    parser_feed(&ref.parser, s.data(), s.size());
+
+    host::TelemetryColumns cols;
+    host::Decoder dec(&cols);
+    uint32_t x = chunk_seed;
+    for (size_t off = 0; off < s.size();) {
+        size_t chunk = max_chunk == 0 ? s.size() : 1 + xorshift(&x) % max_chunk;
+        if (chunk > s.size() - off)
+            chunk = s.size() - off;
+        dec.feed(&s[off], chunk);
+        off += chunk;
+    }
+
+    host::DecodeStats st = dec.stats();
+    TEST_ASSERT_EQUAL_UINT32(ref.parser.stats.frames_ok, (uint32_t)st.frames_ok);
+    TEST_ASSERT_EQUAL_UINT32(ref.parser.stats.crc_errors, (uint32_t)st.crc_errors);
+    TEST_ASSERT_EQUAL_UINT32(ref.parser.stats.framing_errors, (uint32_t)st.framing_errors);
+    TEST_ASSERT_EQUAL_UINT32(ref.parser.stats.overruns, (uint32_t)st.overruns);
+    TEST_ASSERT_EQUAL_UINT32(ref.parser.stats.resyncs, (uint32_t)st.resyncs);
+    TEST_ASSERT_EQUAL_UINT32(ref.parser.stats.bytes_in, (uint32_t)st.bytes_in);
+    TEST_ASSERT_EQUAL(ref.cols.rows(), cols.rows());
+    TEST_ASSERT_TRUE(ref.cols == cols);
+}
+
+void test_delim_scanner_matches_naive_scan() {
+    std::vector<uint8_t> buf(1000);
+    uint32_t x = 42;
+    for (auto &b : buf)
+        b = (xorshift(&x) % 11 == 0) ? 0 : (uint8_t)(1 + xorshift(&x) % 255);
+
+    for (size_t off = 0; off < 70; off++) {
+        for (size_t len : {0u, 1u, 63u, 64u, 65u, 127u, 128u, 500u}) {
+            if (off + len > buf.size())
+                continue;
+            host::DelimScanner scan(&buf[off], &buf[off] + len);
+            for (size_t i = 0; i < len; i++) {
+                if (buf[off + i] == 0)
+                    TEST_ASSERT_EQUAL(i, scan.next());
+            }
+            TEST_ASSERT_EQUAL(SIZE_MAX, scan.next());
+        }
+    }
+}
+
+void test_decoder_clean_stream() {
+    std::vector<uint8_t> s = make_stream(7, 2000, 0);
+
+    host::TelemetryColumns cols;
+    host::Decoder dec(&cols);
+    dec.feed(s.data(), s.size());
+
+    host::DecodeStats st = dec.stats();
+    TEST_ASSERT_EQUAL(2000, st.frames_ok);
+    TEST_ASSERT_EQUAL(2000, st.fast_frames);
+    TEST_ASSERT_EQUAL(0, st.crc_errors);
+    TEST_ASSERT_EQUAL(2000, cols.rows());
+    TEST_ASSERT_EQUAL_UINT16(1999, cols.seq[1999]);
+    TEST_ASSERT_EQUAL_UINT64(1999ull * 1000003u, cols.timestamp_us[1999]);
+
+    check_matches_parser(s, 1, 0);
+}
+
+void test_decoder_matches_parser_on_corrupt_stream() {
+    std::vector<uint8_t> s = make_stream(99, 5000, 20);
+    check_matches_parser(s, 3, 0);      // one call
+    check_matches_parser(s, 5, 1);      // byte at a time
+    check_matches_parser(s, 9, 17);     // splits inside frames
+    check_matches_parser(s, 11, 4096);  // large chunks
+}
+
+void test_decoder_keeps_unterminated_tail_pending() {
+    std::vector<uint8_t> s = make_stream(3, 2, 0);
+    s.pop_back(); // drop the final delimiter
+
+    host::TelemetryColumns cols;
+    host::Decoder dec(&cols);
+    dec.feed(s.data(), s.size());
+    TEST_ASSERT_EQUAL(1, dec.stats().frames_ok);
+
+    const uint8_t delim = PKT_FRAME_DELIM;
+    dec.feed(&delim, 1);
+    TEST_ASSERT_EQUAL(2, dec.stats().frames_ok);
+    TEST_ASSERT_EQUAL(2, cols.rows());
+}
+
+void test_column_writers() {
+    host::TelemetryColumns cols;
+    uint8_t payload[PKT_TELEMETRY_PAYLOAD_SIZE];
+    pkt_telemetry_t rec = {2, 100, 1000, 3};
+    pkt_telemetry_pack(&rec, payload, sizeof(payload));
+    pkt_t a = {PKT_TYPE_TELEMETRY, 5, 123456789ull, payload, sizeof(payload)};
+    pkt_t b = {0x7F, 6, 42, payload, 2};
+    cols.append(&a);
+    cols.append(&b);
+
+    char text[512] = {0};
+    FILE *f = tmpfile();
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_TRUE(host::write_csv(f, cols));
+    rewind(f);
+    size_t n = fread(text, 1, sizeof(text) - 1, f);
+    fclose(f);
+    text[n] = '\0';
+    TEST_ASSERT_EQUAL_STRING(
+        "seq,timestamp_us,type,payload_len,state,telemetry_period_ms,heartbeat_period_ms,fault_count\n"
+        "5,123456789,1,13,2,100,1000,3\n"
+        "6,42,127,2,,,,\n",
+        text);
+
+    // Two windows: the header once, then each window's rows.
+    f = tmpfile();
+    TEST_ASSERT_TRUE(host::write_csv_header(f));
+    TEST_ASSERT_TRUE(host::write_csv_rows(f, cols));
+    TEST_ASSERT_TRUE(host::write_csv_rows(f, cols));
+    rewind(f);
+    n = fread(text, 1, sizeof(text) - 1, f);
+    fclose(f);
+    text[n] = '\0';
+    TEST_ASSERT_EQUAL_STRING(
+        "seq,timestamp_us,type,payload_len,state,telemetry_period_ms,heartbeat_period_ms,fault_count\n"
+        "5,123456789,1,13,2,100,1000,3\n"
+        "6,42,127,2,,,,\n"
+        "5,123456789,1,13,2,100,1000,3\n"
+        "6,42,127,2,,,,\n",
+        text);
+
+    std::vector<uint8_t> bin(4096);
+    f = tmpfile();
+    TEST_ASSERT_TRUE(host::write_columns(f, cols));
+    rewind(f);
+    n = fread(bin.data(), 1, bin.size(), f);
+    fclose(f);
+
+    TEST_ASSERT_EQUAL_MEMORY("TLMC", bin.data(), 4);
+    TEST_ASSERT_EQUAL(2, bin[4] | (bin[5] << 8)); // version
+    TEST_ASSERT_EQUAL(9, bin[6] | (bin[7] << 8)); // columns
+    // First descriptor: "seq", width 2.
+    TEST_ASSERT_EQUAL(3, bin[8]);
+    TEST_ASSERT_EQUAL_MEMORY("seq", &bin[9], 3);
+    TEST_ASSERT_EQUAL(2, bin[12]);
+
+    // Header (8) + descriptors (2 + name each), then one block:
+    // rows (8) + rows * sum(widths = 27).
+    size_t desc = 0;
+    for (const char *name : {"seq", "timestamp_us", "type", "payload_len", "has_record", "state",
+                             "telemetry_period_ms", "heartbeat_period_ms", "fault_count"})
+        desc += 2 + strlen(name);
+    size_t block = 8 + 2 * 27;
+    TEST_ASSERT_EQUAL(8 + desc + block, n);
+    TEST_ASSERT_EQUAL(2, bin[8 + desc]); // block rows (low byte)
+
+    // seq column comes first: 5, 6.
+    TEST_ASSERT_EQUAL(5, bin[8 + desc + 8]);
+    TEST_ASSERT_EQUAL(6, bin[8 + desc + 8 + 2]);
+
+    // Further windows append blocks; an empty window writes nothing.
+    f = tmpfile();
+    TEST_ASSERT_TRUE(host::write_columns(f, cols));
+    TEST_ASSERT_TRUE(host::write_columns_block(f, cols));
+    TEST_ASSERT_TRUE(host::write_columns_block(f, host::TelemetryColumns()));
+    rewind(f);
+    n = fread(bin.data(), 1, bin.size(), f);
+    fclose(f);
+    TEST_ASSERT_EQUAL(8 + desc + 2 * block, n);
+    TEST_ASSERT_EQUAL(2, bin[8 + desc + block]);
+    TEST_ASSERT_EQUAL(5, bin[8 + desc + block + 8]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_delim_scanner_matches_naive_scan);
+    RUN_TEST(test_decoder_clean_stream);
+    RUN_TEST(test_decoder_matches_parser_on_corrupt_stream);
+    RUN_TEST(test_decoder_keeps_unterminated_tail_pending);
+    RUN_TEST(test_column_writers);
+    return UNITY_END();
+}
@@ -0,0 +1,115 @@
+#include <unity.h>
+#include <cstring>
+#include "instr/instrument.h"
+#include "log_histogram.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_histogram_buckets_are_half_octaves() {
+    TEST_ASSERT_EQUAL(0, util::LogHistogram::bucket_of(0));
+    TEST_ASSERT_EQUAL(3, util::LogHistogram::bucket_of(3));
+    TEST_ASSERT_EQUAL(4, util::LogHistogram::bucket_of(4));
+    TEST_ASSERT_EQUAL(4, util::LogHistogram::bucket_of(5));
+    TEST_ASSERT_EQUAL(5, util::LogHistogram::bucket_of(6));
+    TEST_ASSERT_EQUAL(63, util::LogHistogram::bucket_of(UINT32_MAX));
+
+    // Every bucket starts where the previous one ends.
+    for (unsigned b = 1; b < util::LogHistogram::BUCKETS; b++) {
+        uint32_t lo = util::LogHistogram::bucket_floor(b);
+        TEST_ASSERT_EQUAL(b, util::LogHistogram::bucket_of(lo));
+        TEST_ASSERT_EQUAL(b - 1, util::LogHistogram::bucket_of(lo - 1));
+    }
+}
+
+void test_histogram_summary_and_percentiles() {
+    util::LogHistogram h;
+    h.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, h.percentile(500));
+
+    for (uint32_t v = 1; v <= 1000; v++)
+        h.record(v);
+    TEST_ASSERT_EQUAL_UINT32(1000, h.count());
+    TEST_ASSERT_EQUAL_UINT32(1, h.min());
+    TEST_ASSERT_EQUAL_UINT32(1000, h.max());
+    TEST_ASSERT_EQUAL_UINT32(500, h.mean());
+
+    // Never below the true value, at most one bucket (50%) above it.
+    uint32_t p50 = h.percentile(500);
+    uint32_t p99 = h.percentile(990);
+    TEST_ASSERT_TRUE(p50 >= 500 && p50 <= 750);
+    TEST_ASSERT_TRUE(p99 >= 990 && p99 <= 1000);
+    TEST_ASSERT_EQUAL_UINT32(1000, h.percentile(1000));
+
+    h.reset();
+    h.record(7);
+    TEST_ASSERT_EQUAL_UINT32(7, h.min());
+    TEST_ASSERT_EQUAL_UINT32(7, h.percentile(990));
+}
+
+void test_stall_excludes_sleep() {
+    instr::instr_t in;
+    instr::instr_reset(&in, 0);
+
+    instr::instr_tick(&in, 1000);
+    instr::instr_slept(&in, 9000);
+    instr::instr_tick(&in, 10500); // 500 us busy
+    instr::instr_tick(&in, 12500); // 2000 us busy, no sleep
+    instr::instr_slept(&in, 5000);
+    instr::instr_tick(&in, 17600); // 100 us busy
+
+    TEST_ASSERT_EQUAL_UINT32(4, in.ticks);
+    TEST_ASSERT_EQUAL_UINT32(2000, in.max_stall_us);
+
+    instr::instr_reset(&in, 20000);
+    TEST_ASSERT_EQUAL_UINT32(0, in.max_stall_us);
+    TEST_ASSERT_EQUAL_UINT64(20000, in.since_us);
+}
+
+void test_telemetry_jitter_follows_period() {
+    instr::instr_t in;
+    instr::instr_reset(&in, 0);
+
+    instr::instr_telemetry(&in, 1000000, 100000);
+    instr::instr_telemetry(&in, 1100300, 100000); // 300 late
+    instr::instr_telemetry(&in, 1199900, 100000); // 400 early
+    TEST_ASSERT_EQUAL_UINT32(2, in.jitter_us.count());
+    TEST_ASSERT_EQUAL_UINT32(400, in.jitter_us.max());
+    TEST_ASSERT_EQUAL_UINT32(300, in.jitter_us.min());
+
+    // A new period restarts the interval instead of reading as jitter.
+    instr::instr_telemetry(&in, 1210000, 10000);
+    instr::instr_telemetry(&in, 1220000, 10000);
+    TEST_ASSERT_EQUAL_UINT32(3, in.jitter_us.count());
+    TEST_ASSERT_EQUAL_UINT32(0, in.jitter_us.min());
+}
+
+void test_timed_path_records_cycles() {
+    instr::instr_t in;
+    instr::instr_reset(&in, 0);
+
+    INSTR_START(t0);
+    volatile uint32_t spin = 0;
+    for (int i = 0; i < 1000; i++)
+        spin = spin + 1;
+    INSTR_STOP(&in, instr::INSTR_TICK, t0);
+
+    TEST_ASSERT_EQUAL_UINT32(1, in.path[instr::INSTR_TICK].count());
+    TEST_ASSERT_EQUAL_UINT32(0, in.path[instr::INSTR_COMMAND].count());
+    TEST_ASSERT_TRUE(in.path[instr::INSTR_TICK].max() > 0);
+    TEST_ASSERT_EQUAL_UINT32(2000, instr::instr_cycles_to_ns(2 * hal::time::cycles_per_us()));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_histogram_buckets_are_half_octaves);
+    RUN_TEST(test_histogram_summary_and_percentiles);
+    RUN_TEST(test_stall_excludes_sleep);
+    RUN_TEST(test_telemetry_jitter_follows_period);
+    RUN_TEST(test_timed_path_records_cycles);
+    return UNITY_END();
+}
@@ -0,0 +1,63 @@
+#include <unity.h>
+#include <cstring>
+#include "line_assembler.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static size_t feed_str(util::LineAssembler<16> &la, const char *s, bool *complete) {
+    return la.feed((const uint8_t *)s, strlen(s), complete);
+}
+
+void test_line_completes_on_newline_and_ignores_cr() {
+    util::LineAssembler<16> la;
+    bool complete = true;
+
+    TEST_ASSERT_EQUAL(4, feed_str(la, "RATE", &complete));
+    TEST_ASSERT_FALSE(complete);
+
+    // Stops right after the first line; the rest is left for the next feed.
+    TEST_ASSERT_EQUAL(5, feed_str(la, " 10\r\nARM\n", &complete));
+    TEST_ASSERT_TRUE(complete);
+    TEST_ASSERT_EQUAL_STRING("RATE 10", la.line());
+
+    la.clear();
+    TEST_ASSERT_EQUAL(4, feed_str(la, "ARM\n", &complete));
+    TEST_ASSERT_TRUE(complete);
+    TEST_ASSERT_EQUAL_STRING("ARM", la.line());
+
+    la.clear();
+    TEST_ASSERT_EQUAL(1, feed_str(la, "\n", &complete));
+    TEST_ASSERT_TRUE(complete);
+    TEST_ASSERT_EQUAL_STRING("", la.line());
+}
+
+void test_over_long_line_is_dropped_whole() {
+    util::LineAssembler<16> la;
+    bool complete = false;
+
+    // 15 characters fit, the 16th starts discarding up to the newline.
+    TEST_ASSERT_EQUAL(23, feed_str(la, "0123456789ABCDEFGHI\nOK\n", &complete));
+    TEST_ASSERT_TRUE(complete);
+    TEST_ASSERT_EQUAL_STRING("OK", la.line());
+    TEST_ASSERT_EQUAL_UINT32(1, la.lines_dropped());
+
+    la.clear();
+    TEST_ASSERT_EQUAL(15, feed_str(la, "0123456789ABCDE", &complete));
+    TEST_ASSERT_FALSE(complete);
+    TEST_ASSERT_EQUAL(1, feed_str(la, "\n", &complete));
+    TEST_ASSERT_TRUE(complete);
+    TEST_ASSERT_EQUAL(15, la.length());
+    TEST_ASSERT_EQUAL_UINT32(1, la.lines_dropped());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_line_completes_on_newline_and_ignores_cr);
+    RUN_TEST(test_over_long_line_is_dropped_whole);
+    return UNITY_END();
+}
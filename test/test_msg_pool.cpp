@@ -0,0 +1,93 @@
+#include <unity.h>
+#include <cstring>
+#include "msg_pool.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+typedef util::MsgPool<32, 4> Pool;
+
+void test_msg_pool_alloc_until_exhausted() {
+    Pool pool;
+    uint8_t *blocks[4];
+
+    for (int i = 0; i < 4; i++) {
+        blocks[i] = pool.alloc();
+        TEST_ASSERT_NOT_NULL(blocks[i]);
+        TEST_ASSERT_TRUE(pool.owns(blocks[i]));
+        memset(blocks[i], 0xA0 + i, Pool::block_size()); // blocks do not overlap
+    }
+    TEST_ASSERT_EQUAL(0, pool.available());
+
+    TEST_ASSERT_NULL(pool.alloc());
+    TEST_ASSERT_NULL(pool.alloc());
+    TEST_ASSERT_EQUAL(2, pool.stats().exhausted);
+    TEST_ASSERT_EQUAL(4, pool.stats().allocs);
+
+    for (int i = 0; i < 4; i++)
+        TEST_ASSERT_EQUAL_HEX8(0xA0 + i, blocks[i][Pool::block_size() - 1]);
+}
+
+void test_msg_pool_free_recycles_blocks() {
+    Pool pool;
+    uint8_t *a = pool.alloc();
+    uint8_t *b = pool.alloc();
+
+    pool.free(a);
+    TEST_ASSERT_EQUAL(1, pool.stats().in_use);
+    TEST_ASSERT_EQUAL_PTR(a, pool.alloc()); // most recently freed block first
+
+    // Alloc/free churn never leaks: the pool can still be emptied and refilled.
+    for (int i = 0; i < 1000; i++)
+        Pool::release(&pool, pool.alloc());
+    pool.free(a);
+    pool.free(b);
+    TEST_ASSERT_EQUAL(0, pool.stats().in_use);
+    TEST_ASSERT_EQUAL(3, pool.stats().high_water); // a, b and one churn block
+    TEST_ASSERT_EQUAL(Pool::capacity(), pool.available());
+}
+
+void test_msg_pool_rejects_bad_frees() {
+    Pool pool;
+    uint8_t outside[32];
+    uint8_t *a = pool.alloc();
+
+    pool.free(outside);   // not from this pool
+    pool.free(a + 1);     // not a block start
+    pool.free(a);
+    pool.free(a);         // double free
+    TEST_ASSERT_EQUAL(3, pool.stats().bad_frees);
+    TEST_ASSERT_EQUAL(1, pool.stats().frees);
+    TEST_ASSERT_FALSE(pool.owns(outside));
+    TEST_ASSERT_FALSE(pool.owns(a + 1));
+
+    // The free list was not corrupted by the double free.
+    uint8_t *x = pool.alloc();
+    uint8_t *y = pool.alloc();
+    TEST_ASSERT_NOT_EQUAL(x, y);
+}
+
+void test_msg_pool_reset_stats_keeps_occupancy() {
+    Pool pool;
+    pool.alloc();
+    pool.alloc();
+    pool.free(pool.alloc());
+
+    pool.reset_stats();
+    TEST_ASSERT_EQUAL(0, pool.stats().allocs);
+    TEST_ASSERT_EQUAL(2, pool.stats().in_use);
+    TEST_ASSERT_EQUAL(2, pool.stats().high_water);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_msg_pool_alloc_until_exhausted);
+    RUN_TEST(test_msg_pool_free_recycles_blocks);
+    RUN_TEST(test_msg_pool_rejects_bad_frees);
+    RUN_TEST(test_msg_pool_reset_stats_keeps_occupancy);
+    return UNITY_END();
+}
@@ -0,0 +1,706 @@
+#include <unity.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "crc16.h"
+#include "packet.h"
+#include "parser.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_crc16_check_value() {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16_ccitt(check, sizeof(check)));
+}
+
+// Deterministic pseudo-random bytes (xorshift32) for cross-checks.
+static void fill_random(uint8_t *buf, size_t len, uint32_t seed) {
+    uint32_t x = seed ? seed : 1;
+    for (size_t i = 0; i < len; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        buf[i] = (uint8_t)x;
+    }
+}
+
+void test_crc16_engines_match_reference() {
+    static uint8_t buf[1031];
+    fill_random(buf, sizeof(buf), 0xC0FFEE);
+
+    for (size_t len = 0; len <= sizeof(buf); len += (len < 40 ? 1 : 97)) {
+        uint16_t ref = crc16_update_bitwise(crc16_init(), buf, len);
+        TEST_ASSERT_EQUAL_HEX16(ref, crc16_update_table(crc16_init(), buf, len));
+        TEST_ASSERT_EQUAL_HEX16(ref, crc16_update_slice4(crc16_init(), buf, len));
+        TEST_ASSERT_EQUAL_HEX16(ref, crc16_update_slice8(crc16_init(), buf, len));
+        TEST_ASSERT_EQUAL_HEX16(ref, crc16_ccitt(buf, len));
+    }
+}
+
+void test_crc16_incremental_update() {
+    static uint8_t buf[300];
+    fill_random(buf, sizeof(buf), 42);
+    uint16_t ref = crc16_ccitt(buf, sizeof(buf));
+
+    // Any split into chunks, including odd and unaligned ones, gives the same CRC.
+    for (size_t split = 1; split < sizeof(buf); split += 7) {
+        uint16_t crc = crc16_init();
+        crc = crc16_update(crc, buf, split);
+        crc = crc16_update(crc, buf + split, sizeof(buf) - split);
+        TEST_ASSERT_EQUAL_HEX16(ref, crc16_final(crc));
+    }
+}
+
+void test_cobs_round_trip() {
+    const uint8_t in[] = {0x11, 0x00, 0x00, 0x22, 0x33, 0x00};
+    uint8_t enc[PKT_COBS_MAX(sizeof(in))];
+    uint8_t dec[sizeof(in)];
+
+    size_t n = cobs_encode(in, sizeof(in), enc, sizeof(enc));
+    TEST_ASSERT_GREATER_THAN(0, n);
+    for (size_t i = 0; i < n; i++) {
+        TEST_ASSERT_NOT_EQUAL(0, enc[i]);
+    }
+
+    TEST_ASSERT_EQUAL(sizeof(in), cobs_decode(enc, n, dec, sizeof(dec)));
+    TEST_ASSERT_EQUAL_MEMORY(in, dec, sizeof(in));
+}
+
+void test_cobs_long_block() {
+    uint8_t in[300];
+    for (size_t i = 0; i < sizeof(in); i++) {
+        in[i] = (uint8_t)(i % 255 + 1); // no zeros: exercises full 254-byte blocks
+    }
+    uint8_t enc[PKT_COBS_MAX(sizeof(in))];
+    uint8_t dec[sizeof(in)];
+
+    size_t n = cobs_encode(in, sizeof(in), enc, sizeof(enc));
+    TEST_ASSERT_GREATER_THAN(0, n);
+    TEST_ASSERT_EQUAL(sizeof(in), cobs_decode(enc, n, dec, sizeof(dec)));
+    TEST_ASSERT_EQUAL_MEMORY(in, dec, sizeof(in));
+}
+
+void test_packet_round_trip() {
+    pkt_telemetry_t rec = {2, 250, 2000, 7};
+    uint8_t payload[PKT_TELEMETRY_PAYLOAD_SIZE];
+    pkt_t pkt = {PKT_TYPE_TELEMETRY, 0x1234, 0x123489ABCDEFull, payload, 0};
+    pkt.payload_len = pkt_telemetry_pack(&rec, payload, sizeof(payload));
+
+    uint8_t frame[PKT_MAX_FRAME];
+    size_t n = pkt_encode(&pkt, frame, sizeof(frame));
+    TEST_ASSERT_GREATER_THAN(0, n);
+    TEST_ASSERT_EQUAL(PKT_FRAME_DELIM, frame[0]);
+    TEST_ASSERT_EQUAL(PKT_FRAME_DELIM, frame[n - 1]);
+
+    uint8_t scratch[PKT_MAX_RAW];
+    pkt_t out;
+    pkt_telemetry_t rec_out;
+    TEST_ASSERT_TRUE(pkt_decode(frame, n, scratch, sizeof(scratch), &out));
+    TEST_ASSERT_EQUAL(PKT_TYPE_TELEMETRY, out.type);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, out.seq);
+    TEST_ASSERT_EQUAL_UINT64(0x123489ABCDEFull, out.timestamp_us);
+    TEST_ASSERT_TRUE(pkt_telemetry_unpack(out.payload, out.payload_len, &rec_out));
+    TEST_ASSERT_EQUAL(2, rec_out.state);
+    TEST_ASSERT_EQUAL(250, rec_out.telemetry_period_ms);
+    TEST_ASSERT_EQUAL(2000, rec_out.heartbeat_period_ms);
+    TEST_ASSERT_EQUAL(7, rec_out.fault_count);
+
+    // Only the low 48 bits of the timestamp go on the wire.
+    pkt.timestamp_us = 0xFFFF000000000042ull;
+    n = pkt_encode(&pkt, frame, sizeof(frame));
+    TEST_ASSERT_TRUE(pkt_decode(frame, n, scratch, sizeof(scratch), &out));
+    TEST_ASSERT_EQUAL_UINT64(0x000000000042ull, out.timestamp_us);
+}
+
+void test_packet_rejects_corruption() {
+    uint8_t payload[4] = {1, 2, 3, 4};
+    pkt_t pkt = {PKT_TYPE_TELEMETRY, 1, 100, payload, sizeof(payload)};
+    uint8_t frame[PKT_MAX_FRAME];
+    size_t n = pkt_encode(&pkt, frame, sizeof(frame));
+
+    frame[n / 2] ^= 0x40; // flip a bit mid-frame
+
+    uint8_t scratch[PKT_MAX_RAW];
+    pkt_t out;
+    TEST_ASSERT_FALSE(pkt_decode(frame, n, scratch, sizeof(scratch), &out));
+}
+
+void test_packet_rejects_oversize_payload() {
+    static uint8_t payload[PKT_MAX_PAYLOAD + 1];
+    pkt_t pkt = {PKT_TYPE_TELEMETRY, 0, 0, payload, sizeof(payload)};
+    uint8_t frame[PKT_MAX_FRAME + 8];
+    TEST_ASSERT_EQUAL(0, pkt_encode(&pkt, frame, sizeof(frame)));
+}
+
+// ---------------------------------------------------------------------------
+// Varints and delta records
+// ---------------------------------------------------------------------------
+
+void test_varint_round_trip_and_bounds() {
+    const uint32_t values[] = {0, 1, 127, 128, 300, 16383, 16384, 0x0FFFFFFFu, 0x10000000u, 0xFFFFFFFFu};
+    const size_t sizes[] = {1, 1, 1, 2, 2, 2, 3, 4, 5, 5};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        uint8_t buf[PKT_VARINT_MAX];
+        uint32_t v = 0;
+        TEST_ASSERT_EQUAL(sizes[i], pkt_varint_encode(values[i], buf, sizeof(buf)));
+        TEST_ASSERT_EQUAL(sizes[i], pkt_varint_decode(buf, sizes[i], &v));
+        TEST_ASSERT_EQUAL_UINT32(values[i], v);
+        TEST_ASSERT_EQUAL(0, pkt_varint_decode(buf, sizes[i] - 1, &v)); // truncated
+        TEST_ASSERT_EQUAL(0, pkt_varint_encode(values[i], buf, sizes[i] - 1));
+    }
+
+    const uint8_t overlong[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x1F}; // > 32 bits
+    uint32_t v;
+    TEST_ASSERT_EQUAL(0, pkt_varint_decode(overlong, sizeof(overlong), &v));
+
+    const int32_t signed_values[] = {0, -1, 1, -2, 2147483647, (-2147483647 - 1)};
+    const uint32_t zigzag[] = {0, 1, 2, 3, 0xFFFFFFFEu, 0xFFFFFFFFu};
+    for (size_t i = 0; i < 6; i++) {
+        TEST_ASSERT_EQUAL_UINT32(zigzag[i], pkt_zigzag_encode(signed_values[i]));
+        TEST_ASSERT_EQUAL_INT32(signed_values[i], pkt_zigzag_decode(zigzag[i]));
+    }
+}
+
+void test_delta_keyframes_and_deltas() {
+    pkt_delta_t tx, rx;
+    pkt_delta_init(&tx, 4);
+    pkt_delta_init(&rx, 1);
+
+    uint32_t fields[3] = {1000, 0, 7};
+    for (uint16_t seq = 0; seq < 12; seq++) {
+        fields[0] += (seq & 1) ? 3 : (uint32_t)-5; // small moves both ways
+        if (seq == 6)
+            fields[2] = 0xFFFFFFF0u; // wraps through the uint32 range
+
+        uint8_t payload[PKT_DELTA_MAX_PAYLOAD];
+        bool key = false;
+        size_t n = pkt_delta_encode(&tx, fields, 3, payload, sizeof(payload), &key);
+        TEST_ASSERT_TRUE(n > 0);
+        TEST_ASSERT_EQUAL(seq % 4 == 0, key);
+        if (key)
+            TEST_ASSERT_EQUAL(0x5, payload[0]); // field 1 is zero and left out
+        else if (seq != 6)
+            TEST_ASSERT_EQUAL(2, n);             // mask + one 1-byte delta
+
+        uint32_t out[3] = {0, 0, 0};
+        TEST_ASSERT_TRUE(pkt_delta_decode(&rx, key, seq, payload, n, out, 3));
+        TEST_ASSERT_EQUAL_UINT32_ARRAY(fields, out, 3);
+    }
+}
+
+void test_delta_waits_for_keyframe_after_loss() {
+    pkt_delta_t tx, rx;
+    pkt_delta_init(&tx, 8);
+    pkt_delta_init(&rx, 1);
+
+    uint32_t f = 100;
+    uint8_t payload[PKT_DELTA_MAX_PAYLOAD];
+    bool key;
+    uint32_t out;
+    size_t n;
+
+    // A receiver joining mid-stream ignores deltas until the next keyframe.
+    n = pkt_delta_encode(&tx, &f, 1, payload, sizeof(payload), &key);
+    TEST_ASSERT_TRUE(key);
+    for (uint16_t seq = 1; seq < 8; seq++) {
+        f++;
+        n = pkt_delta_encode(&tx, &f, 1, payload, sizeof(payload), &key);
+        TEST_ASSERT_FALSE(key);
+        TEST_ASSERT_FALSE(pkt_delta_decode(&rx, key, seq, payload, n, &out, 1));
+    }
+    f++;
+    n = pkt_delta_encode(&tx, &f, 1, payload, sizeof(payload), &key);
+    TEST_ASSERT_TRUE(key);
+    TEST_ASSERT_TRUE(pkt_delta_decode(&rx, key, 8, payload, n, &out, 1));
+    TEST_ASSERT_EQUAL_UINT32(f, out);
+
+    // A gap in seq invalidates the reference; a forced keyframe resyncs.
+    f++;
+    n = pkt_delta_encode(&tx, &f, 1, payload, sizeof(payload), &key);
+    TEST_ASSERT_FALSE(pkt_delta_decode(&rx, key, 10, payload, n, &out, 1));
+    TEST_ASSERT_FALSE(pkt_delta_decode(&rx, key, 9, payload, n, &out, 1));
+    pkt_delta_request_key(&tx);
+    n = pkt_delta_encode(&tx, &f, 1, payload, sizeof(payload), &key);
+    TEST_ASSERT_TRUE(key);
+    TEST_ASSERT_TRUE(pkt_delta_decode(&rx, key, 11, payload, n, &out, 1));
+    TEST_ASSERT_EQUAL_UINT32(f, out);
+
+    // Malformed payloads: unknown mask bits, trailing bytes, truncated varint.
+    const uint8_t bad_mask[] = {0x02, 0x01};
+    const uint8_t trailing[] = {0x01, 0x01, 0x00};
+    const uint8_t truncated[] = {0x01, 0x80};
+    TEST_ASSERT_FALSE(pkt_delta_decode(&rx, true, 12, bad_mask, sizeof(bad_mask), &out, 1));
+    TEST_ASSERT_FALSE(pkt_delta_decode(&rx, true, 12, trailing, sizeof(trailing), &out, 1));
+    TEST_ASSERT_FALSE(pkt_delta_decode(&rx, true, 12, truncated, sizeof(truncated), &out, 1));
+}
+
+void test_telemetry_delta_round_trip() {
+    pkt_delta_t tx, rx;
+    pkt_delta_init(&tx, 16);
+    pkt_delta_init(&rx, 1);
+
+    pkt_telemetry_t rec = {1, 100, 2000, 0};
+    for (uint16_t seq = 0; seq < 40; seq++) {
+        if (seq % 10 == 9)
+            rec.fault_count++;
+        if (seq == 20)
+            rec.state = 3;
+
+        uint8_t payload[PKT_DELTA_MAX_PAYLOAD];
+        pkt_t pkt = {0, seq, 0, payload, 0};
+        pkt.payload_len = pkt_telemetry_pack_delta(&tx, &rec, payload, sizeof(payload), &pkt.type);
+        TEST_ASSERT_TRUE(pkt.payload_len > 0);
+        TEST_ASSERT_TRUE(pkt.payload_len < PKT_TELEMETRY_PAYLOAD_SIZE);
+
+        pkt_telemetry_t out;
+        TEST_ASSERT_TRUE(pkt_telemetry_unpack_delta(&rx, &pkt, &out));
+        TEST_ASSERT_EQUAL(rec.state, out.state);
+        TEST_ASSERT_EQUAL_UINT32(rec.telemetry_period_ms, out.telemetry_period_ms);
+        TEST_ASSERT_EQUAL_UINT32(rec.heartbeat_period_ms, out.heartbeat_period_ms);
+        TEST_ASSERT_EQUAL_UINT32(rec.fault_count, out.fault_count);
+    }
+
+    // Full records are accepted too and act as a keyframe.
+    uint8_t full[PKT_TELEMETRY_PAYLOAD_SIZE];
+    pkt_t pkt = {PKT_TYPE_TELEMETRY, 500, 0, full, pkt_telemetry_pack(&rec, full, sizeof(full))};
+    pkt_telemetry_t out;
+    pkt_delta_init(&rx, 1);
+    TEST_ASSERT_TRUE(pkt_telemetry_unpack_delta(&rx, &pkt, &out));
+    TEST_ASSERT_EQUAL(501, rx.next_seq);
+}
+
+void test_changes_round_trip() {
+    pkt_delta_t tx, rx;
+    pkt_delta_init(&tx, 100);
+    pkt_delta_init(&rx, 1);
+
+    pkt_changes_t c = {{2, 1000, 2000, 0}, 3, {2048, -5, 0, 0}};
+    uint8_t payload[PKT_CHANGES_MAX_PAYLOAD];
+    pkt_t pkt = {0, 7, 0, payload, 0};
+    pkt.payload_len = pkt_changes_pack(&tx, &c, payload, sizeof(payload), &pkt.type);
+    TEST_ASSERT_EQUAL(PKT_TYPE_CHANGES_KEY, pkt.type);
+    TEST_ASSERT_EQUAL(3, payload[0]);
+
+    pkt_changes_t out;
+    TEST_ASSERT_TRUE(pkt_changes_unpack(&rx, &pkt, &out));
+    TEST_ASSERT_EQUAL(3, out.channels);
+    TEST_ASSERT_EQUAL_INT32(2048, out.value[0]);
+    TEST_ASSERT_EQUAL_INT32(-5, out.value[1]);
+    TEST_ASSERT_EQUAL_UINT32(1000, out.rec.telemetry_period_ms);
+
+    // One changed channel: channel count, mask and a single varint.
+    c.value[1] = -6;
+    pkt.seq = 8;
+    pkt.payload_len = pkt_changes_pack(&tx, &c, payload, sizeof(payload), &pkt.type);
+    TEST_ASSERT_EQUAL(PKT_TYPE_CHANGES_DELTA, pkt.type);
+    TEST_ASSERT_EQUAL(3, pkt.payload_len);
+    TEST_ASSERT_EQUAL_HEX8(1u << (PKT_TELEMETRY_FIELDS + 1), payload[1]);
+    TEST_ASSERT_TRUE(pkt_changes_unpack(&rx, &pkt, &out));
+    TEST_ASSERT_EQUAL_INT32(-6, out.value[1]);
+    TEST_ASSERT_EQUAL_INT32(2048, out.value[0]);
+
+    // Plain telemetry types and too many channels are rejected.
+    pkt.type = PKT_TYPE_TELEMETRY_DELTA;
+    TEST_ASSERT_FALSE(pkt_changes_unpack(&rx, &pkt, &out));
+    c.channels = PKT_CHANGES_MAX_CHANNELS + 1;
+    TEST_ASSERT_EQUAL(0, pkt_changes_pack(&tx, &c, payload, sizeof(payload), &pkt.type));
+    payload[0] = PKT_CHANGES_MAX_CHANNELS + 1;
+    pkt.type = PKT_TYPE_CHANGES_KEY;
+    TEST_ASSERT_FALSE(pkt_changes_unpack(&rx, &pkt, &out));
+}
+
+void test_channels_round_trip() {
+    const pkt_channel_value_t in[] = {{0, 2048}, {5, -1}, {200, 1 << 20}};
+    uint8_t payload[PKT_MAX_PAYLOAD];
+    size_t n = pkt_channels_pack(in, 3, payload, sizeof(payload));
+    TEST_ASSERT_EQUAL(1 + (1 + 2) + (1 + 1) + (1 + 4), n); // count, then channel + varint each
+
+    pkt_channel_value_t out[4];
+    size_t count = 0;
+    TEST_ASSERT_TRUE(pkt_channels_unpack(payload, n, out, 4, &count));
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_EQUAL(5, out[1].channel);
+    TEST_ASSERT_EQUAL_INT32(-1, out[1].value);
+    TEST_ASSERT_EQUAL(200, out[2].channel);
+    TEST_ASSERT_EQUAL_INT32(1 << 20, out[2].value);
+
+    // Too many for the caller, truncated or trailing bytes: rejected.
+    TEST_ASSERT_FALSE(pkt_channels_unpack(payload, n, out, 2, &count));
+    TEST_ASSERT_FALSE(pkt_channels_unpack(payload, n - 1, out, 4, &count));
+    TEST_ASSERT_FALSE(pkt_channels_unpack(payload, n + 1, out, 4, &count));
+    TEST_ASSERT_EQUAL(0, pkt_channels_pack(in, 3, payload, 8));
+
+    // The worst case always fits one payload.
+    pkt_channel_value_t worst[PKT_CHANNELS_MAX_VALUES];
+    for (size_t i = 0; i < PKT_CHANNELS_MAX_VALUES; i++)
+        worst[i] = {(uint8_t)i, INT32_MIN};
+    TEST_ASSERT_TRUE(pkt_channels_pack(worst, PKT_CHANNELS_MAX_VALUES, payload, sizeof(payload)) > 0);
+}
+
+void test_dgram_header_round_trip() {
+    pkt_dgram_t in = {0x1234, 0xCAFEF00Du};
+    uint8_t buf[PKT_DGRAM_HEADER_SIZE];
+    TEST_ASSERT_EQUAL(PKT_DGRAM_HEADER_SIZE, pkt_dgram_header_pack(&in, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_HEX8('T', buf[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x34, buf[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x0D, buf[4]);
+
+    pkt_dgram_t out = {0, 0};
+    TEST_ASSERT_TRUE(pkt_dgram_header_unpack(buf, sizeof(buf), &out));
+    TEST_ASSERT_EQUAL_UINT16(0x1234, out.node);
+    TEST_ASSERT_EQUAL_UINT32(0xCAFEF00Du, out.seq);
+
+    // Short, foreign or newer datagrams are not ours.
+    TEST_ASSERT_FALSE(pkt_dgram_header_unpack(buf, sizeof(buf) - 1, &out));
+    buf[1] = PKT_DGRAM_VERSION + 1;
+    TEST_ASSERT_FALSE(pkt_dgram_header_unpack(buf, sizeof(buf), &out));
+    buf[1] = PKT_DGRAM_VERSION;
+    buf[0] = PKT_FRAME_DELIM;
+    TEST_ASSERT_FALSE(pkt_dgram_header_unpack(buf, sizeof(buf), &out));
+    TEST_ASSERT_EQUAL(0, pkt_dgram_header_pack(&in, buf, sizeof(buf) - 1));
+}
+
+// ---------------------------------------------------------------------------
+// Streaming parser
+// ---------------------------------------------------------------------------
+
+// Payload content is derived from seq so a delivered packet can be validated
+// without remembering what was sent.
+static size_t make_frame(uint16_t seq, uint8_t *frame, size_t cap) {
+    uint8_t payload[PKT_MAX_PAYLOAD];
+    size_t len = seq % (PKT_MAX_PAYLOAD + 1);
+    for (size_t i = 0; i < len; i++) {
+        payload[i] = (uint8_t)(seq * 31 + i); // includes zeros to exercise COBS
+    }
+    pkt_t pkt = {PKT_TYPE_TELEMETRY, seq, (uint64_t)seq * 1000000u, payload, len};
+    return pkt_encode(&pkt, frame, cap);
+}
+
+struct Collector {
+    std::vector<uint16_t> seqs;
+    uint32_t bad_content = 0;
+};
+
+static void collect(void *ctx, const pkt_t *pkt) {
+    Collector *c = static_cast<Collector *>(ctx);
+    bool ok = pkt->type == PKT_TYPE_TELEMETRY &&
+              pkt->timestamp_us == (uint64_t)pkt->seq * 1000000u &&
+              pkt->payload_len == pkt->seq % (PKT_MAX_PAYLOAD + 1);
+    for (size_t i = 0; ok && i < pkt->payload_len; i++) {
+        ok = pkt->payload[i] == (uint8_t)(pkt->seq * 31 + i);
+    }
+    if (!ok) {
+        c->bad_content++;
+    }
+    c->seqs.push_back(pkt->seq);
+}
+
+void test_parser_byte_at_a_time() {
+    parser_t parser;
+    Collector c;
+    parser_init(&parser, collect, &c);
+
+    uint8_t frame[PKT_MAX_FRAME];
+    for (uint16_t seq = 0; seq < 300; seq++) {
+        size_t n = make_frame(seq, frame, sizeof(frame));
+        for (size_t i = 0; i < n; i++) {
+            parser_feed(&parser, &frame[i], 1);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(300, c.seqs.size());
+    TEST_ASSERT_EQUAL(0, c.bad_content);
+    TEST_ASSERT_EQUAL(300, parser.stats.frames_ok);
+    TEST_ASSERT_EQUAL(0, parser.stats.crc_errors + parser.stats.framing_errors + parser.stats.overruns);
+}
+
+void test_parser_resyncs_after_text_and_corruption() {
+    parser_t parser;
+    Collector c;
+    parser_init(&parser, collect, &c);
+
+    uint8_t frame[PKT_MAX_FRAME];
+    size_t n;
+
+    // Text reply interleaved before a frame (binary mode still sends "OK ..." replies).
+    const char *text = "OK TELEMETRY BINARY";
+    parser_feed(&parser, (const uint8_t *)text, strlen(text));
+    n = make_frame(1, frame, sizeof(frame));
+    parser_feed(&parser, frame, n);
+
+    // Corrupted frame followed by a good one.
+    n = make_frame(2, frame, sizeof(frame));
+    frame[n / 2] ^= 0x80;
+    parser_feed(&parser, frame, n);
+    n = make_frame(3, frame, sizeof(frame));
+    parser_feed(&parser, frame, n);
+
+    TEST_ASSERT_EQUAL(2, c.seqs.size());
+    TEST_ASSERT_EQUAL(1, c.seqs[0]);
+    TEST_ASSERT_EQUAL(3, c.seqs[1]);
+    TEST_ASSERT_EQUAL(2, parser.stats.crc_errors + parser.stats.framing_errors);
+}
+
+void test_parser_overrun() {
+    parser_t parser;
+    Collector c;
+    parser_init(&parser, collect, &c);
+
+    // A delimited run of non-zero bytes longer than any legal frame.
+    std::vector<uint8_t> junk(PKT_MAX_RAW * 3, 0xFF);
+    junk.front() = PKT_FRAME_DELIM;
+    junk.back() = PKT_FRAME_DELIM;
+    parser_feed(&parser, junk.data(), junk.size());
+
+    uint8_t frame[PKT_MAX_FRAME];
+    size_t n = make_frame(PKT_MAX_PAYLOAD, frame, sizeof(frame)); // largest legal frame
+    parser_feed(&parser, frame, n);
+
+    TEST_ASSERT_EQUAL(1, parser.stats.overruns);
+    TEST_ASSERT_EQUAL(1, parser.stats.resyncs);
+    TEST_ASSERT_EQUAL(1, c.seqs.size());
+    TEST_ASSERT_EQUAL(PKT_MAX_PAYLOAD, c.seqs[0]);
+}
+
+// Edge-case inputs; none may produce a packet or disturb the frame after it.
+static const uint8_t k_corpus_empty[] = {0x00, 0x00, 0x00};
+static const uint8_t k_corpus_lone_code[] = {0x00, 0x01, 0x00};
+static const uint8_t k_corpus_short_block[] = {0x00, 0x05, 0x11, 0x00};
+static const uint8_t k_corpus_header_only[] = {0x00, 0x08, 1, 2, 3, 4, 5, 6, 7, 0x00};
+static const uint8_t k_corpus_no_leading_delim[] = {0xAA, 0xBB, 0xCC};
+static const uint8_t k_corpus_full_block_end[] = {0x00, 0xFF, 0x00};
+
+struct CorpusEntry {
+    const uint8_t *data;
+    size_t len;
+};
+
+static const CorpusEntry k_corpus[] = {
+    {k_corpus_empty, sizeof(k_corpus_empty)},
+    {k_corpus_lone_code, sizeof(k_corpus_lone_code)},
+    {k_corpus_short_block, sizeof(k_corpus_short_block)},
+    {k_corpus_header_only, sizeof(k_corpus_header_only)},
+    {k_corpus_no_leading_delim, sizeof(k_corpus_no_leading_delim)},
+    {k_corpus_full_block_end, sizeof(k_corpus_full_block_end)},
+};
+
+void test_parser_fuzz_corpus() {
+    uint8_t frame[PKT_MAX_FRAME];
+
+    for (const CorpusEntry &e : k_corpus) {
+        parser_t parser;
+        Collector c;
+        parser_init(&parser, collect, &c);
+
+        parser_feed(&parser, e.data, e.len);
+        TEST_ASSERT_EQUAL(0, c.seqs.size());
+
+        size_t n = make_frame(7, frame, sizeof(frame));
+        parser_feed(&parser, frame, n);
+        TEST_ASSERT_EQUAL(1, c.seqs.size());
+        TEST_ASSERT_EQUAL(7, c.seqs[0]);
+    }
+}
+
+// xorshift32 used to build a reproducible mutated stream.
+static uint32_t fuzz_next(uint32_t *x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+void test_parser_fuzz_random_stream() {
+    std::vector<uint8_t> stream;
+    std::vector<uint16_t> intact;
+    uint32_t rng = 0xDEADBEEF;
+    uint8_t frame[PKT_MAX_FRAME];
+
+    for (uint16_t seq = 0; seq < 5000; seq++) {
+        size_t n = make_frame(seq, frame, sizeof(frame));
+
+        switch (fuzz_next(&rng) % 8) {
+        case 0: // bit flip
+            frame[1 + fuzz_next(&rng) % (n - 2)] ^= (uint8_t)(1u << (fuzz_next(&rng) % 8));
+            break;
+        case 1: // truncated
+            n = 1 + fuzz_next(&rng) % (n - 2); // always loses at least one encoded byte
+            break;
+        case 2: // garbage between frames (may contain delimiters)
+            for (uint32_t k = fuzz_next(&rng) % 64; k > 0; k--) {
+                stream.push_back((uint8_t)fuzz_next(&rng));
+            }
+            intact.push_back(seq);
+            break;
+        default:
+            intact.push_back(seq);
+            break;
+        }
+        stream.insert(stream.end(), frame, frame + n);
+    }
+
+    parser_t parser;
+    Collector c;
+    parser_init(&parser, collect, &c);
+
+    // Deliver in random chunk sizes.
+    size_t off = 0;
+    while (off < stream.size()) {
+        size_t chunk = 1 + fuzz_next(&rng) % 97;
+        if (chunk > stream.size() - off) {
+            chunk = stream.size() - off;
+        }
+        parser_feed(&parser, &stream[off], chunk);
+        off += chunk;
+    }
+
+    TEST_ASSERT_EQUAL(0, c.bad_content);
+    TEST_ASSERT_EQUAL(intact.size(), c.seqs.size());
+    TEST_ASSERT_TRUE(intact == c.seqs);
+    TEST_ASSERT_EQUAL(stream.size(), parser.stats.bytes_in);
+}
+
+static void count_only(void *ctx, const pkt_t *pkt) {
+    *static_cast<uint32_t *>(ctx) += (uint32_t)pkt->payload_len;
+}
+
+// Throughput report; asserts only that every frame made it through.
+void test_parser_throughput() {
+    std::vector<uint8_t> stream;
+    uint8_t frame[PKT_MAX_FRAME];
+    const uint32_t frames = 20000;
+    for (uint32_t i = 0; i < frames; i++) {
+        size_t n = make_frame((uint16_t)(i % 64), frame, sizeof(frame)); // telemetry-sized packets
+        stream.insert(stream.end(), frame, frame + n);
+    }
+
+    parser_t parser;
+    uint32_t sink = 0;
+    parser_init(&parser, count_only, &sink);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t off = 0; off < stream.size(); off += 64) {
+        size_t chunk = stream.size() - off < 64 ? stream.size() - off : 64;
+        parser_feed(&parser, &stream[off], chunk);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    TEST_ASSERT_EQUAL(frames, parser.stats.frames_ok);
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "%.0f frames/sec, %.1f MB/sec",
+             frames / secs, stream.size() / secs / (1024.0 * 1024.0));
+    TEST_MESSAGE(msg);
+}
+
+void test_replay_payload_round_trip() {
+    pkt_telemetry_t rec = {2, 250, 2000, 7};
+    uint8_t payload[PKT_REPLAY_PAYLOAD_SIZE];
+    TEST_ASSERT_EQUAL(0, pkt_replay_pack(1, &rec, payload, sizeof(payload) - 1));
+    TEST_ASSERT_EQUAL(PKT_REPLAY_PAYLOAD_SIZE, pkt_replay_pack(0x12345678u, &rec, payload, sizeof(payload)));
+
+    uint32_t spool_seq = 0;
+    pkt_telemetry_t out;
+    TEST_ASSERT_TRUE(pkt_replay_unpack(payload, sizeof(payload), &spool_seq, &out));
+    TEST_ASSERT_EQUAL_HEX32(0x12345678u, spool_seq);
+    TEST_ASSERT_EQUAL_UINT32(7, out.fault_count);
+
+    // Replayed records decode through the delta path without disturbing it.
+    pkt_delta_t rx;
+    pkt_delta_init(&rx, 1);
+    rx.next_seq = 42;
+    pkt_t pkt = {PKT_TYPE_TELEMETRY_REPLAY, 0x5678, 0, payload, sizeof(payload)};
+    TEST_ASSERT_TRUE(pkt_telemetry_unpack_delta(&rx, &pkt, &out));
+    TEST_ASSERT_EQUAL(2, out.state);
+    TEST_ASSERT_EQUAL(42, rx.next_seq);
+    TEST_ASSERT_FALSE(rx.have_ref);
+}
+
+void test_summary_payload_round_trip() {
+    pkt_summary_t sum = {3, 1000, 100, 2, -40, 4095, -256 * 7, 256 * 12 + 128, 1999, 3900, 4090};
+    uint8_t payload[PKT_SUMMARY_PAYLOAD_SIZE];
+    TEST_ASSERT_EQUAL(0, pkt_summary_pack(&sum, payload, sizeof(payload) - 1));
+    TEST_ASSERT_EQUAL(PKT_SUMMARY_PAYLOAD_SIZE, pkt_summary_pack(&sum, payload, sizeof(payload)));
+
+    pkt_summary_t out;
+    TEST_ASSERT_FALSE(pkt_summary_unpack(payload, sizeof(payload) - 1, &out));
+    TEST_ASSERT_TRUE(pkt_summary_unpack(payload, sizeof(payload), &out));
+    TEST_ASSERT_EQUAL(3, out.channel);
+    TEST_ASSERT_EQUAL_UINT32(100, out.count);
+    TEST_ASSERT_EQUAL_INT32(-40, out.min);
+    TEST_ASSERT_EQUAL_INT32(-256 * 7, out.mean_q8);
+    TEST_ASSERT_EQUAL_UINT32(256 * 12 + 128, out.stddev_q8);
+    TEST_ASSERT_EQUAL_INT32(4090, out.p99);
+
+    // Not a telemetry record.
+    pkt_delta_t rx;
+    pkt_delta_init(&rx, 1);
+    pkt_telemetry_t rec;
+    pkt_t pkt = {PKT_TYPE_SUMMARY, 0, 0, payload, sizeof(payload)};
+    TEST_ASSERT_FALSE(pkt_telemetry_unpack_delta(&rx, &pkt, &rec));
+}
+
+void test_stream_block_round_trip() {
+    int16_t samples[PKT_STREAM_MAX_SAMPLES];
+    for (size_t i = 0; i < PKT_STREAM_MAX_SAMPLES; i++)
+        samples[i] = (int16_t)(i * 1000 - 29000);
+
+    pkt_stream_t blk = {2, (uint8_t)PKT_STREAM_MAX_SAMPLES, 5000, 123456, 48, samples};
+    uint8_t payload[PKT_MAX_PAYLOAD];
+    size_t len = pkt_stream_pack(&blk, payload, sizeof(payload));
+    TEST_ASSERT_EQUAL(PKT_STREAM_HEADER_SIZE + 2 * PKT_STREAM_MAX_SAMPLES, len);
+    TEST_ASSERT_TRUE(len <= PKT_MAX_PAYLOAD);
+    TEST_ASSERT_EQUAL(0, pkt_stream_pack(&blk, payload, len - 1));
+
+    int16_t got[PKT_STREAM_MAX_SAMPLES];
+    pkt_stream_t out;
+    TEST_ASSERT_FALSE(pkt_stream_unpack(payload, len - 2, &out, got, PKT_STREAM_MAX_SAMPLES));
+    TEST_ASSERT_FALSE(pkt_stream_unpack(payload, len, &out, got, 4));
+    TEST_ASSERT_TRUE(pkt_stream_unpack(payload, len, &out, got, PKT_STREAM_MAX_SAMPLES));
+    TEST_ASSERT_EQUAL(2, out.channel);
+    TEST_ASSERT_EQUAL(PKT_STREAM_MAX_SAMPLES, out.count);
+    TEST_ASSERT_EQUAL_UINT16(5000, out.rate_hz);
+    TEST_ASSERT_EQUAL_UINT32(123456, out.first_index);
+    TEST_ASSERT_EQUAL_UINT32(48, out.lost);
+    TEST_ASSERT_EQUAL_INT16(-29000, out.samples[0]);
+    TEST_ASSERT_EQUAL_INT16(28000, out.samples[PKT_STREAM_MAX_SAMPLES - 1]);
+
+    // Oversized blocks are refused.
+    blk.count = PKT_STREAM_MAX_SAMPLES + 1;
+    TEST_ASSERT_EQUAL(0, pkt_stream_pack(&blk, payload, sizeof(payload)));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_crc16_engines_match_reference);
+    RUN_TEST(test_crc16_incremental_update);
+    RUN_TEST(test_cobs_round_trip);
+    RUN_TEST(test_cobs_long_block);
+    RUN_TEST(test_packet_round_trip);
+    RUN_TEST(test_packet_rejects_corruption);
+    RUN_TEST(test_packet_rejects_oversize_payload);
+    RUN_TEST(test_varint_round_trip_and_bounds);
+    RUN_TEST(test_delta_keyframes_and_deltas);
+    RUN_TEST(test_delta_waits_for_keyframe_after_loss);
+    RUN_TEST(test_telemetry_delta_round_trip);
+    RUN_TEST(test_changes_round_trip);
+    RUN_TEST(test_channels_round_trip);
+    RUN_TEST(test_dgram_header_round_trip);
+    RUN_TEST(test_replay_payload_round_trip);
+    RUN_TEST(test_summary_payload_round_trip);
+    RUN_TEST(test_stream_block_round_trip);
+    RUN_TEST(test_parser_byte_at_a_time);
+    RUN_TEST(test_parser_resyncs_after_text_and_corruption);
+    RUN_TEST(test_parser_overrun);
+    RUN_TEST(test_parser_fuzz_corpus);
+    RUN_TEST(test_parser_fuzz_random_stream);
+    RUN_TEST(test_parser_throughput);
+    return UNITY_END();
+}
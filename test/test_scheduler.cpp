@@ -0,0 +1,225 @@
+#include <unity.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "sched/scheduler.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static sched::scheduler_t g_sched;
+
+struct Counter {
+    uint32_t calls = 0;
+    uint64_t last_now = 0;
+};
+
+static void count_job(void *ctx, uint64_t now_us) {
+    Counter *c = static_cast<Counter *>(ctx);
+    c->calls++;
+    c->last_now = now_us;
+}
+
+void test_sched_runs_in_deadline_order() {
+    sched::sched_init(&g_sched);
+    Counter a, b;
+    int ia = sched::sched_add(&g_sched, 300, 300, count_job, &a);
+    int ib = sched::sched_add(&g_sched, 100, 100, count_job, &b);
+    TEST_ASSERT_NOT_EQUAL(-1, ia);
+    TEST_ASSERT_NOT_EQUAL(-1, ib);
+
+    uint64_t next = 0;
+    TEST_ASSERT_TRUE(sched::sched_next_deadline(&g_sched, &next));
+    TEST_ASSERT_EQUAL(100, next);
+
+    TEST_ASSERT_EQUAL(0, sched::sched_run(&g_sched, 99));
+    TEST_ASSERT_EQUAL(1, sched::sched_run(&g_sched, 100));
+    TEST_ASSERT_EQUAL(2, sched::sched_run(&g_sched, 300)); // both due
+    TEST_ASSERT_EQUAL(1, a.calls);
+    TEST_ASSERT_EQUAL(2, b.calls);
+
+    TEST_ASSERT_TRUE(sched::sched_next_deadline(&g_sched, &next));
+    TEST_ASSERT_EQUAL(400, next);
+}
+
+void test_sched_is_drift_free_and_skips_missed() {
+    sched::sched_init(&g_sched);
+    Counter c;
+    int id = sched::sched_add(&g_sched, 1000, 1000, count_job, &c);
+
+    sched::sched_run(&g_sched, 1070); // 70 us late
+    TEST_ASSERT_EQUAL(2000, g_sched.tasks[id].deadline_us); // not 2070
+
+    sched::sched_run(&g_sched, 5500); // 2000..5000 overdue: one run, three skipped
+    TEST_ASSERT_EQUAL(2, c.calls);
+    TEST_ASSERT_EQUAL(3, g_sched.tasks[id].skipped);
+    TEST_ASSERT_EQUAL(6000, g_sched.tasks[id].deadline_us);
+}
+
+void test_sched_crosses_32bit_boundary() {
+    sched::sched_init(&g_sched);
+    Counter c;
+    uint64_t start = 0xFFFFFF00ull; // ~71.6 minutes of uptime in us
+    sched::sched_add(&g_sched, start + 100, 100, count_job, &c);
+
+    for (uint64_t t = start; t != start + 1000; t += 10) {
+        sched::sched_run(&g_sched, t);
+    }
+    TEST_ASSERT_EQUAL(9, c.calls); // start+100 .. start+900
+    TEST_ASSERT_EQUAL_UINT64(start + 900, c.last_now);
+    TEST_ASSERT_EQUAL_UINT64(start + 1000, g_sched.tasks[0].deadline_us);
+}
+
+void test_sched_cancel_and_set_period() {
+    sched::sched_init(&g_sched);
+    Counter a, b;
+    int ia = sched::sched_add(&g_sched, 10, 10, count_job, &a);
+    int ib = sched::sched_add(&g_sched, 20, 0, count_job, &b); // one-shot
+
+    TEST_ASSERT_TRUE(sched::sched_cancel(&g_sched, ia));
+    TEST_ASSERT_FALSE(sched::sched_cancel(&g_sched, ia));
+
+    sched::sched_run(&g_sched, 100);
+    TEST_ASSERT_EQUAL(0, a.calls);
+    TEST_ASSERT_EQUAL(1, b.calls);
+    TEST_ASSERT_FALSE(sched::sched_next_deadline(&g_sched, NULL)); // one-shot retired
+
+    ia = sched::sched_add(&g_sched, 110, 10, count_job, &a);
+    TEST_ASSERT_TRUE(sched::sched_set_period(&g_sched, ia, 50, 100));
+    TEST_ASSERT_EQUAL(150, g_sched.tasks[ia].deadline_us);
+    (void)ib;
+}
+
+void test_sched_capacity() {
+    sched::sched_init(&g_sched);
+    Counter c;
+    for (int i = 0; i < SCHED_MAX_TASKS; i++) {
+        TEST_ASSERT_EQUAL(i, sched::sched_add(&g_sched, (uint64_t)i, 10, count_job, &c));
+    }
+    TEST_ASSERT_EQUAL(-1, sched::sched_add(&g_sched, 0, 10, count_job, &c));
+}
+
+// ---------------------------------------------------------------------------
+// Long-horizon simulation: hundreds of tasks over simulated days. The loop
+// jumps straight to the next deadline and then adds a random loop latency,
+// so the scheduler sees realistic lateness without wall-clock cost.
+// ---------------------------------------------------------------------------
+
+struct SimTask {
+    uint64_t first_deadline;
+    uint32_t period;
+    uint32_t runs;
+    uint64_t jitter_sum;
+    uint64_t jitter_max;
+    uint32_t phase_errors; // runs whose deadline was off the original phase grid
+    int id;
+};
+
+static uint32_t g_rng = 0x2545F491;
+static uint32_t rnd() {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static void sim_job(void *ctx, uint64_t now_us) {
+    SimTask *t = static_cast<SimTask *>(ctx);
+    // The deadline this run served: the scheduler advanced past it already.
+    uint64_t next = g_sched.tasks[t->id].deadline_us;
+    uint64_t served = next - t->period;
+    uint64_t jitter = now_us - served;
+
+    if ((served - t->first_deadline) % t->period != 0) {
+        t->phase_errors++;
+    }
+    t->runs++;
+    t->jitter_sum += jitter;
+    if (jitter > t->jitter_max) {
+        t->jitter_max = jitter;
+    }
+}
+
+void test_sched_simulated_days() {
+    const uint32_t tasks = 300;
+    const uint32_t days = 7;
+    const uint64_t horizon = (uint64_t)days * 24u * 3600u * 1000000u;
+    const uint32_t max_latency = 3000; // us of loop latency per pass
+
+    TEST_ASSERT_GREATER_OR_EQUAL(tasks, SCHED_MAX_TASKS);
+
+    std::vector<SimTask> sim(tasks);
+    sched::sched_init(&g_sched);
+    for (uint32_t i = 0; i < tasks; i++) {
+        sim[i] = SimTask();
+        sim[i].period = 100000 + rnd() % 59900000; // 100 ms .. 60 s
+        sim[i].first_deadline = rnd() % sim[i].period;
+        sim[i].id = sched::sched_add(&g_sched, sim[i].first_deadline, sim[i].period, sim_job, &sim[i]);
+        TEST_ASSERT_NOT_EQUAL(-1, sim[i].id);
+    }
+
+    uint64_t now = 0;
+    uint64_t passes = 0;
+    while (now < horizon) {
+        uint64_t next;
+        TEST_ASSERT_TRUE(sched::sched_next_deadline(&g_sched, &next));
+        if (next > now) {
+            now = next;
+        }
+        now += rnd() % (max_latency + 1);
+        sched::sched_run(&g_sched, now);
+        passes++;
+    }
+
+    uint64_t runs = 0, skipped = 0, jitter_sum = 0;
+    uint64_t jitter_max = 0;
+    uint32_t phase_errors = 0;
+    int64_t worst_drift = 0;
+    for (const SimTask &t : sim) {
+        const sched::sched_task_t &st = g_sched.tasks[t.id];
+        runs += t.runs;
+        skipped += st.skipped;
+        jitter_sum += t.jitter_sum;
+        phase_errors += t.phase_errors;
+        if (t.jitter_max > jitter_max) {
+            jitter_max = t.jitter_max;
+        }
+
+        // Drift: pending deadline vs. the ideal phase grid after the same number of periods.
+        int64_t ideal = (int64_t)t.first_deadline + (int64_t)(t.runs + st.skipped) * t.period;
+        int64_t drift = (int64_t)st.deadline_us - ideal;
+        if (drift < 0) {
+            drift = -drift;
+        }
+        if (drift > worst_drift) {
+            worst_drift = drift;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(0, phase_errors);
+    TEST_ASSERT_EQUAL(0, worst_drift);
+    TEST_ASSERT_EQUAL(0, skipped); // latency is far below the shortest period
+    TEST_ASSERT_LESS_OR_EQUAL(max_latency, jitter_max);
+
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "%u tasks, %u simulated days, %llu passes, %llu runs: jitter mean %.1f us max %llu us, drift %lld us",
+             tasks, days, (unsigned long long)passes, (unsigned long long)runs,
+             (double)jitter_sum / (double)runs, (unsigned long long)jitter_max, (long long)worst_drift);
+    TEST_MESSAGE(msg);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_sched_runs_in_deadline_order);
+    RUN_TEST(test_sched_is_drift_free_and_skips_missed);
+    RUN_TEST(test_sched_crosses_32bit_boundary);
+    RUN_TEST(test_sched_cancel_and_set_period);
+    RUN_TEST(test_sched_capacity);
+    RUN_TEST(test_sched_simulated_days);
+    return UNITY_END();
+}
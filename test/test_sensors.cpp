@@ -0,0 +1,145 @@
+#include <unity.h>
+#include <cstring>
+#include "hal/sensor/sim_sensor.h"
+#include "sensors/sensor_registry.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Manual mock: returns a counter per read, can be told to fail.
+class MockSensor : public hal::sensor::ISensor {
+    public:
+    int32_t next_value = 0;
+    bool fail = false;
+
+    void hal_sensor_init() override {}
+    uint8_t hal_sensor_channel_count() override { return 2; }
+    bool hal_sensor_read(uint8_t channel, int32_t *value) override {
+        if (fail) {
+            return false;
+        }
+        *value = next_value++ + 1000 * channel;
+        return true;
+    }
+};
+
+static sensors::sensor_registry_t g_reg; // large; keep off the stack
+
+void test_registry_per_channel_rates() {
+    MockSensor sensor;
+    sensors::sensor_registry_init(&g_reg);
+
+    TEST_ASSERT_EQUAL(0, sensors::sensor_registry_add(&g_reg, &sensor, 0, 10, 0));
+    TEST_ASSERT_EQUAL(1, sensors::sensor_registry_add(&g_reg, &sensor, 1, 25, 0));
+
+    for (uint32_t t = 0; t <= 1000; t++) {
+        sensors::sensor_registry_poll(&g_reg, t);
+    }
+
+    TEST_ASSERT_EQUAL(100, g_reg.ring[0].count);
+    TEST_ASSERT_EQUAL(40, g_reg.ring[1].count);
+
+    sensors::sample_t s;
+    TEST_ASSERT_TRUE(sensors::sensor_registry_latest(&g_reg, 1, &s));
+    TEST_ASSERT_EQUAL(1000, s.timestamp_ms);
+    TEST_ASSERT_GREATER_OR_EQUAL(1000, s.value);
+}
+
+void test_registry_phase_anchored_when_late() {
+    MockSensor sensor;
+    sensors::sensor_registry_init(&g_reg);
+    sensors::sensor_registry_add(&g_reg, &sensor, 0, 100, 0);
+
+    sensors::sensor_registry_poll(&g_reg, 130); // 30 ms late
+    TEST_ASSERT_EQUAL(200, g_reg.next_due_ms[0]); // stays on the 100 ms grid
+
+    sensors::sensor_registry_poll(&g_reg, 555); // missed 300, 400 and 500 is due
+    TEST_ASSERT_EQUAL(2, g_reg.ring[0].count);
+    TEST_ASSERT_EQUAL(3, g_reg.missed[0]);
+    TEST_ASSERT_EQUAL(600, g_reg.next_due_ms[0]);
+}
+
+void test_registry_next_due_is_earliest_across_wrap() {
+    MockSensor sensor;
+    uint32_t due = 0;
+    sensors::sensor_registry_init(&g_reg);
+    TEST_ASSERT_FALSE(sensors::sensor_registry_next_due(&g_reg, &due));
+
+    // Both deadlines lie past the 32-bit wrap; channel 1 comes first.
+    sensors::sensor_registry_add(&g_reg, &sensor, 0, 300, 0xFFFFFF00u);
+    sensors::sensor_registry_add(&g_reg, &sensor, 1, 10, 0xFFFFFFFAu);
+    TEST_ASSERT_TRUE(sensors::sensor_registry_next_due(&g_reg, &due));
+    TEST_ASSERT_EQUAL_HEX32(0x00000004u, due);
+
+    sensors::sensor_registry_poll(&g_reg, 0x00000004u);
+    TEST_ASSERT_TRUE(sensors::sensor_registry_next_due(&g_reg, &due));
+    TEST_ASSERT_EQUAL_HEX32(0x0000000Eu, due);
+}
+
+void test_registry_ring_keeps_most_recent() {
+    MockSensor sensor;
+    sensors::sensor_registry_init(&g_reg);
+    sensors::sensor_registry_add(&g_reg, &sensor, 0, 1, 0);
+
+    for (uint32_t t = 1; t <= SENSOR_RING_DEPTH + 10; t++) {
+        sensors::sensor_registry_poll(&g_reg, t);
+    }
+
+    uint32_t ts[SENSOR_RING_DEPTH];
+    int32_t values[SENSOR_RING_DEPTH];
+    size_t n = sensors::sensor_registry_recent(&g_reg, 0, ts, values, SENSOR_RING_DEPTH);
+    TEST_ASSERT_EQUAL(SENSOR_RING_DEPTH, n);
+    TEST_ASSERT_EQUAL(11, ts[0]); // oldest surviving sample
+    TEST_ASSERT_EQUAL(10, values[0]);
+    TEST_ASSERT_EQUAL(SENSOR_RING_DEPTH + 10, ts[n - 1]);
+}
+
+void test_registry_rejects_invalid_and_counts_errors() {
+    MockSensor sensor;
+    sensors::sensor_registry_init(&g_reg);
+
+    TEST_ASSERT_EQUAL(-1, sensors::sensor_registry_add(&g_reg, &sensor, 2, 10, 0)); // no such source channel
+    TEST_ASSERT_EQUAL(-1, sensors::sensor_registry_add(&g_reg, &sensor, 0, 0, 0));  // zero period
+    TEST_ASSERT_EQUAL(0, sensors::sensor_registry_add(&g_reg, &sensor, 0, 10, 0));
+
+    sensor.fail = true;
+    sensors::sensor_registry_poll(&g_reg, 10);
+    TEST_ASSERT_EQUAL(1, g_reg.read_errors[0]);
+    sensors::sample_t s;
+    TEST_ASSERT_FALSE(sensors::sensor_registry_latest(&g_reg, 0, &s));
+}
+
+void test_sim_sensor_is_deterministic() {
+    hal::sensor::HalSensorSim a(4);
+    hal::sensor::HalSensorSim b(4);
+    a.hal_sensor_init();
+    b.hal_sensor_init();
+
+    for (int i = 0; i < 500; i++) {
+        for (uint8_t ch = 0; ch < 4; ch++) {
+            int32_t va, vb;
+            TEST_ASSERT_TRUE(a.hal_sensor_read(ch, &va));
+            TEST_ASSERT_TRUE(b.hal_sensor_read(ch, &vb));
+            TEST_ASSERT_EQUAL(va, vb);
+            TEST_ASSERT_INT_WITHIN(1010, 2048, va);
+        }
+    }
+
+    int32_t v;
+    TEST_ASSERT_FALSE(a.hal_sensor_read(4, &v));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_registry_per_channel_rates);
+    RUN_TEST(test_registry_phase_anchored_when_late);
+    RUN_TEST(test_registry_next_due_is_earliest_across_wrap);
+    RUN_TEST(test_registry_ring_keeps_most_recent);
+    RUN_TEST(test_registry_rejects_invalid_and_counts_errors);
+    RUN_TEST(test_sim_sensor_is_deterministic);
+    return UNITY_END();
+}
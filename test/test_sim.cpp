@@ -0,0 +1,181 @@
+#include <unity.h>
+#include <cstring>
+#include "sim/sim_node.h"
+#include "hal/sensor/sim_sensor.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static const uint64_t SEC = 1000000u;
+static const uint64_t DAY = 86400u * SEC;
+
+void test_sim_idle_week_stays_on_grid() {
+    static sim::SimNode node(sim::sim_default_config());
+    node.run_until(7 * DAY + SEC / 2);
+
+    const sim::sim_report_t &r = node.report();
+    // 1 s telemetry and 2 s heartbeat, every one on its slot.
+    TEST_ASSERT_EQUAL_UINT64(7 * 86400u, r.telemetry);
+    TEST_ASSERT_EQUAL_UINT64(7 * 43200u, r.heartbeats);
+    TEST_ASSERT_EQUAL_UINT32(0, r.telemetry_missed);
+    TEST_ASSERT_EQUAL_UINT32(0, r.heartbeat_missed);
+    TEST_ASSERT_EQUAL_UINT32(0, r.telemetry_phase_us.max());
+    TEST_ASSERT_EQUAL_UINT32(0, r.heartbeat_phase_us.max());
+    TEST_ASSERT_EQUAL_UINT32(0, r.tx_dropped);
+
+    // The loop slept between deadlines instead of spinning.
+    TEST_ASSERT_TRUE(r.sleeps * 10 >= r.passes * 9);
+}
+
+void test_sim_command_latency_follows_link_speed() {
+    sim::sim_config_t cfg = sim::sim_default_config();
+    static sim::SimNode node(cfg);
+
+    // Off the telemetry slots so the reply never queues behind a record.
+    for (uint64_t i = 0; i < 100; i++)
+        node.script(i * SEC + SEC / 2, "LED AUTO");
+    node.run_until(101 * SEC);
+
+    const sim::sim_report_t &r = node.report();
+    TEST_ASSERT_EQUAL_UINT64(100, r.commands);
+    TEST_ASSERT_EQUAL_UINT32(100, r.command_latency_us.count());
+    TEST_ASSERT_EQUAL_STRING("OK LED AUTO", node.replies().back().c_str());
+
+    // 10 bytes in ("LED AUTO\r\n") + 13 out ("OK LED AUTO\r\n") at 11520 B/s,
+    // plus the command itself: about 2 ms, the same every time.
+    uint32_t wire_us = 23u * 1000000u / cfg.link_bytes_per_sec;
+    TEST_ASSERT_UINT32_WITHIN(100, wire_us, r.command_latency_us.min());
+    TEST_ASSERT_EQUAL_UINT32(r.command_latency_us.min(), r.command_latency_us.max());
+}
+
+void test_sim_saturated_link_queues_and_drops() {
+    sim::sim_config_t cfg = sim::sim_default_config();
+    cfg.link_bytes_per_sec = 960; // 9600 baud
+    static sim::SimNode node(cfg);
+
+    // ~60-byte text records every 10 ms: six times what the link carries.
+    node.script(0, "RATE 10");
+    node.run_until(60 * SEC);
+
+    const sim::sim_report_t &r = node.report();
+    TEST_ASSERT_TRUE(r.tx_dropped > 0);
+    TEST_ASSERT_TRUE(r.tx_queue_bytes.max() > cfg.tx_queue_bytes - 100);
+    TEST_ASSERT_TRUE(r.tx_bytes <= 61u * cfg.link_bytes_per_sec);
+
+    // Draining a full queue keeps the loop busy, but only by pass costs:
+    // the schedule stays on its grid.
+    TEST_ASSERT_EQUAL_UINT32(0, r.telemetry_missed);
+    TEST_ASSERT_TRUE(r.telemetry_phase_us.max() < 1000);
+}
+
+void test_sim_is_deterministic_across_micros_wrap() {
+    // Boot 10 s before the 32-bit microsecond counter wraps.
+    const uint64_t boot = (1ull << 32) - 10 * SEC;
+    sim::SimNode *runs[2];
+    for (int i = 0; i < 2; i++) {
+        runs[i] = new sim::SimNode(sim::sim_default_config(), boot);
+        runs[i]->script(boot + 3 * SEC, "TELEMETRY BINARY");
+        runs[i]->script(boot + 5 * SEC + 123, "RATE 250");
+        runs[i]->script(boot + 5 * SEC + 500, "STATUS");
+        runs[i]->run_until(boot + 3600 * SEC);
+    }
+
+    const sim::sim_report_t &a = runs[0]->report();
+    const sim::sim_report_t &b = runs[1]->report();
+    TEST_ASSERT_EQUAL_UINT64(a.passes, b.passes);
+    TEST_ASSERT_EQUAL_UINT64(a.tx_bytes, b.tx_bytes);
+    TEST_ASSERT_EQUAL_UINT64(a.telemetry, b.telemetry);
+    TEST_ASSERT_EQUAL_UINT64(a.command_latency_us.sum(), b.command_latency_us.sum());
+
+    // Across the wrap: 3 s of 1 s text, then binary at 250 ms from the RATE.
+    TEST_ASSERT_EQUAL_UINT32(0, a.heartbeat_missed);
+    TEST_ASSERT_EQUAL_UINT32(0, a.telemetry_missed);
+    TEST_ASSERT_EQUAL_UINT32(0, a.heartbeat_phase_us.max());
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)a.telemetry_drift_us);
+    TEST_ASSERT_TRUE(a.telemetry > (3600 - 5) * 4);
+
+    delete runs[0];
+    delete runs[1];
+}
+
+void test_sim_pipelined_commands_beat_lock_step() {
+    // 115200 baud: lock-step pays both wire directions and the host's
+    // turnaround per command; a window of 8 overlaps them.
+    sim::sim_config_t uart = sim::sim_default_config();
+    double lock_step = sim::sim_command_throughput(uart, "LED AUTO", 200, 1, 200);
+    double pipelined = sim::sim_command_throughput(uart, "LED AUTO", 200, 8, 200);
+    TEST_ASSERT_TRUE(lock_step > 0);
+    TEST_ASSERT_TRUE(pipelined > 1.5 * lock_step);
+
+    // USB: the wire is free, the 1 ms frame turnaround is what lock-step waits on.
+    sim::sim_config_t usb = sim::sim_default_config();
+    usb.link_bytes_per_sec = 0;
+    lock_step = sim::sim_command_throughput(usb, "LED AUTO", 200, 1, 1000);
+    pipelined = sim::sim_command_throughput(usb, "LED AUTO", 200, 8, 1000);
+    TEST_ASSERT_TRUE(lock_step > 0);
+    TEST_ASSERT_TRUE(pipelined > 4 * lock_step);
+}
+
+void test_sim_stream_wakes_per_block() {
+    static sim::SimNode node(sim::sim_default_config());
+    static sensors::sensor_registry_t reg;
+    static hal::sensor::HalSensorSim sensor(1);
+    sensor.hal_sensor_init();
+    sensors::sensor_registry_init(&reg);
+    sensors::sensor_registry_add(&reg, &sensor, 0, 100, 0);
+    app::app_attach_sensors(&node.app, &reg);
+
+    // 2 kHz for 10 s: well inside what 115200 baud carries.
+    node.script(0, "STREAM START 2000");
+    node.script(10 * SEC, "STREAM STOP");
+    node.run_until(11 * SEC);
+
+    TEST_ASSERT_EQUAL_STRING_LEN("OK STREAM STOP SAMPLES=", node.replies().back().c_str(), 23);
+    TEST_ASSERT_EQUAL_UINT32(0, node.stream.overruns.load());
+    TEST_ASSERT_EQUAL_UINT32(0, node.stream.lost.load());
+    TEST_ASSERT_UINT32_WITHIN(2, 20000, node.stream.samples.load());
+    TEST_ASSERT_EQUAL_UINT32((node.stream.samples.load() + STREAM_BLOCK_SAMPLES - 1) / STREAM_BLOCK_SAMPLES,
+                             node.stream.blocks_sent);
+
+    // The loop sleeps between blocks rather than between samples.
+    const sim::sim_report_t &r = node.report();
+    TEST_ASSERT_TRUE(r.passes < 2 * (node.stream.blocks_sent + 11 + 6));
+    TEST_ASSERT_EQUAL_UINT32(0, r.tx_dropped);
+}
+
+void test_sim_changes_saves_bandwidth() {
+    // Ten minutes of 100 ms telemetry with four channels. "CHANGES 1" sends
+    // every field every period, the baseline for the same content.
+    sim::sim_config_t cfg = sim::sim_default_config();
+    const uint64_t span = 600 * SEC;
+    double idle_full = sim::sim_telemetry_bandwidth(cfg, "TELEMETRY CHANGES 1", 0, false, span);
+    double idle_noisy = sim::sim_telemetry_bandwidth(cfg, "TELEMETRY CHANGES 100", 0, false, span);
+    double idle = sim::sim_telemetry_bandwidth(cfg, "TELEMETRY CHANGES 100", 16, false, span);
+    double active_full = sim::sim_telemetry_bandwidth(cfg, "TELEMETRY CHANGES 1", 0, true, span);
+    double active = sim::sim_telemetry_bandwidth(cfg, "TELEMETRY CHANGES 100", 16, true, span);
+
+    // Idle: noise inside the deadband leaves little more than the keyframes.
+    TEST_ASSERT_TRUE(idle_full > 0);
+    TEST_ASSERT_TRUE(idle_noisy < idle_full);
+    TEST_ASSERT_TRUE(idle * 20 < idle_full);
+
+    // Active: channels move every period, the record fields rarely do.
+    TEST_ASSERT_TRUE(active > idle);
+    TEST_ASSERT_TRUE(active < active_full);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_sim_idle_week_stays_on_grid);
+    RUN_TEST(test_sim_command_latency_follows_link_speed);
+    RUN_TEST(test_sim_saturated_link_queues_and_drops);
+    RUN_TEST(test_sim_is_deterministic_across_micros_wrap);
+    RUN_TEST(test_sim_pipelined_commands_beat_lock_step);
+    RUN_TEST(test_sim_stream_wakes_per_block);
+    RUN_TEST(test_sim_changes_saves_bandwidth);
+    return UNITY_END();
+}
@@ -0,0 +1,157 @@
+#include <unity.h>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "spsc_ring.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Byte expected at stream position i; not periodic in 256 so reordering shows up.
+static uint8_t pattern(uint64_t i) {
+    return (uint8_t)(i * 7u + (i >> 8) + (i >> 16));
+}
+
+void test_ring_push_pop_wraps() {
+    util::SpscRing<uint32_t, 8> ring;
+
+    for (uint32_t round = 0; round < 10; round++) {
+        for (uint32_t i = 0; i < 5; i++) {
+            TEST_ASSERT_TRUE(ring.push(round * 100 + i));
+        }
+        for (uint32_t i = 0; i < 5; i++) {
+            uint32_t v = 0;
+            TEST_ASSERT_TRUE(ring.pop(v));
+            TEST_ASSERT_EQUAL_UINT32(round * 100 + i, v);
+        }
+    }
+
+    uint32_t v;
+    TEST_ASSERT_FALSE(ring.pop(v));
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_ring_overflow_and_high_water() {
+    util::SpscRing<uint8_t, 16> ring;
+    uint8_t data[24];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+
+    TEST_ASSERT_EQUAL(10, ring.write(data, 10));
+    TEST_ASSERT_EQUAL(10, ring.high_water());
+
+    // Only 6 more fit; the remaining 8 are counted as overflow.
+    TEST_ASSERT_EQUAL(6, ring.write(data + 10, 14));
+    TEST_ASSERT_EQUAL(16, ring.size());
+    TEST_ASSERT_EQUAL(16, ring.high_water());
+    TEST_ASSERT_EQUAL(8, ring.overflows());
+
+    uint8_t out[16];
+    TEST_ASSERT_EQUAL(16, ring.read(out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(data, out, 16);
+
+    ring.reset_stats();
+    TEST_ASSERT_EQUAL(0, ring.overflows());
+    TEST_ASSERT_EQUAL(0, ring.high_water());
+}
+
+void test_ring_peek_span_stops_at_wrap() {
+    util::SpscRing<uint8_t, 8> ring;
+    uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t out[8];
+
+    ring.write(data, 6);
+    ring.read(out, 6); // tail now at index 6
+    ring.write(data, 5); // occupies slots 6,7,0,1,2
+
+    size_t n = 0;
+    const uint8_t *span = ring.peek_span(&n);
+    TEST_ASSERT_NOT_NULL(span);
+    TEST_ASSERT_EQUAL(2, n);
+    TEST_ASSERT_EQUAL(1, span[0]);
+    ring.consume(n);
+
+    span = ring.peek_span(&n);
+    TEST_ASSERT_EQUAL(3, n);
+    TEST_ASSERT_EQUAL(3, span[0]);
+}
+
+// Producer and consumer threads move a long byte stream through a small
+// ring in random-sized bulk operations; every byte must arrive in order.
+void test_ring_threaded_stress() {
+    static util::SpscRing<uint8_t, 1024> ring;
+    const uint64_t total = 16u * 1024u * 1024u;
+
+    std::thread producer([&]() {
+        uint8_t chunk[300];
+        uint64_t sent = 0;
+        uint32_t rng = 1;
+        while (sent < total) {
+            rng = rng * 1103515245u + 12345u;
+            size_t want = 1 + (rng >> 16) % sizeof(chunk);
+            if (want > total - sent) {
+                want = (size_t)(total - sent);
+            }
+            want = want < ring.free_space() ? want : ring.free_space();
+            for (size_t i = 0; i < want; i++) {
+                chunk[i] = pattern(sent + i);
+            }
+            sent += ring.write(chunk, want);
+            if (want == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t received = 0;
+    uint64_t mismatches = 0;
+    uint8_t chunk[257];
+    uint32_t rng = 7;
+    while (received < total) {
+        rng = rng * 1103515245u + 12345u;
+        size_t got;
+        if (rng & 0x10000) {
+            got = ring.read(chunk, 1 + (rng >> 17) % sizeof(chunk));
+            for (size_t i = 0; i < got; i++) {
+                mismatches += chunk[i] != pattern(received + i);
+            }
+        } else {
+            const uint8_t *span = ring.peek_span(&got);
+            for (size_t i = 0; i < got; i++) {
+                mismatches += span[i] != pattern(received + i);
+            }
+            ring.consume(got);
+        }
+        received += got;
+        if (got == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    TEST_ASSERT_EQUAL(0, mismatches);
+    TEST_ASSERT_EQUAL(total, received);
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_EQUAL(0, ring.overflows()); // producer never wrote more than free_space()
+    TEST_ASSERT_LESS_OR_EQUAL(ring.capacity(), ring.high_water());
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "moved %llu bytes, high water %zu/%zu",
+             (unsigned long long)received, ring.high_water(), ring.capacity());
+    TEST_MESSAGE(msg);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_push_pop_wraps);
+    RUN_TEST(test_ring_overflow_and_high_water);
+    RUN_TEST(test_ring_peek_span_stops_at_wrap);
+    RUN_TEST(test_ring_threaded_stress);
+    return UNITY_END();
+}
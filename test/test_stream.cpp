@@ -0,0 +1,160 @@
+#include <unity.h>
+#include <cstring>
+#include "mock_hal.h"
+#include "stream/stream.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Manual mock: returns a counter per read, can be told to fail or to
+// return values outside the int16 range.
+class MockSensor : public hal::sensor::ISensor {
+    public:
+    int32_t next_value = 0;
+    int32_t step = 1;
+    bool fail = false;
+
+    void hal_sensor_init() override {}
+    uint8_t hal_sensor_channel_count() override { return 2; }
+    bool hal_sensor_read(uint8_t channel, int32_t *value) override {
+        if (fail) {
+            return false;
+        }
+        *value = next_value + 1000 * channel;
+        next_value += step;
+        return true;
+    }
+};
+
+static const uint32_t N = STREAM_BLOCK_SAMPLES;
+
+void test_stream_start_and_stop() {
+    MockHalTimer timer;
+    MockSensor sensor;
+    stream::stream_t s;
+    stream::stream_init(&s, &timer, nullptr);
+    TEST_ASSERT_FALSE(stream::stream_active(&s));
+    TEST_ASSERT_FALSE(stream::stream_active(nullptr));
+
+    // Period rounded to whole microseconds.
+    TEST_ASSERT_TRUE(stream::stream_start(&s, &sensor, 1, 3, 3000));
+    TEST_ASSERT_TRUE(stream::stream_active(&s));
+    TEST_ASSERT_TRUE(timer.running);
+    TEST_ASSERT_EQUAL_UINT32(333, timer.period_us);
+    TEST_ASSERT_EQUAL_UINT32(333, s.period_us);
+    TEST_ASSERT_FALSE(stream::stream_start(&s, &sensor, 1, 3, 3000)); // already running
+
+    stream::stream_stop(&s);
+    TEST_ASSERT_FALSE(stream::stream_active(&s));
+    TEST_ASSERT_FALSE(timer.running);
+
+    // A timer that cannot run leaves the stream stopped.
+    timer.refuse = true;
+    TEST_ASSERT_FALSE(stream::stream_start(&s, &sensor, 1, 3, 1000));
+    TEST_ASSERT_FALSE(stream::stream_active(&s));
+}
+
+void test_stream_double_buffers_blocks() {
+    MockHalTimer timer;
+    MockSensor sensor;
+    stream::stream_t s;
+    stream::stream_init(&s, &timer, nullptr);
+    TEST_ASSERT_TRUE(stream::stream_start(&s, &sensor, 1, 1, 1000));
+
+    timer.fire(N - 1);
+    TEST_ASSERT_NULL(stream::stream_peek(&s));
+    timer.fire();
+    const stream::stream_block_t *b = stream::stream_peek(&s);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_UINT32(0, b->first_index);
+    TEST_ASSERT_EQUAL_UINT32(N, b->count);
+    TEST_ASSERT_EQUAL_INT16(1000, b->samples[0]);
+    TEST_ASSERT_EQUAL_INT16(1000 + N - 1, b->samples[N - 1]);
+
+    // The timer fills the other block while this one waits.
+    timer.fire(N / 2);
+    TEST_ASSERT_EQUAL_PTR(b, stream::stream_peek(&s));
+    stream::stream_release(&s);
+    TEST_ASSERT_NULL(stream::stream_peek(&s));
+    TEST_ASSERT_EQUAL_UINT32(1, s.blocks_sent);
+
+    timer.fire(N - N / 2);
+    b = stream::stream_peek(&s);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_UINT32(N, b->first_index);
+    TEST_ASSERT_EQUAL_INT16(1000 + N, b->samples[0]);
+    stream::stream_release(&s);
+
+    TEST_ASSERT_EQUAL_UINT32(2 * N, s.samples.load());
+    TEST_ASSERT_EQUAL_UINT32(0, s.lost.load());
+    TEST_ASSERT_EQUAL_UINT32(0, s.overruns.load());
+}
+
+void test_stream_counts_overruns() {
+    MockHalTimer timer;
+    MockSensor sensor;
+    stream::stream_t s;
+    stream::stream_init(&s, &timer, nullptr);
+    TEST_ASSERT_TRUE(stream::stream_start(&s, &sensor, 0, 0, 1000));
+
+    // Nobody sends: the first block waits, the next two are dropped.
+    timer.fire(3 * N);
+    TEST_ASSERT_EQUAL_UINT32(2, s.overruns.load());
+    TEST_ASSERT_EQUAL_UINT32(2 * N, s.lost.load());
+
+    // The waiting block is never overwritten; the next one shows the gap.
+    const stream::stream_block_t *b = stream::stream_peek(&s);
+    TEST_ASSERT_EQUAL_UINT32(0, b->first_index);
+    TEST_ASSERT_EQUAL_INT16(0, b->samples[0]);
+    stream::stream_release(&s);
+    timer.fire(N);
+    b = stream::stream_peek(&s);
+    TEST_ASSERT_EQUAL_UINT32(3 * N, b->first_index);
+    TEST_ASSERT_EQUAL_INT16(3 * N, b->samples[0]);
+
+    // Discarding a ready block counts it like a dropped one, not as sent.
+    stream::stream_discard(&s);
+    TEST_ASSERT_NULL(stream::stream_peek(&s));
+    TEST_ASSERT_EQUAL_UINT32(1, s.blocks_sent);
+    TEST_ASSERT_EQUAL_UINT32(3, s.overruns.load());
+    TEST_ASSERT_EQUAL_UINT32(3 * N, s.lost.load());
+}
+
+void test_stream_partial_block_and_saturation() {
+    MockHalTimer timer;
+    MockSensor sensor;
+    stream::stream_t s;
+    stream::stream_init(&s, &timer, nullptr);
+    TEST_ASSERT_TRUE(stream::stream_start(&s, &sensor, 0, 0, 1000));
+
+    sensor.next_value = 40000;
+    sensor.step = -40000;
+    timer.fire(3); // 40000, 0, -40000
+    sensor.fail = true;
+    timer.fire(2);
+    TEST_ASSERT_EQUAL_UINT32(2, s.read_errors.load());
+
+    stream::stream_block_t partial;
+    TEST_ASSERT_FALSE(stream::stream_take_partial(&s, &partial)); // still running
+    stream::stream_stop(&s);
+    stream::stream_on_timer(&s); // a tick racing the stop is ignored
+    TEST_ASSERT_TRUE(stream::stream_take_partial(&s, &partial));
+    TEST_ASSERT_EQUAL_UINT32(3, partial.count);
+    TEST_ASSERT_EQUAL_INT16(INT16_MAX, partial.samples[0]);
+    TEST_ASSERT_EQUAL_INT16(0, partial.samples[1]);
+    TEST_ASSERT_EQUAL_INT16(INT16_MIN, partial.samples[2]);
+    TEST_ASSERT_FALSE(stream::stream_take_partial(&s, &partial)); // emptied
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_stream_start_and_stop);
+    RUN_TEST(test_stream_double_buffers_blocks);
+    RUN_TEST(test_stream_counts_overruns);
+    RUN_TEST(test_stream_partial_block_and_saturation);
+    return UNITY_END();
+}
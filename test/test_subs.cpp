@@ -0,0 +1,132 @@
+#include <unity.h>
+#include <cstring>
+#include "subs/subscriptions.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static int count_bits(const subs::subs_mask_t &m) {
+    int n = 0;
+    for (int ch = subs::subs_next(&m, 0); ch >= 0; ch = subs::subs_next(&m, ch + 1))
+        n++;
+    return n;
+}
+
+void test_subs_add_remove_and_next_due() {
+    subs::subs_table_t t;
+    subs::subs_init(&t);
+    uint64_t due = 0;
+    TEST_ASSERT_FALSE(subs::subs_next_due(&t, &due));
+    TEST_ASSERT_FALSE(subs::subs_add(&t, 3, 0, 0));
+    TEST_ASSERT_FALSE(subs::subs_add(&t, SUBS_MAX_CHANNELS, 1000, 0));
+
+    TEST_ASSERT_TRUE(subs::subs_add(&t, 3, 5000, 1000));
+    TEST_ASSERT_TRUE(subs::subs_add(&t, 63, 2000, 1000));
+    TEST_ASSERT_TRUE(subs::subs_active(&t, 63));
+    TEST_ASSERT_FALSE(subs::subs_active(&t, 62));
+    TEST_ASSERT_EQUAL(2, t.count);
+    TEST_ASSERT_TRUE(subs::subs_next_due(&t, &due));
+    TEST_ASSERT_EQUAL_UINT64(3000, due);
+
+    // Resubscribing the earliest one later moves the earliest deadline.
+    TEST_ASSERT_TRUE(subs::subs_add(&t, 63, 9000, 1000));
+    TEST_ASSERT_EQUAL(2, t.count);
+    subs::subs_next_due(&t, &due);
+    TEST_ASSERT_EQUAL_UINT64(6000, due);
+
+    TEST_ASSERT_TRUE(subs::subs_remove(&t, 3));
+    TEST_ASSERT_FALSE(subs::subs_remove(&t, 3));
+    subs::subs_next_due(&t, &due);
+    TEST_ASSERT_EQUAL_UINT64(10000, due);
+
+    subs::subs_clear(&t);
+    TEST_ASSERT_FALSE(subs::subs_next_due(&t, &due));
+    TEST_ASSERT_FALSE(subs::subs_active(&t, 63));
+}
+
+void test_subs_collect_packs_due_channels() {
+    subs::subs_table_t t;
+    subs::subs_init(&t);
+    subs::subs_add(&t, 0, 100, 0);
+    subs::subs_add(&t, 1, 200, 0);
+    subs::subs_add(&t, 7, 100, 0);
+
+    subs::subs_mask_t due;
+    TEST_ASSERT_EQUAL(0, subs::subs_collect(&t, 99, &due));
+    TEST_ASSERT_EQUAL(-1, subs::subs_next(&due, 0));
+
+    TEST_ASSERT_EQUAL(2, subs::subs_collect(&t, 100, &due));
+    TEST_ASSERT_EQUAL(0, subs::subs_next(&due, 0));
+    TEST_ASSERT_EQUAL(7, subs::subs_next(&due, 1));
+    TEST_ASSERT_EQUAL(-1, subs::subs_next(&due, 8));
+
+    TEST_ASSERT_EQUAL(3, subs::subs_collect(&t, 200, &due));
+
+    // A late tick sends once and counts the skipped periods; the grid holds.
+    TEST_ASSERT_EQUAL(3, subs::subs_collect(&t, 450, &due));
+    TEST_ASSERT_EQUAL_UINT32(1, t.missed); // channels 0 and 7 share one 100 us grid
+    uint64_t next = 0;
+    subs::subs_next_due(&t, &next);
+    TEST_ASSERT_EQUAL_UINT64(500, next);
+    subs::subs_remove(&t, 0);
+    subs::subs_remove(&t, 7);
+    subs::subs_next_due(&t, &next);
+    TEST_ASSERT_EQUAL_UINT64(600, next);
+}
+
+void test_subs_same_period_shares_a_grid() {
+    subs::subs_table_t t;
+    subs::subs_init(&t);
+    subs::subs_add(&t, 4, 100, 0);
+
+    // Joining later: first value at the group's next deadline, in its record.
+    subs::subs_add(&t, 9, 100, 250);
+    subs::subs_mask_t due;
+    TEST_ASSERT_EQUAL(2, subs::subs_collect(&t, 300, &due));
+
+    // Every group in use: a new period is refused, a known one still joins,
+    // and the sole member of a group can move to a new period.
+    for (int i = 1; i < SUBS_MAX_GROUPS; i++)
+        TEST_ASSERT_TRUE(subs::subs_add(&t, (uint8_t)(10 + i), 100 + i, 300));
+    TEST_ASSERT_FALSE(subs::subs_add(&t, 30, 5000, 300));
+    TEST_ASSERT_FALSE(subs::subs_active(&t, 30));
+    TEST_ASSERT_TRUE(subs::subs_add(&t, 30, 100, 300));
+    TEST_ASSERT_TRUE(subs::subs_add(&t, 11, 5000, 300));
+    TEST_ASSERT_EQUAL(1, t.group[t.group_of[11]].count);
+    TEST_ASSERT_EQUAL_UINT32(5000, t.group[t.group_of[11]].period_us);
+
+    // Leaving a shared group keeps its grid for the others.
+    TEST_ASSERT_TRUE(subs::subs_add(&t, 4, 5000, 300));
+    TEST_ASSERT_EQUAL(2, t.group[t.group_of[9]].count);
+    TEST_ASSERT_EQUAL(2, subs::subs_collect(&t, 400, &due));
+    TEST_ASSERT_EQUAL(9, subs::subs_next(&due, 0));
+    TEST_ASSERT_EQUAL(30, subs::subs_next(&due, 10));
+}
+
+void test_subs_many_channels_on_one_grid() {
+    subs::subs_table_t t;
+    subs::subs_init(&t);
+    for (int ch = 0; ch < SUBS_MAX_CHANNELS; ch++)
+        subs::subs_add(&t, (uint8_t)ch, ch % 2 ? 1000 : 2000, 0);
+
+    subs::subs_mask_t due;
+    TEST_ASSERT_EQUAL(SUBS_MAX_CHANNELS / 2, subs::subs_collect(&t, 1000, &due));
+    TEST_ASSERT_EQUAL(SUBS_MAX_CHANNELS / 2, count_bits(due));
+    TEST_ASSERT_EQUAL(1, subs::subs_next(&due, 0));
+    TEST_ASSERT_EQUAL(SUBS_MAX_CHANNELS, subs::subs_collect(&t, 2000, &due));
+    TEST_ASSERT_EQUAL(SUBS_MAX_CHANNELS - 1, subs::subs_next(&due, SUBS_MAX_CHANNELS - 1));
+    TEST_ASSERT_EQUAL_UINT32(0, t.missed);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_subs_add_remove_and_next_due);
+    RUN_TEST(test_subs_collect_packs_due_channels);
+    RUN_TEST(test_subs_same_period_shares_a_grid);
+    RUN_TEST(test_subs_many_channels_on_one_grid);
+    return UNITY_END();
+}
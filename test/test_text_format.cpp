@@ -0,0 +1,128 @@
+#include <unity.h>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include "text_format.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static constexpr char k_one[] = "{}";
+static constexpr char k_status[] = "STATE={} TIME={} TELEMETRY_MS={} HEARTBEAT_MS={} FAULTS={}";
+static constexpr char k_plain[] = "OK ARMED";
+
+static uint64_t next_random(uint64_t *x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+void test_unsigned_matches_snprintf() {
+    typedef util::TextFormat<k_one, uint32_t> u32_t;
+    typedef util::TextFormat<k_one, uint64_t> u64_t;
+    char got[32], want[32];
+
+    // Every power-of-ten boundary, then random values of every bit length.
+    uint64_t v = 1;
+    for (int i = 0; i < 20; i++, v *= 10) {
+        for (uint64_t d : {v - 1, v, v + 1}) {
+            snprintf(want, sizeof(want), "%llu", (unsigned long long)d);
+            TEST_ASSERT_EQUAL(strlen(want), u64_t::write(got, sizeof(got), d));
+            TEST_ASSERT_EQUAL_STRING(want, got);
+        }
+    }
+    uint64_t x = 88172645463325252ull;
+    for (int i = 0; i < 100000; i++) {
+        uint64_t r = next_random(&x) >> (i % 64);
+        snprintf(want, sizeof(want), "%llu", (unsigned long long)r);
+        u64_t::write(got, sizeof(got), r);
+        TEST_ASSERT_EQUAL_STRING(want, got);
+
+        snprintf(want, sizeof(want), "%lu", (unsigned long)(uint32_t)r);
+        u32_t::write(got, sizeof(got), (uint32_t)r);
+        TEST_ASSERT_EQUAL_STRING(want, got);
+    }
+    u64_t::write(got, sizeof(got), UINT64_MAX);
+    TEST_ASSERT_EQUAL_STRING("18446744073709551615", got);
+    u32_t::write(got, sizeof(got), UINT32_MAX);
+    TEST_ASSERT_EQUAL_STRING("4294967295", got);
+}
+
+void test_signed_matches_snprintf() {
+    typedef util::TextFormat<k_one, int> int_t;
+    typedef util::TextFormat<k_one, int64_t> i64_t;
+    char got[32], want[32];
+
+    const int values[] = {0, 1, -1, 9, -9, 10, -10, 2147483647, INT_MIN};
+    for (int v : values) {
+        snprintf(want, sizeof(want), "%d", v);
+        int_t::write(got, sizeof(got), v);
+        TEST_ASSERT_EQUAL_STRING(want, got);
+    }
+    i64_t::write(got, sizeof(got), INT64_MIN);
+    TEST_ASSERT_EQUAL_STRING("-9223372036854775808", got);
+}
+
+void test_status_line_identical_to_snprintf() {
+    typedef util::TextFormat<k_status, int, uint64_t, uint32_t, uint32_t, uint32_t> status_t;
+    char got[128], want[128];
+
+    uint64_t x = 12345;
+    for (int i = 0; i < 10000; i++) {
+        int state = (int)(next_random(&x) % 4);
+        uint64_t time_ms = next_random(&x) >> (next_random(&x) % 64);
+        uint32_t period = (uint32_t)next_random(&x) >> (i % 32);
+        uint32_t faults = (uint32_t)next_random(&x) >> (i % 32);
+
+        int n = snprintf(want, sizeof(want), "STATE=%d TIME=%llu TELEMETRY_MS=%lu HEARTBEAT_MS=%lu FAULTS=%lu",
+                         state, (unsigned long long)time_ms, (unsigned long)period, 2000ul, (unsigned long)faults);
+        TEST_ASSERT_EQUAL(n, status_t::write(got, sizeof(got), state, time_ms, period, 2000u, faults));
+        TEST_ASSERT_EQUAL_STRING(want, got);
+    }
+}
+
+void test_truncates_like_snprintf() {
+    typedef util::TextFormat<k_status, int, uint64_t, uint32_t, uint32_t, uint32_t> status_t;
+    char got[128], want[128];
+
+    for (size_t cap = 1; cap < 64; cap++) {
+        // Truncation is the point here; keep the reference snprintf's cap
+        // opaque so -Wformat-truncation does not flag it.
+        volatile size_t want_cap = cap;
+        snprintf(want, want_cap, "STATE=%d TIME=%llu TELEMETRY_MS=%lu HEARTBEAT_MS=%lu FAULTS=%lu",
+                 1, 123456789ull, 100ul, 2000ul, 3ul);
+        memset(got, 'x', sizeof(got));
+        TEST_ASSERT_EQUAL(strlen(want), status_t::write(got, cap, 1, 123456789ull, 100u, 2000u, 3u));
+        TEST_ASSERT_EQUAL_STRING(want, got);
+        TEST_ASSERT_EQUAL('x', got[cap]); // nothing written past cap
+    }
+    TEST_ASSERT_EQUAL(0, status_t::write(got, 0, 1, 1ull, 1u, 1u, 1u));
+}
+
+void test_compile_time_lengths() {
+    typedef util::TextFormat<k_status, int, uint64_t, uint32_t, uint32_t, uint32_t> status_t;
+    typedef util::TextFormat<k_plain> plain_t;
+
+    // Literal characters plus the widest rendering of each argument.
+    static_assert(status_t::max_len == 48 + 11 + 20 + 10 + 10 + 10, "status max_len");
+    static_assert(plain_t::max_len == 8, "plain max_len");
+
+    char got[16];
+    TEST_ASSERT_EQUAL(8, plain_t::write(got, sizeof(got)));
+    TEST_ASSERT_EQUAL_STRING("OK ARMED", got);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_unsigned_matches_snprintf);
+    RUN_TEST(test_signed_matches_snprintf);
+    RUN_TEST(test_status_line_identical_to_snprintf);
+    RUN_TEST(test_truncates_like_snprintf);
+    RUN_TEST(test_compile_time_lengths);
+    return UNITY_END();
+}
@@ -0,0 +1,188 @@
+#include <unity.h>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+#include "app.h"
+#include "hal/transport/udp_link.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Records what HalUdp sends and hands it queued inbound datagrams.
+class FakeSocket : public hal::transport::IDatagramSocket {
+public:
+    std::vector<std::vector<uint8_t>> sent;
+    std::deque<std::string> inbound;
+    bool refuse = false;
+
+    bool dgram_send(const uint8_t *data, size_t len) override {
+        if (refuse)
+            return false;
+        sent.emplace_back(data, data + len);
+        return true;
+    }
+
+    size_t dgram_recv(uint8_t *out, size_t cap) override {
+        if (inbound.empty())
+            return 0;
+        std::string d = inbound.front();
+        inbound.pop_front();
+        size_t n = d.size() < cap ? d.size() : cap;
+        memcpy(out, d.data(), n);
+        return n;
+    }
+};
+
+static std::string payload_of(const std::vector<uint8_t> &d) {
+    return std::string(d.begin() + PKT_DGRAM_HEADER_SIZE, d.end());
+}
+
+void test_udp_messages_share_one_datagram_per_flush() {
+    FakeSocket sock;
+    hal::transport::HalUdp link(sock, 7);
+    TEST_ASSERT_FALSE(link.hal_serial_pending());
+    TEST_ASSERT_EQUAL(0, link.hal_serial_tx_wait_us(256));
+    TEST_ASSERT_EQUAL(0, link.hal_serial_flush(256)); // nothing to send
+
+    link.hal_serial_print("OK ");
+    link.hal_udp_println("RATE SET");
+    const uint8_t frame[] = {0x00, 0x03, 0x01, 0x02, 0x00};
+    link.hal_serial_write(frame, sizeof(frame));
+    TEST_ASSERT_FALSE(link.hal_serial_pending()); // RX only
+    TEST_ASSERT_EQUAL(1, link.hal_serial_tx_wait_us(256)); // the next flush sends it
+    TEST_ASSERT_EQUAL(0, sock.sent.size());
+
+    TEST_ASSERT_EQUAL(PKT_DGRAM_HEADER_SIZE + 13 + sizeof(frame), link.hal_serial_flush(1));
+    TEST_ASSERT_EQUAL(1, sock.sent.size());
+    pkt_dgram_t h;
+    TEST_ASSERT_TRUE(pkt_dgram_header_unpack(sock.sent[0].data(), sock.sent[0].size(), &h));
+    TEST_ASSERT_EQUAL_UINT16(7, h.node);
+    TEST_ASSERT_EQUAL_UINT32(0, h.seq);
+    TEST_ASSERT_EQUAL_STRING_LEN("OK RATE SET\r\n", payload_of(sock.sent[0]).data(), 13);
+
+    link.hal_serial_print("x");
+    link.hal_serial_flush(256);
+    TEST_ASSERT_TRUE(pkt_dgram_header_unpack(sock.sent[1].data(), sock.sent[1].size(), &h));
+    TEST_ASSERT_EQUAL_UINT32(1, h.seq);
+    TEST_ASSERT_EQUAL_UINT32(2, link.stats().datagrams_sent);
+}
+
+void test_udp_messages_are_never_split() {
+    FakeSocket sock;
+    hal::transport::HalUdp link(sock, 1);
+    const size_t room = UDP_DATAGRAM_SIZE - PKT_DGRAM_HEADER_SIZE;
+    TEST_ASSERT_EQUAL(room, link.hal_serial_tx_free());
+
+    std::string first(room - 10, 'a');
+    std::string second(20, 'b');
+    link.hal_serial_print(first.c_str());
+    link.hal_serial_print(second.c_str()); // does not fit: the open datagram goes first
+    TEST_ASSERT_EQUAL(1, sock.sent.size());
+    TEST_ASSERT_EQUAL_STRING(first.c_str(), payload_of(sock.sent[0]).c_str());
+    link.hal_serial_flush(256);
+    TEST_ASSERT_EQUAL_STRING(second.c_str(), payload_of(sock.sent[1]).c_str());
+
+    // Larger than any datagram: dropped, not truncated.
+    std::string huge(room + 1, 'h');
+    link.hal_serial_print(huge.c_str());
+    TEST_ASSERT_EQUAL(0, link.hal_serial_tx_wait_us(256));
+    TEST_ASSERT_EQUAL_UINT32(1, link.stats().messages_dropped);
+    TEST_ASSERT_TRUE(link.hal_serial_alloc(room + 1) == nullptr);
+
+    // A refused datagram still uses its seq, so the gateway sees the loss.
+    sock.refuse = true;
+    link.hal_serial_print("lost");
+    TEST_ASSERT_EQUAL(0, link.hal_serial_flush(256));
+    TEST_ASSERT_EQUAL_UINT32(1, link.stats().send_errors);
+    TEST_ASSERT_EQUAL_UINT32(3, link.next_seq());
+}
+
+void test_udp_full_reply_batch_fits_one_datagram() {
+    FakeSocket sock;
+    hal::transport::HalUdp link(sock, 1);
+
+    // A full batch of tagged replies (app_end_batch() writes it at once)
+    // after a log line it does not fit beside: the open datagram goes
+    // first, the batch travels whole in the next one.
+    std::string batch;
+    for (uint32_t tag = 1; batch.size() + 24 <= APP_REPLY_BATCH_BYTES; tag++)
+        batch += "#" + std::to_string(tag) + " ERR Unknown command\r\n";
+    batch.append(APP_REPLY_BATCH_BYTES - batch.size(), 'x');
+    std::string log(100, 'l');
+    link.hal_udp_println(log.c_str());
+    link.hal_serial_write((const uint8_t *)batch.data(), batch.size());
+    link.hal_serial_flush(256);
+
+    TEST_ASSERT_EQUAL(2, sock.sent.size());
+    TEST_ASSERT_EQUAL_STRING((log + "\r\n").c_str(), payload_of(sock.sent[0]).c_str());
+    TEST_ASSERT_EQUAL_STRING(batch.c_str(), payload_of(sock.sent[1]).c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, link.stats().messages_dropped);
+}
+
+void test_udp_alloc_builds_in_place() {
+    FakeSocket sock;
+    hal::transport::HalUdp link(sock, 1);
+    link.hal_serial_print("A");
+
+    uint8_t *block = link.hal_serial_alloc(PKT_MAX_FRAME);
+    TEST_ASSERT_NOT_NULL(block);
+    TEST_ASSERT_TRUE(link.hal_serial_alloc(8) == nullptr); // one lent at a time
+    TEST_ASSERT_EQUAL(0, link.hal_serial_tx_free());
+    link.hal_serial_print("!"); // dropped while the block is out
+    memcpy(block, "BC", 2);
+    link.hal_serial_send(block, 2);
+
+    // len 0 just returns the block.
+    block = link.hal_serial_alloc(PKT_MAX_FRAME);
+    link.hal_serial_send(block, 0);
+    link.hal_serial_flush(256);
+    TEST_ASSERT_EQUAL_STRING("ABC", payload_of(sock.sent[0]).c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, link.stats().messages_dropped);
+
+    // A block that no longer fits the open datagram sends it first.
+    std::string fill(UDP_DATAGRAM_SIZE - PKT_DGRAM_HEADER_SIZE - 4, 'f');
+    link.hal_serial_print(fill.c_str());
+    block = link.hal_serial_alloc(PKT_MAX_FRAME);
+    TEST_ASSERT_NOT_NULL(block);
+    TEST_ASSERT_EQUAL(2, sock.sent.size());
+}
+
+void test_udp_inbound_datagrams_split_into_lines() {
+    FakeSocket sock;
+    hal::transport::HalUdp link(sock, 1);
+    char line[96];
+    TEST_ASSERT_FALSE(link.serial_readline(line, sizeof(line)));
+
+    sock.inbound.push_back("#1 STATUS\r\n#2 RATE 100\n");
+    sock.inbound.push_back("HELP"); // the datagram end ends the line
+    sock.inbound.push_back(std::string(200, 'x') + "\nLED ON");
+
+    TEST_ASSERT_TRUE(link.serial_readline(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("#1 STATUS", line);
+    TEST_ASSERT_TRUE(link.hal_serial_pending());
+    TEST_ASSERT_TRUE(link.serial_readline(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("#2 RATE 100", line);
+    TEST_ASSERT_TRUE(link.serial_readline(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("HELP", line);
+    TEST_ASSERT_TRUE(link.serial_readline(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("LED ON", line);
+    TEST_ASSERT_FALSE(link.serial_readline(line, sizeof(line)));
+
+    TEST_ASSERT_EQUAL_UINT32(3, link.stats().datagrams_received);
+    TEST_ASSERT_EQUAL_UINT32(1, link.stats().lines_dropped);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_udp_messages_share_one_datagram_per_flush);
+    RUN_TEST(test_udp_messages_are_never_split);
+    RUN_TEST(test_udp_full_reply_batch_fits_one_datagram);
+    RUN_TEST(test_udp_alloc_builds_in_place);
+    RUN_TEST(test_udp_inbound_datagrams_split_into_lines);
+    return UNITY_END();
+}
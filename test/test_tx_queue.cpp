@@ -0,0 +1,246 @@
+#include <unity.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "msg_pool.h"
+#include "tx_queue.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Sink that accepts at most `room` bytes per call, like a UART FIFO.
+struct LinkSink {
+    std::string wire;
+    size_t room = 1 << 20;
+    uint32_t calls = 0;
+
+    size_t operator()(const uint8_t *data, size_t len) {
+        calls++;
+        size_t n = len < room ? len : room;
+        wire.append((const char *)data, n);
+        return n;
+    }
+};
+
+template <size_t N, size_t M>
+static bool push(util::TxQueue<N, M> &q, const char *s) {
+    return q.enqueue(s, strlen(s));
+}
+
+void test_tx_queue_gathers_messages() {
+    util::TxQueue<64, 8> q;
+    LinkSink link;
+
+    push(q, "OK ");
+    push(q, "STATE=1");
+    util::tx_iov_t iov[2] = {{"X", 1}, {"\r\n", 2}};
+    q.enqueue(iov, 2);
+
+    TEST_ASSERT_EQUAL(3, q.queued_msgs());
+    TEST_ASSERT_EQUAL(13, q.flush(link, 256));
+    TEST_ASSERT_EQUAL_STRING("OK STATE=1X\r\n", link.wire.c_str());
+    TEST_ASSERT_EQUAL(1, link.calls); // one contiguous write for all three
+    TEST_ASSERT_TRUE(q.empty());
+}
+
+void test_tx_queue_flush_is_bounded() {
+    util::TxQueue<64, 8> q;
+    LinkSink link;
+
+    push(q, "0123456789");
+    TEST_ASSERT_EQUAL(4, q.flush(link, 4));
+    TEST_ASSERT_EQUAL(6, q.queued_bytes());
+
+    // Link accepts only 3 bytes: flush stops instead of waiting.
+    link.room = 3;
+    TEST_ASSERT_EQUAL(3, q.flush(link, 100));
+    link.room = 100;
+    q.flush(link, 100);
+    TEST_ASSERT_EQUAL_STRING("0123456789", link.wire.c_str());
+    TEST_ASSERT_EQUAL(0, q.queued_msgs());
+}
+
+void test_tx_queue_drop_newest() {
+    util::TxQueue<16, 8> q(util::TX_DROP_NEWEST);
+    LinkSink link;
+
+    TEST_ASSERT_TRUE(q.enqueue("AAAAAAAAAA", 10));
+    TEST_ASSERT_FALSE(q.enqueue("BBBBBBBB", 8)); // does not fit, rejected whole
+    TEST_ASSERT_TRUE(q.enqueue("CCCCCC", 6));
+
+    q.flush(link, 100);
+    TEST_ASSERT_EQUAL_STRING("AAAAAAAAAACCCCCC", link.wire.c_str());
+    TEST_ASSERT_EQUAL(1, q.stats().msgs_dropped);
+    TEST_ASSERT_EQUAL(8, q.stats().bytes_dropped);
+    TEST_ASSERT_EQUAL(16, q.stats().high_water);
+}
+
+void test_tx_queue_overwrite_oldest() {
+    util::TxQueue<16, 8> q(util::TX_OVERWRITE_OLDEST);
+    LinkSink link;
+
+    q.enqueue("AAAAA", 5);
+    q.enqueue("BBBBB", 5);
+    q.enqueue("CCCCC", 5);
+    TEST_ASSERT_TRUE(q.enqueue("DDDDDDD", 7)); // evicts A and B
+
+    q.flush(link, 100);
+    TEST_ASSERT_EQUAL_STRING("CCCCCDDDDDDD", link.wire.c_str());
+    TEST_ASSERT_EQUAL(2, q.stats().msgs_overwritten);
+    TEST_ASSERT_EQUAL(10, q.stats().bytes_dropped);
+}
+
+void test_tx_queue_overwrite_keeps_message_in_flight() {
+    util::TxQueue<16, 8> q(util::TX_OVERWRITE_OLDEST);
+    LinkSink link;
+
+    q.enqueue("AAAAAA", 6);
+    q.enqueue("BBBBB", 5);
+    q.enqueue("CCCCC", 5);
+    TEST_ASSERT_EQUAL(2, q.flush(link, 2)); // "AA" already on the wire
+
+    // Needs 6 bytes: B is evicted, the rest of A is kept intact.
+    TEST_ASSERT_TRUE(q.enqueue("DDDDDD", 6));
+
+    q.flush(link, 100);
+    TEST_ASSERT_EQUAL_STRING("AAAAAACCCCCDDDDDD", link.wire.c_str());
+    TEST_ASSERT_EQUAL(1, q.stats().msgs_overwritten);
+}
+
+void test_tx_queue_message_slots_limit() {
+    util::TxQueue<64, 2> q(util::TX_DROP_NEWEST);
+
+    TEST_ASSERT_TRUE(q.enqueue("a", 1));
+    TEST_ASSERT_TRUE(q.enqueue("b", 1));
+    TEST_ASSERT_FALSE(q.enqueue("c", 1)); // bytes free, but no message slot
+    TEST_ASSERT_FALSE(q.enqueue(std::string(65, 'x').data(), 65)); // larger than the queue
+    TEST_ASSERT_EQUAL(2, q.stats().msgs_dropped);
+}
+
+void test_tx_queue_wraps() {
+    util::TxQueue<16, 4> q;
+    LinkSink link;
+    std::string expect;
+
+    for (int i = 0; i < 50; i++) {
+        char msg[8];
+        int n = snprintf(msg, sizeof(msg), "m%02d|", i);
+        TEST_ASSERT_TRUE(q.enqueue(msg, (size_t)n));
+        expect += msg;
+        q.flush(link, 3 + i % 4); // uneven drains keep the ring wrapping
+    }
+    q.flush(link, 1000);
+    TEST_ASSERT_EQUAL_STRING(expect.c_str(), link.wire.c_str());
+}
+
+typedef util::MsgPool<16, 4> Pool;
+
+static bool push_ref(util::TxQueue<16, 8> &q, Pool &pool, const char *s) {
+    uint8_t *block = pool.alloc();
+    memcpy(block, s, strlen(s));
+    return q.enqueue_ref(block, strlen(s), Pool::release, &pool);
+}
+
+void test_tx_queue_ref_messages_keep_order() {
+    util::TxQueue<16, 8> q;
+    Pool pool;
+    LinkSink link;
+
+    push(q, "a");
+    push(q, "b");
+    push_ref(q, pool, "REF1");
+    push(q, "c");
+    push_ref(q, pool, "REF2");
+
+    TEST_ASSERT_EQUAL(5, q.queued_msgs());
+    TEST_ASSERT_EQUAL(11, q.queued_bytes());
+    TEST_ASSERT_EQUAL(2, pool.stats().in_use);
+
+    // A partly sent block stays owned by the queue.
+    TEST_ASSERT_EQUAL(4, q.flush(link, 4));
+    TEST_ASSERT_EQUAL(2, pool.stats().in_use);
+    TEST_ASSERT_EQUAL(7, q.queued_bytes());
+
+    q.flush(link, 100);
+    TEST_ASSERT_EQUAL_STRING("abREF1cREF2", link.wire.c_str());
+    // "ab" | "RE" | "F1" | "c" | "REF2": copied runs are gathered, blocks go out in place.
+    TEST_ASSERT_EQUAL(5, link.calls);
+    TEST_ASSERT_EQUAL(0, pool.stats().in_use);
+    TEST_ASSERT_EQUAL(2, pool.stats().frees);
+    TEST_ASSERT_TRUE(q.empty());
+}
+
+void test_tx_queue_ref_released_when_dropped() {
+    Pool pool;
+
+    // Rejected: no message slot left; the block comes straight back.
+    util::TxQueue<64, 2> full(util::TX_DROP_NEWEST);
+    full.enqueue("a", 1);
+    full.enqueue("b", 1);
+    uint8_t *block = pool.alloc();
+    TEST_ASSERT_FALSE(full.enqueue_ref(block, 4, Pool::release, &pool));
+    TEST_ASSERT_EQUAL(0, pool.stats().in_use);
+    TEST_ASSERT_EQUAL(1, full.stats().msgs_dropped);
+
+    // Overwritten: evicted blocks are released, the in-flight one is not.
+    util::TxQueue<16, 2> q(util::TX_OVERWRITE_OLDEST);
+    LinkSink link;
+    uint8_t *a = pool.alloc();
+    memcpy(a, "AAAA", 4);
+    q.enqueue_ref(a, 4, Pool::release, &pool);
+    uint8_t *b = pool.alloc();
+    memcpy(b, "BBBB", 4);
+    q.enqueue_ref(b, 4, Pool::release, &pool);
+    TEST_ASSERT_EQUAL(1, q.flush(link, 1)); // "A" on the wire
+
+    TEST_ASSERT_TRUE(q.enqueue("CC", 2)); // needs a slot: B is evicted
+    TEST_ASSERT_EQUAL(1, pool.stats().in_use);
+    TEST_ASSERT_EQUAL(1, q.stats().msgs_overwritten);
+
+    q.flush(link, 100);
+    TEST_ASSERT_EQUAL_STRING("AAAACC", link.wire.c_str());
+    TEST_ASSERT_EQUAL(0, pool.stats().in_use);
+    TEST_ASSERT_EQUAL(0, pool.stats().bad_frees);
+}
+
+void test_tx_queue_ref_overwrite_mixed() {
+    util::TxQueue<16, 4> q(util::TX_OVERWRITE_OLDEST);
+    Pool pool;
+    LinkSink link;
+
+    push(q, "AAAAAA");
+    TEST_ASSERT_EQUAL(2, q.flush(link, 2)); // A in flight
+    uint8_t *r = pool.alloc();
+    memcpy(r, "RR", 2);
+    q.enqueue_ref(r, 2, Pool::release, &pool);
+    push(q, "BBBB");
+    push(q, "CCCC");
+
+    // Needs 8 ring bytes and a slot: oldest first, the ref goes (its block
+    // is released) and then B, with the rest of A slid over it.
+    TEST_ASSERT_TRUE(q.enqueue("DDDDDDDD", 8));
+    TEST_ASSERT_EQUAL(2, q.stats().msgs_overwritten);
+    TEST_ASSERT_EQUAL(0, pool.stats().in_use);
+
+    q.flush(link, 100);
+    TEST_ASSERT_EQUAL_STRING("AAAAAACCCCDDDDDDDD", link.wire.c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_tx_queue_gathers_messages);
+    RUN_TEST(test_tx_queue_flush_is_bounded);
+    RUN_TEST(test_tx_queue_drop_newest);
+    RUN_TEST(test_tx_queue_overwrite_oldest);
+    RUN_TEST(test_tx_queue_overwrite_keeps_message_in_flight);
+    RUN_TEST(test_tx_queue_message_slots_limit);
+    RUN_TEST(test_tx_queue_wraps);
+    RUN_TEST(test_tx_queue_ref_messages_keep_order);
+    RUN_TEST(test_tx_queue_ref_released_when_dropped);
+    RUN_TEST(test_tx_queue_ref_overwrite_mixed);
+    return UNITY_END();
+}
@@ -0,0 +1,224 @@
+#include <unity.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "sensors/sensor_registry.h"
+#include "stats/window_stats.h"
+
+// Unity setup/teardown hooks
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Manual mock: returns values from a script, then repeats the last one.
+class ScriptSensor : public hal::sensor::ISensor {
+    public:
+    std::vector<int32_t> values;
+    size_t next = 0;
+
+    void hal_sensor_init() override {}
+    uint8_t hal_sensor_channel_count() override { return 2; }
+    bool hal_sensor_read(uint8_t channel, int32_t *value) override {
+        (void)channel;
+        *value = values.empty() ? 0 : values[next < values.size() ? next : values.size() - 1];
+        next++;
+        return true;
+    }
+};
+
+static sensors::sensor_registry_t g_reg; // large; keep off the stack
+static stats::stats_table_t g_table;
+
+static std::vector<stats::window_summary_t> g_emitted;
+
+static void collect(void *ctx, const stats::window_summary_t *s) {
+    (void)ctx;
+    g_emitted.push_back(*s);
+}
+
+// Exact nearest-rank percentile.
+static int32_t exact_percentile(std::vector<int32_t> v, double p) {
+    std::sort(v.begin(), v.end());
+    size_t rank = (size_t)std::ceil(p * (double)v.size());
+    rank = rank < 1 ? 1 : rank;
+    return v[rank - 1];
+}
+
+void test_welford_matches_two_pass() {
+    stats::window_stats_t ws;
+    stats::stats_reset(&ws);
+
+    // Large offset, small spread: where sum of squares would cancel.
+    std::vector<int32_t> v;
+    uint32_t lcg = 1;
+    for (int i = 0; i < 1000; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        v.push_back(25000 + (int32_t)(lcg >> 28));
+        stats::stats_add(&ws, v.back());
+    }
+
+    double mean = 0, m2 = 0;
+    for (int32_t x : v)
+        mean += x;
+    mean /= (double)v.size();
+    for (int32_t x : v)
+        m2 += (x - mean) * (x - mean);
+    double var = m2 / (double)(v.size() - 1);
+
+    stats::window_summary_t s;
+    stats::stats_summarize(&ws, &s);
+    TEST_ASSERT_EQUAL_UINT32(1000, s.count);
+    TEST_ASSERT_EQUAL_INT32(*std::min_element(v.begin(), v.end()), s.min);
+    TEST_ASSERT_EQUAL_INT32(*std::max_element(v.begin(), v.end()), s.max);
+    TEST_ASSERT_TRUE(std::fabs(s.mean - mean) < 0.01);
+    TEST_ASSERT_TRUE(std::fabs(s.variance - var) / var < 0.01);
+}
+
+void test_quantiles_track_exact_percentiles() {
+    stats::window_stats_t ws;
+    stats::stats_reset(&ws);
+
+    // Skewed distribution: mostly small values, a long tail.
+    std::vector<int32_t> v;
+    uint32_t lcg = 7;
+    for (int i = 0; i < 5000; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        uint32_t u = lcg >> 20; // 0..4095
+        int32_t x = (int32_t)((u * u) >> 12);
+        v.push_back(x);
+        stats::stats_add(&ws, x);
+    }
+
+    stats::window_summary_t s;
+    stats::stats_summarize(&ws, &s);
+    // Within 2% of the value range of the exact answer.
+    TEST_ASSERT_INT32_WITHIN(82, exact_percentile(v, 0.50), s.p50);
+    TEST_ASSERT_INT32_WITHIN(82, exact_percentile(v, 0.90), s.p90);
+    TEST_ASSERT_INT32_WITHIN(82, exact_percentile(v, 0.99), s.p99);
+}
+
+void test_small_windows_are_exact() {
+    stats::window_stats_t ws;
+    stats::stats_reset(&ws);
+    stats::stats_add(&ws, 30);
+    stats::stats_add(&ws, -10);
+    stats::stats_add(&ws, 20);
+
+    stats::window_summary_t s;
+    stats::stats_summarize(&ws, &s);
+    TEST_ASSERT_EQUAL_UINT32(3, s.count);
+    TEST_ASSERT_EQUAL_INT32(20, s.p50);
+    TEST_ASSERT_EQUAL_INT32(30, s.p90);
+    TEST_ASSERT_EQUAL_INT32(30, s.p99);
+    TEST_ASSERT_TRUE(std::fabs(s.variance - 433.333f) < 0.01f);
+
+    stats::stats_reset(&ws);
+    stats::stats_add(&ws, 5);
+    stats::stats_summarize(&ws, &s);
+    TEST_ASSERT_EQUAL_INT32(5, s.p99);
+    TEST_ASSERT_TRUE(s.variance == 0.0f);
+}
+
+void test_tumbling_windows_over_registry() {
+    ScriptSensor sensor;
+    for (int32_t i = 0; i < 40; i++)
+        sensor.values.push_back(i);
+    sensors::sensor_registry_init(&g_reg);
+    sensors::sensor_registry_add(&g_reg, &sensor, 0, 10, 0);
+    stats::stats_init(&g_table);
+    g_emitted.clear();
+
+    TEST_ASSERT_FALSE(stats::stats_configure(&g_table, &g_reg, 1, 100, 0)); // no such channel
+    TEST_ASSERT_FALSE(stats::stats_configure(&g_table, &g_reg, 0, 0, 0));
+    TEST_ASSERT_TRUE(stats::stats_configure(&g_table, &g_reg, 0, 100, 0));
+
+    uint32_t due = 0;
+    TEST_ASSERT_TRUE(stats::stats_next_due(&g_table, &due));
+    TEST_ASSERT_EQUAL_UINT32(100, due);
+
+    for (uint32_t t = 0; t <= 300; t++) {
+        sensors::sensor_registry_poll(&g_reg, t);
+        stats::stats_poll(&g_table, &g_reg, t, collect, NULL);
+    }
+
+    // Samples at 10..90, 100..190, 200..290: one summary per window.
+    TEST_ASSERT_EQUAL(3, g_emitted.size());
+    TEST_ASSERT_EQUAL_UINT32(9, g_emitted[0].count);
+    TEST_ASSERT_EQUAL_INT32(0, g_emitted[0].min);
+    TEST_ASSERT_EQUAL_INT32(8, g_emitted[0].max);
+    TEST_ASSERT_EQUAL_UINT32(100, g_emitted[0].end_ms);
+    TEST_ASSERT_EQUAL_UINT32(10, g_emitted[1].count);
+    TEST_ASSERT_EQUAL_INT32(9, g_emitted[1].min);
+    TEST_ASSERT_TRUE(std::fabs(g_emitted[1].mean - 13.5f) < 0.001f);
+    TEST_ASSERT_EQUAL_UINT32(300, g_emitted[2].end_ms);
+    TEST_ASSERT_EQUAL_UINT32(30, g_table.samples); // the sample at 300 opened the next window
+
+    TEST_ASSERT_TRUE(stats::stats_disable(&g_table, 0));
+    TEST_ASSERT_FALSE(stats::stats_disable(&g_table, 0));
+    TEST_ASSERT_FALSE(stats::stats_next_due(&g_table, &due));
+}
+
+void test_windows_skip_gaps_and_count_lost_samples() {
+    ScriptSensor sensor;
+    sensor.values.push_back(7);
+    sensors::sensor_registry_init(&g_reg);
+    sensors::sensor_registry_add(&g_reg, &sensor, 0, 1, 0);
+    stats::stats_init(&g_table);
+    g_emitted.clear();
+    TEST_ASSERT_TRUE(stats::stats_configure(&g_table, &g_reg, 0, 1000, 0));
+
+    // The ring holds SENSOR_RING_DEPTH samples; read late, the rest are lost.
+    for (uint32_t t = 1; t <= 100; t++)
+        sensors::sensor_registry_poll(&g_reg, t);
+    stats::stats_poll(&g_table, &g_reg, 100, collect, NULL);
+    TEST_ASSERT_EQUAL_UINT32(SENSOR_RING_DEPTH, g_table.samples);
+
+    // Nothing sampled for several windows, then one sample at 5500: the
+    // first window closes, the empty ones emit nothing.
+    sensors::sensor_registry_poll(&g_reg, 5500);
+    stats::stats_poll(&g_table, &g_reg, 5500, collect, NULL);
+    TEST_ASSERT_EQUAL(1, g_emitted.size());
+    TEST_ASSERT_EQUAL_UINT32(SENSOR_RING_DEPTH, g_emitted[0].count);
+    TEST_ASSERT_EQUAL_UINT32(100 - SENSOR_RING_DEPTH, g_emitted[0].lost);
+    TEST_ASSERT_EQUAL_INT32(7, g_emitted[0].p50);
+
+    stats::stats_poll(&g_table, &g_reg, 6000, collect, NULL);
+    TEST_ASSERT_EQUAL(2, g_emitted.size());
+    TEST_ASSERT_EQUAL_UINT32(1, g_emitted[1].count);
+    TEST_ASSERT_EQUAL_UINT32(6000, g_emitted[1].end_ms);
+    TEST_ASSERT_EQUAL_UINT32(0, g_emitted[1].lost);
+}
+
+void test_table_capacity() {
+    ScriptSensor sensor;
+    sensors::sensor_registry_init(&g_reg);
+    for (int i = 0; i <= STATS_MAX_WINDOWS; i++)
+        sensors::sensor_registry_add(&g_reg, &sensor, 0, 10, 0);
+    stats::stats_init(&g_table);
+
+    for (int i = 0; i < STATS_MAX_WINDOWS; i++)
+        TEST_ASSERT_TRUE(stats::stats_configure(&g_table, &g_reg, (uint8_t)i, 100, 0));
+    TEST_ASSERT_FALSE(stats::stats_configure(&g_table, &g_reg, STATS_MAX_WINDOWS, 100, 0));
+
+    // Reconfiguring a channel reuses its slot; disabling frees one.
+    TEST_ASSERT_TRUE(stats::stats_configure(&g_table, &g_reg, 0, 250, 0));
+    TEST_ASSERT_EQUAL_UINT32(250, g_table.win[0].window_ms);
+    TEST_ASSERT_TRUE(stats::stats_disable(&g_table, 3));
+    TEST_ASSERT_TRUE(stats::stats_configure(&g_table, &g_reg, STATS_MAX_WINDOWS, 100, 0));
+    TEST_ASSERT_TRUE(stats::stats_enabled(&g_table, STATS_MAX_WINDOWS));
+    TEST_ASSERT_FALSE(stats::stats_enabled(&g_table, 3));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_welford_matches_two_pass);
+    RUN_TEST(test_quantiles_track_exact_percentiles);
+    RUN_TEST(test_small_windows_are_exact);
+    RUN_TEST(test_tumbling_windows_over_registry);
+    RUN_TEST(test_windows_skip_gaps_and_count_lost_samples);
+    RUN_TEST(test_table_capacity);
+    return UNITY_END();
+}